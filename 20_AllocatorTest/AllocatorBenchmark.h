@@ -0,0 +1,611 @@
+#pragma once
+
+#include <nabla.h>
+#include "ThreadCachingAddressAllocator.h"
+#include "LockFreePoolAddressAllocator.h"
+
+#include <chrono>
+#include <latch>
+#include <numeric>
+#include <thread>
+
+// Deterministic throughput benchmarks of the address allocators: the same seeded allocation traces are replayed against each of them
+// Traces are made from `std::mt19937` output directly rather than through the `std::*_distribution`s, whose algorithms differ between standard libraries, so a seed gives the same trace everywhere
+
+constexpr uint32_t DefaultBenchmarkSeed = 0x5eed1234u;
+
+// A recorded sequence of batched allocations and frees
+struct AllocationTrace
+{
+	struct Allocation
+	{
+		uint32_t size;
+		uint32_t alignment;
+	};
+
+	struct Batch
+	{
+		bool free; // otherwise it allocates
+		uint32_t first; // into `frees` when freeing, otherwise the first allocation id (a batch allocates consecutive ids)
+		uint32_t count;
+	};
+
+	std::string name;
+	uint32_t addressSpaceSize = 0u;
+	uint32_t maxAlignment = 1u;
+	uint32_t minBlockSize = 1u; // smallest allocation, the general purpose and stack allocators are created with it
+	uint32_t poolBlockSize = 1u; // largest allocation, the pool allocators are created with it
+
+	nbl::core::vector<Batch> batches;
+	nbl::core::vector<Allocation> allocations; // allocation id -> request
+	nbl::core::vector<uint32_t> frees; // allocation ids, each freed at most once
+
+	// returns the id of the first allocation of the batch
+	inline uint32_t pushAllocBatch(const uint32_t count, const std::function<Allocation()>& makeAllocation)
+	{
+		const uint32_t first = allocations.size();
+		batches.push_back({ false, first, count });
+		for (uint32_t i = 0u; i < count; i++)
+			allocations.push_back(makeAllocation());
+		return first;
+	}
+
+	inline void pushFreeBatch(const uint32_t* ids, const uint32_t count)
+	{
+		if (count == 0u)
+			return;
+		batches.push_back({ true, static_cast<uint32_t>(frees.size()), count });
+		frees.insert(frees.end(), ids, ids + count);
+	}
+};
+
+class TraceRandomNumberGenerator
+{
+	public:
+		TraceRandomNumberGenerator(const uint32_t seed) : mt(seed) {}
+
+		// in [rangeBegin, rangeEnd], the modulo bias is negligible for the ranges used here
+		inline uint32_t getRandomNumber(uint32_t rangeBegin, uint32_t rangeEnd)
+		{
+			return rangeBegin + static_cast<uint32_t>(uint64_t(mt()) % (uint64_t(rangeEnd - rangeBegin) + 1ull));
+		}
+
+		// sizes spread evenly over the orders of magnitude, like real allocations tend to be
+		inline uint32_t getLogUniformNumber(uint32_t rangeBegin, uint32_t rangeEnd)
+		{
+			const double t = double(mt()) / 4294967296.0;
+			const double value = std::exp2(std::log2(double(rangeBegin)) + t * (std::log2(double(rangeEnd)) - std::log2(double(rangeBegin))));
+			return std::clamp(static_cast<uint32_t>(value), rangeBegin, rangeEnd);
+		}
+
+		inline uint32_t getPoTAlignment(uint32_t minExp, uint32_t maxExp) { return 1u << getRandomNumber(minExp, maxExp); }
+
+		template<typename T>
+		inline void shuffle(nbl::core::vector<T>& values)
+		{
+			for (uint32_t i = values.size(); i > 1u; i--)
+				std::swap(values[i - 1u], values[getRandomNumber(0u, i - 1u)]);
+		}
+
+	private:
+		std::mt19937 mt;
+};
+
+// Streaming upload buffer: every frame allocates a few hundred small to medium ranges and frees what the frame `FramesInFlight` ago allocated, in allocation order
+inline AllocationTrace makeFrameStreamingTrace(const uint32_t seed, const uint32_t frameCount = 512u)
+{
+	constexpr uint32_t FramesInFlight = 3u;
+
+	TraceRandomNumberGenerator rng(seed);
+	AllocationTrace trace;
+	trace.name = "frame streaming";
+	trace.addressSpaceSize = 64u << 20u;
+	trace.maxAlignment = 256u;
+	trace.minBlockSize = 256u;
+	trace.poolBlockSize = 64u << 10u;
+
+	auto makeAllocation = [&]() -> AllocationTrace::Allocation { return { rng.getLogUniformNumber(256u, 64u << 10u), rng.getPoTAlignment(2u, 8u) }; };
+
+	std::array<nbl::core::vector<uint32_t>, FramesInFlight> frameAllocations;
+	auto freeFrame = [&](nbl::core::vector<uint32_t>& ids)
+		{
+			for (uint32_t i = 0u; i < ids.size(); i += 64u)
+				trace.pushFreeBatch(ids.data() + i, std::min<uint32_t>(64u, ids.size() - i));
+			ids.clear();
+		};
+
+	for (uint32_t frame = 0u; frame < frameCount; frame++)
+	{
+		// the frame reusing this slot has finished on the GPU
+		nbl::core::vector<uint32_t>& ids = frameAllocations[frame % FramesInFlight];
+		freeFrame(ids);
+
+		const uint32_t allocCount = rng.getRandomNumber(64u, 256u);
+		for (uint32_t allocated = 0u; allocated < allocCount;)
+		{
+			const uint32_t batchSize = std::min(rng.getRandomNumber(1u, 32u), allocCount - allocated);
+			const uint32_t first = trace.pushAllocBatch(batchSize, makeAllocation);
+			for (uint32_t i = 0u; i < batchSize; i++)
+				ids.push_back(first + i);
+			allocated += batchSize;
+		}
+	}
+	for (uint32_t i = 1u; i <= FramesInFlight; i++)
+		freeFrame(frameAllocations[(frameCount + i) % FramesInFlight]);
+	return trace;
+}
+
+// Long lived allocations of very different sizes and alignments, each round allocates more and frees a random half of everything live in random order
+inline AllocationTrace makeFragmentationTrace(const uint32_t seed, const uint32_t roundCount = 256u)
+{
+	TraceRandomNumberGenerator rng(seed);
+	AllocationTrace trace;
+	trace.name = "fragmentation";
+	trace.addressSpaceSize = 512u << 20u;
+	trace.maxAlignment = 4096u;
+	trace.minBlockSize = 64u;
+	trace.poolBlockSize = 1u << 20u;
+
+	auto makeAllocation = [&]() -> AllocationTrace::Allocation { return { rng.getLogUniformNumber(64u, 1u << 20u), rng.getPoTAlignment(2u, 12u) }; };
+
+	nbl::core::vector<uint32_t> live;
+	auto freeLive = [&](const uint32_t count)
+		{
+			rng.shuffle(live);
+			for (uint32_t freed = 0u; freed < count;)
+			{
+				const uint32_t batchSize = std::min(rng.getRandomNumber(1u, 16u), count - freed);
+				trace.pushFreeBatch(live.data() + live.size() - freed - batchSize, batchSize);
+				freed += batchSize;
+			}
+			live.resize(live.size() - count);
+		};
+
+	for (uint32_t round = 0u; round < roundCount; round++)
+	{
+		const uint32_t allocCount = rng.getRandomNumber(64u, 256u);
+		for (uint32_t allocated = 0u; allocated < allocCount;)
+		{
+			const uint32_t batchSize = std::min(rng.getRandomNumber(1u, 16u), allocCount - allocated);
+			const uint32_t first = trace.pushAllocBatch(batchSize, makeAllocation);
+			for (uint32_t i = 0u; i < batchSize; i++)
+				live.push_back(first + i);
+			allocated += batchSize;
+		}
+		freeLive(live.size() / 2u);
+	}
+	freeLive(live.size());
+	return trace;
+}
+
+// `multi_alloc_addr`/`multi_free_addr` of whole batches of `batchSize` small allocations, like loaders suballocating everything a mesh needs at once and releasing it together
+inline AllocationTrace makeBulkTrace(const uint32_t seed, const uint32_t roundCount = 128u, const uint32_t batchSize = 256u)
+{
+	constexpr uint32_t BatchesPerRound = 8u;
+	constexpr uint32_t MaxLiveBatches = 16u;
+
+	TraceRandomNumberGenerator rng(seed);
+	AllocationTrace trace;
+	trace.name = "bulk multi_alloc";
+	trace.addressSpaceSize = 64u << 20u;
+	trace.maxAlignment = 64u;
+	trace.minBlockSize = 64u;
+	trace.poolBlockSize = 4096u;
+
+	auto makeAllocation = [&]() -> AllocationTrace::Allocation { return { rng.getRandomNumber(1u, 64u) * 64u, rng.getPoTAlignment(4u, 6u) }; };
+
+	nbl::core::vector<uint32_t> liveBatches; // first id of each
+	nbl::core::vector<uint32_t> ids(batchSize);
+	auto freeBatch = [&](const uint32_t liveIdx)
+		{
+			std::iota(ids.begin(), ids.end(), liveBatches[liveIdx]);
+			trace.pushFreeBatch(ids.data(), batchSize);
+			liveBatches.erase(liveBatches.begin() + liveIdx);
+		};
+
+	for (uint32_t round = 0u; round < roundCount; round++)
+	{
+		for (uint32_t i = 0u; i < BatchesPerRound; i++)
+			liveBatches.push_back(trace.pushAllocBatch(batchSize, makeAllocation));
+		while (liveBatches.size() > MaxLiveBatches)
+			freeBatch(rng.getRandomNumber(0u, liveBatches.size() - 1u));
+	}
+	while (!liveBatches.empty())
+		freeBatch(liveBatches.size() - 1u);
+	return trace;
+}
+
+// Replays an `AllocationTrace` against one allocator type
+// Allocators which can't free in any order adapt the trace: the stack allocator frees the last allocations it made instead of the ones the trace names,
+// the linear allocator skips the frees and gets reset whenever it runs out of space (dropping everything it held)
+template<typename AlctrType>
+class TraceReplayer
+{
+		using Traits = nbl::core::address_allocator_traits<AlctrType>;
+		static constexpr bool IsLinear = std::is_same_v<AlctrType, nbl::core::LinearAddressAllocator<uint32_t>>;
+		static constexpr bool IsStack = std::is_same_v<AlctrType, nbl::core::StackAddressAllocator<uint32_t>>;
+		static constexpr bool IsPool = std::is_same_v<AlctrType, nbl::core::PoolAddressAllocator<uint32_t>> || std::is_same_v<AlctrType, nbl::core::IteratablePoolAddressAllocator<uint32_t>>;
+
+	public:
+		struct Result
+		{
+			double nsPerOp = 0.0; // per address allocated or freed, best of the timed replays
+			// largest (address range spanned by what the allocator holds - bytes the trace holds) / address space size seen between batches
+			// counts both padding inside allocations (alignment, pool blocks) and holes between them
+			double peakFragmentation = 0.0;
+			uint64_t reservedBytes = 0ull; // `reserved_size`, the allocator's own bookkeeping memory
+			uint32_t failedAllocations = 0u;
+			uint32_t resets = 0u;
+		};
+
+		TraceReplayer(const AllocationTrace& trace) : m_trace(trace) {}
+
+		Result run(const uint32_t timedReplays = 3u)
+		{
+			Result result = {};
+			if constexpr (IsLinear)
+				result.reservedBytes = 0ull;
+			else
+				result.reservedBytes = AlctrType::reserved_size(m_trace.maxAlignment, m_trace.addressSpaceSize, getBlockSize());
+			void* reservedSpace = result.reservedBytes ? _NBL_ALIGNED_MALLOC(result.reservedBytes, _NBL_SIMD_ALIGNMENT) : nullptr;
+
+			double bestMs = std::numeric_limits<double>::max();
+			for (uint32_t i = 0u; i < timedReplays; i++)
+			{
+				AlctrType alctr = createAllocator(reservedSpace);
+				resetReplayState();
+				const auto begin = std::chrono::high_resolution_clock::now();
+				replay<false>(alctr);
+				bestMs = std::min(bestMs, std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - begin).count());
+			}
+			result.nsPerOp = bestMs * 1e6 / double(std::max<uint64_t>(m_opCount, 1ull));
+
+			// the fragmentation bookkeeping would skew the timings, so it gets its own replay
+			{
+				AlctrType alctr = createAllocator(reservedSpace);
+				resetReplayState();
+				replay<true>(alctr);
+				result.peakFragmentation = m_peakFragmentation;
+				result.failedAllocations = m_failedAllocations;
+				result.resets = m_resets;
+			}
+
+			if (reservedSpace)
+				_NBL_ALIGNED_FREE(reservedSpace);
+			return result;
+		}
+
+	private:
+		inline uint32_t getBlockSize() const { return IsPool ? m_trace.poolBlockSize : m_trace.minBlockSize; }
+
+		AlctrType createAllocator(void* reservedSpace) const
+		{
+			if constexpr (IsLinear)
+				return AlctrType(nullptr, 0u, 0u, m_trace.maxAlignment, m_trace.addressSpaceSize);
+			else
+				return AlctrType(reservedSpace, 0u, 0u, m_trace.maxAlignment, m_trace.addressSpaceSize, getBlockSize());
+		}
+
+		void resetReplayState()
+		{
+			m_addresses.assign(m_trace.allocations.size(), AlctrType::invalid_address);
+			m_heldPos.assign(m_trace.allocations.size(), 0u);
+			m_held.clear();
+			m_liveBytes = 0ull;
+			m_opCount = 0ull;
+			m_peakFragmentation = 0.0;
+			m_failedAllocations = 0u;
+			m_resets = 0u;
+		}
+
+		template<bool Instrumented>
+		void replay(AlctrType& alctr)
+		{
+			for (const AllocationTrace::Batch& batch : m_trace.batches)
+			{
+				if (batch.free)
+					replayFree<Instrumented>(alctr, batch);
+				else
+					replayAlloc<Instrumented>(alctr, batch);
+
+				if constexpr (Instrumented)
+					sampleFragmentation();
+			}
+		}
+
+		template<bool Instrumented>
+		void replayAlloc(AlctrType& alctr, const AllocationTrace::Batch& batch)
+		{
+			for (uint32_t begin = 0u; begin < batch.count; begin += Traits::maxMultiOps)
+			{
+				const uint32_t count = std::min<uint32_t>(Traits::maxMultiOps, batch.count - begin);
+				const uint32_t firstId = batch.first + begin;
+				for (uint32_t i = 0u; i < count; i++)
+				{
+					m_outAddresses[i] = AlctrType::invalid_address;
+					m_sizes[i] = m_trace.allocations[firstId + i].size;
+					m_alignments[i] = m_trace.allocations[firstId + i].alignment;
+				}
+
+				Traits::multi_alloc_addr(alctr, count, m_outAddresses.data(), m_sizes.data(), m_alignments.data());
+				if constexpr (IsLinear)
+				{
+					if (std::find(m_outAddresses.begin(), m_outAddresses.begin() + count, AlctrType::invalid_address) != m_outAddresses.begin() + count)
+					{
+						// out of space, reset like a per frame linear allocator would and retry the whole batch
+						alctr.reset();
+						m_resets++;
+						if constexpr (Instrumented)
+						{
+							for (const uint32_t id : m_held)
+								m_addresses[id] = AlctrType::invalid_address;
+							m_held.clear();
+							m_liveBytes = 0ull;
+						}
+						std::fill(m_outAddresses.begin(), m_outAddresses.begin() + count, AlctrType::invalid_address);
+						Traits::multi_alloc_addr(alctr, count, m_outAddresses.data(), m_sizes.data(), m_alignments.data());
+					}
+				}
+				m_opCount += count;
+
+				for (uint32_t i = 0u; i < count; i++)
+				{
+					const uint32_t id = firstId + i;
+					m_addresses[id] = m_outAddresses[i];
+					if (m_outAddresses[i] == AlctrType::invalid_address)
+					{
+						m_failedAllocations++;
+						continue;
+					}
+					// the stack allocator needs them in order to free them, the others only for the fragmentation
+					if (Instrumented || IsStack)
+					{
+						m_heldPos[id] = m_held.size();
+						m_held.push_back(id);
+					}
+					if constexpr (Instrumented)
+						m_liveBytes += m_sizes[i];
+				}
+			}
+		}
+
+		template<bool Instrumented>
+		void replayFree(AlctrType& alctr, const AllocationTrace::Batch& batch)
+		{
+			if constexpr (IsLinear)
+			{
+				// nothing to give back until the next reset, the allocation keeps taking up space (and stays in `m_held`) until then
+				if constexpr (Instrumented)
+				{
+					for (uint32_t i = 0u; i < batch.count; i++)
+					{
+						const uint32_t id = m_trace.frees[batch.first + i];
+						if (m_addresses[id] != AlctrType::invalid_address)
+							m_liveBytes -= m_trace.allocations[id].size;
+					}
+				}
+			}
+			else
+				replayFreeToAllocator<Instrumented>(alctr, batch);
+		}
+
+		template<bool Instrumented>
+		void replayFreeToAllocator(AlctrType& alctr, const AllocationTrace::Batch& batch)
+		{
+			uint32_t count = 0u;
+			auto flush = [&]()
+				{
+					Traits::multi_free_addr(alctr, count, m_outAddresses.data(), m_sizes.data());
+					m_opCount += count;
+					count = 0u;
+				};
+			auto addFree = [&](const uint32_t id)
+				{
+					m_outAddresses[count] = m_addresses[id];
+					m_sizes[count] = m_trace.allocations[id].size;
+					m_addresses[id] = AlctrType::invalid_address;
+					if constexpr (Instrumented)
+						m_liveBytes -= m_sizes[count];
+					if (++count == Traits::maxMultiOps)
+						flush();
+				};
+
+			if constexpr (IsStack)
+			{
+				// frees the same amount the trace does, most recent allocation first
+				for (uint32_t i = 0u; i < batch.count && !m_held.empty(); i++)
+				{
+					addFree(m_held.back());
+					m_held.pop_back();
+				}
+			}
+			else
+			{
+				for (uint32_t i = 0u; i < batch.count; i++)
+				{
+					const uint32_t id = m_trace.frees[batch.first + i];
+					if (m_addresses[id] == AlctrType::invalid_address)
+						continue; // its allocation failed
+					if constexpr (Instrumented)
+					{
+						// swap and pop
+						const uint32_t lastId = m_held.back();
+						m_held[m_heldPos[id]] = lastId;
+						m_heldPos[lastId] = m_heldPos[id];
+						m_held.pop_back();
+					}
+					addFree(id);
+				}
+			}
+			if (count)
+				flush();
+		}
+
+		void sampleFragmentation()
+		{
+			if (m_held.empty())
+				return;
+			uint64_t spanBegin = std::numeric_limits<uint64_t>::max();
+			uint64_t spanEnd = 0ull;
+			for (const uint32_t id : m_held)
+			{
+				spanBegin = std::min<uint64_t>(spanBegin, m_addresses[id]);
+				spanEnd = std::max<uint64_t>(spanEnd, uint64_t(m_addresses[id]) + m_trace.allocations[id].size);
+			}
+			const uint64_t wasted = spanEnd - spanBegin - std::min(m_liveBytes, spanEnd - spanBegin);
+			m_peakFragmentation = std::max(m_peakFragmentation, double(wasted) / double(m_trace.addressSpaceSize));
+		}
+
+		const AllocationTrace& m_trace;
+
+		nbl::core::vector<uint32_t> m_addresses; // allocation id -> address, invalid when it failed or was freed (the linear allocator's only get invalidated by resets)
+		nbl::core::vector<uint32_t> m_held; // ids of the allocations the allocator holds, in allocation order for the stack and linear allocators
+		nbl::core::vector<uint32_t> m_heldPos; // allocation id -> index in `m_held`, for the allocators freeing in any order
+		uint64_t m_liveBytes = 0ull; // requested bytes of the allocations the trace holds
+		uint64_t m_opCount = 0ull;
+		double m_peakFragmentation = 0.0;
+		uint32_t m_failedAllocations = 0u;
+		uint32_t m_resets = 0u;
+
+		// inputs for `multi_alloc_addr` and `multi_free_addr`
+		std::array<uint32_t, Traits::maxMultiOps> m_outAddresses;
+		std::array<uint32_t, Traits::maxMultiOps> m_sizes;
+		std::array<uint32_t, Traits::maxMultiOps> m_alignments;
+};
+
+template<typename AlctrType>
+void benchmarkAllocatorOnTrace(nbl::system::ILogger* logger, const char* allocatorName, const AllocationTrace& trace)
+{
+	const auto result = TraceReplayer<AlctrType>(trace).run();
+	logger->log("\t%-24s %8.2f ns/op, peak fragmentation %6.2f%%, reserved %10.2f KB (%7.3f%% of the address space), %u failed allocations, %u resets",
+		nbl::system::ILogger::ELL_PERFORMANCE, allocatorName, result.nsPerOp, result.peakFragmentation * 100.0,
+		double(result.reservedBytes) / 1024.0, 100.0 * double(result.reservedBytes) / double(trace.addressSpaceSize), result.failedAllocations, result.resets);
+}
+
+inline void benchmarkAllocators(nbl::system::ILogger* logger, const uint32_t seed = DefaultBenchmarkSeed)
+{
+	const AllocationTrace traces[] = {
+		makeFrameStreamingTrace(seed),
+		makeFragmentationTrace(seed),
+		makeBulkTrace(seed),
+	};
+
+	for (const AllocationTrace& trace : traces)
+	{
+		logger->log("Allocator benchmark \"%s\" (seed %u): %u allocations, %u frees in %u batches over %u MB",
+			nbl::system::ILogger::ELL_PERFORMANCE, trace.name.c_str(), seed, uint32_t(trace.allocations.size()), uint32_t(trace.frees.size()), uint32_t(trace.batches.size()), trace.addressSpaceSize >> 20u);
+		benchmarkAllocatorOnTrace<nbl::core::PoolAddressAllocator<uint32_t>>(logger, "Pool", trace);
+		benchmarkAllocatorOnTrace<nbl::core::IteratablePoolAddressAllocator<uint32_t>>(logger, "IteratablePool", trace);
+		benchmarkAllocatorOnTrace<nbl::core::LinearAddressAllocator<uint32_t>>(logger, "Linear", trace);
+		benchmarkAllocatorOnTrace<nbl::core::StackAddressAllocator<uint32_t>>(logger, "Stack", trace);
+		benchmarkAllocatorOnTrace<nbl::core::GeneralpurposeAddressAllocator<uint32_t>>(logger, "Generalpurpose", trace);
+	}
+}
+
+// Every thread keeps up to `MaxLivePerThread` allocations of its own, allocating and freeing small batches of them in random order through `address_allocator_traits`
+// Reports the ops/s of all threads together, the threads start on a latch so thread creation isn't measured
+template<typename AlctrType>
+void benchmarkThreadScaling(nbl::system::ILogger* logger, const char* allocatorName, const uint32_t blockSize, const uint32_t maxAllocationSize, const uint32_t seed = DefaultBenchmarkSeed, const uint32_t opsPerThread = 1u << 16u, const uint32_t addressSpaceSize = 256u << 20u)
+{
+	using Traits = nbl::core::address_allocator_traits<AlctrType>;
+	constexpr uint32_t MaxAlignment = 256u;
+	constexpr uint32_t MaxLivePerThread = 128u;
+	constexpr uint32_t MaxBatchSize = 8u;
+
+	double singleThreadOpsPerSecond = 0.0;
+	for (uint32_t threadCount = 1u; threadCount <= 64u; threadCount *= 2u)
+	{
+		const auto reservedSize = AlctrType::reserved_size(MaxAlignment, addressSpaceSize, blockSize);
+		void* reservedSpace = _NBL_ALIGNED_MALLOC(reservedSize, _NBL_SIMD_ALIGNMENT);
+		auto alctr = std::make_unique<AlctrType>(reservedSpace, 0u, 0u, MaxAlignment, addressSpaceSize, blockSize);
+
+		std::atomic_uint32_t failedAllocations = 0u;
+		std::latch start(threadCount + 1u);
+		nbl::core::vector<std::thread> threads;
+		for (uint32_t t = 0u; t < threadCount; t++)
+		{
+			threads.emplace_back([&, t]()
+				{
+					TraceRandomNumberGenerator rng(seed + t);
+					nbl::core::vector<uint32_t> live, liveSizes;
+					std::array<uint32_t, MaxBatchSize> addresses, sizes, alignments;
+					uint32_t failed = 0u;
+
+					start.arrive_and_wait();
+					for (uint32_t ops = 0u; ops < opsPerThread;)
+					{
+						const uint32_t batchSize = rng.getRandomNumber(1u, MaxBatchSize);
+						if (live.size() + batchSize <= MaxLivePerThread && (live.size() < MaxLivePerThread / 2u || rng.getRandomNumber(0u, 1u)))
+						{
+							for (uint32_t i = 0u; i < batchSize; i++)
+							{
+								addresses[i] = AlctrType::invalid_address;
+								sizes[i] = rng.getLogUniformNumber(std::min(64u, maxAllocationSize), maxAllocationSize);
+								alignments[i] = std::min(rng.getPoTAlignment(4u, 8u), maxAllocationSize);
+							}
+							Traits::multi_alloc_addr(*alctr, batchSize, addresses.data(), sizes.data(), alignments.data());
+							for (uint32_t i = 0u; i < batchSize; i++)
+							{
+								if (addresses[i] == AlctrType::invalid_address)
+								{
+									failed++;
+									continue;
+								}
+								live.push_back(addresses[i]);
+								liveSizes.push_back(sizes[i]);
+							}
+						}
+						else
+						{
+							const uint32_t count = std::min<uint32_t>(batchSize, live.size());
+							for (uint32_t i = 0u; i < count; i++)
+							{
+								// swap a random one to the back and pop it
+								const uint32_t idx = rng.getRandomNumber(0u, live.size() - 1u);
+								addresses[i] = live[idx];
+								sizes[i] = liveSizes[idx];
+								live[idx] = live.back();
+								liveSizes[idx] = liveSizes.back();
+								live.pop_back();
+								liveSizes.pop_back();
+							}
+							Traits::multi_free_addr(*alctr, count, addresses.data(), sizes.data());
+						}
+						ops += batchSize;
+					}
+					for (uint32_t i = 0u; i < live.size(); i++)
+						Traits::multi_free_addr(*alctr, 1u, live.data() + i, liveSizes.data() + i);
+					failedAllocations += failed;
+				});
+		}
+
+		const auto begin = std::chrono::high_resolution_clock::now();
+		start.arrive_and_wait();
+		for (std::thread& thread : threads)
+			thread.join();
+		const double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - begin).count();
+
+		const double opsPerSecond = double(threadCount) * double(opsPerThread) / seconds;
+		if (threadCount == 1u)
+			singleThreadOpsPerSecond = opsPerSecond;
+		logger->log("\t%-36s %2u threads: %8.2f Mops/s (%5.2fx of 1 thread), %u failed allocations",
+			nbl::system::ILogger::ELL_PERFORMANCE, allocatorName, threadCount, opsPerSecond * 1e-6, opsPerSecond / singleThreadOpsPerSecond, failedAllocations.load());
+
+		alctr = nullptr;
+		_NBL_ALIGNED_FREE(reservedSpace);
+	}
+}
+
+// The recursive mutex wrapped allocators vs `ThreadCachingAddressAllocator` and `LockFreePoolAddressAllocator` from 1 to 64 threads,
+// the "slots" runs are single unit allocations out of 1M like `IndexAllocator` does for descriptor and texture array slots, so all threads fight over the same few bitmap words or one lock
+inline void benchmarkAllocatorThreadScaling(nbl::system::ILogger* logger, const uint32_t seed = DefaultBenchmarkSeed)
+{
+	logger->log("Allocator thread scaling (seed %u), %u hardware threads", nbl::system::ILogger::ELL_PERFORMANCE, seed, std::thread::hardware_concurrency());
+	benchmarkThreadScaling<nbl::core::PoolAddressAllocatorMT<uint32_t, std::recursive_mutex>>(logger, "PoolMT<recursive_mutex>", 4096u, 4096u, seed);
+	benchmarkThreadScaling<ThreadCachingAddressAllocator<nbl::core::PoolAddressAllocator<uint32_t>>>(logger, "ThreadCaching<Pool>", 4096u, 4096u, seed);
+	benchmarkThreadScaling<LockFreePoolAddressAllocator<uint32_t>>(logger, "LockFreePool", 4096u, 4096u, seed);
+	benchmarkThreadScaling<nbl::core::PoolAddressAllocatorMT<uint32_t, std::recursive_mutex>>(logger, "PoolMT<recursive_mutex> slots", 1u, 1u, seed, 1u << 16u, 1u << 20u);
+	benchmarkThreadScaling<LockFreePoolAddressAllocator<uint32_t>>(logger, "LockFreePool slots", 1u, 1u, seed, 1u << 16u, 1u << 20u);
+	benchmarkThreadScaling<nbl::core::GeneralpurposeAddressAllocatorMT<uint32_t, std::recursive_mutex>>(logger, "GeneralpurposeMT<recursive_mutex>", 64u, 16u << 10u, seed);
+	benchmarkThreadScaling<ThreadCachingAddressAllocator<nbl::core::GeneralpurposeAddressAllocator<uint32_t>>>(logger, "ThreadCaching<Generalpurpose>", 64u, 16u << 10u, seed);
+}
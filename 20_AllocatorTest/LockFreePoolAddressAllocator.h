@@ -0,0 +1,190 @@
+#pragma once
+
+#include <nabla.h>
+
+#include <atomic>
+#include <bit>
+
+// Pool address allocator (fixed size blocks, same rules as `core::PoolAddressAllocator`) which many threads can use at once without locks
+// The free blocks are a bitmap of 64bit words in the reserved space, allocating claims the lowest set bits of a word with one compare-exchange
+// and freeing sets them back with one `fetch_or` per word, so `multi_alloc_addr`/`multi_free_addr` of neighbouring blocks cost one atomic op per 64 blocks
+// Threads start looking for free blocks at different words so they don't all fight over the first one, a search only fails after a whole sweep found nothing free
+// `reset` and the size queries aren't atomic with respect to concurrent allocations
+template<typename _size_type>
+class LockFreePoolAddressAllocator
+{
+	public:
+		using size_type = _size_type;
+		static constexpr size_type invalid_address = ~size_type(0u);
+		static constexpr bool supportsArbitraryOrderFrees = true;
+		static constexpr bool supportsNullBuffer = true;
+		static constexpr uint32_t maxMultiOps = 256u;
+
+		static inline size_type reserved_size(size_type maxAlignment, size_type bufSz, size_type blockSz) noexcept
+		{
+			return getWordCount(bufSz / blockSz) * sizeof(Word);
+		}
+
+		// same arguments as `core::PoolAddressAllocator`
+		LockFreePoolAddressAllocator(void* reservedSpc, size_type addressOffsetToApply, size_type alignOffsetNeeded, size_type maxAllocatableAlignment, size_type bufSz, size_type blockSz) noexcept
+			: m_words(reinterpret_cast<Word*>(reservedSpc))
+			, m_addressOffset(addressOffsetToApply)
+			, m_alignOffset(alignOffsetNeeded)
+			, m_maxAlignment(maxAllocatableAlignment)
+			, m_blockSize(blockSz)
+		{
+			// first block goes where `alignOffsetNeeded` + its offset is aligned
+			m_firstBlockOffset = (m_maxAlignment - m_alignOffset % m_maxAlignment) % m_maxAlignment;
+			m_blockCount = bufSz > m_firstBlockOffset ? (bufSz - m_firstBlockOffset) / m_blockSize : 0u;
+			m_wordCount = getWordCount(m_blockCount);
+			for (uint32_t w = 0u; w < m_wordCount; w++)
+				new (m_words + w) Word();
+			reset();
+		}
+
+		LockFreePoolAddressAllocator(const LockFreePoolAddressAllocator&) = delete;
+		LockFreePoolAddressAllocator& operator=(const LockFreePoolAddressAllocator&) = delete;
+
+		inline size_type alloc_addr(size_type bytes, size_type alignment, size_type hint = 0u) noexcept
+		{
+			size_type addr = invalid_address;
+			multi_alloc_addr(1u, &addr, &bytes, &alignment);
+			return addr;
+		}
+
+		inline void free_addr(size_type addr, size_type bytes) noexcept
+		{
+			const size_type block = getBlockIndex(addr);
+			m_words[block / 64u].fetch_or(uint64_t(1u) << (block % 64u), std::memory_order_release);
+		}
+
+		//! Only allocates the `outAddresses` still equal to `invalid_address`
+		void multi_alloc_addr(uint32_t count, size_type* outAddresses, const size_type* bytes, const size_type* alignment, const size_type* hint = nullptr) noexcept
+		{
+			uint32_t needed = 0u;
+			for (uint32_t i = 0u; i < count; i++)
+				needed += (outAddresses[i] == invalid_address && isAllocatable(bytes[i], alignment[i])) ? 1u : 0u;
+			if (needed == 0u || m_wordCount == 0u)
+				return;
+
+			uint32_t nextOut = 0u;
+			auto emit = [&](const size_type block)
+				{
+					while (outAddresses[nextOut] != invalid_address || !isAllocatable(bytes[nextOut], alignment[nextOut]))
+						nextOut++;
+					outAddresses[nextOut++] = m_addressOffset + m_firstBlockOffset + block * m_blockSize;
+				};
+
+			const uint32_t startWord = getStartWord();
+			for (uint32_t i = 0u; i < m_wordCount && needed; i++)
+			{
+				const uint32_t w = (startWord + i) % m_wordCount;
+				uint64_t freeBits = m_words[w].load(std::memory_order_relaxed);
+				while (freeBits && needed)
+				{
+					// the `needed` lowest free blocks of the word
+					uint64_t claimed = freeBits;
+					if (std::popcount(claimed) > needed)
+					{
+						claimed = 0u;
+						uint64_t remaining = freeBits;
+						for (uint32_t b = 0u; b < needed; b++)
+						{
+							const uint64_t lowest = remaining & (~remaining + 1u);
+							claimed |= lowest;
+							remaining ^= lowest;
+						}
+					}
+					// on failure `freeBits` gets the word's current value and we try again with it
+					if (m_words[w].compare_exchange_weak(freeBits, freeBits & ~claimed, std::memory_order_acquire, std::memory_order_relaxed))
+					{
+						needed -= std::popcount(claimed);
+						for (; claimed; claimed &= claimed - 1u)
+							emit(size_type(w) * 64u + std::countr_zero(claimed));
+						break;
+					}
+				}
+			}
+		}
+
+		//! Blocks in the same word are given back with one atomic op, so it's best if `addr` is sorted, `bytes` isn't read and can be null
+		void multi_free_addr(uint32_t count, const size_type* addr, const size_type* bytes) noexcept
+		{
+			uint32_t word = ~0u;
+			uint64_t bits = 0u;
+			for (uint32_t i = 0u; i < count; i++)
+			{
+				if (addr[i] == invalid_address)
+					continue;
+				const size_type block = getBlockIndex(addr[i]);
+				if (block / 64u != word)
+				{
+					if (bits)
+						m_words[word].fetch_or(bits, std::memory_order_release);
+					word = block / 64u;
+					bits = 0u;
+				}
+				bits |= uint64_t(1u) << (block % 64u);
+			}
+			if (bits)
+				m_words[word].fetch_or(bits, std::memory_order_release);
+		}
+
+		inline void reset() noexcept
+		{
+			for (uint32_t w = 0u; w < m_wordCount; w++)
+			{
+				const size_type blocksInWord = std::min<size_type>(m_blockCount - size_type(w) * 64u, 64u);
+				m_words[w].store(blocksInWord == 64u ? ~uint64_t(0u) : ((uint64_t(1u) << blocksInWord) - 1u), std::memory_order_relaxed);
+			}
+			std::atomic_thread_fence(std::memory_order_release);
+		}
+
+		inline size_type max_size() const noexcept { return m_blockSize; }
+		inline size_type min_size() const noexcept { return m_blockSize; }
+		inline size_type max_alignment() const noexcept { return m_maxAlignment; }
+		inline size_type get_align_offset() const noexcept { return m_alignOffset; }
+		inline size_type get_combined_offset() const noexcept { return m_addressOffset; }
+		inline size_type get_total_size() const noexcept { return m_firstBlockOffset + m_blockCount * m_blockSize; }
+		// counts the bitmap, O(blocks / 64)
+		inline size_type get_free_size() const noexcept
+		{
+			size_type freeBlocks = 0u;
+			for (uint32_t w = 0u; w < m_wordCount; w++)
+				freeBlocks += std::popcount(m_words[w].load(std::memory_order_relaxed));
+			return freeBlocks * m_blockSize;
+		}
+		inline size_type get_allocated_size() const noexcept { return m_blockCount * m_blockSize - get_free_size(); }
+
+		inline const void* getReservedSpacePtr() const noexcept { return m_words; }
+
+	private:
+		using Word = std::atomic<uint64_t>;
+		static_assert(sizeof(Word) == sizeof(uint64_t) && Word::is_always_lock_free);
+
+		static inline uint32_t getWordCount(size_type blockCount) { return static_cast<uint32_t>((uint64_t(blockCount) + 63u) / 64u); }
+
+		inline bool isAllocatable(size_type bytes, size_type alignment) const
+		{
+			return bytes != 0u && bytes <= m_blockSize && alignment != 0u && (m_blockSize % alignment) == 0u && alignment <= m_maxAlignment;
+		}
+
+		inline size_type getBlockIndex(size_type addr) const { return (addr - m_addressOffset - m_firstBlockOffset) / m_blockSize; }
+
+		// spreads threads over the bitmap, 0x9E3779B9 being 2^32 / golden ratio
+		inline uint32_t getStartWord() const
+		{
+			static std::atomic_uint32_t nextThreadIndex = 0u;
+			thread_local const uint32_t threadIndex = nextThreadIndex.fetch_add(1u, std::memory_order_relaxed);
+			return static_cast<uint32_t>((uint64_t(threadIndex * 0x9E3779B9u) * m_wordCount) >> 32u);
+		}
+
+		Word* m_words;
+		uint32_t m_wordCount = 0u;
+		size_type m_addressOffset;
+		size_type m_alignOffset;
+		size_type m_maxAlignment;
+		size_type m_blockSize;
+		size_type m_firstBlockOffset = 0u;
+		size_type m_blockCount = 0u;
+};
@@ -0,0 +1,278 @@
+#pragma once
+
+#include <nabla.h>
+
+#include <atomic>
+#include <bit>
+#include <memory>
+#include <mutex>
+
+// Multi threaded front end for an address allocator which can free in any order (Pool or Generalpurpose), an alternative to wrapping the whole allocator in one mutex like the *MT typedefs do
+// Allocations up to `CacheParams::maxCachedSize` get rounded up to a size class (`blockSz` times a power of two, never more than the shared allocator's `max_size`, so a Pool has just the one)
+// and are served from a per thread cache of free blocks of that class,
+// the cache is refilled from/returns to the shared allocator `CacheParams::batchSize` blocks at a time with a single `multi_alloc_addr`/`multi_free_addr` under its lock
+// Bigger allocations go straight to the shared allocator, so do the rare ones aligned more than their size class (with the class' size, so they can be cached once freed)
+// Blocks sitting in caches count as allocated for the shared allocator, another thread can run out while they're there, `flush` gives them back
+// Usable through `core::address_allocator_traits`, `free_addr` has to be given the same `bytes` as the matching `alloc_addr`
+template<class AddressAllocator, class Lockable = std::mutex>
+class ThreadCachingAddressAllocator
+{
+		using BaseTraits = nbl::core::address_allocator_traits<AddressAllocator>;
+		static_assert(BaseTraits::supportsArbitraryOrderFrees, "The thread caches free blocks in whatever order they come back");
+
+	public:
+		using size_type = typename AddressAllocator::size_type;
+		static constexpr size_type invalid_address = AddressAllocator::invalid_address;
+		static constexpr bool supportsArbitraryOrderFrees = true;
+		static constexpr bool supportsNullBuffer = AddressAllocator::supportsNullBuffer;
+		static constexpr uint32_t maxMultiOps = BaseTraits::maxMultiOps;
+
+		struct CacheParams
+		{
+			size_type maxCachedSize = 64u << 10u; // clamped to what the shared allocator can allocate
+			uint32_t batchSize = 32u; // a cache holds up to twice that many blocks per size class
+			uint32_t cacheCount = 64u; // threads get a cache each round robin, more threads than caches share them
+		};
+
+		static inline size_type reserved_size(size_type maxAlignment, size_type bufSz, size_type blockSz) noexcept
+		{
+			return AddressAllocator::reserved_size(maxAlignment, bufSz, blockSz);
+		}
+
+		// same arguments as the Pool and Generalpurpose allocators, `blockSz` is the smallest size class
+		ThreadCachingAddressAllocator(void* reservedSpc, size_type addressOffsetToApply, size_type alignOffsetNeeded, size_type maxAllocatableAlignment, size_type bufSz, size_type blockSz, const CacheParams& params = {})
+			: m_allocator(reservedSpc, addressOffsetToApply, alignOffsetNeeded, maxAllocatableAlignment, bufSz, blockSz)
+			, m_batchSize(std::max(params.batchSize, 1u))
+			, m_cacheCount(std::max(params.cacheCount, 1u))
+			, m_caches(std::make_unique<ThreadCache[]>(m_cacheCount))
+		{
+			// classes are multiples of `blockSz` rather than powers of two, so a Pool with blocks of 48 bytes gets a 48 byte class and not one bigger than its blocks
+			m_minClassSize = std::max<size_type>(blockSz, 1u);
+			const size_type classLimit = std::max(std::min(params.maxCachedSize, BaseTraits::max_size(m_allocator)), m_minClassSize);
+			m_classCount = 1u;
+			while (m_classCount < MaxClassCount && (classLimit >> m_classCount) >= m_minClassSize)
+				m_classCount++;
+			m_maxClassSize = m_minClassSize << (m_classCount - 1u);
+			m_scratch.resize(m_batchSize * 2u);
+		}
+
+		ThreadCachingAddressAllocator(const ThreadCachingAddressAllocator&) = delete;
+		ThreadCachingAddressAllocator& operator=(const ThreadCachingAddressAllocator&) = delete;
+
+		size_type alloc_addr(size_type bytes, size_type alignment, size_type hint = 0u) noexcept
+		{
+			if (bytes == 0u)
+				return invalid_address;
+			if (bytes > m_maxClassSize)
+			{
+				std::lock_guard<Lockable> lock(m_lock);
+				return m_allocator.alloc_addr(bytes, alignment, hint);
+			}
+
+			const uint32_t classIdx = getClassIndex(bytes);
+			const size_type classSize = m_minClassSize << classIdx;
+			if (alignment > getClassAlignment(classSize))
+			{
+				std::lock_guard<Lockable> lock(m_lock);
+				return m_allocator.alloc_addr(classSize, alignment, hint);
+			}
+
+			ThreadCache& cache = getThreadCache();
+			std::lock_guard<Lockable> cacheLock(cache.lock);
+			return allocFromCache(cache, classIdx);
+		}
+
+		void free_addr(size_type addr, size_type bytes) noexcept
+		{
+			if (bytes > m_maxClassSize)
+			{
+				std::lock_guard<Lockable> lock(m_lock);
+				m_allocator.free_addr(addr, bytes);
+				return;
+			}
+
+			ThreadCache& cache = getThreadCache();
+			std::lock_guard<Lockable> cacheLock(cache.lock);
+			freeToCache(cache, getClassIndex(bytes), addr);
+		}
+
+		// takes the thread's cache lock once for the whole batch
+		void multi_alloc_addr(uint32_t count, size_type* outAddresses, const size_type* bytes, const size_type* alignment, const size_type* hint = nullptr) noexcept
+		{
+			ThreadCache& cache = getThreadCache();
+			std::unique_lock<Lockable> cacheLock(cache.lock, std::defer_lock);
+			for (uint32_t i = 0u; i < count; i++)
+			{
+				if (outAddresses[i] != invalid_address)
+					continue;
+				if (bytes[i] == 0u || bytes[i] > m_maxClassSize || alignment[i] > getClassAlignment(m_minClassSize << getClassIndex(bytes[i])))
+				{
+					// cache lock before shared lock, like everywhere else
+					outAddresses[i] = alloc_addr(bytes[i], alignment[i], hint ? hint[i] : 0u);
+					continue;
+				}
+				if (!cacheLock.owns_lock())
+					cacheLock.lock();
+				outAddresses[i] = allocFromCache(cache, getClassIndex(bytes[i]));
+			}
+		}
+
+		void multi_free_addr(uint32_t count, const size_type* addr, const size_type* bytes) noexcept
+		{
+			ThreadCache& cache = getThreadCache();
+			std::unique_lock<Lockable> cacheLock(cache.lock, std::defer_lock);
+			for (uint32_t i = 0u; i < count; i++)
+			{
+				if (addr[i] == invalid_address)
+					continue;
+				if (bytes[i] > m_maxClassSize)
+				{
+					std::lock_guard<Lockable> lock(m_lock);
+					m_allocator.free_addr(addr[i], bytes[i]);
+					continue;
+				}
+				if (!cacheLock.owns_lock())
+					cacheLock.lock();
+				freeToCache(cache, getClassIndex(bytes[i]), addr[i]);
+			}
+		}
+
+		// Gives every cached block back to the shared allocator, can run concurrently with allocations
+		void flush() noexcept
+		{
+			for (uint32_t i = 0u; i < m_cacheCount; i++)
+			{
+				std::lock_guard<Lockable> cacheLock(m_caches[i].lock);
+				flushCache(m_caches[i]);
+			}
+		}
+
+		// Not thread safe, like the allocators' own `reset`
+		void reset() noexcept
+		{
+			for (uint32_t i = 0u; i < m_cacheCount; i++)
+				for (auto& blocks : m_caches[i].blocks)
+					blocks.clear();
+			std::lock_guard<Lockable> lock(m_lock);
+			m_allocator.reset();
+		}
+
+		// Of the shared allocator, blocks in the caches count as allocated
+		inline size_type max_size() const noexcept { return BaseTraits::max_size(m_allocator); }
+		inline size_type min_size() const noexcept { return BaseTraits::min_size(m_allocator); }
+		inline size_type max_alignment() const noexcept { return BaseTraits::max_alignment(m_allocator); }
+		inline size_type get_align_offset() const noexcept { return BaseTraits::get_align_offset(m_allocator); }
+		inline size_type get_combined_offset() const noexcept { return BaseTraits::get_combined_offset(m_allocator); }
+		inline size_type get_free_size() const noexcept { std::lock_guard<Lockable> lock(m_lock); return BaseTraits::get_free_size(m_allocator); }
+		inline size_type get_allocated_size() const noexcept { std::lock_guard<Lockable> lock(m_lock); return BaseTraits::get_allocated_size(m_allocator); }
+		inline size_type get_total_size() const noexcept { return BaseTraits::get_total_size(m_allocator); }
+
+		inline uint32_t getSizeClassCount() const { return m_classCount; }
+		inline size_type getMaxCachedSize() const { return m_maxClassSize; }
+
+	private:
+		static constexpr uint32_t MaxClassCount = 24u;
+
+		struct alignas(64) ThreadCache // own cache line each, threads only touch theirs
+		{
+			Lockable lock;
+			std::array<nbl::core::vector<size_type>, MaxClassCount> blocks;
+		};
+
+		static uint32_t getThreadIndex()
+		{
+			static std::atomic_uint32_t nextThreadIndex = 0u;
+			thread_local const uint32_t threadIndex = nextThreadIndex.fetch_add(1u, std::memory_order_relaxed);
+			return threadIndex;
+		}
+
+		inline ThreadCache& getThreadCache() { return m_caches[getThreadIndex() % m_cacheCount]; }
+
+		inline uint32_t getClassIndex(size_type bytes) const
+		{
+			const size_type blockCount = (std::max(bytes, m_minClassSize) + m_minClassSize - 1u) / m_minClassSize;
+			return std::countr_zero(std::bit_ceil(blockCount));
+		}
+
+		// blocks of a class are aligned to the largest power of two dividing its size (all of it for power of two sizes), up to what the shared allocator can do
+		inline size_type getClassAlignment(size_type classSize) const { return std::min<size_type>(classSize & (~classSize + 1u), BaseTraits::max_alignment(m_allocator)); }
+
+		// cache lock held
+		size_type allocFromCache(ThreadCache& cache, uint32_t classIdx)
+		{
+			auto& blocks = cache.blocks[classIdx];
+			if (blocks.empty())
+			{
+				refill(cache, classIdx);
+				if (blocks.empty())
+				{
+					// the space might be sitting in this cache's other classes
+					flushCache(cache);
+					refill(cache, classIdx);
+					if (blocks.empty())
+						return invalid_address;
+				}
+			}
+			const size_type addr = blocks.back();
+			blocks.pop_back();
+			return addr;
+		}
+
+		// cache lock held
+		void freeToCache(ThreadCache& cache, uint32_t classIdx, size_type addr)
+		{
+			auto& blocks = cache.blocks[classIdx];
+			blocks.push_back(addr);
+			if (blocks.size() >= m_batchSize * 2u)
+			{
+				// give back the oldest half, the most recently freed blocks are the likeliest to be in CPU caches if the range is mapped
+				std::lock_guard<Lockable> lock(m_lock);
+				std::fill_n(m_scratch.begin(), m_batchSize, m_minClassSize << classIdx);
+				BaseTraits::multi_free_addr(m_allocator, m_batchSize, blocks.data(), m_scratch.data());
+				blocks.erase(blocks.begin(), blocks.begin() + m_batchSize);
+			}
+		}
+
+		// cache lock held
+		void refill(ThreadCache& cache, uint32_t classIdx)
+		{
+			const size_type classSize = m_minClassSize << classIdx;
+			auto& blocks = cache.blocks[classIdx];
+			const size_t first = blocks.size();
+			blocks.resize(first + m_batchSize, invalid_address);
+
+			std::lock_guard<Lockable> lock(m_lock);
+			std::fill_n(m_scratch.begin(), m_batchSize, classSize);
+			std::fill_n(m_scratch.begin() + m_batchSize, m_batchSize, getClassAlignment(classSize));
+			BaseTraits::multi_alloc_addr(m_allocator, m_batchSize, blocks.data() + first, m_scratch.data(), m_scratch.data() + m_batchSize);
+			blocks.erase(std::remove(blocks.begin() + first, blocks.end(), invalid_address), blocks.end());
+		}
+
+		// cache lock held
+		void flushCache(ThreadCache& cache)
+		{
+			std::lock_guard<Lockable> lock(m_lock);
+			for (uint32_t classIdx = 0u; classIdx < m_classCount; classIdx++)
+			{
+				auto& blocks = cache.blocks[classIdx];
+				for (size_t i = 0u; i < blocks.size(); i += m_scratch.size())
+				{
+					const uint32_t count = std::min(blocks.size() - i, m_scratch.size());
+					std::fill_n(m_scratch.begin(), count, m_minClassSize << classIdx);
+					BaseTraits::multi_free_addr(m_allocator, count, blocks.data() + i, m_scratch.data());
+				}
+				blocks.clear();
+			}
+		}
+
+		AddressAllocator m_allocator;
+		mutable Lockable m_lock; // guards `m_allocator` and `m_scratch`, always taken after a cache's lock
+		nbl::core::vector<size_type> m_scratch; // sizes and alignments for the batched calls
+
+		uint32_t m_batchSize;
+		uint32_t m_cacheCount;
+		std::unique_ptr<ThreadCache[]> m_caches;
+		size_type m_minClassSize;
+		size_type m_maxClassSize;
+		uint32_t m_classCount;
+};
@@ -3,6 +3,12 @@
 // For conditions of distribution and use, see copyright notice in nabla.h
 #include "nbl/application_templates/MonoSystemMonoLoggerApplication.hpp"
 
+#include "AllocatorBenchmark.h"
+
+// Replaces the randomized correctness tests with `benchmarkAllocators`, which replays seeded allocation traces and logs ns/op, fragmentation and reserved memory per allocator,
+// and `benchmarkAllocatorThreadScaling`
+//#define BENCHMARK_ALLOCATORS
+
 using namespace nbl;
 using namespace core;
 using namespace system;
@@ -295,6 +301,243 @@ void AllocatorHandler<core::LinearAddressAllocator<uint32_t>>::randFreeAllocated
 	}
 }
 
+// Threads allocate, free and hand allocations to each other through a `ThreadCachingAddressAllocator`, every granule of an allocation is claimed in a shadow map so overlaps get caught
+template<typename AlctrType>
+void executeThreadCachingAllocatorTest(ILogger* logger, const uint32_t blockSz, const uint32_t maxAllocationSize)
+{
+	using Traits = core::address_allocator_traits<AlctrType>;
+	constexpr uint32_t threadCount = 16u;
+	constexpr uint32_t opsPerThread = 20000u;
+	constexpr uint32_t addressSpaceSize = 64u << 20u;
+	constexpr uint32_t maxAlign = 256u;
+	// blocks which aren't a power of two in size don't start on 64 byte boundaries
+	const uint32_t granuleSize = std::min(64u, blockSz & (~blockSz + 1u));
+
+	logger->log("Performing thread caching allocator test with %d threads!\n", ILogger::ELL_INFO, threadCount);
+
+	const auto reservedSize = AlctrType::reserved_size(maxAlign, addressSpaceSize, blockSz);
+	void* reservedSpace = _NBL_ALIGNED_MALLOC(reservedSize, _NBL_SIMD_ALIGNMENT);
+	typename AlctrType::CacheParams cacheParams = {};
+	cacheParams.batchSize = 8u;
+	cacheParams.cacheCount = threadCount / 2u; // so some threads share a cache
+	auto alctr = std::make_unique<AlctrType>(reservedSpace, 0u, 0u, maxAlign, addressSpaceSize, blockSz, cacheParams);
+
+	core::vector<std::atomic_uint32_t> granuleOwners(addressSpaceSize / granuleSize);
+	std::atomic_bool failed = false;
+	auto claim = [&](const uint32_t addr, const uint32_t size, const uint32_t owner)
+		{
+			for (uint32_t g = addr / granuleSize; g < (addr + size + granuleSize - 1u) / granuleSize; g++)
+			{
+				uint32_t expected = 0u;
+				if (!granuleOwners[g].compare_exchange_strong(expected, owner))
+					failed = true;
+			}
+		};
+	auto release = [&](const uint32_t addr, const uint32_t size)
+		{
+			for (uint32_t g = addr / granuleSize; g < (addr + size + granuleSize - 1u) / granuleSize; g++)
+				granuleOwners[g] = 0u;
+		};
+
+	// allocations any thread can free
+	std::mutex handoffLock;
+	core::vector<std::pair<uint32_t, uint32_t>> handoff;
+
+	core::vector<std::thread> threads;
+	for (uint32_t t = 0u; t < threadCount; t++)
+	{
+		// `rng` isn't thread safe
+		threads.emplace_back([&, t, seed = rng.getRandomNumber(0u, ~0u)]()
+			{
+				std::mt19937 mt(seed);
+				auto getRandomNumber = [&](uint32_t rangeBegin, uint32_t rangeEnd) { return std::uniform_int_distribution<uint32_t>(rangeBegin, rangeEnd)(mt); };
+				core::vector<std::pair<uint32_t, uint32_t>> live;
+				for (uint32_t i = 0u; i < opsPerThread && !failed; i++)
+				{
+					const uint32_t action = getRandomNumber(0u, 9u);
+					if (action < 5u || live.empty())
+					{
+						const uint32_t size = getRandomNumber(1u, maxAllocationSize);
+						const uint32_t align = 1u << getRandomNumber(0u, 8u);
+						uint32_t addr = AlctrType::invalid_address;
+						Traits::multi_alloc_addr(*alctr, 1u, &addr, &size, &align);
+						if (addr == AlctrType::invalid_address)
+							continue;
+						if (addr % align)
+							failed = true;
+						claim(addr, size, t + 1u);
+						live.emplace_back(addr, size);
+					}
+					else if (action < 9u)
+					{
+						const auto allocation = live.back();
+						live.pop_back();
+						release(allocation.first, allocation.second);
+						Traits::multi_free_addr(*alctr, 1u, &allocation.first, &allocation.second);
+					}
+					else
+					{
+						std::lock_guard<std::mutex> lock(handoffLock);
+						handoff.push_back(live.back());
+						live.pop_back();
+						if (handoff.size() > 1u)
+						{
+							// free someone else's (or an old one of ours)
+							const auto allocation = handoff.front();
+							handoff.erase(handoff.begin());
+							release(allocation.first, allocation.second);
+							Traits::multi_free_addr(*alctr, 1u, &allocation.first, &allocation.second);
+						}
+					}
+				}
+				for (const auto& allocation : live)
+				{
+					release(allocation.first, allocation.second);
+					Traits::multi_free_addr(*alctr, 1u, &allocation.first, &allocation.second);
+				}
+			});
+	}
+	for (std::thread& thread : threads)
+		thread.join();
+	for (const auto& allocation : handoff)
+		Traits::multi_free_addr(*alctr, 1u, &allocation.first, &allocation.second);
+
+	// everything's back, with the cached blocks returned the shared allocator has to be empty again
+	alctr->flush();
+	if (failed || Traits::get_allocated_size(*alctr) != 0u)
+		exit(35); // TODO: log failure
+
+	alctr = nullptr;
+	_NBL_ALIGNED_FREE(reservedSpace);
+}
+
+// Threads allocate and free batches of blocks from a `LockFreePoolAddressAllocator` small enough to run out, and hand batches to each other so blocks get freed by another thread,
+// every block is claimed in a shadow map so double allocations get caught, at the end every block has to be free and allocatable again
+void executeLockFreePoolAllocatorTest(ILogger* logger)
+{
+	using AlctrType = LockFreePoolAddressAllocator<uint32_t>;
+	constexpr uint32_t threadCount = 16u;
+	constexpr uint32_t opsPerThread = 20000u;
+	constexpr uint32_t maxBatchSize = 96u;
+	constexpr uint32_t blockSz = 256u;
+	constexpr uint32_t maxAlign = 256u;
+	// not a multiple of 64 blocks, so the last bitmap word is partial, and not aligned so the blocks start after some padding
+	constexpr uint32_t addressOffset = 1024u;
+	constexpr uint32_t alignOffset = 16u;
+	constexpr uint32_t addressSpaceSize = 1000u * blockSz + maxAlign;
+
+	logger->log("Performing lock-free pool allocator test with %d threads!\n", ILogger::ELL_INFO, threadCount);
+
+	const auto reservedSize = AlctrType::reserved_size(maxAlign, addressSpaceSize, blockSz);
+	void* reservedSpace = _NBL_ALIGNED_MALLOC(reservedSize, _NBL_SIMD_ALIGNMENT);
+	auto alctr = std::make_unique<AlctrType>(reservedSpace, addressOffset, alignOffset, maxAlign, addressSpaceSize, blockSz);
+	const uint32_t blockCount = alctr->get_free_size() / blockSz;
+	const uint32_t firstBlock = alctr->get_total_size() - blockCount * blockSz;
+
+	core::vector<std::atomic_uint32_t> blockOwners(blockCount);
+	std::atomic_bool failed = false;
+	auto claim = [&](const uint32_t addr, const uint32_t owner)
+		{
+			const uint32_t offset = addr - addressOffset - firstBlock;
+			if (addr < addressOffset + firstBlock || offset % blockSz || offset / blockSz >= blockCount || (addr - addressOffset + alignOffset) % blockSz)
+			{
+				failed = true;
+				return;
+			}
+			uint32_t expected = 0u;
+			if (!blockOwners[offset / blockSz].compare_exchange_strong(expected, owner))
+				failed = true;
+		};
+	auto release = [&](const uint32_t addr) { blockOwners[(addr - addressOffset - firstBlock) / blockSz] = 0u; };
+
+	std::mutex handoffLock;
+	core::vector<core::vector<uint32_t>> handoff;
+
+	core::vector<std::thread> threads;
+	for (uint32_t t = 0u; t < threadCount; t++)
+	{
+		// `rng` isn't thread safe
+		threads.emplace_back([&, t, seed = rng.getRandomNumber(0u, ~0u)]()
+			{
+				std::mt19937 mt(seed);
+				auto getRandomNumber = [&](uint32_t rangeBegin, uint32_t rangeEnd) { return std::uniform_int_distribution<uint32_t>(rangeBegin, rangeEnd)(mt); };
+				core::vector<uint32_t> live, addresses(maxBatchSize), sizes(maxBatchSize), alignments(maxBatchSize);
+				auto freeLive = [&](const uint32_t count)
+					{
+						for (uint32_t i = live.size() - count; i < live.size(); i++)
+							release(live[i]);
+						alctr->multi_free_addr(count, live.data() + live.size() - count, nullptr);
+						live.resize(live.size() - count);
+					};
+				for (uint32_t i = 0u; i < opsPerThread && !failed; i++)
+				{
+					const uint32_t action = getRandomNumber(0u, 9u);
+					const uint32_t batchSize = getRandomNumber(1u, maxBatchSize);
+					if (action < 5u || live.empty())
+					{
+						for (uint32_t j = 0u; j < batchSize; j++)
+						{
+							// some entries are already "allocated" and have to be skipped
+							addresses[j] = getRandomNumber(0u, 15u) ? AlctrType::invalid_address : 0xdeadbeefu;
+							sizes[j] = getRandomNumber(1u, blockSz);
+							alignments[j] = 1u << getRandomNumber(0u, 8u);
+						}
+						alctr->multi_alloc_addr(batchSize, addresses.data(), sizes.data(), alignments.data());
+						for (uint32_t j = 0u; j < batchSize; j++)
+						{
+							if (addresses[j] == 0xdeadbeefu || addresses[j] == AlctrType::invalid_address)
+								continue;
+							claim(addresses[j], t + 1u);
+							live.push_back(addresses[j]);
+						}
+					}
+					else if (action < 9u)
+					{
+						std::shuffle(live.begin(), live.end(), mt);
+						freeLive(std::min<uint32_t>(batchSize, live.size()));
+					}
+					else
+					{
+						// give a batch away and free the oldest one given by anyone
+						const uint32_t count = std::min<uint32_t>(batchSize, live.size());
+						std::lock_guard<std::mutex> lock(handoffLock);
+						handoff.emplace_back(live.end() - count, live.end());
+						live.resize(live.size() - count);
+						if (handoff.size() > 1u)
+						{
+							for (const uint32_t addr : handoff.front())
+								release(addr);
+							alctr->multi_free_addr(handoff.front().size(), handoff.front().data(), nullptr);
+							handoff.erase(handoff.begin());
+						}
+					}
+				}
+				freeLive(live.size());
+			});
+	}
+	for (std::thread& thread : threads)
+		thread.join();
+	for (const auto& batch : handoff)
+	{
+		for (const uint32_t addr : batch)
+			release(addr);
+		alctr->multi_free_addr(batch.size(), batch.data(), nullptr);
+	}
+
+	if (failed || alctr->get_allocated_size() != 0u)
+		exit(36); // TODO: log failure
+
+	// after all the contention, all blocks have to come back in one go and exactly once
+	core::vector<uint32_t> addresses(blockCount + 1u, AlctrType::invalid_address), sizes(blockCount + 1u, blockSz), alignments(blockCount + 1u, blockSz);
+	alctr->multi_alloc_addr(blockCount + 1u, addresses.data(), sizes.data(), alignments.data());
+	for (uint32_t i = 0u; i < blockCount; i++)
+		claim(addresses[i], ~0u);
+	if (failed || addresses[blockCount] != AlctrType::invalid_address)
+		exit(36); // TODO: log failure
+
+	alctr = nullptr;
+	_NBL_ALIGNED_FREE(reservedSpace);
+}
 
 class AllocatorTestApp final : public nbl::application_templates::MonoSystemMonoLoggerApplication
 {
@@ -309,6 +552,10 @@ class AllocatorTestApp final : public nbl::application_templates::MonoSystemMono
 			if (!base_t::onAppInitialized(std::move(system)))
 				return false;
 
+#ifdef BENCHMARK_ALLOCATORS
+			benchmarkAllocators(m_logger.get());
+			benchmarkAllocatorThreadScaling(m_logger.get());
+#else
 			// Allocator test
 			{
 				{
@@ -336,7 +583,14 @@ class AllocatorTestApp final : public nbl::application_templates::MonoSystemMono
 					AllocatorHandler<core::GeneralpurposeAddressAllocator<uint32_t>> generalpurposeAlctrHandler;
 					generalpurposeAlctrHandler.executeAllocatorTest(m_logger.get());
 				}
+
+				executeThreadCachingAllocatorTest<ThreadCachingAddressAllocator<core::PoolAddressAllocator<uint32_t>>>(m_logger.get(), 4096u, 4096u);
+				// a block size which isn't a power of two, its size class has to stay 48 bytes
+				executeThreadCachingAllocatorTest<ThreadCachingAddressAllocator<core::PoolAddressAllocator<uint32_t>>>(m_logger.get(), 48u, 48u);
+				executeThreadCachingAllocatorTest<ThreadCachingAddressAllocator<core::GeneralpurposeAddressAllocator<uint32_t>>>(m_logger.get(), 64u, 16u << 10u);
+				executeLockFreePoolAllocatorTest(m_logger.get());
 			}
+#endif
 
 
 			// Address allocator traits test
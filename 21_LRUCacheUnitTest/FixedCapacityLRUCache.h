@@ -0,0 +1,245 @@
+#pragma once
+
+#include <nabla.h>
+
+#include <bit>
+#include <sstream>
+#include <utility>
+
+// LRU cache with the interface of `core::LRUCache` which allocates everything it will ever need up front and nothing after
+// Entries live in one array of nodes linked into the recency list by 32bit indices instead of pointers, freed nodes are kept on an intrusive free list threaded through the same links
+// Keys are found through an open addressing table (linear probing, backward shift deletion so no tombstones) of 32bit node indices, kept at most 3/4 full
+// Per entry that's the key and value plus 8 bytes of links and 5 to 11 bytes of table depending on how close the capacity is to a power of two, see `memoryFootprint()`
+template<typename Key, typename Value, typename MapHash=std::hash<Key>, typename MapEquals=std::equal_to<Key>>
+class FixedCapacityLRUCache
+{
+	public:
+		using size_type = uint32_t;
+		static constexpr size_type InvalidIndex = ~size_type(0u);
+
+		FixedCapacityLRUCache(const size_type capacity) : m_capacity(capacity)
+		{
+			// the table size has to fit in `size_type` too
+			assert(capacity > 0u && capacity <= (3u << 29u));
+			m_nodes = std::make_unique_for_overwrite<Node[]>(m_capacity);
+			// at least 4/3 of the capacity so the table is never more than 3/4 full
+			const uint64_t minTableSize = std::max<uint64_t>((uint64_t(m_capacity) * 4u + 2u) / 3u, 2u);
+			m_tableMask = static_cast<size_type>(std::bit_ceil(minTableSize) - 1u);
+			m_table = std::make_unique<size_type[]>(uint64_t(m_tableMask) + 1u);
+			std::fill_n(m_table.get(), uint64_t(m_tableMask) + 1u, InvalidIndex);
+		}
+		~FixedCapacityLRUCache()
+		{
+			clear();
+		}
+
+		FixedCapacityLRUCache(const FixedCapacityLRUCache&) = delete;
+		FixedCapacityLRUCache& operator=(const FixedCapacityLRUCache&) = delete;
+
+		inline size_type size() const { return m_size; }
+		inline size_type capacity() const { return m_capacity; }
+
+		//! Bytes of everything the cache owns, which doesn't change after construction
+		inline size_t memoryFootprint() const
+		{
+			return sizeof(*this) + sizeof(Node) * size_t(m_capacity) + sizeof(size_type) * (size_t(m_tableMask) + 1u);
+		}
+
+		//! Makes `key` the most recently used entry
+		inline Value* get(const Key& key)
+		{
+			const size_type node = m_table[findSlot(key)];
+			if (node == InvalidIndex)
+				return nullptr;
+			moveToFront(node);
+			return &m_nodes[node].entry.value;
+		}
+
+		//! Doesn't change the recency order
+		inline Value* peek(const Key& key)
+		{
+			const size_type node = m_table[findSlot(key)];
+			return node != InvalidIndex ? &m_nodes[node].entry.value : nullptr;
+		}
+
+		//! Same as `core::LRUCache::insert`, a cached `key` gets `value` assigned and a new one is constructed from it,
+		//! if the cache is full the least recently used entry is passed to `evictCallback` first and its node reused
+		template<typename K, typename V, typename EvictionCallback>
+		Value* insert(K&& key, V&& value, EvictionCallback&& evictCallback)
+		{
+			size_type slot = findSlot(key);
+			size_type node = m_table[slot];
+			if (node != InvalidIndex)
+			{
+				m_nodes[node].entry.value = std::forward<V>(value);
+				moveToFront(node);
+				return &m_nodes[node].entry.value;
+			}
+
+			if (m_size == m_capacity)
+			{
+				evictCallback(std::as_const(m_nodes[m_tail].entry.value));
+				removeEntry(m_tail);
+				// the backward shift could have moved the slot we were going to use
+				slot = findSlot(key);
+			}
+
+			node = popFreeNode();
+			new (&m_nodes[node].entry) Entry{ Key(std::forward<K>(key)), Value(std::forward<V>(value)) };
+			m_table[slot] = node;
+			linkFront(node);
+			m_size++;
+			return &m_nodes[node].entry.value;
+		}
+		template<typename K, typename V>
+		inline Value* insert(K&& key, V&& value)
+		{
+			return insert(std::forward<K>(key), std::forward<V>(value), [](const Value&) -> void {});
+		}
+
+		inline void erase(const Key& key)
+		{
+			const size_type node = m_table[findSlot(key)];
+			if (node != InvalidIndex)
+				removeEntry(node);
+		}
+
+		void clear()
+		{
+			for (size_type node = m_head; node != InvalidIndex;)
+			{
+				const size_type next = m_nodes[node].next;
+				m_nodes[node].entry.~Entry();
+				node = next;
+			}
+			std::fill_n(m_table.get(), uint64_t(m_tableMask) + 1u, InvalidIndex);
+			m_head = m_tail = m_freeHead = InvalidIndex;
+			m_size = m_untouchedNodes = 0u;
+		}
+
+		void print(nbl::core::smart_refctd_ptr<nbl::system::ILogger> logger)
+		{
+			logger->log("Printing LRU cache contents");
+			for (size_type node = m_head; node != InvalidIndex; node = m_nodes[node].next)
+			{
+				std::ostringstream stream;
+				stream << "k: '" << m_nodes[node].entry.key << "', v: '" << m_nodes[node].entry.value << "'";
+				logger->log(stream.str());
+			}
+		}
+
+	private:
+		struct Entry
+		{
+			Key key;
+			Value value;
+		};
+		// the entry only exists while the node is in the recency list, nothing gets initialized until the node is first used
+		struct Node
+		{
+			Node() {}
+			~Node() {}
+
+			union
+			{
+				Entry entry;
+			};
+			size_type prev;
+			size_type next;
+		};
+
+		inline size_type getHomeSlot(const Key& key) const
+		{
+			// fibonacci hashing so identity hashes of sequential keys still spread over the table
+			return static_cast<size_type>((uint64_t(MapHash()(key)) * 0x9E3779B97F4A7C15ull) >> 32u) & m_tableMask;
+		}
+
+		// the slot holding `key`, or the empty slot where it would go
+		inline size_type findSlot(const Key& key) const
+		{
+			size_type slot = getHomeSlot(key);
+			for (; m_table[slot] != InvalidIndex; slot = (slot + 1u) & m_tableMask)
+			{
+				if (MapEquals()(m_nodes[m_table[slot]].entry.key, key))
+					break;
+			}
+			return slot;
+		}
+
+		// nodes which were never used are handed out in order before the free list, so construction doesn't have to touch them
+		inline size_type popFreeNode()
+		{
+			if (m_freeHead == InvalidIndex)
+				return m_untouchedNodes++;
+			const size_type node = m_freeHead;
+			m_freeHead = m_nodes[node].next;
+			return node;
+		}
+
+		inline void unlink(const size_type node)
+		{
+			Node& n = m_nodes[node];
+			if (n.prev != InvalidIndex)
+				m_nodes[n.prev].next = n.next;
+			else
+				m_head = n.next;
+			if (n.next != InvalidIndex)
+				m_nodes[n.next].prev = n.prev;
+			else
+				m_tail = n.prev;
+		}
+
+		inline void linkFront(const size_type node)
+		{
+			Node& n = m_nodes[node];
+			n.prev = InvalidIndex;
+			n.next = m_head;
+			if (m_head != InvalidIndex)
+				m_nodes[m_head].prev = node;
+			else
+				m_tail = node;
+			m_head = node;
+		}
+
+		inline void moveToFront(const size_type node)
+		{
+			if (node == m_head)
+				return;
+			unlink(node);
+			linkFront(node);
+		}
+
+		// takes the entry out of the table and the recency list, destroys it and puts its node on the free list
+		void removeEntry(const size_type node)
+		{
+			size_type hole = findSlot(m_nodes[node].entry.key);
+			// shift back every following entry of the probe run which isn't already in its home slot range
+			for (size_type slot = (hole + 1u) & m_tableMask; m_table[slot] != InvalidIndex; slot = (slot + 1u) & m_tableMask)
+			{
+				const size_type home = getHomeSlot(m_nodes[m_table[slot]].entry.key);
+				// distance from home to `slot` has to be at least the distance from `hole` to `slot` for the entry to be movable into the hole
+				if (((slot - home) & m_tableMask) >= ((slot - hole) & m_tableMask))
+				{
+					m_table[hole] = m_table[slot];
+					hole = slot;
+				}
+			}
+			m_table[hole] = InvalidIndex;
+
+			unlink(node);
+			m_nodes[node].entry.~Entry();
+			m_nodes[node].next = m_freeHead;
+			m_freeHead = node;
+			m_size--;
+		}
+
+		std::unique_ptr<Node[]> m_nodes;
+		std::unique_ptr<size_type[]> m_table;
+		size_type m_tableMask;
+		size_type m_capacity;
+		size_type m_size = 0u;
+		size_type m_untouchedNodes = 0u;
+		size_type m_head = InvalidIndex;
+		size_type m_tail = InvalidIndex;
+		size_type m_freeHead = InvalidIndex;
+};
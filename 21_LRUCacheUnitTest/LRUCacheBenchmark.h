@@ -0,0 +1,186 @@
+#pragma once
+
+#include <nabla.h>
+#include "ShardedLRUCache.h"
+#include "FixedCapacityLRUCache.h"
+
+#include <chrono>
+#include <latch>
+#include <thread>
+
+// Throughput of `ShardedLRUCache` against one `core::LRUCache` behind one lock (what the streaming threads had to do before), from 1 to 64 threads,
+// and single threaded insert/get/evict rates of `FixedCapacityLRUCache` against `core::LRUCache` at residency cache sizes
+// Seeded straight from `std::mt19937` output so every run and standard library replays the same key sequence per thread
+
+constexpr uint32_t DefaultLRUBenchmarkSeed = 0x5eed1234u;
+
+// `core::LRUCache` behind a single lock with the same batched interface as `ShardedLRUCache`, a batch takes the lock once
+template<typename Key, typename Value>
+class GloballyLockedLRUCache
+{
+	public:
+		GloballyLockedLRUCache(const uint32_t capacity) : m_cache(capacity) {}
+
+		template<typename HitCallback>
+		uint32_t multi_get(const uint32_t count, const Key* keys, HitCallback&& onHit)
+		{
+			std::lock_guard<std::mutex> lock(m_lock);
+			uint32_t hits = 0u;
+			for (uint32_t i = 0u; i < count; i++)
+			{
+				Value* value = m_cache.get(keys[i]);
+				if (value)
+				{
+					onHit(i, *value);
+					hits++;
+				}
+			}
+			return hits;
+		}
+
+		template<typename V, typename EvictionCallback>
+		void multi_insert(const uint32_t count, const Key* keys, const V* values, EvictionCallback&& evictCallback)
+		{
+			std::lock_guard<std::mutex> lock(m_lock);
+			for (uint32_t i = 0u; i < count; i++)
+				m_cache.insert(keys[i], values[i], evictCallback);
+		}
+
+	private:
+		std::mutex m_lock;
+		nbl::core::LRUCache<Key, Value> m_cache;
+};
+
+// Every thread does batches of `BatchSize` lookups of keys skewed towards the low ones (log-uniform over `KeyRange`, so a hot working set and a long tail),
+// inserting the misses back like a streaming thread would after loading them, the cache holds a quarter of the key range
+template<typename CacheType>
+void benchmarkLRUCacheScaling(nbl::system::ILogger* logger, const char* cacheName, std::function<std::unique_ptr<CacheType>(uint32_t)> createCache, const uint32_t seed = DefaultLRUBenchmarkSeed, const uint32_t batchesPerThread = 1u << 14u)
+{
+	constexpr uint32_t KeyRange = 1u << 20u;
+	constexpr uint32_t Capacity = KeyRange / 4u;
+	constexpr uint32_t BatchSize = 16u;
+
+	double singleThreadOpsPerSecond = 0.0;
+	for (uint32_t threadCount = 1u; threadCount <= 64u; threadCount *= 2u)
+	{
+		auto cache = createCache(Capacity);
+		std::atomic_uint64_t hits = 0u, evictions = 0u;
+		std::latch start(threadCount + 1u);
+		nbl::core::vector<std::thread> threads;
+		for (uint32_t t = 0u; t < threadCount; t++)
+		{
+			threads.emplace_back([&, t]()
+				{
+					std::mt19937 mt(seed + t);
+					std::array<uint32_t, BatchSize> keys, missKeys;
+					std::array<uint64_t, BatchSize> values;
+					uint64_t threadHits = 0u, threadEvictions = 0u;
+					auto onEvict = [&](const uint64_t&) -> void { threadEvictions++; };
+
+					start.arrive_and_wait();
+					for (uint32_t b = 0u; b < batchesPerThread; b++)
+					{
+						for (uint32_t i = 0u; i < BatchSize; i++)
+						{
+							const double u = double(mt()) / 4294967296.0;
+							keys[i] = static_cast<uint32_t>(std::exp2(u * std::log2(double(KeyRange)))) - 1u;
+						}
+						std::array<bool, BatchSize> hit = {};
+						threadHits += cache->multi_get(BatchSize, keys.data(), [&](const uint32_t i, uint64_t&) -> void { hit[i] = true; });
+
+						uint32_t missCount = 0u;
+						for (uint32_t i = 0u; i < BatchSize; i++)
+						{
+							if (hit[i])
+								continue;
+							missKeys[missCount] = keys[i];
+							values[missCount++] = keys[i];
+						}
+						cache->multi_insert(missCount, missKeys.data(), values.data(), onEvict);
+					}
+					hits += threadHits;
+					evictions += threadEvictions;
+				});
+		}
+
+		const auto begin = std::chrono::high_resolution_clock::now();
+		start.arrive_and_wait();
+		for (std::thread& thread : threads)
+			thread.join();
+		const double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - begin).count();
+
+		const double lookups = double(threadCount) * double(batchesPerThread) * double(BatchSize);
+		const double opsPerSecond = lookups / seconds;
+		if (threadCount == 1u)
+			singleThreadOpsPerSecond = opsPerSecond;
+		logger->log("\t%-24s %2u threads: %8.2f M lookups/s (%5.2fx of 1 thread), %5.1f%% hits, %llu evictions",
+			nbl::system::ILogger::ELL_PERFORMANCE, cacheName, threadCount, opsPerSecond * 1e-6, opsPerSecond / singleThreadOpsPerSecond, 100.0 * double(hits.load()) / lookups, static_cast<unsigned long long>(evictions.load()));
+	}
+}
+
+inline void benchmarkLRUCacheThroughput(nbl::system::ILogger* logger, const uint32_t seed = DefaultLRUBenchmarkSeed)
+{
+	logger->log("LRU cache thread scaling (seed %u), %u hardware threads", nbl::system::ILogger::ELL_PERFORMANCE, seed, std::thread::hardware_concurrency());
+	using global_t = GloballyLockedLRUCache<uint32_t, uint64_t>;
+	benchmarkLRUCacheScaling<global_t>(logger, "LRUCache + mutex", [](const uint32_t capacity) { return std::make_unique<global_t>(capacity); }, seed);
+	using sharded_t = ShardedLRUCache<uint32_t, uint64_t>;
+	for (const uint32_t shardCount : { 16u, 64u, 256u })
+	{
+		const std::string name = "Sharded, " + std::to_string(shardCount) + " shards";
+		benchmarkLRUCacheScaling<sharded_t>(logger, name.c_str(), [shardCount](const uint32_t capacity) { return std::make_unique<sharded_t>(capacity, shardCount); }, seed);
+	}
+}
+
+// Fills an empty cache of `capacity` entries, gets random cached keys, then inserts new keys so every insert evicts, each phase timed on its own
+// Keys are `i * odd constant`, which is a bijection over 32 bits, so they're unique without being sequential
+template<typename CacheType>
+void benchmarkLRUCacheOperations(nbl::system::ILogger* logger, const char* cacheName, const uint32_t capacity, const uint32_t seed = DefaultLRUBenchmarkSeed)
+{
+	constexpr uint32_t KeyMultiplier = 0x9E3779B1u;
+	// the get and evict phases don't need to go over the whole cache to get a stable rate
+	const uint32_t opCount = std::min(capacity, 1u << 22u);
+	auto makeKey = [](const uint32_t i) -> uint32_t { return i * KeyMultiplier; };
+	using clock_t = std::chrono::high_resolution_clock;
+	auto nsPerOp = [](const clock_t::time_point begin, const uint32_t ops) { return std::chrono::duration<double, std::nano>(clock_t::now() - begin).count() / double(ops); };
+
+	auto begin = clock_t::now();
+	auto cache = std::make_unique<CacheType>(capacity);
+	const double constructMs = std::chrono::duration<double, std::milli>(clock_t::now() - begin).count();
+
+	begin = clock_t::now();
+	for (uint32_t i = 0u; i < capacity; i++)
+		cache->insert(makeKey(i), uint64_t(i));
+	const double insertNs = nsPerOp(begin, capacity);
+
+	std::mt19937 mt(seed);
+	uint64_t checksum = 0u;
+	begin = clock_t::now();
+	for (uint32_t i = 0u; i < opCount; i++)
+		checksum += *cache->get(makeKey(mt() % capacity));
+	const double getNs = nsPerOp(begin, opCount);
+
+	uint32_t evictions = 0u;
+	begin = clock_t::now();
+	for (uint32_t i = 0u; i < opCount; i++)
+		cache->insert(makeKey(capacity + i), uint64_t(i), [&evictions](const uint64_t&) -> void { evictions++; });
+	const double evictNs = nsPerOp(begin, opCount);
+
+	logger->log("\t%-22s %5uM entries: construct %8.2f ms, insert %6.1f ns, get %6.1f ns, evicting insert %6.1f ns (%u evictions, checksum %llu)",
+		nbl::system::ILogger::ELL_PERFORMANCE, cacheName, capacity / 1000000u, constructMs, insertNs, getNs, evictNs, evictions, static_cast<unsigned long long>(checksum));
+	if constexpr (requires(const CacheType& c) { c.memoryFootprint(); })
+	{
+		const size_t footprint = cache->memoryFootprint();
+		logger->log("\t%-22s %5uM entries: %.1f MiB, %.1f bytes per entry", nbl::system::ILogger::ELL_PERFORMANCE,
+			cacheName, capacity / 1000000u, double(footprint) / double(1u << 20u), double(footprint) / double(capacity));
+	}
+}
+
+inline void benchmarkLRUCacheImplementations(nbl::system::ILogger* logger, const uint32_t seed = DefaultLRUBenchmarkSeed)
+{
+	logger->log("LRU cache implementations, uint32_t keys and uint64_t values (seed %u)", nbl::system::ILogger::ELL_PERFORMANCE, seed);
+	for (const uint32_t capacity : { 1000000u, 10000000u, 50000000u })
+	{
+		benchmarkLRUCacheOperations<nbl::core::LRUCache<uint32_t, uint64_t>>(logger, "LRUCache", capacity, seed);
+		benchmarkLRUCacheOperations<FixedCapacityLRUCache<uint32_t, uint64_t>>(logger, "FixedCapacityLRUCache", capacity, seed);
+	}
+}
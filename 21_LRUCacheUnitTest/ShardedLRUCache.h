@@ -0,0 +1,187 @@
+#pragma once
+
+#include <nabla.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <mutex>
+
+// `core::LRUCache` split into shards by key hash, each shard being its own `core::LRUCache` with its own lock, so threads touching different keys mostly don't wait for each other
+// The recency order is per shard, so the evicted entry is the least recently used one of its shard and not necessarily of the whole cache
+// `multi_get`/`multi_insert` group the keys by shard and take each shard lock once per batch, in ascending shard order
+// Values never leave the lock as pointers (another thread could evict them right after), hits are passed to a callback which runs under the shard lock instead,
+// same goes for the eviction callbacks, which get called exactly like `core::LRUCache::insert` calls them
+template<typename Key, typename Value, typename MapHash=std::hash<Key>, typename MapEquals=std::equal_to<Key>, class Lockable=std::mutex>
+class ShardedLRUCache
+{
+	public:
+		using cache_t = nbl::core::LRUCache<Key, Value, MapHash, MapEquals>;
+
+		// `shardCount` gets rounded up to a power of two, `capacity` is split evenly between the shards
+		ShardedLRUCache(const uint32_t capacity, const uint32_t shardCount = 64u)
+			: m_shardCountLog2(std::bit_width(std::max(shardCount, 1u) - 1u))
+		{
+			const uint32_t actualShardCount = 1u << m_shardCountLog2;
+			const uint32_t shardCapacity = std::max((capacity + actualShardCount - 1u) / actualShardCount, 1u);
+			m_shards.reserve(actualShardCount);
+			for (uint32_t s = 0u; s < actualShardCount; s++)
+				m_shards.push_back(std::make_unique<Shard>(shardCapacity));
+			m_capacity = shardCapacity * actualShardCount;
+		}
+
+		ShardedLRUCache(const ShardedLRUCache&) = delete;
+		ShardedLRUCache& operator=(const ShardedLRUCache&) = delete;
+
+		inline uint32_t getShardCount() const { return m_shards.size(); }
+		// can be slightly more than asked for, every shard gets the same capacity
+		inline uint32_t getCapacity() const { return m_capacity; }
+
+		//! Calls `onHit(Value&)` under the shard lock if `key` is cached and makes it the most recently used of its shard
+		template<typename HitCallback>
+		inline bool get(const Key& key, HitCallback&& onHit)
+		{
+			Shard& shard = *m_shards[getShardIndex(key)];
+			std::lock_guard<Lockable> lock(shard.lock);
+			Value* value = shard.cache.get(key);
+			if (value)
+				onHit(*value);
+			return value != nullptr;
+		}
+
+		//! Same as `get` but doesn't change the recency order
+		template<typename HitCallback>
+		inline bool peek(const Key& key, HitCallback&& onHit)
+		{
+			Shard& shard = *m_shards[getShardIndex(key)];
+			std::lock_guard<Lockable> lock(shard.lock);
+			Value* value = shard.cache.peek(key);
+			if (value)
+				onHit(*value);
+			return value != nullptr;
+		}
+
+		//! Calls `onHit(index, Value&)` for every `keys[index]` which is cached, returns the number of hits
+		template<typename HitCallback>
+		uint32_t multi_get(const uint32_t count, const Key* keys, HitCallback&& onHit)
+		{
+			uint32_t hits = 0u;
+			forEachShard(count, keys, [&](Shard& shard, const uint32_t index)
+				{
+					Value* value = shard.cache.get(keys[index]);
+					if (value)
+					{
+						onHit(index, *value);
+						hits++;
+					}
+				});
+			return hits;
+		}
+
+		//! Same as `core::LRUCache::insert`, `onInserted(Value&)` gets called with the inserted or updated value while the shard is still locked
+		template<typename K, typename V, typename EvictionCallback, typename InsertCallback>
+		inline void insert(K&& key, V&& value, EvictionCallback&& evictCallback, InsertCallback&& onInserted)
+		{
+			Shard& shard = *m_shards[getShardIndex(key)];
+			std::lock_guard<Lockable> lock(shard.lock);
+			onInserted(*shard.cache.insert(std::forward<K>(key), std::forward<V>(value), evictCallback));
+		}
+		template<typename K, typename V, typename EvictionCallback>
+		inline void insert(K&& key, V&& value, EvictionCallback&& evictCallback)
+		{
+			insert(std::forward<K>(key), std::forward<V>(value), evictCallback, [](Value&) -> void {});
+		}
+
+		//! Inserts `values[i]` under `keys[i]` (copied, not moved), keys which repeat within one batch end up with the value which comes last
+		//! `evictCallback(const Value&)` runs under the lock of the shard it evicts from, `onInserted(index, Value&)` like in `multi_get`
+		template<typename V, typename EvictionCallback, typename InsertCallback>
+		void multi_insert(const uint32_t count, const Key* keys, const V* values, EvictionCallback&& evictCallback, InsertCallback&& onInserted)
+		{
+			forEachShard(count, keys, [&](Shard& shard, const uint32_t index)
+				{
+					onInserted(index, *shard.cache.insert(keys[index], values[index], evictCallback));
+				});
+		}
+		template<typename V, typename EvictionCallback>
+		inline void multi_insert(const uint32_t count, const Key* keys, const V* values, EvictionCallback&& evictCallback)
+		{
+			multi_insert(count, keys, values, evictCallback, [](const uint32_t, Value&) -> void {});
+		}
+
+		inline void erase(const Key& key)
+		{
+			Shard& shard = *m_shards[getShardIndex(key)];
+			std::lock_guard<Lockable> lock(shard.lock);
+			shard.cache.erase(key);
+		}
+
+		void print(nbl::core::smart_refctd_ptr<nbl::system::ILogger> logger)
+		{
+			for (uint32_t s = 0u; s < m_shards.size(); s++)
+			{
+				std::lock_guard<Lockable> lock(m_shards[s]->lock);
+				logger->log("Shard %u:", nbl::system::ILogger::ELL_INFO, s);
+				m_shards[s]->cache.print(logger);
+			}
+		}
+
+	private:
+		struct alignas(64) Shard
+		{
+			Shard(const uint32_t capacity) : cache(capacity) {}
+
+			Lockable lock;
+			cache_t cache;
+		};
+
+		// the top bits of a fibonacci hash, the shard's own hash map uses the low bits of `MapHash` so this keeps the two uncorrelated
+		inline uint32_t getShardIndex(const Key& key) const
+		{
+			if (m_shardCountLog2 == 0u)
+				return 0u;
+			return static_cast<uint32_t>((uint64_t(MapHash()(key)) * 0x9E3779B97F4A7C15ull) >> (64u - m_shardCountLog2));
+		}
+
+		// sorts the keys by shard, then every shard that has any of the keys is locked once
+		template<typename PerKey>
+		void forEachShard(const uint32_t count, const Key* keys, PerKey&& perKey)
+		{
+			if (count == 0u)
+				return;
+			if (count == 1u)
+			{
+				Shard& shard = *m_shards[getShardIndex(keys[0])];
+				std::lock_guard<Lockable> lock(shard.lock);
+				perKey(shard, 0u);
+				return;
+			}
+
+			// shard index in the high half, key index in the low half, so within a shard the keys keep their order and repeated keys resolve the same as they would one by one
+			// batches are usually small, those don't touch the heap
+			constexpr uint32_t MaxStackBatch = 64u;
+			std::array<uint64_t, MaxStackBatch> stackOrder;
+			nbl::core::vector<uint64_t> heapOrder;
+			uint64_t* order = stackOrder.data();
+			if (count > MaxStackBatch)
+			{
+				heapOrder.resize(count);
+				order = heapOrder.data();
+			}
+			for (uint32_t i = 0u; i < count; i++)
+				order[i] = (uint64_t(getShardIndex(keys[i])) << 32u) | i;
+			std::sort(order, order + count);
+
+			for (uint32_t i = 0u; i < count;)
+			{
+				const uint32_t s = static_cast<uint32_t>(order[i] >> 32u);
+				Shard& shard = *m_shards[s];
+				std::lock_guard<Lockable> lock(shard.lock);
+				for (; i < count && static_cast<uint32_t>(order[i] >> 32u) == s; i++)
+					perKey(shard, static_cast<uint32_t>(order[i]));
+			}
+		}
+
+		uint32_t m_shardCountLog2;
+		uint32_t m_capacity = 0u;
+		nbl::core::vector<std::unique_ptr<Shard>> m_shards;
+};
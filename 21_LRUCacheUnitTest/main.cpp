@@ -6,6 +6,12 @@
 // I've moved out a tiny part of this example into a shared header for reuse, please open and read it.
 #include "nbl/application_templates/MonoSystemMonoLoggerApplication.hpp"
 
+#include "LRUCacheBenchmark.h"
+
+// Also runs `benchmarkLRUCacheThroughput`, which compares `ShardedLRUCache` to a locked `core::LRUCache` from 1 to 64 threads,
+// and `benchmarkLRUCacheImplementations`, which compares `FixedCapacityLRUCache` to `core::LRUCache` at 1M, 10M and 50M entries
+//#define BENCHMARK_LRU_CACHE
+
 using namespace nbl;
 using namespace core;
 using namespace system;
@@ -13,6 +19,195 @@ using namespace asset;
 using namespace video;
 
 
+// Values are `key << 32 | stamp` so every hit and every eviction can be checked against its key
+constexpr uint64_t makeStressValue(const uint32_t key, const uint32_t stamp) { return (uint64_t(key) << 32u) | stamp; }
+constexpr uint32_t getStressKey(const uint64_t value) { return static_cast<uint32_t>(value >> 32u); }
+
+// Many threads using one `ShardedLRUCache` through the batched and the single key functions
+bool executeConcurrentLRUCacheTest(ILogger* logger)
+{
+	constexpr uint32_t threadCount = 16u;
+	constexpr uint32_t batchSize = 32u;
+	std::atomic_bool failed = false;
+	auto fail = [&](const char* what)
+		{
+			if (!failed.exchange(true))
+				logger->log("Concurrent LRU cache test failed: %s", ILogger::ELL_ERROR, what);
+		};
+	auto runThreads = [&](const std::function<void(uint32_t)>& body)
+		{
+			core::vector<std::thread> threads;
+			for (uint32_t t = 0u; t < threadCount; t++)
+				threads.emplace_back(body, t);
+			for (std::thread& thread : threads)
+				thread.join();
+		};
+
+	logger->log("Testing concurrent LRU cache with %u threads...", ILogger::ELL_INFO, threadCount);
+
+	// every thread has its own keys and the cache fits all of them, so nothing may get evicted or lost
+	{
+		constexpr uint32_t keysPerThread = 4096u;
+		ShardedLRUCache<uint32_t, uint64_t> cache(threadCount * keysPerThread * 4u, 64u);
+		runThreads([&](const uint32_t t)
+			{
+				auto onEvict = [&](const uint64_t&) -> void { fail("evicted with spare capacity"); };
+				std::array<uint32_t, batchSize> keys;
+				std::array<uint64_t, batchSize> values;
+				// the second round hits and has to update the values in place
+				for (uint32_t stamp = 0u; stamp < 2u; stamp++)
+				{
+					for (uint32_t first = 0u; first < keysPerThread; first += batchSize)
+					{
+						for (uint32_t i = 0u; i < batchSize; i++)
+						{
+							keys[i] = t * keysPerThread + first + i;
+							values[i] = makeStressValue(keys[i], stamp);
+						}
+						cache.multi_insert(batchSize, keys.data(), values.data(), onEvict, [&](const uint32_t i, uint64_t& inserted) -> void
+							{
+								if (inserted != values[i])
+									fail("inserted value doesn't match");
+							});
+					}
+				}
+				for (uint32_t first = 0u; first < keysPerThread; first += batchSize)
+				{
+					for (uint32_t i = 0u; i < batchSize; i++)
+						keys[i] = t * keysPerThread + first + i;
+					const uint32_t hits = cache.multi_get(batchSize, keys.data(), [&](const uint32_t i, uint64_t& value) -> void
+						{
+							if (value != makeStressValue(keys[i], 1u))
+								fail("got a stale or foreign value");
+						});
+					if (hits != batchSize)
+						fail("lost an entry");
+				}
+			});
+	}
+
+	// everyone fights over a key range much bigger than the cache, with erases and repeated keys in a batch thrown in
+	{
+		constexpr uint32_t keyRange = 1u << 14u;
+		constexpr uint32_t batchesPerThread = 4096u;
+		ShardedLRUCache<uint32_t, uint64_t> cache(1024u, 16u);
+		std::atomic_uint32_t evictions = 0u;
+		auto onEvict = [&](const uint64_t& evicted) -> void
+			{
+				if (getStressKey(evicted) >= keyRange)
+					fail("evicted a value which was never inserted");
+				evictions++;
+			};
+		runThreads([&, seed = uint32_t(std::random_device()())](const uint32_t t)
+			{
+				std::mt19937 mt(seed + t);
+				std::array<uint32_t, batchSize> keys;
+				std::array<uint64_t, batchSize> values;
+				for (uint32_t b = 0u; b < batchesPerThread && !failed; b++)
+				{
+					for (uint32_t i = 0u; i < batchSize; i++)
+					{
+						// the low keys are hot and some repeat within the batch
+						keys[i] = (mt() % 4u) ? mt() % (keyRange / 16u) : mt() % keyRange;
+						values[i] = makeStressValue(keys[i], t);
+					}
+					switch (mt() % 8u)
+					{
+						case 0u:
+							cache.erase(keys[0]);
+							break;
+						case 1u:
+						case 2u:
+							cache.multi_insert(batchSize, keys.data(), values.data(), onEvict);
+							break;
+						case 3u:
+							cache.insert(keys[0], values[0], onEvict, [&](uint64_t& inserted) -> void
+								{
+									if (inserted != values[0])
+										fail("inserted value doesn't match");
+								});
+							break;
+						default:
+							cache.multi_get(batchSize, keys.data(), [&](const uint32_t i, uint64_t& value) -> void
+								{
+									if (getStressKey(value) != keys[i])
+										fail("got a value of another key");
+								});
+							break;
+					}
+				}
+			});
+
+		// can't hold more than the shards' capacities together
+		uint32_t resident = 0u;
+		for (uint32_t key = 0u; key < keyRange; key++)
+			resident += cache.peek(key, [](uint64_t&) -> void {}) ? 1u : 0u;
+		if (resident > cache.getCapacity())
+			fail("more entries than capacity");
+		if (evictions == 0u)
+			fail("nothing got evicted");
+	}
+
+	return !failed;
+}
+
+// Random inserts, gets, peeks and erases on a `FixedCapacityLRUCache` and a `core::LRUCache` side by side, both have to agree on every hit, value and eviction
+bool executeFixedCapacityLRUCacheTest(ILogger* logger)
+{
+	constexpr uint32_t capacity = 1000u;
+	constexpr uint32_t keyRange = 4000u;
+	constexpr uint32_t opCount = 1000000u;
+
+	logger->log("Testing fixed capacity LRU cache against LRUCache...", ILogger::ELL_INFO);
+
+	FixedCapacityLRUCache<uint32_t, uint64_t> fixedCache(capacity);
+	LRUCache<uint32_t, uint64_t> referenceCache(capacity);
+	std::mt19937 mt(std::random_device{}());
+	for (uint32_t i = 0u; i < opCount; i++)
+	{
+		const uint32_t key = mt() % keyRange;
+		bool matches = true;
+		switch (mt() % 8u)
+		{
+			case 0u:
+				fixedCache.erase(key);
+				referenceCache.erase(key);
+				break;
+			case 1u:
+			{
+				const uint64_t* fixedValue = fixedCache.peek(key);
+				const uint64_t* referenceValue = referenceCache.peek(key);
+				matches = fixedValue ? (referenceValue && *fixedValue == *referenceValue) : !referenceValue;
+				break;
+			}
+			case 2u:
+			case 3u:
+			case 4u:
+			{
+				const uint64_t* fixedValue = fixedCache.get(key);
+				const uint64_t* referenceValue = referenceCache.get(key);
+				matches = fixedValue ? (referenceValue && *fixedValue == *referenceValue) : !referenceValue;
+				break;
+			}
+			default:
+			{
+				uint64_t fixedEvicted = ~0ull, referenceEvicted = ~0ull;
+				const uint64_t value = (uint64_t(key) << 32u) | i;
+				const uint64_t fixedInserted = *fixedCache.insert(key, value, [&](const uint64_t& evicted) -> void { fixedEvicted = evicted; });
+				const uint64_t referenceInserted = *referenceCache.insert(key, value, [&](const uint64_t& evicted) -> void { referenceEvicted = evicted; });
+				matches = fixedInserted == value && referenceInserted == value && fixedEvicted == referenceEvicted;
+				break;
+			}
+		}
+		if (!matches || fixedCache.size() > capacity)
+		{
+			logger->log("Fixed capacity LRU cache test failed at operation %u on key %u", ILogger::ELL_ERROR, i, key);
+			return false;
+		}
+	}
+	return true;
+}
+
 class LRUCacheTestApp final : public nbl::application_templates::MonoSystemMonoLoggerApplication
 {
 		using base_t = application_templates::MonoSystemMonoLoggerApplication;
@@ -47,6 +242,11 @@ class LRUCacheTestApp final : public nbl::application_templates::MonoSystemMonoL
 			LRUCache<int, char> hugeCache(50000000u);
 			hugeCache.insert(0, '0');
 			hugeCache.print(m_logger);
+			m_logger->log("Testing large fixed capacity cache...");
+			FixedCapacityLRUCache<int, char> hugeFixedCache(50000000u);
+			hugeFixedCache.insert(0, '0');
+			hugeFixedCache.print(m_logger);
+			m_logger->log("50M entry fixed capacity cache takes %.1f MiB", ILogger::ELL_INFO, double(hugeFixedCache.memoryFootprint()) / double(1u << 20u));
 
 
 			LRUCache<int, char> cache(5u);
@@ -185,6 +385,15 @@ class LRUCacheTestApp final : public nbl::application_templates::MonoSystemMonoL
 			assert(insertion->alloc_idx == InvalidIdx);
 			assert(insertion->lastUsedSemaphoreValue == 6999ull);
 
+			if (!executeConcurrentLRUCacheTest(m_logger.get()))
+				return false;
+			if (!executeFixedCapacityLRUCacheTest(m_logger.get()))
+				return false;
+		#ifdef BENCHMARK_LRU_CACHE
+			benchmarkLRUCacheThroughput(m_logger.get());
+			benchmarkLRUCacheImplementations(m_logger.get());
+		#endif
+
 			return true;
 		}
 		std::unique_ptr<TextureLRUCache> m_textureLRUCache;
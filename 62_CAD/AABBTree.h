@@ -0,0 +1,149 @@
+#pragma once
+
+#include <vector>
+#include <span>
+#include <algorithm>
+#include <cstdint>
+#include <cassert>
+
+// Static bounding volume hierarchy over 2D axis aligned boxes answering "which boxes overlap this box"
+// Built top-down by splitting at the median centroid along the longest axis of each node, so the tree is always balanced
+// build is O(n log n), query is O(log n + k) for small query boxes, where k is the number of reported boxes
+// Boxes are referred to by their index in the span passed to `build`
+template<typename vector_t>
+class AABBTree
+{
+public:
+	struct AABB
+	{
+		vector_t min;
+		vector_t max;
+
+		inline bool overlaps(const AABB& other) const
+		{
+			return min.x <= other.max.x && other.min.x <= max.x && min.y <= other.max.y && other.min.y <= max.y;
+		}
+
+		inline void extend(const AABB& other)
+		{
+			min.x = std::min(min.x, other.min.x);
+			min.y = std::min(min.y, other.min.y);
+			max.x = std::max(max.x, other.max.x);
+			max.y = std::max(max.y, other.max.y);
+		}
+	};
+
+	static constexpr uint32_t MaxLeafSize = 4u;
+
+	AABBTree() = default;
+
+	void build(std::span<const AABB> boxes)
+	{
+		clear();
+		if (boxes.empty())
+			return;
+
+		m_boxes.assign(boxes.begin(), boxes.end());
+		m_indices.resize(boxes.size());
+		for (uint32_t i = 0u; i < m_indices.size(); ++i)
+			m_indices[i] = i;
+
+		m_nodes.reserve(2u * (boxes.size() / MaxLeafSize + 1u));
+		m_nodes.emplace_back();
+		build_impl(0u, 0u, static_cast<uint32_t>(m_indices.size()));
+	}
+
+	void clear()
+	{
+		m_nodes.clear();
+		m_indices.clear();
+		m_boxes.clear();
+	}
+
+	inline uint32_t size() const { return static_cast<uint32_t>(m_indices.size()); }
+	inline bool empty() const { return m_indices.empty(); }
+
+	// calls `func(uint32_t boxIdx)` for every box overlapping `queryBox`
+	template<typename Func>
+	void query(const AABB& queryBox, Func&& func) const
+	{
+		if (m_nodes.empty())
+			return;
+
+		// balanced tree, so depth is log2 of the leaf count
+		constexpr uint32_t MaxStackSize = 64u;
+		uint32_t stack[MaxStackSize];
+		uint32_t stackSize = 0u;
+		stack[stackSize++] = 0u;
+
+		while (stackSize > 0u)
+		{
+			const Node& node = m_nodes[stack[--stackSize]];
+			if (!node.box.overlaps(queryBox))
+				continue;
+
+			if (node.isLeaf())
+			{
+				for (uint32_t i = node.first; i < node.first + node.count; ++i)
+					if (m_boxes[m_indices[i]].overlaps(queryBox))
+						func(m_indices[i]);
+			}
+			else
+			{
+				assert(stackSize + 2u <= MaxStackSize);
+				stack[stackSize++] = node.first;
+				stack[stackSize++] = node.first + 1u;
+			}
+		}
+	}
+
+private:
+	struct Node
+	{
+		AABB box;
+		uint32_t first; // first index in `m_indices` for leaves, index of the left child for inner nodes (right child follows it)
+		uint32_t count; // 0 for inner nodes
+
+		inline bool isLeaf() const { return count > 0u; }
+	};
+
+	void build_impl(uint32_t nodeIdx, uint32_t first, uint32_t count)
+	{
+		AABB box = m_boxes[m_indices[first]];
+		for (uint32_t i = first + 1u; i < first + count; ++i)
+			box.extend(m_boxes[m_indices[i]]);
+		m_nodes[nodeIdx].box = box;
+
+		if (count <= MaxLeafSize)
+		{
+			m_nodes[nodeIdx].first = first;
+			m_nodes[nodeIdx].count = count;
+			return;
+		}
+
+		const bool splitX = (box.max.x - box.min.x) >= (box.max.y - box.min.y);
+		const uint32_t half = count / 2u;
+		auto begin = m_indices.begin() + first;
+		std::nth_element(begin, begin + half, begin + count,
+			[&](uint32_t lhs, uint32_t rhs)
+			{
+				const AABB& a = m_boxes[lhs];
+				const AABB& b = m_boxes[rhs];
+				return splitX ? (a.min.x + a.max.x) < (b.min.x + b.max.x) : (a.min.y + a.max.y) < (b.min.y + b.max.y);
+			});
+
+		// careful, `m_nodes` may reallocate here
+		const uint32_t leftIdx = static_cast<uint32_t>(m_nodes.size());
+		m_nodes.emplace_back();
+		m_nodes.emplace_back();
+		m_nodes[nodeIdx].first = leftIdx;
+		m_nodes[nodeIdx].count = 0u;
+
+		build_impl(leftIdx, first, half);
+		build_impl(leftIdx + 1u, first + half, count - half);
+	}
+
+	std::vector<Node> m_nodes;
+	std::vector<uint32_t> m_indices;
+	std::vector<AABB> m_boxes;
+};
@@ -0,0 +1,1249 @@
+#pragma once
+
+// CPU-side benchmarks of the CAD example, these don't need a device and run before anything gets recorded
+// Enable them with the BENCHMARK_* defines at the top of main.cpp
+
+#include "Hatch.h"
+#include "Polyline.h"
+#include "IntervalTree.h"
+#include "DrawResourcesFiller.h"
+#include "HatchGlyphBuilder.h"
+#include "MemoryArena.h"
+#include "ParallelPolylineCache.h"
+#include "SingleLineText.h"
+#include "TextBlock.h"
+#include "SpatialGrid.h"
+#include "PolylineLOD.h"
+#include "GeoTextureStreaming.h"
+
+#include <chrono>
+#include <fstream>
+#include <random>
+#include <thread>
+#include <queue>
+#include <memory_resource>
+
+namespace cad_benchmarks
+{
+
+using bench_clock_t = std::chrono::high_resolution_clock;
+
+template<typename Func>
+inline double measureMilliseconds(Func&& func)
+{
+	const auto begin = bench_clock_t::now();
+	func();
+	const auto end = bench_clock_t::now();
+	return std::chrono::duration<double, std::milli>(end - begin).count();
+}
+
+// Closed loops only, because hatches are built from closed polygons
+// Each synthetic hatch is a jittered ring of lines with a circular hole made of quadratic beziers
+inline std::vector<std::vector<CPolyline>> generateSyntheticHatches(uint32_t hatchCount, uint32_t segmentsPerLoop, uint32_t seed = 0x45u)
+{
+	std::mt19937 mt(seed);
+	std::uniform_real_distribution<double> jitter(0.85, 1.15);
+
+	std::vector<std::vector<CPolyline>> ret(hatchCount);
+	const uint32_t gridWidth = static_cast<uint32_t>(std::ceil(std::sqrt(double(hatchCount))));
+	for (uint32_t h = 0u; h < hatchCount; ++h)
+	{
+		const float64_t2 center = float64_t2(double(h % gridWidth), double(h / gridWidth)) * 10.0;
+		CPolyline polyline;
+
+		std::vector<float64_t2> linePoints;
+		linePoints.reserve(segmentsPerLoop + 1u);
+		for (uint32_t s = 0u; s < segmentsPerLoop; ++s)
+		{
+			const double angle = (2.0 * nbl::core::PI<double>() * s) / segmentsPerLoop;
+			linePoints.push_back(center + float64_t2(cos(angle), sin(angle)) * 4.0 * jitter(mt));
+		}
+		linePoints.push_back(linePoints.front());
+		polyline.addLinePoints(linePoints);
+
+		std::vector<shapes::QuadraticBezier<double>> beziers;
+		beziers.reserve(segmentsPerLoop);
+		const double halfStep = nbl::core::PI<double>() / segmentsPerLoop;
+		const double radius = 2.0;
+		for (uint32_t s = 0u; s < segmentsPerLoop; ++s)
+		{
+			const double a0 = 2.0 * halfStep * s;
+			const double a1 = 2.0 * halfStep * (s + 1u);
+			const double mid = a0 + halfStep;
+			beziers.push_back(shapes::QuadraticBezier<double>::construct(
+				center + float64_t2(cos(a0), sin(a0)) * radius,
+				center + float64_t2(cos(mid), sin(mid)) * (radius / cos(halfStep)),
+				center + float64_t2(cos(a1), sin(a1)) * radius));
+		}
+		polyline.addQuadBeziers(beziers);
+
+		ret[h].push_back(std::move(polyline));
+	}
+	return ret;
+}
+
+// Open polylines of jittered lines followed by a run of quadratic beziers, laid out on a grid
+inline std::vector<CPolyline> generateSyntheticPolylines(uint32_t polylineCount, uint32_t linesPerPolyline, uint32_t beziersPerPolyline, uint32_t seed = 0x45u)
+{
+	std::mt19937 mt(seed);
+	std::uniform_real_distribution<double> jitter(-0.25, 0.25);
+
+	std::vector<CPolyline> ret(polylineCount);
+	const uint32_t gridWidth = static_cast<uint32_t>(std::ceil(std::sqrt(double(polylineCount))));
+	for (uint32_t p = 0u; p < polylineCount; ++p)
+	{
+		float64_t2 pos = float64_t2(double(p % gridWidth), double(p / gridWidth)) * 10.0;
+
+		std::vector<float64_t2> linePoints;
+		linePoints.push_back(pos);
+		for (uint32_t i = 0u; i < linesPerPolyline; ++i)
+		{
+			pos += float64_t2(0.5, jitter(mt));
+			linePoints.push_back(pos);
+		}
+		if (linePoints.size() > 1u)
+			ret[p].addLinePoints(linePoints);
+
+		std::vector<shapes::QuadraticBezier<double>> beziers;
+		for (uint32_t i = 0u; i < beziersPerPolyline; ++i)
+		{
+			const float64_t2 p1 = pos + float64_t2(0.25, 1.0 + jitter(mt));
+			const float64_t2 p2 = pos + float64_t2(0.5, jitter(mt));
+			beziers.push_back(shapes::QuadraticBezier<double>::construct(pos, p1, p2));
+			pos = p2;
+		}
+		if (!beziers.empty())
+			ret[p].addQuadBeziers(beziers);
+	}
+	return ret;
+}
+
+// Serial `Hatch` constructors vs `Hatch::constructInParallel` over the same synthetic hatch set
+inline void benchmarkHatchConstruction(nbl::system::ILogger* logger, uint32_t hatchCount = 4096u, uint32_t segmentsPerLoop = 64u)
+{
+	auto hatchesPolylines = generateSyntheticHatches(hatchCount, segmentsPerLoop);
+	std::vector<std::span<CPolyline>> hatchesSpans;
+	hatchesSpans.reserve(hatchesPolylines.size());
+	for (auto& polylines : hatchesPolylines)
+		hatchesSpans.push_back(polylines);
+
+	std::vector<Hatch> serialHatches;
+	serialHatches.reserve(hatchCount);
+	const double serialMs = measureMilliseconds([&]()
+		{
+			for (auto& polylines : hatchesSpans)
+				serialHatches.emplace_back(polylines, SelectedMajorAxis);
+		});
+
+	std::vector<Hatch> parallelHatches;
+	const uint32_t threadCount = Hatch::getParallelThreadCount(static_cast<uint32_t>(hatchesSpans.size()));
+	const double parallelMs = measureMilliseconds([&]()
+		{
+			parallelHatches = Hatch::constructInParallel(hatchesSpans, SelectedMajorAxis, nullptr, threadCount);
+		});
+
+	// both paths run the exact same sweep per hatch, so the outputs must match bit for bit
+	bool identical = serialHatches.size() == parallelHatches.size();
+	for (uint32_t i = 0u; identical && i < serialHatches.size(); ++i)
+	{
+		identical = serialHatches[i].getHatchBoxCount() == parallelHatches[i].getHatchBoxCount();
+		for (uint32_t b = 0u; identical && b < serialHatches[i].getHatchBoxCount(); ++b)
+			identical = memcmp(&serialHatches[i].getHatchBox(b), &parallelHatches[i].getHatchBox(b), sizeof(Hatch::CurveHatchBox)) == 0;
+	}
+
+	logger->log("Hatch construction of %u hatches (%u segments each): serial = %.2fms, parallel (%u threads) = %.2fms, speedup = %.2fx, identical output = %s",
+		nbl::system::ILogger::ELL_PERFORMANCE, hatchCount, segmentsPerLoop * 2u, serialMs, threadCount, parallelMs, serialMs / parallelMs, identical ? "true" : "false");
+}
+
+// Sweep-like workload on the minor extents index alone vs the linear scan over active candidates it replaced:
+// intervals start and end along major, every start queries the active ones overlapping it in minor
+// then the full `Hatch` construction for a single hatch with the same segment count (many loops in a grid, so the active set grows with it)
+inline void benchmarkHatchSweepScaling(nbl::system::ILogger* logger)
+{
+	struct SweepInterval
+	{
+		double majorStart, majorEnd;
+		double minorMin, minorMax;
+	};
+
+	for (uint32_t segmentCount = 1000u; segmentCount <= 1000000u; segmentCount *= 10u)
+	{
+		std::mt19937 mt(0x45u);
+		const double extent = std::sqrt(double(segmentCount));
+		std::uniform_real_distribution<double> position(0.0, extent);
+		std::uniform_real_distribution<double> length(0.1, 2.0);
+
+		std::vector<SweepInterval> intervals(segmentCount);
+		for (auto& interval : intervals)
+		{
+			interval.majorStart = position(mt);
+			interval.majorEnd = interval.majorStart + length(mt);
+			interval.minorMin = position(mt);
+			interval.minorMax = interval.minorMin + length(mt);
+		}
+		std::sort(intervals.begin(), intervals.end(), [](const SweepInterval& a, const SweepInterval& b) { return a.majorStart < b.majorStart; });
+
+		uint64_t treeOverlaps = 0ull;
+		const double treeMs = measureMilliseconds([&]()
+			{
+				IntervalTree<double, uint32_t> active;
+				active.reserve(segmentCount);
+				std::priority_queue<std::pair<double, uint32_t>, std::vector<std::pair<double, uint32_t>>, std::greater<std::pair<double, uint32_t>>> ends;
+				for (uint32_t i = 0u; i < segmentCount; ++i)
+				{
+					const auto& interval = intervals[i];
+					while (!ends.empty() && ends.top().first < interval.majorStart)
+					{
+						active.erase(ends.top().second);
+						ends.pop();
+					}
+					active.query(interval.minorMin, interval.minorMax, [&](uint32_t) { treeOverlaps++; });
+					ends.push({ interval.majorEnd, active.insert(interval.minorMin, interval.minorMax, i) });
+				}
+			});
+
+		uint64_t linearOverlaps = 0ull;
+		const double linearMs = measureMilliseconds([&]()
+			{
+				std::vector<uint32_t> active;
+				for (uint32_t i = 0u; i < segmentCount; ++i)
+				{
+					const auto& interval = intervals[i];
+					std::erase_if(active, [&](uint32_t j) { return intervals[j].majorEnd < interval.majorStart; });
+					for (const uint32_t j : active)
+						if (intervals[j].minorMax >= interval.minorMin && intervals[j].minorMin <= interval.minorMax)
+							linearOverlaps++;
+					active.push_back(i);
+				}
+			});
+
+		// every loop in `generateSyntheticHatches` has `segmentsPerLoop*2` segments, put them all in one hatch
+		constexpr uint32_t SegmentsPerLoop = 32u;
+		auto hatchesPolylines = generateSyntheticHatches(std::max(segmentCount / (SegmentsPerLoop * 2u), 1u), SegmentsPerLoop);
+		std::vector<CPolyline> polylines;
+		polylines.reserve(hatchesPolylines.size());
+		for (auto& hatchPolylines : hatchesPolylines)
+			for (auto& polyline : hatchPolylines)
+				polylines.push_back(std::move(polyline));
+
+		size_t hatchBoxCount = 0u;
+		uint32_t sweepEventCount = 0u;
+		const double hatchMs = measureMilliseconds([&]()
+			{
+				Hatch hatch(polylines, SelectedMajorAxis);
+				hatchBoxCount = hatch.getHatchBoxCount();
+				sweepEventCount = hatch.getSweepEventCount();
+			});
+		// constant if the sweep is O(log n) per event, growing with the segment count while it's O(n)
+		const double nsPerEvent = hatchMs * 1e6 / double(std::max(sweepEventCount, 1u));
+
+		logger->log("Hatch sweep with %u segments: interval tree = %.2fms, linear scan = %.2fms (speedup = %.2fx, overlaps match = %s), full Hatch = %.2fms (%zu boxes, %u events, %.1fns per event)",
+			nbl::system::ILogger::ELL_PERFORMANCE, segmentCount, treeMs, linearMs, linearMs / treeMs, (treeOverlaps == linearOverlaps) ? "true" : "false", hatchMs, hatchBoxCount, sweepEventCount, nsPerEvent);
+	}
+}
+
+// `Subdivision::adaptive` one curve at a time through the AddBezierFunc vs `Subdivision::adaptiveBatched` into a pre-sized span, on random elliptical arcs and cubic curves
+inline void benchmarkCurveSubdivision(nbl::system::ILogger* logger, uint32_t curveCount = 100000u, float64_t targetMaxError = 1e-3, uint32_t maxDepth = 10u)
+{
+	using namespace curves;
+
+	std::mt19937 mt(0x45u);
+	std::uniform_real_distribution<double> position(-100.0, 100.0);
+	std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+	std::vector<EllipticalArcInfo> ellipses(curveCount);
+	for (auto& ellipse : ellipses)
+	{
+		ellipse.majorAxis = float64_t2(position(mt), position(mt)) * 0.1;
+		ellipse.center = float64_t2(position(mt), position(mt));
+		ellipse.angleBounds.x = unit(mt) * nbl::core::PI<double>();
+		ellipse.angleBounds.y = ellipse.angleBounds.x + (0.1 + unit(mt)) * nbl::core::PI<double>();
+		ellipse.eccentricity = 0.1 + unit(mt) * 0.9;
+	}
+
+	std::vector<CubicCurve> cubics;
+	cubics.reserve(curveCount);
+	for (uint32_t i = 0u; i < curveCount; ++i)
+		cubics.emplace_back(float64_t4(position(mt), position(mt), position(mt), position(mt)), float64_t4(position(mt), position(mt), position(mt), position(mt)));
+
+	auto run = [&](const char* name, auto inputs, auto&& subdivideSingle)
+		{
+			std::vector<shapes::QuadraticBezier<double>> scalarBeziers;
+			const double scalarMs = measureMilliseconds([&]()
+				{
+					Subdivision::AddBezierFunc addBezier = [&](shapes::QuadraticBezier<double>&& bezier) { scalarBeziers.push_back(bezier); };
+					for (const auto& curve : inputs)
+						subdivideSingle(curve, addBezier);
+				});
+
+			// the worst case of `getMaxBeziersPerCurve` per curve would be gigabytes here, the scalar run tells us roughly how much is needed
+			std::vector<shapes::QuadraticBezier<double>> batchedBeziers(scalarBeziers.size() * 2u);
+			std::vector<Subdivision::BatchedOutputRange> ranges(inputs.size());
+			std::vector<shapes::QuadraticBezier<double>> overflowBeziers;
+			uint32_t batchedBezierCount = 0u;
+			const double batchedMs = measureMilliseconds([&]()
+				{
+					Subdivision::AddBezierFunc addOverflowBezier = [&](shapes::QuadraticBezier<double>&& bezier) { overflowBeziers.push_back(bezier); };
+					batchedBezierCount = Subdivision::adaptiveBatched(inputs, targetMaxError, batchedBeziers, ranges, addOverflowBezier, maxDepth);
+				});
+
+			logger->log("Subdivision of %zu %s: adaptive = %.2fms (%.0f curves/s, %zu beziers), adaptiveBatched = %.2fms (%.0f curves/s, %u beziers + %zu overflowed), speedup = %.2fx",
+				nbl::system::ILogger::ELL_PERFORMANCE, inputs.size(), name,
+				scalarMs, inputs.size() / (scalarMs * 1e-3), scalarBeziers.size(),
+				batchedMs, inputs.size() / (batchedMs * 1e-3), batchedBezierCount, overflowBeziers.size(), scalarMs / batchedMs);
+		};
+
+	run("elliptical arcs", std::span<const EllipticalArcInfo>(ellipses), [&](const EllipticalArcInfo& ellipse, Subdivision::AddBezierFunc& addBezier) { Subdivision::adaptive(ellipse, targetMaxError, addBezier, maxDepth); });
+	run("cubic curves", std::span<const CubicCurve>(cubics), [&](const CubicCurve& cubic, Subdivision::AddBezierFunc& addBezier) { Subdivision::adaptive(cubic, 0.0, 1.0, targetMaxError, addBezier, maxDepth); });
+}
+
+// `CPolylineBase::intersectTwoSections` with sweep and prune vs the BVH over the next section, on two interleaved zigzag "combs"
+// Both combs end far to the right so the chord the sweep runs along is horizontal while every tooth spans the same horizontal range, making the sweep quadratic
+inline void benchmarkPolylineSectionIntersection(nbl::system::ILogger* logger, uint32_t maxSegmentCount = 100000u)
+{
+	struct SectionIntersectionPolyline : public CPolyline
+	{
+		using CPolyline::SectionIntersectResult;
+		using CPolyline::intersectTwoSections_SweepAndPrune;
+		using CPolyline::intersectTwoSections_BVH;
+	};
+
+	constexpr double ToothWidth = 10.0;
+	constexpr double ToothHeight = 0.01;
+
+	for (uint32_t segmentCount = 1000u; segmentCount <= maxSegmentCount; segmentCount *= 10u)
+	{
+		const uint32_t segmentsPerSection = segmentCount / 2u;
+
+		SectionIntersectionPolyline polyline;
+		std::vector<float64_t2> points(segmentsPerSection + 1u);
+		auto addComb = [&](float64_t2 offset)
+			{
+				for (uint32_t i = 0u; i < segmentsPerSection; ++i)
+					points[i] = offset + float64_t2(double(i % 2u) * ToothWidth, double(i) * ToothHeight);
+				points[segmentsPerSection] = float64_t2(ToothWidth * 1000.0, 0.0);
+				polyline.addLinePoints(points);
+			};
+		addComb(float64_t2(0.0, 0.0));
+		addComb(float64_t2(ToothWidth * 0.5, ToothHeight * 0.25));
+
+		const auto& prevSection = polyline.getSectionInfoAt(0u);
+		const auto& nextSection = polyline.getSectionInfoAt(1u);
+		// only the number of removed objects is well defined, intersections removing the same amount may be visited in different orders
+		auto getObjectsToRemove = [&](const SectionIntersectionPolyline::SectionIntersectResult& result) -> int64_t
+			{
+				return result.valid() ? int64_t(prevSection.count - result.prevObjIndex - 1u) + result.nextObjIndex : -1ll;
+			};
+
+		SectionIntersectionPolyline::SectionIntersectResult sweepResult = {};
+		const double sweepMs = measureMilliseconds([&]() { sweepResult = polyline.intersectTwoSections_SweepAndPrune(prevSection, nextSection); });
+
+		SectionIntersectionPolyline::SectionIntersectResult bvhResult = {};
+		const double bvhMs = measureMilliseconds([&]() { bvhResult = polyline.intersectTwoSections_BVH(prevSection, nextSection); });
+
+		logger->log("Section intersection with %u segments: sweep and prune = %.2fms, BVH = %.2fms (speedup = %.2fx, results match = %s)",
+			nbl::system::ILogger::ELL_PERFORMANCE, segmentCount, sweepMs, bvhMs, sweepMs / bvhMs, (getObjectsToRemove(sweepResult) == getObjectsToRemove(bvhResult)) ? "true" : "false");
+	}
+}
+
+// `CPolyline::generateParallelPolyline` on one long polyline of alternating line and bezier sections, serial vs all threads
+// then restyling many small polylines through a few widths again and again, without vs with `ParallelPolylineCache`
+inline void benchmarkPolylineOffsetting(nbl::system::ILogger* logger, uint32_t sectionCount = 20000u, uint32_t restyledPolylineCount = 10000u, uint32_t restyleCount = 8u)
+{
+	std::mt19937 mt(0x45u);
+	std::uniform_real_distribution<double> jitter(-0.25, 0.25);
+
+	CPolyline longPolyline;
+	{
+		float64_t2 pos = float64_t2(0.0, 0.0);
+		std::vector<float64_t2> linePoints;
+		std::vector<shapes::QuadraticBezier<double>> beziers;
+		for (uint32_t i = 0u; i < sectionCount; ++i)
+		{
+			if (i % 2u == 0u)
+			{
+				linePoints.clear();
+				linePoints.push_back(pos);
+				for (uint32_t j = 0u; j < 4u; ++j)
+				{
+					pos += float64_t2(0.5, jitter(mt));
+					linePoints.push_back(pos);
+				}
+				longPolyline.addLinePoints(linePoints);
+			}
+			else
+			{
+				beziers.clear();
+				for (uint32_t j = 0u; j < 4u; ++j)
+				{
+					const float64_t2 p1 = pos + float64_t2(0.25, 1.0 + jitter(mt));
+					const float64_t2 p2 = pos + float64_t2(0.5, jitter(mt));
+					beziers.push_back(shapes::QuadraticBezier<double>::construct(pos, p1, p2));
+					pos = p2;
+				}
+				longPolyline.addQuadBeziers(beziers);
+			}
+		}
+	}
+
+	CPolyline serialOffset, parallelOffset;
+	const double serialMs = measureMilliseconds([&]() { serialOffset = longPolyline.generateParallelPolyline(0.1, 1e-5, 1u); });
+	const double parallelMs = measureMilliseconds([&]() { parallelOffset = longPolyline.generateParallelPolyline(0.1, 1e-5, 0u); });
+	const bool offsetsMatch = serialOffset.getSectionsCount() == parallelOffset.getSectionsCount() &&
+		serialOffset.getSectionLastPoint(serialOffset.getSectionInfoAt(serialOffset.getSectionsCount() - 1u)) == parallelOffset.getSectionLastPoint(parallelOffset.getSectionInfoAt(parallelOffset.getSectionsCount() - 1u));
+
+	logger->log("Offsetting a polyline of %u sections: serial = %.2fms, %u threads = %.2fms (speedup = %.2fx, results match = %s)",
+		nbl::system::ILogger::ELL_PERFORMANCE, sectionCount, serialMs, std::thread::hardware_concurrency(), parallelMs, serialMs / parallelMs, offsetsMatch ? "true" : "false");
+
+	const std::vector<CPolyline> polylines = generateSyntheticPolylines(restyledPolylineCount, 16u, 8u);
+	constexpr float64_t Widths[] = { 0.05, 0.1, 0.2 };
+	CPolyline offset1, offset2;
+
+	const double uncachedMs = measureMilliseconds([&]()
+		{
+			for (uint32_t restyle = 0u; restyle < restyleCount; ++restyle)
+				for (const CPolyline& polyline : polylines)
+					polyline.makeWideWhole(offset1, offset2, Widths[restyle % std::size(Widths)], 1e-3);
+		});
+
+	ParallelPolylineCache cache(restyledPolylineCount * 2u * static_cast<uint32_t>(std::size(Widths)));
+	const double cachedMs = measureMilliseconds([&]()
+		{
+			for (uint32_t restyle = 0u; restyle < restyleCount; ++restyle)
+				for (uint32_t i = 0u; i < polylines.size(); ++i)
+					cache.makeWideWhole(i, polylines[i], offset1, offset2, Widths[restyle % std::size(Widths)], 1e-3);
+		});
+
+	logger->log("Restyling %u polylines %u times through %zu widths: uncached = %.2fms, cached = %.2fms (speedup = %.2fx, %llu hits, %llu misses)",
+		nbl::system::ILogger::ELL_PERFORMANCE, restyledPolylineCount, restyleCount, std::size(Widths), uncachedMs, cachedMs, uncachedMs / cachedMs, cache.getHitCount(), cache.getMissCount());
+}
+
+// `CPolyline::preprocessPolylineWithStyle` with shapes on the stipple scenes of CASE_4 (single bezier test curves) and CASE_5 (lines and elliptical arcs with shapes), each repeated `copies` times
+// then the inverse arc length of every shape position alone, `ArcLengthCalculator::calcArcLenInverse` one at a time vs `curves::QuadraticArcLenInverseBatch`
+inline void benchmarkStipplePreprocessing(nbl::system::ILogger* logger, uint32_t copies = 2000u, uint32_t frameCount = 8u)
+{
+	struct StippleScene
+	{
+		const char* name;
+		std::vector<CPolyline> polylines;
+		std::vector<LineStyleInfo> styles;
+	};
+	StippleScene scenes[2] = { { "CASE_4" }, { "CASE_5" } };
+
+	for (uint32_t copy = 0u; copy < copies; ++copy)
+	{
+		const float64_t2 copyOffset = float64_t2(double(copy % 64u) * 400.0, double(copy / 64u) * 300.0);
+
+		// CASE_4: translated test curves then the special cases (lines, folded line, oblique line, A.x == 0, long parabola), each followed by a line
+		{
+			std::vector<shapes::QuadraticBezier<double>> quadratics;
+			for (uint32_t i = 0u; i < 10u; ++i)
+			{
+				const float64_t2 translation = float64_t2(0.0, -5.0 * i);
+				quadratics.push_back(shapes::QuadraticBezier<double>::construct(float64_t2(-90, 68) + translation, float64_t2(-41, 118) + translation, float64_t2(88, 19) + translation));
+			}
+			quadratics.push_back(shapes::QuadraticBezier<double>::construct(float64_t2(-100, -3), float64_t2(0, -3), float64_t2(100, -3)));
+			quadratics.push_back(shapes::QuadraticBezier<double>::construct(float64_t2(-100, -13), float64_t2(20, -13), float64_t2(100, -13)));
+			quadratics.push_back(shapes::QuadraticBezier<double>::construct(float64_t2(-100, -23), float64_t2(100, -23), float64_t2(50, -23)));
+			quadratics.push_back(shapes::QuadraticBezier<double>::construct(float64_t2(-100, 100), float64_t2(50, -50), float64_t2(100, -100)));
+			quadratics.push_back(shapes::QuadraticBezier<double>::construct(float64_t2(0, 0), float64_t2(3, 4.14), float64_t2(6, 4)));
+			quadratics.push_back(shapes::QuadraticBezier<double>::construct(float64_t2(-150, 1), float64_t2(2000, 0), float64_t2(-150, -1)));
+
+			const std::vector<double> stipplePatterns[] = {
+				{ 0.0, -5.0, 2.0, -5.0 },
+				{ 2.5, -5.0, 1.0, -5.0, 2.5 },
+				{ 5.0, -5.0, 1.0, -5.0 },
+				{ 0.0, -0.5, 0.2, -0.5 },
+			};
+
+			for (uint32_t i = 0u; i < quadratics.size(); ++i)
+			{
+				auto& quadratic = quadratics[i];
+				quadratic.P0 += copyOffset;
+				quadratic.P1 += copyOffset;
+				quadratic.P2 += copyOffset;
+
+				CPolyline polyline;
+				polyline.addQuadBeziers({ &quadratic, 1u });
+				float64_t2 linePoints[2u] = { quadratic.P2, quadratic.P2 + float64_t2(100.0, -1.0 * i) };
+				polyline.addLinePoints(linePoints);
+
+				LineStyleInfo style = {};
+				style.screenSpaceLineWidth = 7.0f;
+				const auto& pattern = stipplePatterns[i % std::size(stipplePatterns)];
+				style.setStipplePatternData(pattern, 0.0, false, false);
+				scenes[0].polylines.push_back(std::move(polyline));
+				scenes[0].styles.push_back(style);
+			}
+		}
+
+		// CASE_5: lines and elliptical arcs with shapes, stretched and not
+		{
+			constexpr double StipplePattern[] = { 5.0, -5.0 };
+			for (uint32_t i = 0u; i < 4u; ++i)
+			{
+				const bool stretch = (i % 2u) == 1u;
+
+				CPolyline linePolyline;
+				float64_t2 linePoints[2u] = { copyOffset + float64_t2(-50.0, 50.0 - 2.0 * i), copyOffset + float64_t2(50.0, 50.0 - 2.0 * i) };
+				linePolyline.addLinePoints(linePoints);
+
+				CPolyline arcPolyline;
+				std::vector<shapes::QuadraticBezier<double>> quadBeziers;
+				curves::EllipticalArcInfo arc;
+				arc.majorAxis = { -50.0 - 2.0 * i, 0.0 };
+				arc.center = copyOffset + float64_t2(0.0, 25.0);
+				arc.angleBounds = { 0.0, nbl::core::PI<double>() * (0.5 + 0.125 * i) };
+				arc.eccentricity = 1.0;
+				curves::Subdivision::AddBezierFunc addToBezier = [&](shapes::QuadraticBezier<double>&& info) -> void { quadBeziers.push_back(info); };
+				curves::Subdivision::adaptive(arc, 1e-3, addToBezier, 10u);
+				arcPolyline.addQuadBeziers(quadBeziers);
+
+				LineStyleInfo style = {};
+				style.screenSpaceLineWidth = 4.0f;
+				style.setStipplePatternData(StipplePattern, 7.5, stretch, stretch);
+				scenes[1].polylines.push_back(std::move(linePolyline));
+				scenes[1].styles.push_back(style);
+				scenes[1].polylines.push_back(std::move(arcPolyline));
+				scenes[1].styles.push_back(style);
+			}
+		}
+	}
+
+	for (auto& scene : scenes)
+	{
+		uint64_t shapeCount = 0ull;
+		std::vector<std::pair<shapes::QuadraticBezier<double>, float64_t>> curveShapeProblems;
+		const CPolyline::AddShapeFunc addShape = [&](const float64_t2&, const float64_t2&, float32_t) { shapeCount++; };
+
+		const double preprocessMs = measureMilliseconds([&]()
+			{
+				for (uint32_t frame = 0u; frame < frameCount; ++frame)
+					for (uint32_t i = 0u; i < scene.polylines.size(); ++i)
+						scene.polylines[i].preprocessPolylineWithStyle(scene.styles[i], addShape);
+			});
+
+		// the same kind of problems the shapes on curves make: every pattern repetition along every bezier
+		for (uint32_t i = 0u; i < scene.polylines.size(); ++i)
+		{
+			const CPolyline& polyline = scene.polylines[i];
+			const float64_t patternLen = 1.0 / scene.styles[i].reciprocalStipplePatternLen;
+			for (uint32_t sectionIdx = 0u; sectionIdx < polyline.getSectionsCount(); ++sectionIdx)
+			{
+				const auto& section = polyline.getSectionInfoAt(sectionIdx);
+				if (section.type != ObjectType::QUAD_BEZIER)
+					continue;
+				for (uint32_t bezierIdx = section.index; bezierIdx < section.index + section.count; ++bezierIdx)
+				{
+					const auto& bezier = polyline.getQuadBezierInfoAt(bezierIdx).shape;
+					const auto quadratic = shapes::Quadratic<double>::constructFromBezier(bezier);
+					const float64_t bezierLen = shapes::Quadratic<double>::ArcLengthCalculator::construct(quadratic).calcArcLen(1.0);
+					for (float64_t arcLen = patternLen * 0.5; arcLen < bezierLen; arcLen += patternLen)
+						curveShapeProblems.push_back({ bezier, arcLen });
+				}
+			}
+		}
+
+		std::vector<float64_t> scalarResults(curveShapeProblems.size());
+		const double scalarMs = measureMilliseconds([&]()
+			{
+				for (uint32_t i = 0u; i < curveShapeProblems.size(); ++i)
+				{
+					const auto quadratic = shapes::Quadratic<double>::constructFromBezier(curveShapeProblems[i].first);
+					const auto arcLenCalc = shapes::Quadratic<double>::ArcLengthCalculator::construct(quadratic);
+					scalarResults[i] = arcLenCalc.calcArcLenInverse(quadratic, 0.0, 1.0, curveShapeProblems[i].second, 1e-5, 0.5);
+				}
+			});
+
+		curves::QuadraticArcLenInverseBatch batch;
+		const double batchedMs = measureMilliseconds([&]()
+			{
+				batch.reserve(static_cast<uint32_t>(curveShapeProblems.size()), static_cast<uint32_t>(curveShapeProblems.size()));
+				for (const auto& problem : curveShapeProblems)
+					batch.add(batch.addBezier(problem.first), problem.second);
+				batch.solve(1e-5);
+			});
+
+		float64_t maxPositionError = 0.0;
+		for (uint32_t i = 0u; i < curveShapeProblems.size(); ++i)
+		{
+			const auto quadratic = shapes::Quadratic<double>::constructFromBezier(curveShapeProblems[i].first);
+			maxPositionError = nbl::core::max(maxPositionError, glm::distance(quadratic.evaluate(scalarResults[i]), quadratic.evaluate(batch.getResult(i))));
+		}
+
+		logger->log("Stipple preprocessing of %s x%u (%zu polylines): %.2fms/frame, %.0f shapes/s (%llu shapes/frame); inverse arc length of %zu curve shape positions: calcArcLenInverse = %.2fms, batched = %.2fms (speedup = %.2fx, max position difference = %.2e)",
+			nbl::system::ILogger::ELL_PERFORMANCE, scene.name, copies, scene.polylines.size(), preprocessMs / frameCount, shapeCount / (preprocessMs * 1e-3), shapeCount / frameCount,
+			curveShapeProblems.size(), scalarMs, batchedMs, scalarMs / batchedMs, maxPositionError);
+	}
+}
+
+// Forwards to `upstream` and counts what goes through it, to count the mallocs behind a memory resource
+class CountingMemoryResource : public std::pmr::memory_resource
+{
+public:
+	explicit CountingMemoryResource(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource()) : m_upstream(upstream) {}
+
+	void resetCounters()
+	{
+		allocationCount = 0ull;
+		allocatedBytes = 0ull;
+	}
+
+	uint64_t allocationCount = 0ull;
+	uint64_t allocatedBytes = 0ull;
+
+protected:
+	void* do_allocate(size_t bytes, size_t alignment) override
+	{
+		allocationCount++;
+		allocatedBytes += bytes;
+		return m_upstream->allocate(bytes, alignment);
+	}
+
+	void do_deallocate(void* p, size_t bytes, size_t alignment) override
+	{
+		m_upstream->deallocate(p, bytes, alignment);
+	}
+
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+	{
+		return this == &other;
+	}
+
+	std::pmr::memory_resource* m_upstream;
+};
+
+// Glyph outlines to hatches like the text hatches of CASE_8 (`FreetypeHatchBuilder` then `Hatch`), every frame converts the whole string again
+// Temporaries on the heap vs on a `MemoryArena` reset every frame, allocations are counted on the resource each run puts them on
+// so the ones that don't go through it (hatch boxes, the sweep's interval tree) aren't in either count
+inline void benchmarkGlyphToHatch(nbl::system::ILogger* logger, nbl::ext::TextRendering::FontFace* font, uint32_t frameCount = 64u)
+{
+	constexpr auto TestString = "Hatch: The quick brown fox jumps over the lazy dog. !@#$%&*()_+-";
+	const size_t glyphCount = strlen(TestString);
+
+	auto convertGlyphs = [&](std::pmr::memory_resource* memoryResource) -> size_t
+		{
+			size_t hatchBoxCount = 0u;
+			for (size_t i = 0u; i < glyphCount; ++i)
+			{
+				const auto glyphIndex = font->getGlyphIndex(wchar_t(TestString[i]));
+
+				FreetypeHatchBuilder hatchBuilder(memoryResource);
+				FT_Outline_Funcs ftFunctions;
+				ftFunctions.move_to = &ftMoveTo;
+				ftFunctions.line_to = &ftLineTo;
+				ftFunctions.conic_to = &ftConicTo;
+				ftFunctions.cubic_to = &ftCubicTo;
+				ftFunctions.shift = 0;
+				ftFunctions.delta = 0;
+				if (FT_Outline_Decompose(&font->getGlyphSlot(glyphIndex)->outline, &ftFunctions, &hatchBuilder))
+					continue;
+				hatchBuilder.finish();
+				if (hatchBuilder.polylines.empty())
+					continue;
+
+				Hatch hatch(hatchBuilder.polylines, SelectedMajorAxis, nullptr, nullptr, {}, memoryResource);
+				hatchBoxCount += hatch.getHatchBoxCount();
+			}
+			return hatchBoxCount;
+		};
+
+	// first frame of each run is a warmup, the arena sizes its block there
+	CountingMemoryResource heap;
+	size_t heapHatchBoxCount = convertGlyphs(&heap);
+	heap.resetCounters();
+	const double heapMs = measureMilliseconds([&]()
+		{
+			for (uint32_t frame = 0u; frame < frameCount; ++frame)
+				heapHatchBoxCount = convertGlyphs(&heap);
+		});
+
+	CountingMemoryResource arenaUpstream;
+	MemoryArena arena(64u * 1024u, &arenaUpstream);
+	size_t arenaHatchBoxCount = convertGlyphs(&arena);
+	arena.reset();
+	arenaUpstream.resetCounters();
+	uint64_t arenaAllocationCount = 0ull;
+	const double arenaMs = measureMilliseconds([&]()
+		{
+			for (uint32_t frame = 0u; frame < frameCount; ++frame)
+			{
+				arena.reset();
+				arenaHatchBoxCount = convertGlyphs(&arena);
+				arenaAllocationCount += arena.getAllocationCount();
+			}
+		});
+
+	const double glyphsPerFrame = double(glyphCount);
+	logger->log("Glyph to hatch (%zu glyphs/frame): heap = %.3fms/frame (%.0f glyphs/s, %.1f mallocs/frame, %.1f KB/frame), arena = %.3fms/frame (%.0f glyphs/s, %.1f arena allocations/frame, %.1f mallocs/frame, %.1f KB block), speedup = %.2fx, hatch boxes match = %s",
+		nbl::system::ILogger::ELL_PERFORMANCE, glyphCount,
+		heapMs / frameCount, glyphsPerFrame * frameCount / (heapMs * 1e-3), double(heap.allocationCount) / frameCount, double(heap.allocatedBytes) / (1024.0 * frameCount),
+		arenaMs / frameCount, glyphsPerFrame * frameCount / (arenaMs * 1e-3), double(arenaAllocationCount) / frameCount, double(arenaUpstream.allocationCount) / frameCount, arena.getBlockSize() / 1024.0,
+		heapMs / arenaMs, (heapHatchBoxCount == arenaHatchBoxCount) ? "true" : "false");
+}
+
+struct HeadlessRecordingScene
+{
+	std::string name;
+	// records one frame of the scene
+	std::function<void(DrawResourcesFiller&, SIntendedSubmitInfo&)> record;
+};
+
+// Replays each scene for `frameCount` frames into a headless DrawResourcesFiller (see `DrawResourcesFiller::allocateHeadless`) and reports the recording throughput
+// `allocateFiller` should call `allocateHeadless` and set the MSDF functions, the first frame of each scene is a warmup that fills the MSDF cache and isn't measured
+// After the measured frames, the frames are recorded again with `DrawResourcesFiller::FrameStats` timing on, to log why it auto-submitted and dump the per frame stats
+// to `<frameStatsDir>/headless_<scene>_frame_stats.csv/.json` when `frameStatsDir` isn't empty
+inline void benchmarkHeadlessRecording(nbl::system::ILogger* logger, std::span<const HeadlessRecordingScene> scenes, const std::function<void(DrawResourcesFiller&)>& allocateFiller, uint32_t frameCount = 64u, const nbl::system::path& frameStatsDir = {})
+{
+	for (const HeadlessRecordingScene& scene : scenes)
+	{
+		DrawResourcesFiller filler;
+		allocateFiller(filler);
+		assert(filler.isHeadless());
+
+		// counted on every submit, because the counters are reset right after
+		uint64_t drawObjects = 0ull;
+		uint64_t mainObjects = 0ull;
+		uint64_t autoSubmits = 0ull;
+		filler.setSubmitDrawsFunction(
+			[&](SIntendedSubmitInfo&)
+			{
+				drawObjects += filler.getDrawObjectCount();
+				mainObjects += filler.getMainObjectCount();
+				autoSubmits++;
+			});
+
+		SIntendedSubmitInfo intendedNextSubmit = {};
+		auto recordFrame = [&]()
+			{
+				filler.reset();
+				scene.record(filler, intendedNextSubmit);
+				filler.finalizeAllCopiesToGPU(intendedNextSubmit);
+				drawObjects += filler.getDrawObjectCount();
+				mainObjects += filler.getMainObjectCount();
+			};
+
+		recordFrame();
+		drawObjects = mainObjects = autoSubmits = 0ull;
+		const uint64_t uploadedBytesBegin = filler.getHeadlessUploadedBytes();
+
+		const double ms = measureMilliseconds([&]()
+			{
+				for (uint32_t i = 0u; i < frameCount; ++i)
+					recordFrame();
+			});
+		const double seconds = ms * 1e-3;
+		const uint64_t uploadedBytes = filler.getHeadlessUploadedBytes() - uploadedBytesBegin;
+
+		logger->log("Headless recording of \"%s\" over %u frames: %.3fms/frame, %.0f draw objects/s, %.0f main objects/s, %.2f MB/s uploaded, %.2f auto-submits/frame",
+			nbl::system::ILogger::ELL_PERFORMANCE, scene.name.c_str(), frameCount, ms / double(frameCount),
+			double(drawObjects) / seconds, double(mainObjects) / seconds, double(uploadedBytes) / (seconds * 1024.0 * 1024.0), double(autoSubmits) / double(frameCount));
+
+		// instrumented pass, kept out of the measurement above since timing the draw calls reads the clock twice per call
+		using FrameStats = DrawResourcesFiller::FrameStats;
+		std::vector<FrameStats> frameStats(frameCount);
+		filler.enableFrameStatsTiming(true);
+		for (uint32_t i = 0u; i < frameCount; ++i)
+		{
+			filler.resetFrameStats();
+			recordFrame();
+			frameStats[i] = filler.getFrameStats();
+		}
+		filler.enableFrameStatsTiming(false);
+
+		FrameStats total = {};
+		for (const FrameStats& stats : frameStats)
+		{
+			for (uint32_t r = 0u; r < total.autoSubmits.size(); ++r)
+				total.autoSubmits[r] += stats.autoSubmits[r];
+			total.peakDrawObjectCount = core::max(total.peakDrawObjectCount, stats.peakDrawObjectCount);
+			total.peakGeometryBytes = core::max(total.peakGeometryBytes, stats.peakGeometryBytes);
+			total.peakMainObjectCount = core::max(total.peakMainObjectCount, stats.peakMainObjectCount);
+			total.peakLineStyleCount = core::max(total.peakLineStyleCount, stats.peakLineStyleCount);
+			total.msdfHits += stats.msdfHits;
+			total.msdfMisses += stats.msdfMisses;
+		}
+		std::string autoSubmitReasons;
+		for (uint32_t r = 0u; r < total.autoSubmits.size(); ++r)
+			if (total.autoSubmits[r])
+				autoSubmitReasons += std::string(autoSubmitReasons.empty() ? "" : ", ") + FrameStats::getName(static_cast<DrawResourcesFiller::AutoSubmitReason>(r)) + " " + std::to_string(total.autoSubmits[r]);
+		logger->log("\"%s\" auto-submits: %s, peak usage: %u draw objects, %llu geometry bytes, %u main objects, %u line styles, MSDF hit rate %.2f%%",
+			nbl::system::ILogger::ELL_PERFORMANCE, scene.name.c_str(), autoSubmitReasons.empty() ? "none" : autoSubmitReasons.c_str(),
+			total.peakDrawObjectCount, total.peakGeometryBytes, total.peakMainObjectCount, total.peakLineStyleCount,
+			100.0 * double(total.msdfHits) / double(core::max(total.msdfHits + total.msdfMisses, uint64_t(1u))));
+
+		if (!frameStatsDir.empty())
+		{
+			std::string fileName = "headless_" + scene.name + "_frame_stats";
+			for (char& c : fileName)
+				if (!std::isalnum(static_cast<unsigned char>(c)))
+					c = '_';
+			std::ofstream csv(frameStatsDir / (fileName + ".csv"));
+			FrameStats::writeCSV(csv, frameStats);
+			std::ofstream json(frameStatsDir / (fileName + ".json"));
+			FrameStats::writeJSON(json, frameStats);
+			if (!csv || !json)
+				logger->log("Couldn't write the frame stats of \"%s\" to %s", nbl::system::ILogger::ELL_WARNING, scene.name.c_str(), frameStatsDir.string().c_str());
+		}
+	}
+}
+
+// Text throughput of an annotation layer of ~`glyphCount` glyphs (lines of `text`, a main object each) recorded into a headless filler
+// `drawFontGlyph` per glyph vs `drawFontGlyphRun` per line vs `SingleLineText::Draw`, `allocateFiller` is the same as for `benchmarkHeadlessRecording`
+inline void benchmarkTextThroughput(nbl::system::ILogger* logger, nbl::ext::TextRendering::FontFace* face, const std::function<void(DrawResourcesFiller&)>& allocateFiller, const std::string& text, uint32_t glyphCount = 1000000u, uint32_t frameCount = 8u)
+{
+	DrawResourcesFiller filler;
+	allocateFiller(filler);
+	assert(filler.isHeadless());
+	filler.setSubmitDrawsFunction([](SIntendedSubmitInfo&) {});
+
+	// same layout as `SingleLineText`
+	std::vector<DrawResourcesFiller::GlyphRunInstance> line;
+	float64_t2 currentPos = float64_t2(0.0, 0.0);
+	for (const char c : text)
+	{
+		const auto glyphIndex = face->getGlyphIndex(wchar_t(c));
+		const auto glyphMetrics = face->getGlyphMetrics(glyphIndex);
+		if (glyphIndex != 0 && !(glyphMetrics.size.x == 0.0 && glyphMetrics.size.y == 0.0))
+		{
+			DrawResourcesFiller::GlyphRunInstance glyph = {};
+			glyph.topLeft = currentPos + glyphMetrics.horizontalBearing;
+			glyph.dirU = float32_t2(glyphMetrics.size.x, 0.0f);
+			glyph.aspectRatio = glyphMetrics.size.y / glyphMetrics.size.x;
+			glyph.minUV = face->getUV(float32_t2(0.0f, 0.0f), glyphMetrics.size, filler.getMSDFResolution(), MSDFPixelRange);
+			glyph.glyphIdx = glyphIndex;
+			line.push_back(glyph);
+		}
+		currentPos += glyphMetrics.advance;
+	}
+	if (line.empty())
+		return;
+
+	const uint32_t lineCount = (glyphCount + line.size() - 1u) / line.size();
+	const uint64_t glyphsPerFrame = uint64_t(lineCount) * line.size();
+	std::vector<DrawResourcesFiller::GlyphRunInstance> movedLine = line;
+	SingleLineText singleLineText(core::smart_refctd_ptr<nbl::ext::TextRendering::FontFace>(face), text);
+
+	SIntendedSubmitInfo intendedNextSubmit = {};
+	auto measureGlyphsPerSecond = [&](const std::function<void(uint32_t /*lineIdx*/, uint32_t /*mainObjIdx*/)>& drawLine) -> double
+		{
+			auto recordFrame = [&]()
+				{
+					filler.reset();
+					LineStyleInfo lineStyle = {};
+					lineStyle.color = float32_t4(1.0f, 1.0f, 1.0f, 1.0f);
+					const uint32_t styleIdx = filler.addLineStyle_SubmitIfNeeded(lineStyle, intendedNextSubmit);
+					for (uint32_t lineIdx = 0u; lineIdx < lineCount; ++lineIdx)
+						drawLine(lineIdx, filler.addMainObject_SubmitIfNeeded(styleIdx, intendedNextSubmit));
+					filler.finalizeAllCopiesToGPU(intendedNextSubmit);
+				};
+			recordFrame(); // warmup, fills the MSDF cache
+			const double ms = measureMilliseconds([&]()
+				{
+					for (uint32_t i = 0u; i < frameCount; ++i)
+						recordFrame();
+				});
+			return double(glyphsPerFrame * frameCount) / (ms * 1e-3);
+		};
+
+	const double perGlyph = measureGlyphsPerSecond([&](uint32_t lineIdx, uint32_t mainObjIdx)
+		{
+			const float64_t2 lineOffset = float64_t2(0.0, -20.0 * lineIdx);
+			for (const auto& glyph : line)
+				filler.drawFontGlyph(face, glyph.glyphIdx, glyph.topLeft + lineOffset, glyph.dirU, glyph.aspectRatio, glyph.minUV, mainObjIdx, intendedNextSubmit);
+		});
+
+	const double glyphRun = measureGlyphsPerSecond([&](uint32_t lineIdx, uint32_t mainObjIdx)
+		{
+			const float64_t2 lineOffset = float64_t2(0.0, -20.0 * lineIdx);
+			for (uint32_t i = 0u; i < line.size(); ++i)
+				movedLine[i].topLeft = line[i].topLeft + lineOffset;
+			filler.drawFontGlyphRun(face, movedLine, mainObjIdx, intendedNextSubmit);
+		});
+
+	// adds its own style and main object per line, so the one `measureGlyphsPerSecond` adds goes unused
+	const double singleLineTextDraw = measureGlyphsPerSecond([&](uint32_t lineIdx, uint32_t)
+		{
+			singleLineText.Draw(filler, intendedNextSubmit, float64_t2(0.0, -20.0 * lineIdx));
+		});
+
+	logger->log("Text throughput, %u lines of %zu glyphs: drawFontGlyph = %.0f glyphs/s, drawFontGlyphRun = %.0f glyphs/s (speedup = %.2fx), SingleLineText::Draw = %.0f glyphs/s",
+		nbl::system::ILogger::ELL_PERFORMANCE, lineCount, line.size(), perGlyph, glyphRun, glyphRun / perGlyph, singleLineTextDraw);
+}
+
+// Recording a sheet of `polylineCount` polylines zoomed into a corner showing ~1% of it, into a headless filler
+// Everything vs `DrawResourcesFiller::enableCulling` vs querying a `SpatialGrid` of the polylines' AABBs first (filler culling still trims the ones crossing the view's border)
+inline void benchmarkSpatialCulling(nbl::system::ILogger* logger, const std::function<void(DrawResourcesFiller&)>& allocateFiller, uint32_t polylineCount = 100000u, uint32_t frameCount = 16u)
+{
+	const std::vector<CPolyline> polylines = generateSyntheticPolylines(polylineCount, 16u, 8u);
+
+	// hull of the line points and bezier control points of every section
+	std::vector<SpatialGrid::AABB> polylineAABBs(polylines.size());
+	SpatialGrid::AABB sheetAABB = {};
+	for (uint32_t i = 0u; i < polylines.size(); ++i)
+	{
+		const CPolyline& polyline = polylines[i];
+		SpatialGrid::AABB& aabb = polylineAABBs[i];
+		bool first = true;
+		auto extend = [&](const float64_t2 point)
+			{
+				if (first)
+					aabb = { point, point };
+				else
+					aabb.extend({ point, point });
+				first = false;
+			};
+		for (uint32_t s = 0u; s < polyline.getSectionsCount(); ++s)
+		{
+			const auto& section = polyline.getSectionInfoAt(s);
+			if (section.type == ObjectType::LINE)
+			{
+				for (uint32_t p = 0u; p <= section.count; ++p)
+					extend(polyline.getLinePointAt(section.index + p).p);
+			}
+			else
+			{
+				for (uint32_t b = 0u; b < section.count; ++b)
+				{
+					const auto& bezier = polyline.getQuadBezierInfoAt(section.index + b).shape;
+					extend(bezier.P0);
+					extend(bezier.P1);
+					extend(bezier.P2);
+				}
+			}
+		}
+		if (i == 0u)
+			sheetAABB = aabb;
+		else
+			sheetAABB.extend(aabb);
+	}
+
+	SpatialGrid grid;
+	const double gridBuildMs = measureMilliseconds([&]() { grid.build(polylineAABBs); });
+
+	// same projection as `Camera2D::constructViewProjection`, a tenth of the sheet along each axis at it's min corner
+	const float64_t2 viewBounds = (sheetAABB.max - sheetAABB.min) * 0.1;
+	const float64_t2 viewOrigin = sheetAABB.min + viewBounds * 0.5;
+	ClipProjectionData clipProjection = {};
+	clipProjection.projectionToNDC = float64_t3x3();
+	clipProjection.projectionToNDC[0][0] = 2.0 / viewBounds.x;
+	clipProjection.projectionToNDC[1][1] = -2.0 / viewBounds.y;
+	clipProjection.projectionToNDC[2][2] = 1.0;
+	clipProjection.projectionToNDC[0][2] = (-2.0 * viewOrigin.x) / viewBounds.x;
+	clipProjection.projectionToNDC[1][2] = (2.0 * viewOrigin.y) / viewBounds.y;
+	clipProjection.minClipNDC = float32_t2(-1.0f, -1.0f);
+	clipProjection.maxClipNDC = float32_t2(+1.0f, +1.0f);
+	const float32_t2 ndcMargin = float32_t2(0.01f, 0.01f); // a few pixels, covers the 2px lines and AA
+
+	std::vector<uint32_t> visiblePolylines;
+
+	DrawResourcesFiller filler;
+	allocateFiller(filler);
+	assert(filler.isHeadless());
+	uint64_t drawObjects = 0ull;
+	filler.setSubmitDrawsFunction([&](SIntendedSubmitInfo&) { drawObjects += filler.getDrawObjectCount(); });
+
+	SIntendedSubmitInfo intendedNextSubmit = {};
+	LineStyleInfo lineStyle = {};
+	lineStyle.screenSpaceLineWidth = 2.0f;
+	lineStyle.color = float32_t4(0.8f, 0.5f, 0.2f, 1.0f);
+
+	struct Result
+	{
+		double msPerFrame;
+		double uploadedKBPerFrame;
+		double drawObjectsPerFrame;
+	};
+	auto measure = [&](const std::function<void()>& drawSheet) -> Result
+		{
+			auto recordFrame = [&]()
+				{
+					filler.reset();
+					drawSheet();
+					filler.finalizeAllCopiesToGPU(intendedNextSubmit);
+					drawObjects += filler.getDrawObjectCount();
+				};
+			recordFrame();
+			drawObjects = 0ull;
+			const uint64_t uploadedBytesBegin = filler.getHeadlessUploadedBytes();
+			const double ms = measureMilliseconds([&]()
+				{
+					for (uint32_t i = 0u; i < frameCount; ++i)
+						recordFrame();
+				});
+			const uint64_t uploadedBytes = filler.getHeadlessUploadedBytes() - uploadedBytesBegin;
+			return { ms / frameCount, double(uploadedBytes) / (1024.0 * frameCount), double(drawObjects) / frameCount };
+		};
+
+	filler.disableCulling();
+	const Result everything = measure([&]()
+		{
+			for (const CPolyline& polyline : polylines)
+				filler.drawPolyline(polyline, lineStyle, intendedNextSubmit);
+		});
+
+	filler.setDefaultClipProjection(clipProjection);
+	filler.enableCulling(ndcMargin);
+	const Result fillerCulling = measure([&]()
+		{
+			for (const CPolyline& polyline : polylines)
+				filler.drawPolyline(polyline, lineStyle, intendedNextSubmit);
+		});
+
+	const Result gridCulling = measure([&]()
+		{
+			visiblePolylines.clear();
+			grid.queryVisible(clipProjection, ndcMargin, visiblePolylines);
+			for (const uint32_t polylineIdx : visiblePolylines)
+				filler.drawPolyline(polylines[polylineIdx], lineStyle, intendedNextSubmit);
+		});
+
+	logger->log("Spatial culling of %zu polylines zoomed into a corner (%zu visible, grid of %ux%u tiles built in %.2fms): everything = %.3fms/frame %.0fKB/frame %.0f draw objects/frame, filler culling = %.3fms/frame %.0fKB/frame %.0f draw objects/frame, grid + filler culling = %.3fms/frame %.0fKB/frame %.0f draw objects/frame (%.1fx less uploaded, %.2fx faster)",
+		nbl::system::ILogger::ELL_PERFORMANCE, polylines.size(), visiblePolylines.size(), grid.getTileCount().x, grid.getTileCount().y, gridBuildMs,
+		everything.msPerFrame, everything.uploadedKBPerFrame, everything.drawObjectsPerFrame,
+		fillerCulling.msPerFrame, fillerCulling.uploadedKBPerFrame, fillerCulling.drawObjectsPerFrame,
+		gridCulling.msPerFrame, gridCulling.uploadedKBPerFrame, gridCulling.drawObjectsPerFrame,
+		everything.uploadedKBPerFrame / core::max(gridCulling.uploadedKBPerFrame, 1e-9), everything.msPerFrame / core::max(gridCulling.msPerFrame, 1e-9));
+}
+
+// Recording `polylineCount` dense polylines into a headless filler at a few zoom levels, always level 0 vs `CPolylineLOD` levels picked for half a pixel of error on a 1920x1080 screen
+inline void benchmarkPolylineLOD(nbl::system::ILogger* logger, const std::function<void(DrawResourcesFiller&)>& allocateFiller, uint32_t polylineCount = 20000u, uint32_t frameCount = 16u)
+{
+	const std::vector<CPolyline> polylines = generateSyntheticPolylines(polylineCount, 64u, 32u);
+
+	float64_t2 sheetMin = polylines.front().getMin();
+	float64_t2 sheetMax = polylines.front().getMax();
+	for (const CPolyline& polyline : polylines)
+	{
+		sheetMin = float64_t2(core::min(sheetMin.x, polyline.getMin().x), core::min(sheetMin.y, polyline.getMin().y));
+		sheetMax = float64_t2(core::max(sheetMax.x, polyline.getMax().x), core::max(sheetMax.y, polyline.getMax().y));
+	}
+	const float64_t2 sheetSize = sheetMax - sheetMin;
+	const uint32_t2 resolution = uint32_t2(1920u, 1080u);
+
+	std::vector<CPolylineLOD> lods;
+	lods.reserve(polylines.size());
+	const double lodBuildMs = measureMilliseconds([&]()
+		{
+			// finest level at a hundredth of a pixel with the whole sheet on screen
+			const float64_t finestError = 0.01 * sheetSize.x / resolution.x;
+			for (const CPolyline& polyline : polylines)
+				lods.emplace_back(polyline, finestError);
+		});
+	uint64_t levelCount = 0ull;
+	for (const CPolylineLOD& lod : lods)
+		levelCount += lod.getLevelCount();
+	logger->log("Polyline LOD: built %zu LODs (%.2f levels on average) in %.2fms", nbl::system::ILogger::ELL_PERFORMANCE, lods.size(), double(levelCount) / double(lods.size()), lodBuildMs);
+
+	DrawResourcesFiller filler;
+	allocateFiller(filler);
+	assert(filler.isHeadless());
+	uint64_t drawObjects = 0ull;
+	uint64_t autoSubmits = 0ull;
+	filler.setSubmitDrawsFunction(
+		[&](SIntendedSubmitInfo&)
+		{
+			drawObjects += filler.getDrawObjectCount();
+			autoSubmits++;
+		});
+
+	SIntendedSubmitInfo intendedNextSubmit = {};
+	LineStyleInfo lineStyle = {};
+	lineStyle.screenSpaceLineWidth = 1.0f;
+	lineStyle.color = float32_t4(0.2f, 0.5f, 0.8f, 1.0f);
+
+	struct Result
+	{
+		double msPerFrame;
+		double uploadedKBPerFrame;
+		double drawObjectsPerFrame;
+		double autoSubmitsPerFrame;
+	};
+	auto measure = [&](const std::function<void()>& drawSheet) -> Result
+		{
+			auto recordFrame = [&]()
+				{
+					filler.reset();
+					drawSheet();
+					filler.finalizeAllCopiesToGPU(intendedNextSubmit);
+					drawObjects += filler.getDrawObjectCount();
+				};
+			recordFrame();
+			drawObjects = autoSubmits = 0ull;
+			const uint64_t uploadedBytesBegin = filler.getHeadlessUploadedBytes();
+			const double ms = measureMilliseconds([&]()
+				{
+					for (uint32_t i = 0u; i < frameCount; ++i)
+						recordFrame();
+				});
+			const uint64_t uploadedBytes = filler.getHeadlessUploadedBytes() - uploadedBytesBegin;
+			return { ms / frameCount, double(uploadedBytes) / (1024.0 * frameCount), double(drawObjects) / frameCount, double(autoSubmits) / frameCount };
+		};
+
+	filler.setPolylineLODMaxNDCError(1.0f / resolution.x);
+	// how many times the sheet fits in the view's width
+	constexpr float64_t ZoomOutFactors[] = { 0.25, 1.0, 4.0, 16.0 };
+	for (const float64_t zoomOut : ZoomOutFactors)
+	{
+		// same projection as `Camera2D::constructViewProjection`, centered on the sheet
+		const float64_t2 viewBounds = float64_t2(sheetSize.x * zoomOut, sheetSize.x * zoomOut * resolution.y / resolution.x);
+		const float64_t2 viewOrigin = (sheetMin + sheetMax) * 0.5;
+		ClipProjectionData clipProjection = {};
+		clipProjection.projectionToNDC = float64_t3x3();
+		clipProjection.projectionToNDC[0][0] = 2.0 / viewBounds.x;
+		clipProjection.projectionToNDC[1][1] = -2.0 / viewBounds.y;
+		clipProjection.projectionToNDC[2][2] = 1.0;
+		clipProjection.projectionToNDC[0][2] = (-2.0 * viewOrigin.x) / viewBounds.x;
+		clipProjection.projectionToNDC[1][2] = (2.0 * viewOrigin.y) / viewBounds.y;
+		clipProjection.minClipNDC = float32_t2(-1.0f, -1.0f);
+		clipProjection.maxClipNDC = float32_t2(+1.0f, +1.0f);
+		filler.setDefaultClipProjection(clipProjection);
+
+		const Result fullDetail = measure([&]()
+			{
+				for (const CPolyline& polyline : polylines)
+					filler.drawPolyline(polyline, lineStyle, intendedNextSubmit);
+			});
+
+		std::array<uint64_t, CPolylineLOD::MaxLevels> levelHistogramBegin = {};
+		std::copy(filler.getPolylineLODLevelHistogram().begin(), filler.getPolylineLODLevelHistogram().end(), levelHistogramBegin.begin());
+		const Result lod = measure([&]()
+			{
+				for (const CPolylineLOD& polylineLOD : lods)
+					filler.drawPolyline(polylineLOD, lineStyle, intendedNextSubmit);
+			});
+		uint64_t levelSum = 0ull;
+		uint64_t levelDraws = 0ull;
+		for (uint32_t level = 0u; level < CPolylineLOD::MaxLevels; ++level)
+		{
+			const uint64_t draws = filler.getPolylineLODLevelHistogram()[level] - levelHistogramBegin[level];
+			levelSum += draws * level;
+			levelDraws += draws;
+		}
+
+		logger->log("Polyline LOD, sheet %.2fx the view's width: level 0 = %.3fms/frame %.0fKB/frame %.0f draw objects/frame %.2f auto-submits/frame, LOD (average level %.2f) = %.3fms/frame %.0fKB/frame %.0f draw objects/frame %.2f auto-submits/frame (%.1fx less uploaded)",
+			nbl::system::ILogger::ELL_PERFORMANCE, 1.0 / zoomOut,
+			fullDetail.msPerFrame, fullDetail.uploadedKBPerFrame, fullDetail.drawObjectsPerFrame, fullDetail.autoSubmitsPerFrame,
+			double(levelSum) / double(core::max(levelDraws, uint64_t(1u))), lod.msPerFrame, lod.uploadedKBPerFrame, lod.drawObjectsPerFrame, lod.autoSubmitsPerFrame,
+			fullDetail.uploadedKBPerFrame / core::max(lod.uploadedKBPerFrame, 1e-9));
+	}
+}
+
+// Converts a procedural `imageSize`^2 raster to a `TiledGeoTexture` at `tempPath` (deleted afterwards), then streams it through a `GeoTextureStreamer` with a 64MiB budget
+// while the camera pans across it and zooms between the whole texture and 1:1 texels, like browsing an aerial image
+inline void benchmarkGeoTextureStreaming(nbl::system::ILogger* logger, nbl::system::ISystem* system, const nbl::system::path& tempPath, uint32_t imageSize = 8192u, uint32_t frameCount = 1024u)
+{
+	const uint32_t tileSize = 256u;
+	GeoTextureOBB obb = {};
+	obb.topLeft = float64_t2(0.0, 0.0);
+	obb.dirU = float32_t2(float32_t(imageSize), 0.0f); // a world unit per texel
+	obb.aspectRatio = 1.0f;
+
+	auto readRows = [imageSize](uint32_t firstRow, uint32_t rowCount, uint8_t* dst)
+		{
+			for (uint32_t y = firstRow; y < firstRow + rowCount; ++y)
+				for (uint32_t x = 0u; x < imageSize; ++x, dst += TiledGeoTexture::BytesPerTexel)
+				{
+					dst[0] = static_cast<uint8_t>(x ^ y);
+					dst[1] = static_cast<uint8_t>((x >> 4u) + (y >> 4u));
+					dst[2] = static_cast<uint8_t>((x * y) >> 8u);
+					dst[3] = 255u;
+				}
+			return true;
+		};
+
+	bool converted = false;
+	const double convertMs = measureMilliseconds([&]() { converted = TiledGeoTexture::convert(system, tempPath, uint32_t2(imageSize, imageSize), obb, readRows, tileSize); });
+	GeoTextureStreamer streamer(nbl::core::smart_refctd_ptr<nbl::system::ISystem>(system), 64ull << 20u, 64u);
+	if (!converted || !streamer.open(tempPath))
+	{
+		logger->log("GeoTexture streaming benchmark failed to write or open %s", nbl::system::ILogger::ELL_ERROR, tempPath.string().c_str());
+		system->deleteFile(tempPath);
+		return;
+	}
+	const double sourceMiB = double(imageSize) * imageSize * TiledGeoTexture::BytesPerTexel / double(1u << 20u);
+	logger->log("GeoTexture conversion of a %ux%u image (%u mips, %u px tiles): %.1f ms, %.1f MiB/s",
+		nbl::system::ILogger::ELL_PERFORMANCE, imageSize, imageSize, streamer.getHeader().mipCount, tileSize, convertMs, sourceMiB / (convertMs * 1e-3));
+
+	const uint32_t2 viewport = uint32_t2(1920u, 1080u);
+	const float64_t aspect = float64_t(viewport.y) / viewport.x;
+	double maxFrameMs = 0.0;
+	const double totalMs = measureMilliseconds([&]()
+		{
+			for (uint32_t frame = 0u; frame < frameCount; ++frame)
+			{
+				// view width goes from the whole texture to a texel per pixel and back, every ~200 frames
+				const float64_t t = float64_t(frame);
+				const float64_t zoom = 0.5 + 0.5 * std::cos(t * 0.03);
+				const float64_t viewWidth = std::exp2(std::log2(float64_t(viewport.x)) + zoom * std::log2(float64_t(imageSize) / viewport.x));
+				const float64_t2 viewOrigin = float64_t2(0.5 + 0.35 * std::sin(t * 0.011), -0.5 - 0.35 * std::cos(t * 0.007)) * float64_t(imageSize);
+
+				ClipProjectionData clipProjection = {};
+				clipProjection.projectionToNDC = float64_t3x3();
+				clipProjection.projectionToNDC[0][0] = 2.0 / viewWidth;
+				clipProjection.projectionToNDC[1][1] = -2.0 / (viewWidth * aspect);
+				clipProjection.projectionToNDC[2][2] = 1.0;
+				clipProjection.projectionToNDC[0][2] = (-2.0 * viewOrigin.x) / viewWidth;
+				clipProjection.projectionToNDC[1][2] = (2.0 * viewOrigin.y) / (viewWidth * aspect);
+				clipProjection.minClipNDC = float32_t2(-1.0f, -1.0f);
+				clipProjection.maxClipNDC = float32_t2(+1.0f, +1.0f);
+
+				const double frameMs = measureMilliseconds([&]() { streamer.update(clipProjection, viewport); });
+				maxFrameMs = core::max(maxFrameMs, frameMs);
+			}
+		});
+	system->deleteFile(tempPath);
+
+	const GeoTextureStreamer::Stats& stats = streamer.getStats();
+	const double hitRate = (stats.requestedTileCount > 0ull) ? double(stats.hitCount) / stats.requestedTileCount : 0.0;
+	logger->log("GeoTexture streaming over %u frames (%u slots): %.0f tiles/s, %.1f MiB/s read, %.3f ms/frame avg, %.3f ms max, hit rate = %.1f%%, %llu loads, %llu evictions, %llu stand-ins, %llu missing",
+		nbl::system::ILogger::ELL_PERFORMANCE, frameCount, streamer.getSlotCount(), stats.loadCount / (totalMs * 1e-3), (stats.bytesRead / double(1u << 20u)) / (totalMs * 1e-3),
+		totalMs / frameCount, maxFrameMs, hitRate * 100.0, stats.loadCount, stats.evictionCount, stats.fallbackCount, stats.missingCount);
+}
+
+// Re-labelling `annotationCount` dimension annotations (two line `TextBlock`s) on each of `zoomSteps` zoom steps, laid out every time vs through a `TextLayoutCache`
+inline void benchmarkTextLayout(nbl::system::ILogger* logger, nbl::ext::TextRendering::FontFace* face, uint32_t annotationCount = 10000u, uint32_t zoomSteps = 16u)
+{
+	std::vector<std::string> labels(annotationCount);
+	std::mt19937 mt(0x5eed);
+	std::uniform_real_distribution<double> length(0.1, 250.0);
+	for (auto& label : labels)
+	{
+		char buffer[64];
+		snprintf(buffer, sizeof(buffer), "L = %.3f m\nR%u", length(mt), uint32_t(mt() % 100u));
+		label = buffer;
+	}
+
+	TextLayoutParams params = {};
+	params.fontSize = 0.5;
+	params.maxLineWidth = 400.0;
+	params.alignment = TextAlignment::CENTER;
+
+	uint64_t lineCount = 0ull; // keeps the layouts from being optimized out
+	const double uncachedMs = measureMilliseconds([&]()
+		{
+			for (uint32_t step = 0u; step < zoomSteps; ++step)
+				for (const auto& label : labels)
+				{
+					TextBlock block(core::smart_refctd_ptr<nbl::ext::TextRendering::FontFace>(face), label, params);
+					lineCount += block.getLineCount();
+				}
+		});
+
+	TextLayoutCache cache(annotationCount);
+	const double cachedMs = measureMilliseconds([&]()
+		{
+			for (uint32_t step = 0u; step < zoomSteps; ++step)
+				for (const auto& label : labels)
+				{
+					TextBlock block(core::smart_refctd_ptr<nbl::ext::TextRendering::FontFace>(face), label, params, &cache);
+					lineCount += block.getLineCount();
+				}
+		});
+
+	const double layouts = double(annotationCount) * zoomSteps;
+	logger->log("Text layout of %u annotations over %u zoom steps: uncached = %.0f layouts/s, cached = %.0f layouts/s (speedup = %.2fx, %llu hits, %llu misses)",
+		nbl::system::ILogger::ELL_PERFORMANCE, annotationCount, zoomSteps, layouts / (uncachedMs * 1e-3), layouts / (cachedMs * 1e-3), uncachedMs / cachedMs, cache.getHitCount(), cache.getMissCount());
+}
+
+} // namespace cad_benchmarks
@@ -113,12 +113,14 @@ void DrawResourcesFiller::allocateStylesBuffer(ILogicalDevice* logicalDevice, ui
 		auto stylesBufferMem = logicalDevice->allocate(memReq, gpuDrawBuffers.lineStylesBuffer.get());
 
 		cpuDrawBuffers.lineStylesBuffer = ICPUBuffer::create({ lineStylesBufferSize });
+		lineStyleIndices.reserve(lineStylesCount);
 	}
 }
 
 void DrawResourcesFiller::allocateMSDFTextures(ILogicalDevice* logicalDevice, uint32_t maxMSDFs, uint32_t2 msdfsExtent)
 {
 	msdfLRUCache = std::unique_ptr<MSDFsLRUCache>(new MSDFsLRUCache(maxMSDFs));
+	msdfTextureArrayIndicesUsed.assign(maxMSDFs, false);
 	msdfTextureArrayIndexAllocator = core::make_smart_refctd_ptr<IndexAllocator>(core::smart_refctd_ptr<ILogicalDevice>(logicalDevice), maxMSDFs);
 
 	asset::E_FORMAT msdfFormat = MSDFTextureFormat;
@@ -165,10 +167,40 @@ void DrawResourcesFiller::allocateMSDFTextures(ILogicalDevice* logicalDevice, ui
 	}
 }
 
+void DrawResourcesFiller::allocateHeadless(uint32_t maxIndices, uint32_t mainObjects, uint32_t drawObjects, size_t geometryBufferSize, uint32_t lineStylesCount, uint32_t maxMSDFs, uint32_t2 msdfsExtent)
+{
+	m_headless = true;
+	m_headlessUploadedBytes = 0ull;
+
+	// index buffer contents are fixed and only ever needed on the gpu
+	maxIndexCount = maxIndices;
+
+	maxMainObjects = mainObjects;
+	cpuDrawBuffers.mainObjectsBuffer = ICPUBuffer::create({ maxMainObjects * sizeof(MainObject) });
+
+	maxDrawObjects = drawObjects;
+	cpuDrawBuffers.drawObjectsBuffer = ICPUBuffer::create({ maxDrawObjects * sizeof(DrawObject) });
+
+	maxGeometryBufferSize = geometryBufferSize;
+	geometryBufferAddress = 0ull;
+	cpuDrawBuffers.geometryBuffer = ICPUBuffer::create({ geometryBufferSize });
+
+	maxLineStyles = lineStylesCount;
+	cpuDrawBuffers.lineStylesBuffer = ICPUBuffer::create({ maxLineStyles * sizeof(LineStyle) });
+	lineStyleIndices.reserve(maxLineStyles);
+
+	// without a device there are no semaphores to defer frees on, headless submits are done as soon as they're called so we free right away
+	msdfLRUCache = std::unique_ptr<MSDFsLRUCache>(new MSDFsLRUCache(maxMSDFs));
+	msdfTextureArrayIndicesUsed.assign(maxMSDFs, false);
+	msdfTextureArrayIndexAllocator = core::make_smart_refctd_ptr<IndexAllocator>(nullptr, maxMSDFs);
+	m_headlessMSDFExtent = msdfsExtent;
+}
+
 void DrawResourcesFiller::drawPolyline(const CPolylineBase& polyline, const LineStyleInfo& lineStyleInfo, SIntendedSubmitInfo& intendedNextSubmit)
 {
 	if (!lineStyleInfo.isVisible())
 		return;
+	DrawCallScope drawCallScope(*this, DrawCallType::POLYLINE);
 
 	uint32_t styleIdx = addLineStyle_SubmitIfNeeded(lineStyleInfo, intendedNextSubmit);
 
@@ -179,6 +211,7 @@ void DrawResourcesFiller::drawPolyline(const CPolylineBase& polyline, const Line
 
 void DrawResourcesFiller::drawPolyline(const CPolylineBase& polyline, uint32_t polylineMainObjIdx, SIntendedSubmitInfo& intendedNextSubmit)
 {
+	DrawCallScope drawCallScope(*this, DrawCallType::POLYLINE);
 	if (polylineMainObjIdx == InvalidMainObjectIdx)
 	{
 		// TODO: assert or log error here
@@ -186,36 +219,104 @@ void DrawResourcesFiller::drawPolyline(const CPolylineBase& polyline, uint32_t p
 		return;
 	}
 	
-	const auto sectionsCount = polyline.getSectionsCount();
-
-	uint32_t currentSectionIdx = 0u;
-	uint32_t currentObjectInSection = 0u; // Object here refers to DrawObject used in vertex shader. You can think of it as a Cage.
-
-	while (currentSectionIdx < sectionsCount)
+	// world space region the objects have to touch, grown by the half width of the polyline instead of growing every object
+	SpatialGrid::AABB cullingAABB = {};
+	SpatialGrid::AABB connectorCullingAABB = {};
+	if (m_cullingEnabled)
 	{
-		const auto& currentSection = polyline.getSectionInfoAt(currentSectionIdx);
-		addPolylineObjects_Internal(polyline, currentSection, currentObjectInSection, polylineMainObjIdx);
-
-		if (currentObjectInSection >= currentSection.count)
+		cullingAABB = getCullingWorldAABB();
+		connectorCullingAABB = cullingAABB;
+		const uint32_t styleIdx = getMainObject(polylineMainObjIdx)->styleIdx;
+		if (styleIdx != InvalidStyleIdx)
 		{
-			currentSectionIdx++;
-			currentObjectInSection = 0u;
+			const float64_t halfWidth = reinterpret_cast<LineStyle*>(cpuDrawBuffers.lineStylesBuffer->getPointer())[styleIdx].worldSpaceLineWidth * 0.5;
+			const float64_t2 margin = float64_t2(halfWidth, halfWidth);
+			cullingAABB.min = cullingAABB.min - margin;
+			cullingAABB.max = cullingAABB.max + margin;
+			connectorCullingAABB.min = connectorCullingAABB.min - margin * float64_t(m_cullingMiterLimit);
+			connectorCullingAABB.max = connectorCullingAABB.max + margin * float64_t(m_cullingMiterLimit);
 		}
-		else
-			submitCurrentDrawObjectsAndReset(intendedNextSubmit, polylineMainObjIdx);
 	}
 
-	if (!polyline.getConnectors().empty())
+	const auto sectionsCount = polyline.getSectionsCount();
+	for (uint32_t sectionIdx = 0u; sectionIdx < sectionsCount; ++sectionIdx)
 	{
-		uint32_t currentConnectorPolylineObject = 0u;
-		while (currentConnectorPolylineObject < polyline.getConnectors().size())
-		{
-			addPolylineConnectors_Internal(polyline, currentConnectorPolylineObject, polylineMainObjIdx);
+		const auto& section = polyline.getSectionInfoAt(sectionIdx);
+		auto isVisible = [&](uint32_t objIdx)
+			{
+				SpatialGrid::AABB objAABB = {};
+				if (section.type == ObjectType::LINE)
+				{
+					const float64_t2 p0 = polyline.getLinePointAt(section.index + objIdx).p;
+					const float64_t2 p1 = polyline.getLinePointAt(section.index + objIdx + 1u).p;
+					objAABB = { p0, p0 };
+					objAABB.extend({ p1, p1 });
+				}
+				else
+				{
+					// convex hull of the control points contains the curve
+					const auto& bezier = polyline.getQuadBezierInfoAt(section.index + objIdx).shape;
+					objAABB = { bezier.P0, bezier.P0 };
+					objAABB.extend({ bezier.P1, bezier.P1 });
+					objAABB.extend({ bezier.P2, bezier.P2 });
+				}
+				return objAABB.overlaps(cullingAABB);
+			};
 
-			if (currentConnectorPolylineObject < polyline.getConnectors().size())
+		forEachVisibleRun(section.count, isVisible,
+			[&](uint32_t runBegin, uint32_t runEnd)
+			{
+				CPolylineBase::SectionInfo run = section;
+				run.index += runBegin;
+				run.count = runEnd - runBegin;
+
+				uint32_t currentObjectInSection = 0u; // Object here refers to DrawObject used in vertex shader. You can think of it as a Cage.
+				while (true)
+				{
+					addPolylineObjects_Internal(polyline, run, currentObjectInSection, polylineMainObjIdx);
+					if (currentObjectInSection >= run.count)
+						break;
+					submitCurrentDrawObjectsAndReset(intendedNextSubmit, polylineMainObjIdx);
+				}
+			});
+	}
+
+	const auto connectors = polyline.getConnectors();
+	forEachVisibleRun(static_cast<uint32_t>(connectors.size()),
+		[&](uint32_t connectorIdx)
+		{
+			const float64_t2 center = connectors[connectorIdx].circleCenter;
+			return SpatialGrid::AABB{ center, center }.overlaps(connectorCullingAABB);
+		},
+		[&](uint32_t runBegin, uint32_t runEnd)
+		{
+			uint32_t currentConnectorPolylineObject = runBegin;
+			while (true)
+			{
+				addPolylineConnectors_Internal(polyline, currentConnectorPolylineObject, runEnd, polylineMainObjIdx);
+				if (currentConnectorPolylineObject >= runEnd)
+					break;
 				submitCurrentDrawObjectsAndReset(intendedNextSubmit, polylineMainObjIdx);
-		}
+			}
+		});
+}
+
+void DrawResourcesFiller::drawPolyline(const CPolylineLOD& polylineLOD, const LineStyleInfo& lineStyleInfo, SIntendedSubmitInfo& intendedNextSubmit)
+{
+	DrawCallScope drawCallScope(*this, DrawCallType::POLYLINE);
+	uint32_t level = 0u;
+	if (m_polylineLODMaxNDCError > 0.0f)
+	{
+		// world space distances grow by at most the frobenius norm of the linear part when projected
+		const float64_t3x3& projectionToNDC = getCurrentClipProjection().projectionToNDC;
+		const float64_t scale = std::sqrt(
+			projectionToNDC[0][0] * projectionToNDC[0][0] + projectionToNDC[0][1] * projectionToNDC[0][1] +
+			projectionToNDC[1][0] * projectionToNDC[1][0] + projectionToNDC[1][1] * projectionToNDC[1][1]);
+		if (scale > 0.0)
+			level = polylineLOD.selectLevel(float64_t(m_polylineLODMaxNDCError) / scale);
 	}
+	m_polylineLODLevelHistogram[level]++;
+	drawPolyline(polylineLOD.getLevel(level), lineStyleInfo, intendedNextSubmit);
 }
 
 void DrawResourcesFiller::drawHatch(
@@ -225,6 +326,8 @@ void DrawResourcesFiller::drawHatch(
 		const HatchFillPattern fillPattern,
 		SIntendedSubmitInfo& intendedNextSubmit)
 {
+	DrawCallScope drawCallScope(*this, DrawCallType::HATCH);
+
 	// TODO[Optimization Idea]: don't draw hatch twice if both colors are visible: instead do the msdf inside the alpha resolve by detecting mainObj being a hatch
 	// https://discord.com/channels/593902898015109131/856835291712716820/1228337893366300743
 	// TODO: Come back to this idea when doing color resolve for ecws (they don't have mainObj/style Index, instead they have uv into a texture
@@ -241,15 +344,8 @@ void DrawResourcesFiller::drawHatch(
 		const HatchFillPattern fillPattern,
 		SIntendedSubmitInfo& intendedNextSubmit)
 {
-	uint32_t textureIdx = InvalidTextureIdx;
-	if (fillPattern != HatchFillPattern::SOLID_FILL)
-	{
-		MSDFInputInfo msdfInfo = MSDFInputInfo(fillPattern);
-		textureIdx = getMSDFIndexFromInputInfo(msdfInfo, intendedNextSubmit);
-		if (textureIdx == InvalidTextureIdx)
-			textureIdx = addMSDFTexture(msdfInfo, getHatchFillPatternMSDF(fillPattern), InvalidMainObjectIdx, intendedNextSubmit);
-		_NBL_DEBUG_BREAK_IF(textureIdx == InvalidTextureIdx); // probably getHatchFillPatternMSDF returned nullptr
-	}
+	DrawCallScope drawCallScope(*this, DrawCallType::HATCH);
+	const uint32_t textureIdx = getHatchFillPatternMSDFIndex(fillPattern, intendedNextSubmit);
 
 	LineStyleInfo lineStyle = {};
 	lineStyle.color = color;
@@ -257,17 +353,29 @@ void DrawResourcesFiller::drawHatch(
 	const uint32_t styleIdx = addLineStyle_SubmitIfNeeded(lineStyle, intendedNextSubmit);
 
 	uint32_t mainObjIdx = addMainObject_SubmitIfNeeded(styleIdx, intendedNextSubmit);
-	uint32_t currentObjectInSection = 0u; // Object here refers to DrawObject used in vertex shader. You can think of it as a Cage.
-	while (currentObjectInSection < hatch.getHatchBoxCount())
-	{
-		addHatch_Internal(hatch, currentObjectInSection, mainObjIdx);
-		if (currentObjectInSection < hatch.getHatchBoxCount())
-			submitCurrentDrawObjectsAndReset(intendedNextSubmit, mainObjIdx);
-	}
+
+	const SpatialGrid::AABB cullingAABB = m_cullingEnabled ? getCullingWorldAABB() : SpatialGrid::AABB{};
+	forEachVisibleRun(hatch.getHatchBoxCount(),
+		[&](uint32_t hatchBoxIdx)
+		{
+			const Hatch::CurveHatchBox& hatchBox = hatch.getHatchBox(hatchBoxIdx);
+			return SpatialGrid::AABB{ hatchBox.aabbMin, hatchBox.aabbMax }.overlaps(cullingAABB);
+		},
+		[&](uint32_t runBegin, uint32_t runEnd)
+		{
+			uint32_t currentObjectInSection = runBegin; // Object here refers to DrawObject used in vertex shader. You can think of it as a Cage.
+			while (currentObjectInSection < runEnd)
+			{
+				addHatch_Internal(hatch, currentObjectInSection, runEnd, mainObjIdx);
+				if (currentObjectInSection < runEnd)
+					submitCurrentDrawObjectsAndReset(intendedNextSubmit, mainObjIdx);
+			}
+		});
 }
 
 void DrawResourcesFiller::drawHatch(const Hatch& hatch, const float32_t4& color, SIntendedSubmitInfo& intendedNextSubmit)
 {
+	DrawCallScope drawCallScope(*this, DrawCallType::HATCH);
 	drawHatch(hatch, color, HatchFillPattern::SOLID_FILL, intendedNextSubmit);
 }
 
@@ -281,12 +389,14 @@ void DrawResourcesFiller::drawFontGlyph(
 		uint32_t mainObjIdx,
 		SIntendedSubmitInfo& intendedNextSubmit)
 {
-	uint32_t textureIdx = InvalidTextureIdx;
-	const MSDFInputInfo msdfInput = MSDFInputInfo(fontFace->getHash(), glyphIdx);
-	textureIdx = getMSDFIndexFromInputInfo(msdfInput, intendedNextSubmit);
-	if (textureIdx == InvalidTextureIdx)
-		textureIdx = addMSDFTexture(msdfInput, getGlyphMSDF(fontFace, glyphIdx), mainObjIdx, intendedNextSubmit);
+	DrawCallScope drawCallScope(*this, DrawCallType::FONT_GLYPH);
+	if (m_cullingEnabled && !isGlyphVisible(topLeft, dirU, aspectRatio, getCullingWorldAABB()))
+	{
+		m_culledObjectCount++;
+		return;
+	}
 
+	const uint32_t textureIdx = getGlyphMSDFIndex(fontFace, glyphIdx, mainObjIdx, intendedNextSubmit);
 	if (textureIdx != InvalidTextureIdx)
 	{
 		GlyphInfo glyphInfo = GlyphInfo(topLeft, dirU, aspectRatio, textureIdx, minUV);
@@ -305,8 +415,566 @@ void DrawResourcesFiller::drawFontGlyph(
 	}
 }
 
+uint32_t DrawResourcesFiller::getGlyphMSDFIndex(nbl::ext::TextRendering::FontFace* fontFace, uint32_t glyphIdx, uint32_t mainObjIdx, SIntendedSubmitInfo& intendedNextSubmit)
+{
+	const MSDFInputInfo msdfInput = MSDFInputInfo(fontFace->getHash(), glyphIdx);
+	uint32_t textureIdx = getMSDFIndexFromInputInfo(msdfInput, intendedNextSubmit);
+	if (textureIdx == InvalidTextureIdx)
+	{
+		if (m_msdfGenerationPool)
+		{
+			// the job outlives this call, so it keeps its own references
+			textureIdx = addMSDFTextureAsync(msdfInput,
+				[face = smart_refctd_ptr<nbl::ext::TextRendering::FontFace>(fontFace), glyphIdx, msdfInput, getGlyphMSDF = getGlyphMSDF, sharedCache = m_sharedMSDFCache]()
+				{
+					auto generate = [&]() { return getGlyphMSDF(face.get(), glyphIdx); };
+					return sharedCache ? sharedCache->getOrGenerate(msdfInput, generate) : generate();
+				},
+				mainObjIdx, intendedNextSubmit);
+		}
+		else
+			textureIdx = addMSDFTexture(msdfInput, getMSDFImage(msdfInput, [&]() { return getGlyphMSDF(fontFace, glyphIdx); }), mainObjIdx, intendedNextSubmit);
+	}
+
+	return textureIdx;
+}
+
+void DrawResourcesFiller::drawFontGlyphRun(
+		nbl::ext::TextRendering::FontFace* fontFace,
+		std::span<const GlyphRunInstance> glyphs,
+		uint32_t mainObjIdx,
+		SIntendedSubmitInfo& intendedNextSubmit)
+{
+	DrawCallScope drawCallScope(*this, DrawCallType::FONT_GLYPH_RUN);
+	if (m_cullingEnabled)
+	{
+		// culled glyphs shouldn't get their MSDFs resolved either
+		const SpatialGrid::AABB cullingAABB = getCullingWorldAABB();
+		m_glyphRunVisibleGlyphs.clear();
+		for (const GlyphRunInstance& glyph : glyphs)
+		{
+			if (isGlyphVisible(glyph.topLeft, glyph.dirU, glyph.aspectRatio, cullingAABB))
+				m_glyphRunVisibleGlyphs.push_back(glyph);
+			else
+				m_culledObjectCount++;
+		}
+		glyphs = m_glyphRunVisibleGlyphs;
+	}
+
+	// Resolve the MSDF of every distinct glyph first. Adding a missing one can evict one resolved earlier in the pass (and its index can get reused),
+	// so the pass is redone if anything got evicted, the second pass only misses if the run has more distinct glyphs than the MSDF cache holds
+	const uint64_t msdfHitsBefore = m_frameStats.msdfHits;
+	const uint64_t msdfMissesBefore = m_frameStats.msdfMisses;
+	uint64_t firstPassMisses = 0ull;
+	bool resolved = false;
+	for (uint32_t attempt = 0u; attempt < 2u && !resolved; ++attempt)
+	{
+		const uint64_t evictionCountBefore = m_msdfEvictionCount;
+		m_glyphRunDistinctGlyphs.clear();
+		m_glyphRunTextureIndices.resize(glyphs.size());
+		for (uint32_t i = 0u; i < glyphs.size(); ++i)
+		{
+			auto [it, inserted] = m_glyphRunDistinctGlyphs.try_emplace(glyphs[i].glyphIdx, InvalidTextureIdx);
+			if (inserted)
+				it->second = getGlyphMSDFIndex(fontFace, glyphs[i].glyphIdx, mainObjIdx, intendedNextSubmit);
+			m_glyphRunTextureIndices[i] = it->second;
+		}
+		if (attempt == 0u)
+			firstPassMisses = m_frameStats.msdfMisses - msdfMissesBefore;
+		resolved = (m_msdfEvictionCount == evictionCountBefore);
+	}
+
+	// count per glyph like `drawFontGlyph` does: a repeated glyph hits the MSDF its first instance added, and the redone pass isn't counted
+	m_frameStats.msdfHits = msdfHitsBefore;
+	m_frameStats.msdfMisses = msdfMissesBefore;
+	if (!resolved)
+	{
+		for (const GlyphRunInstance& glyph : glyphs)
+			drawFontGlyph(fontFace, glyph.glyphIdx, glyph.topLeft, glyph.dirU, glyph.aspectRatio, glyph.minUV, mainObjIdx, intendedNextSubmit);
+		return;
+	}
+	m_frameStats.msdfMisses += firstPassMisses;
+	m_frameStats.msdfHits += glyphs.size() - firstPassMisses;
+
+	uint32_t glyphsWritten = 0u;
+	while (glyphsWritten < glyphs.size())
+	{
+		const auto maxGeometryBufferFontGlyphs = (maxGeometryBufferSize - currentGeometryBufferSize) / sizeof(GlyphInfo);
+		const uint32_t uploadableObjects = getUploadableDrawObjectCount(maxGeometryBufferFontGlyphs);
+
+		if (uploadableObjects == 0u)
+		{
+			// not enough memory left to push to gpu, so we submit rendering current objects and reset geometry buffer and draw objects
+			submitCurrentDrawObjectsAndReset(intendedNextSubmit, mainObjIdx);
+			continue;
+		}
+
+		const uint32_t chunkEnd = std::min(glyphsWritten + uploadableObjects, static_cast<uint32_t>(glyphs.size()));
+		GlyphInfo* geomDst = reinterpret_cast<GlyphInfo*>(reinterpret_cast<char*>(cpuDrawBuffers.geometryBuffer->getPointer()) + currentGeometryBufferSize);
+		DrawObject* drawObjDst = reinterpret_cast<DrawObject*>(cpuDrawBuffers.drawObjectsBuffer->getPointer()) + currentDrawObjectCount;
+		uint64_t fontGlyphAddr = geometryBufferAddress + currentGeometryBufferSize;
+		uint32_t chunkObjectCount = 0u;
+		for (uint32_t i = glyphsWritten; i < chunkEnd; ++i)
+		{
+			const uint32_t textureIdx = m_glyphRunTextureIndices[i];
+			if (textureIdx == InvalidTextureIdx)
+			{
+				// TODO: Log, probably getGlyphMSDF(face,glyphIdx) returned nullptr ICPUImage ptr
+				_NBL_DEBUG_BREAK_IF(true);
+				continue;
+			}
+
+			const GlyphRunInstance& glyph = glyphs[i];
+			const GlyphInfo glyphInfo = GlyphInfo(glyph.topLeft, glyph.dirU, glyph.aspectRatio, textureIdx, glyph.minUV);
+			memcpy(geomDst + chunkObjectCount, &glyphInfo, sizeof(GlyphInfo));
+
+			DrawObject drawObj = {};
+			drawObj.type_subsectionIdx = uint32_t(static_cast<uint16_t>(ObjectType::FONT_GLYPH) | (0 << 16));
+			drawObj.mainObjIndex = mainObjIdx;
+			drawObj.geometryAddress = fontGlyphAddr;
+			memcpy(drawObjDst + chunkObjectCount, &drawObj, sizeof(DrawObject));
+
+			fontGlyphAddr += sizeof(GlyphInfo);
+			chunkObjectCount++;
+		}
+		currentGeometryBufferSize += sizeof(GlyphInfo) * chunkObjectCount;
+		currentDrawObjectCount += chunkObjectCount;
+		glyphsWritten = chunkEnd;
+	}
+}
+
+DrawResourcesFiller::RecordingContext DrawResourcesFiller::createRecordingContext() const
+{
+	// A segment needs to fit into empty buffers, with the clip projection that gets re-pushed after an auto-submit
+	uint32_t maxSegmentDrawObjects = RecordingContext::MaxSegmentDrawObjects;
+	maxSegmentDrawObjects = std::min(maxSegmentDrawObjects, maxIndexCount / 6u);
+	maxSegmentDrawObjects = std::min(maxSegmentDrawObjects, maxDrawObjects);
+
+	uint64_t maxSegmentGeometrySize = RecordingContext::MaxSegmentGeometrySize;
+	const uint64_t maxNonResidentGeometrySize = maxGeometryBufferSize - getMaxResidentGeometryBufferSize();
+	maxSegmentGeometrySize = std::min(maxSegmentGeometrySize, maxNonResidentGeometrySize - std::min<uint64_t>(maxNonResidentGeometrySize, sizeof(ClipProjectionData)));
+
+	// otherwise a single quadratic bezier wouldn't fit, make sure the buffers are allocated before creating contexts
+	assert(maxSegmentDrawObjects >= getCageCountPerPolylineObject(ObjectType::QUAD_BEZIER));
+	assert(maxSegmentGeometrySize >= sizeof(QuadraticBezierInfo));
+
+	return RecordingContext(maxSegmentDrawObjects, maxSegmentGeometrySize);
+}
+
+void DrawResourcesFiller::mergeRecordingContexts(std::span<const RecordingContext> contexts, SIntendedSubmitInfo& intendedNextSubmit)
+{
+	DrawCallScope drawCallScope(*this, DrawCallType::RECORDING_CONTEXT_MERGE);
+	for (const RecordingContext& context : contexts)
+		mergeRecordingContext(context, intendedNextSubmit);
+}
+
+void DrawResourcesFiller::mergeRecordingContext(const RecordingContext& context, SIntendedSubmitInfo& intendedNextSubmit)
+{
+	DrawCallScope drawCallScope(*this, DrawCallType::RECORDING_CONTEXT_MERGE);
+
+	// index of the context's clip projection we've pushed on top of our stack, consecutive main objects usually share it so we don't push it again for each of them
+	uint32_t pushedClipProjectionIdx = RecordingContext::InvalidIdx;
+
+	for (const RecordingContext::RecordedMainObject& recordedMainObject : context.mainObjects)
+	{
+		// nothing was drawn into it
+		if (recordedMainObject.segmentsCount == 0u)
+			continue;
+
+		const uint32_t mainObjIdx = addRecordedMainObject_SubmitIfNeeded(recordedMainObject, context.clipProjections, pushedClipProjectionIdx, intendedNextSubmit);
+
+		for (uint32_t i = 0u; i < recordedMainObject.segmentsCount; ++i)
+		{
+			const RecordingContext::RecordedSegment& segment = context.segments[recordedMainObject.segmentsOffset + i];
+			if (segment.glyphIdx != RecordingContext::InvalidIdx)
+			{
+				const RecordingContext::RecordedGlyph& glyph = context.glyphs[segment.glyphIdx];
+				drawFontGlyph(glyph.fontFace, glyph.glyphIdx, glyph.topLeft, glyph.dirU, glyph.aspectRatio, glyph.minUV, mainObjIdx, intendedNextSubmit);
+				continue;
+			}
+
+			if (!addRecordedSegment_Internal(context, segment, mainObjIdx))
+			{
+				// segment couldn't fit into memory to push to gpu, so we submit rendering current objects and reset geometry buffer and draw objects
+				submitCurrentDrawObjectsAndReset(intendedNextSubmit, mainObjIdx);
+				bool success = addRecordedSegment_Internal(context, segment, mainObjIdx);
+				assert(success); // segments are limited to fit in empty buffers in `createRecordingContext`, so this is a bug
+			}
+		}
+	}
+
+	if (pushedClipProjectionIdx != RecordingContext::InvalidIdx)
+		popClipProjectionData();
+}
+
+DrawResourcesFiller::StaticBatchHandle DrawResourcesFiller::registerStaticBatch(const RecordingContext& context)
+{
+	// resident geometry needs to be contiguous at the front of the buffer, so nothing else should be in the geometry buffer yet
+	assert(currentGeometryBufferSize == residentGeometryBufferSize);
+	if (currentGeometryBufferSize != residentGeometryBufferSize)
+		return InvalidStaticBatchHandle;
+
+	const uint64_t batchGeometrySize = context.geometry.size();
+	if (residentGeometryBufferSize + batchGeometrySize > getMaxResidentGeometryBufferSize())
+		return InvalidStaticBatchHandle;
+
+	const uint64_t batchGeometryAddress = geometryBufferAddress + residentGeometryBufferSize;
+	void* dst = reinterpret_cast<char*>(cpuDrawBuffers.geometryBuffer->getPointer()) + residentGeometryBufferSize;
+	memcpy(dst, context.geometry.data(), batchGeometrySize);
+	residentGeometryBufferSize += batchGeometrySize;
+	currentGeometryBufferSize = residentGeometryBufferSize; // inMemGeometryBufferSize stays behind, so it gets uploaded on the next finalize
+
+	StaticBatch batch = {};
+	batch.clipProjections = context.clipProjections;
+	batch.drawObjects.reserve(context.drawObjects.size());
+	for (const RecordingContext::RecordedMainObject& recordedMainObject : context.mainObjects)
+	{
+		if (recordedMainObject.segmentsCount == 0u)
+			continue;
+
+		StaticBatch::MainObjectInfo mainObject = {};
+		mainObject.recorded = recordedMainObject;
+		mainObject.drawObjectsOffset = batch.drawObjects.size();
+		for (uint32_t i = 0u; i < recordedMainObject.segmentsCount; ++i)
+		{
+			const RecordingContext::RecordedSegment& segment = context.segments[recordedMainObject.segmentsOffset + i];
+			assert(segment.glyphIdx == RecordingContext::InvalidIdx); // glyphs aren't retained
+			for (uint32_t j = 0u; j < segment.drawObjectsCount; ++j)
+			{
+				DrawObject drawObj = context.drawObjects[segment.drawObjectsOffset + j];
+				drawObj.geometryAddress += batchGeometryAddress + segment.geometryOffset;
+				batch.drawObjects.push_back(drawObj);
+			}
+		}
+		mainObject.drawObjectsCount = batch.drawObjects.size() - mainObject.drawObjectsOffset;
+		batch.mainObjects.push_back(mainObject);
+	}
+
+	staticBatches.push_back(std::move(batch));
+	return staticBatches.size() - 1u;
+}
+
+void DrawResourcesFiller::drawStaticBatch(StaticBatchHandle handle, SIntendedSubmitInfo& intendedNextSubmit)
+{
+	DrawCallScope drawCallScope(*this, DrawCallType::STATIC_BATCH);
+	if (handle >= staticBatches.size())
+	{
+		assert(false);
+		return;
+	}
+
+	const StaticBatch& batch = staticBatches[handle];
+	uint32_t pushedClipProjectionIdx = RecordingContext::InvalidIdx;
+	for (const StaticBatch::MainObjectInfo& mainObject : batch.mainObjects)
+	{
+		const uint32_t mainObjIdx = addRecordedMainObject_SubmitIfNeeded(mainObject.recorded, batch.clipProjections, pushedClipProjectionIdx, intendedNextSubmit);
+
+		uint32_t currentDrawObject = 0u;
+		while (currentDrawObject < mainObject.drawObjectsCount)
+		{
+			currentDrawObject += addStaticBatchDrawObjects_Internal(
+				batch.drawObjects.data() + mainObject.drawObjectsOffset + currentDrawObject,
+				mainObject.drawObjectsCount - currentDrawObject,
+				mainObjIdx);
+
+			// resident geometry isn't reset by this, so the draw objects remain valid
+			if (currentDrawObject < mainObject.drawObjectsCount)
+				submitCurrentDrawObjectsAndReset(intendedNextSubmit, mainObjIdx);
+		}
+	}
+
+	if (pushedClipProjectionIdx != RecordingContext::InvalidIdx)
+		popClipProjectionData();
+}
+
+void DrawResourcesFiller::releaseAllStaticBatches()
+{
+	assert(currentGeometryBufferSize == residentGeometryBufferSize); // nothing else should be in the geometry buffer yet
+	staticBatches.clear();
+	residentGeometryBufferSize = 0u;
+	resetGeometryCounters();
+}
+
+uint32_t DrawResourcesFiller::addRecordedMainObject_SubmitIfNeeded(const RecordingContext::RecordedMainObject& recordedMainObject, std::span<const ClipProjectionData> clipProjections, uint32_t& pushedClipProjectionIdx, SIntendedSubmitInfo& intendedNextSubmit)
+{
+	if (recordedMainObject.clipProjectionIdx != pushedClipProjectionIdx)
+	{
+		if (pushedClipProjectionIdx != RecordingContext::InvalidIdx)
+			popClipProjectionData();
+		if (recordedMainObject.clipProjectionIdx != RecordingContext::InvalidIdx)
+			pushClipProjectionData(clipProjections[recordedMainObject.clipProjectionIdx]);
+		pushedClipProjectionIdx = recordedMainObject.clipProjectionIdx;
+	}
+
+	// MSDF texture may auto-submit, so resolve it before the style and mainObject (same as drawHatch)
+	LineStyleInfo lineStyle = recordedMainObject.lineStyle;
+	if (recordedMainObject.fillPattern != HatchFillPattern::SOLID_FILL)
+		lineStyle.screenSpaceLineWidth = nbl::hlsl::bit_cast<float, uint32_t>(getHatchFillPatternMSDFIndex(recordedMainObject.fillPattern, intendedNextSubmit));
+
+	const uint32_t styleIdx = addLineStyle_SubmitIfNeeded(lineStyle, intendedNextSubmit);
+	return addMainObject_SubmitIfNeeded(styleIdx, intendedNextSubmit);
+}
+
+void DrawResourcesFiller::RecordingContext::reset()
+{
+	mainObjects.clear();
+	segments.clear();
+	drawObjects.clear();
+	geometry.clear();
+	glyphs.clear();
+	clipProjections.clear();
+	clipProjectionStack.clear();
+}
+
+void DrawResourcesFiller::RecordingContext::pushClipProjectionData(const ClipProjectionData& clipProjectionData)
+{
+	clipProjectionStack.push_back(clipProjections.size());
+	clipProjections.push_back(clipProjectionData);
+}
+
+void DrawResourcesFiller::RecordingContext::popClipProjectionData()
+{
+	if (clipProjectionStack.empty())
+		return;
+
+	clipProjectionStack.pop_back();
+}
+
+void DrawResourcesFiller::RecordingContext::drawPolyline(const CPolylineBase& polyline, const LineStyleInfo& lineStyleInfo)
+{
+	if (!lineStyleInfo.isVisible())
+		return;
+
+	const uint32_t mainObjIdx = addMainObject_Internal(lineStyleInfo, HatchFillPattern::SOLID_FILL);
+
+	for (uint32_t i = 0u; i < polyline.getSectionsCount(); ++i)
+	{
+		const auto& section = polyline.getSectionInfoAt(i);
+		if (section.type == ObjectType::LINE)
+			addLines(polyline, section, mainObjIdx);
+		else if (section.type == ObjectType::QUAD_BEZIER)
+			addQuadBeziers(polyline, section, mainObjIdx);
+		else
+			assert(false); // we don't handle other object types
+	}
+
+	if (!polyline.getConnectors().empty())
+		addPolylineConnectors(polyline, mainObjIdx);
+}
+
+void DrawResourcesFiller::RecordingContext::drawHatch(const Hatch& hatch, const float32_t4& foregroundColor, const float32_t4& backgroundColor, const HatchFillPattern fillPattern)
+{
+	drawHatch(hatch, backgroundColor);
+	drawHatch(hatch, foregroundColor, fillPattern);
+}
+
+void DrawResourcesFiller::RecordingContext::drawHatch(const Hatch& hatch, const float32_t4& color, const HatchFillPattern fillPattern)
+{
+	LineStyleInfo lineStyle = {};
+	lineStyle.color = color;
+	lineStyle.screenSpaceLineWidth = nbl::hlsl::bit_cast<float, uint32_t>(InvalidTextureIdx); // overwritten on merge if there's a fill pattern
+	const uint32_t mainObjIdx = addMainObject_Internal(lineStyle, fillPattern);
+	addHatchBoxes(hatch, mainObjIdx);
+}
+
+void DrawResourcesFiller::RecordingContext::drawHatch(const Hatch& hatch, const float32_t4& color)
+{
+	drawHatch(hatch, color, HatchFillPattern::SOLID_FILL);
+}
+
+uint32_t DrawResourcesFiller::RecordingContext::addMainObject(const LineStyleInfo& lineStyleInfo)
+{
+	return addMainObject_Internal(lineStyleInfo, HatchFillPattern::SOLID_FILL);
+}
+
+void DrawResourcesFiller::RecordingContext::drawFontGlyph(
+		nbl::ext::TextRendering::FontFace* fontFace,
+		uint32_t glyphIdx,
+		float64_t2 topLeft,
+		float32_t2 dirU,
+		float32_t  aspectRatio,
+		float32_t2 minUV,
+		uint32_t mainObjIdx)
+{
+	assert(mainObjIdx == mainObjects.size() - 1u); // only draw into the last main object
+
+	RecordedMainObject& mainObject = mainObjects[mainObjIdx];
+	if (mainObject.segmentsCount == 0u)
+		mainObject.segmentsOffset = segments.size();
+	mainObject.segmentsCount++;
+
+	RecordedSegment segment = {};
+	segment.drawObjectsOffset = drawObjects.size();
+	segment.geometryOffset = geometry.size();
+	segment.glyphIdx = glyphs.size();
+	segments.push_back(segment);
+
+	glyphs.push_back(RecordedGlyph{ fontFace, glyphIdx, topLeft, dirU, aspectRatio, minUV });
+}
+
+uint32_t DrawResourcesFiller::RecordingContext::addMainObject_Internal(const LineStyleInfo& lineStyleInfo, HatchFillPattern fillPattern)
+{
+	RecordedMainObject mainObject = {};
+	mainObject.lineStyle = lineStyleInfo;
+	mainObject.fillPattern = fillPattern;
+	mainObject.clipProjectionIdx = (clipProjectionStack.empty()) ? InvalidIdx : clipProjectionStack.back();
+	mainObject.segmentsOffset = segments.size();
+	mainObject.segmentsCount = 0u;
+	mainObjects.push_back(mainObject);
+	return mainObjects.size() - 1u;
+}
+
+DrawResourcesFiller::RecordingContext::RecordedSegment& DrawResourcesFiller::RecordingContext::acquireSegment(uint32_t mainObjIdx, uint32_t drawObjectCount, uint64_t geometrySize)
+{
+	assert(mainObjIdx == mainObjects.size() - 1u); // only draw into the last main object, so it's segments are always at the back
+	assert(drawObjectCount <= maxSegmentDrawObjects && geometrySize <= maxSegmentGeometrySize);
+
+	RecordedMainObject& mainObject = mainObjects[mainObjIdx];
+	if (mainObject.segmentsCount > 0u)
+	{
+		RecordedSegment& lastSegment = segments.back();
+		const bool fits = 
+			lastSegment.drawObjectsCount + drawObjectCount <= maxSegmentDrawObjects &&
+			lastSegment.geometrySize + geometrySize <= maxSegmentGeometrySize;
+		if (lastSegment.glyphIdx == InvalidIdx && fits)
+			return lastSegment;
+	}
+	else
+		mainObject.segmentsOffset = segments.size();
+	mainObject.segmentsCount++;
+
+	RecordedSegment segment = {};
+	segment.drawObjectsOffset = drawObjects.size();
+	segment.geometryOffset = geometry.size();
+	segments.push_back(segment);
+	return segments.back();
+}
+
+uint64_t DrawResourcesFiller::RecordingContext::addSegmentGeometry(RecordedSegment& segment, const void* data, uint64_t size)
+{
+	assert(segment.geometryOffset + segment.geometrySize == geometry.size()); // only the last segment can grow
+	const uint64_t ret = segment.geometrySize;
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+	geometry.insert(geometry.end(), bytes, bytes + size);
+	segment.geometrySize += size;
+	return ret;
+}
+
+void DrawResourcesFiller::RecordingContext::addSegmentDrawObject(RecordedSegment& segment, ObjectType type, uint16_t subsectionIdx, uint64_t segmentGeometryAddress)
+{
+	assert(segment.drawObjectsOffset + segment.drawObjectsCount == drawObjects.size()); // only the last segment can grow
+	DrawObject drawObj = {};
+	drawObj.type_subsectionIdx = uint32_t(static_cast<uint16_t>(type) | (subsectionIdx << 16));
+	drawObj.mainObjIndex = InvalidMainObjectIdx; // fixed up on merge
+	drawObj.geometryAddress = segmentGeometryAddress; // relative to the segment, fixed up on merge
+	drawObjects.push_back(drawObj);
+	segment.drawObjectsCount++;
+}
+
+void DrawResourcesFiller::RecordingContext::addLines(const CPolylineBase& polyline, const CPolylineBase::SectionInfo& section, uint32_t mainObjIdx)
+{
+	assert(section.count >= 1u);
+	assert(section.type == ObjectType::LINE);
+
+	uint32_t currentObjectInSection = 0u;
+	while (currentObjectInSection < section.count)
+	{
+		// k lines need k+1 points
+		RecordedSegment& segment = acquireSegment(mainObjIdx, 1u, sizeof(LinePointInfo) * 2u);
+		const uint64_t segmentPoints = (maxSegmentGeometrySize - segment.geometrySize) / sizeof(LinePointInfo);
+
+		uint32_t objectsToAdd = maxSegmentDrawObjects - segment.drawObjectsCount;
+		objectsToAdd = std::min(static_cast<uint64_t>(objectsToAdd), segmentPoints - 1u);
+		objectsToAdd = std::min(objectsToAdd, section.count - currentObjectInSection);
+
+		const auto& linePoint = polyline.getLinePointAt(section.index + currentObjectInSection);
+		uint64_t geometryAddress = addSegmentGeometry(segment, &linePoint, sizeof(LinePointInfo) * (objectsToAdd + 1u));
+		for (uint32_t i = 0u; i < objectsToAdd; ++i)
+		{
+			addSegmentDrawObject(segment, ObjectType::LINE, 0u, geometryAddress);
+			geometryAddress += sizeof(LinePointInfo);
+		}
+
+		currentObjectInSection += objectsToAdd;
+	}
+}
+
+void DrawResourcesFiller::RecordingContext::addQuadBeziers(const CPolylineBase& polyline, const CPolylineBase::SectionInfo& section, uint32_t mainObjIdx)
+{
+	constexpr uint32_t CagesPerQuadBezier = getCageCountPerPolylineObject(ObjectType::QUAD_BEZIER);
+	assert(section.type == ObjectType::QUAD_BEZIER);
+
+	uint32_t currentObjectInSection = 0u;
+	while (currentObjectInSection < section.count)
+	{
+		RecordedSegment& segment = acquireSegment(mainObjIdx, CagesPerQuadBezier, sizeof(QuadraticBezierInfo));
+		const uint64_t segmentBeziers = (maxSegmentGeometrySize - segment.geometrySize) / sizeof(QuadraticBezierInfo);
+
+		uint32_t objectsToAdd = (maxSegmentDrawObjects - segment.drawObjectsCount) / CagesPerQuadBezier;
+		objectsToAdd = std::min(static_cast<uint64_t>(objectsToAdd), segmentBeziers);
+		objectsToAdd = std::min(objectsToAdd, section.count - currentObjectInSection);
+
+		const auto& quadBezier = polyline.getQuadBezierInfoAt(section.index + currentObjectInSection);
+		uint64_t geometryAddress = addSegmentGeometry(segment, &quadBezier, sizeof(QuadraticBezierInfo) * objectsToAdd);
+		for (uint32_t i = 0u; i < objectsToAdd; ++i)
+		{
+			for (uint16_t subObject = 0; subObject < CagesPerQuadBezier; subObject++)
+				addSegmentDrawObject(segment, ObjectType::QUAD_BEZIER, subObject, geometryAddress);
+			geometryAddress += sizeof(QuadraticBezierInfo);
+		}
+
+		currentObjectInSection += objectsToAdd;
+	}
+}
+
+void DrawResourcesFiller::RecordingContext::addPolylineConnectors(const CPolylineBase& polyline, uint32_t mainObjIdx)
+{
+	const auto& connectors = polyline.getConnectors();
+	const uint32_t connectorCount = connectors.size();
+
+	uint32_t currentConnector = 0u;
+	while (currentConnector < connectorCount)
+	{
+		RecordedSegment& segment = acquireSegment(mainObjIdx, 1u, sizeof(PolylineConnector));
+		const uint64_t segmentConnectors = (maxSegmentGeometrySize - segment.geometrySize) / sizeof(PolylineConnector);
+
+		uint32_t objectsToAdd = maxSegmentDrawObjects - segment.drawObjectsCount;
+		objectsToAdd = std::min(static_cast<uint64_t>(objectsToAdd), segmentConnectors);
+		objectsToAdd = std::min(objectsToAdd, connectorCount - currentConnector);
+
+		uint64_t geometryAddress = addSegmentGeometry(segment, &connectors[currentConnector], sizeof(PolylineConnector) * objectsToAdd);
+		for (uint32_t i = 0u; i < objectsToAdd; ++i)
+		{
+			addSegmentDrawObject(segment, ObjectType::POLYLINE_CONNECTOR, 0u, geometryAddress);
+			geometryAddress += sizeof(PolylineConnector);
+		}
+
+		currentConnector += objectsToAdd;
+	}
+}
+
+void DrawResourcesFiller::RecordingContext::addHatchBoxes(const Hatch& hatch, uint32_t mainObjIdx)
+{
+	static_assert(sizeof(CurveBox) == sizeof(Hatch::CurveHatchBox));
+
+	for (uint32_t i = 0u; i < hatch.getHatchBoxCount(); ++i)
+	{
+		RecordedSegment& segment = acquireSegment(mainObjIdx, 1u, sizeof(CurveBox));
+		const uint64_t geometryAddress = addSegmentGeometry(segment, &hatch.getHatchBox(i), sizeof(CurveBox));
+		addSegmentDrawObject(segment, ObjectType::CURVE_BOX, 0u, geometryAddress);
+	}
+}
+
 bool DrawResourcesFiller::finalizeAllCopiesToGPU(SIntendedSubmitInfo& intendedNextSubmit)
 {
+	m_frameStats.peakMainObjectCount = core::max(m_frameStats.peakMainObjectCount, currentMainObjectCount);
+	m_frameStats.peakDrawObjectCount = core::max(m_frameStats.peakDrawObjectCount, currentDrawObjectCount);
+	m_frameStats.peakGeometryBytes = core::max(m_frameStats.peakGeometryBytes, currentGeometryBufferSize);
+	m_frameStats.peakLineStyleCount = core::max(m_frameStats.peakLineStyleCount, currentLineStylesCount);
+
+	if (m_headless)
+		return finalizeAllCopiesHeadless();
+
 	bool success = true;
 	success &= finalizeMainObjectCopiesToGPU(intendedNextSubmit);
 	success &= finalizeGeometryCopiesToGPU(intendedNextSubmit);
@@ -320,8 +988,7 @@ uint32_t DrawResourcesFiller::addLineStyle_SubmitIfNeeded(const LineStyleInfo& l
 	uint32_t outLineStyleIdx = addLineStyle_Internal(lineStyle);
 	if (outLineStyleIdx == InvalidStyleIdx)
 	{
-		finalizeAllCopiesToGPU(intendedNextSubmit);
-		submitDraws(intendedNextSubmit);
+		autoSubmit(intendedNextSubmit, AutoSubmitReason::LINE_STYLES_BUFFER);
 		resetGeometryCounters();
 		resetMainObjectCounters();
 		resetLineStyleCounters();
@@ -339,8 +1006,7 @@ uint32_t DrawResourcesFiller::addMainObject_SubmitIfNeeded(uint32_t styleIdx, SI
 	uint32_t outMainObjectIdx = addMainObject_Internal(mainObject);
 	if (outMainObjectIdx == InvalidMainObjectIdx)
 	{
-		finalizeAllCopiesToGPU(intendedNextSubmit);
-		submitDraws(intendedNextSubmit);
+		autoSubmit(intendedNextSubmit, AutoSubmitReason::MAIN_OBJECTS_BUFFER);
 
 		// geometries needs to be reset because they reference draw objects and draw objects reference main objects that are now unavailable and reset
 		resetGeometryCounters();
@@ -373,6 +1039,18 @@ void DrawResourcesFiller::popClipProjectionData()
 	clipProjectionAddresses.pop_back();
 }
 
+void DrawResourcesFiller::enableCulling(float32_t2 ndcMargin, float32_t miterLimit)
+{
+	m_cullingEnabled = true;
+	m_cullingNDCMargin = ndcMargin;
+	m_cullingMiterLimit = miterLimit;
+}
+
+SpatialGrid::AABB DrawResourcesFiller::getCullingWorldAABB() const
+{
+	return SpatialGrid::getClipProjectionWorldAABB(getCurrentClipProjection(), m_cullingNDCMargin);
+}
+
 bool DrawResourcesFiller::finalizeMainObjectCopiesToGPU(SIntendedSubmitInfo& intendedNextSubmit)
 {
 	bool success = true;
@@ -383,7 +1061,10 @@ bool DrawResourcesFiller::finalizeMainObjectCopiesToGPU(SIntendedSubmitInfo& int
 	{
 		const MainObject* srcMainObjData = reinterpret_cast<MainObject*>(cpuDrawBuffers.mainObjectsBuffer->getPointer()) + inMemMainObjectCount;
 		if (m_utilities->updateBufferRangeViaStagingBuffer(intendedNextSubmit, mainObjectsRange, srcMainObjData))
+		{
+			m_frameStats.uploadedMainObjectBytes += mainObjectsRange.size;
 			inMemMainObjectCount = currentMainObjectCount;
+		}
 		else
 		{
 			// TODO: Log
@@ -403,7 +1084,10 @@ bool DrawResourcesFiller::finalizeGeometryCopiesToGPU(SIntendedSubmitInfo& inten
 	{
 		const DrawObject* srcDrawObjData = reinterpret_cast<DrawObject*>(cpuDrawBuffers.drawObjectsBuffer->getPointer()) + inMemDrawObjectCount;
 		if (m_utilities->updateBufferRangeViaStagingBuffer(intendedNextSubmit, drawObjectsRange, srcDrawObjData))
+		{
+			m_frameStats.uploadedDrawObjectBytes += drawObjectsRange.size;
 			inMemDrawObjectCount = currentDrawObjectCount;
+		}
 		else
 		{
 			// TODO: Log
@@ -418,7 +1102,10 @@ bool DrawResourcesFiller::finalizeGeometryCopiesToGPU(SIntendedSubmitInfo& inten
 	{
 		const uint8_t* srcGeomData = reinterpret_cast<uint8_t*>(cpuDrawBuffers.geometryBuffer->getPointer()) + inMemGeometryBufferSize;
 		if (m_utilities->updateBufferRangeViaStagingBuffer(intendedNextSubmit, geomRange, srcGeomData))
+		{
+			m_frameStats.uploadedGeometryBytes += geomRange.size;
 			inMemGeometryBufferSize = currentGeometryBufferSize;
+		}
 		else
 		{
 			// TODO: Log
@@ -438,7 +1125,10 @@ bool DrawResourcesFiller::finalizeLineStyleCopiesToGPU(SIntendedSubmitInfo& inte
 	{
 		const LineStyle* srcLineStylesData = reinterpret_cast<LineStyle*>(cpuDrawBuffers.lineStylesBuffer->getPointer()) + inMemLineStylesCount;
 		if (m_utilities->updateBufferRangeViaStagingBuffer(intendedNextSubmit, stylesRange, srcLineStylesData))
+		{
+			m_frameStats.uploadedLineStyleBytes += stylesRange.size;
 			inMemLineStylesCount = currentLineStylesCount;
+		}
 		else
 		{
 			// TODO: Log
@@ -448,9 +1138,48 @@ bool DrawResourcesFiller::finalizeLineStyleCopiesToGPU(SIntendedSubmitInfo& inte
 	return success;
 }
 
+bool DrawResourcesFiller::finalizeAllCopiesHeadless()
+{
+	patchGeneratedMSDFs();
+
+	const uint64_t mainObjectBytes = sizeof(MainObject) * (currentMainObjectCount - inMemMainObjectCount);
+	m_frameStats.uploadedMainObjectBytes += mainObjectBytes;
+	m_headlessUploadedBytes += mainObjectBytes;
+	inMemMainObjectCount = currentMainObjectCount;
+
+	const uint64_t drawObjectBytes = sizeof(DrawObject) * (currentDrawObjectCount - inMemDrawObjectCount);
+	m_frameStats.uploadedDrawObjectBytes += drawObjectBytes;
+	m_headlessUploadedBytes += drawObjectBytes;
+	inMemDrawObjectCount = currentDrawObjectCount;
+
+	const uint64_t geometryBytes = currentGeometryBufferSize - inMemGeometryBufferSize;
+	m_frameStats.uploadedGeometryBytes += geometryBytes;
+	m_headlessUploadedBytes += geometryBytes;
+	inMemGeometryBufferSize = currentGeometryBufferSize;
+
+	const uint64_t lineStyleBytes = sizeof(LineStyle) * (currentLineStylesCount - inMemLineStylesCount);
+	m_frameStats.uploadedLineStyleBytes += lineStyleBytes;
+	m_headlessUploadedBytes += lineStyleBytes;
+	inMemLineStylesCount = currentLineStylesCount;
+
+	for (const auto& textureCopy : msdfTextureCopies)
+	{
+		if (textureCopy.image)
+		{
+			m_frameStats.uploadedMSDFBytes += textureCopy.image->getBuffer()->getSize();
+			m_headlessUploadedBytes += textureCopy.image->getBuffer()->getSize();
+		}
+	}
+	msdfTextureCopies.clear();
+	std::fill(msdfTextureArrayIndicesUsed.begin(), msdfTextureArrayIndicesUsed.end(), false); // same as `finalizeTextureCopies`, the frame is done with them
+
+	return true;
+}
+
 bool DrawResourcesFiller::finalizeTextureCopies(SIntendedSubmitInfo& intendedNextSubmit)
 {
-	msdfTextureArrayIndicesUsed.clear(); // clear msdf textures used in the frame, because the frame finished and called this function.
+	patchGeneratedMSDFs();
+	std::fill(msdfTextureArrayIndicesUsed.begin(), msdfTextureArrayIndicesUsed.end(), false); // clear msdf textures used in the frame, because the frame finished and called this function.
 
 	if (!msdfTextureCopies.size() && m_hasInitializedMSDFTextureArrays) // even if the textureCopies are empty, we want to continue if not initialized yet so that the layout of all layers become READ_ONLY_OPTIMAL
 		return true; // yay successfully copied nothing
@@ -543,7 +1272,9 @@ bool DrawResourcesFiller::finalizeTextureCopies(SIntendedSubmitInfo& intendedNex
 				copySuccess = false;
 			}
 
-			if (!copySuccess)
+			if (copySuccess)
+				m_frameStats.uploadedMSDFBytes += iit->image->getBuffer()->getSize();
+			else
 			{
 				// we move the failed copy to the oit and advance it
 				if (oit != iit)
@@ -595,10 +1326,18 @@ bool DrawResourcesFiller::finalizeTextureCopies(SIntendedSubmitInfo& intendedNex
 	}
 }
 
-void DrawResourcesFiller::submitCurrentDrawObjectsAndReset(SIntendedSubmitInfo& intendedNextSubmit, uint32_t mainObjectIndex)
+void DrawResourcesFiller::autoSubmit(SIntendedSubmitInfo& intendedNextSubmit, AutoSubmitReason reason)
 {
+	m_frameStats.autoSubmits[static_cast<size_t>(reason)]++;
+	const auto begin = std::chrono::steady_clock::now();
 	finalizeAllCopiesToGPU(intendedNextSubmit);
 	submitDraws(intendedNextSubmit);
+	m_frameStats.autoSubmitMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+}
+
+void DrawResourcesFiller::submitCurrentDrawObjectsAndReset(SIntendedSubmitInfo& intendedNextSubmit, uint32_t mainObjectIndex, AutoSubmitReason reason)
+{
+	autoSubmit(intendedNextSubmit, reason);
 
 	// We reset Geometry Counters (drawObj+geometryInfos) because we're done rendering previous geometry
 	// We don't reset counters for styles because we will be reusing them
@@ -664,12 +1403,16 @@ uint32_t DrawResourcesFiller::addLineStyle_Internal(const LineStyleInfo& lineSty
 	LineStyle gpuLineStyle = lineStyleInfo.getAsGPUData();
 	_NBL_DEBUG_BREAK_IF(gpuLineStyle.stipplePatternSize > LineStyle::StipplePatternMaxSize); // Oops, even after style normalization the style is too long to be in gpu mem :(
 	LineStyle* stylesArray = reinterpret_cast<LineStyle*>(cpuDrawBuffers.lineStylesBuffer->getPointer());
-	for (uint32_t i = 0u; i < currentLineStylesCount; ++i)
-	{
-		const LineStyle& itr = stylesArray[i];
 
-		if (itr == gpuLineStyle)
-			return i;
+	lineStyleLookupStats.lookups++;
+	if (!lineStyleIndices.empty())
+		lineStyleLookupStats.comparisons += lineStyleIndices.bucket_size(lineStyleIndices.bucket(gpuLineStyle));
+
+	auto found = lineStyleIndices.find(gpuLineStyle);
+	if (found != lineStyleIndices.end())
+	{
+		lineStyleLookupStats.hits++;
+		return found->second;
 	}
 
 	if (currentLineStylesCount >= maxLineStyles)
@@ -677,6 +1420,7 @@ uint32_t DrawResourcesFiller::addLineStyle_Internal(const LineStyleInfo& lineSty
 
 	void* dst = stylesArray + currentLineStylesCount;
 	memcpy(dst, &gpuLineStyle, sizeof(LineStyle));
+	lineStyleIndices.emplace(gpuLineStyle, currentLineStylesCount);
 	return currentLineStylesCount++;
 }
 
@@ -696,8 +1440,7 @@ uint64_t DrawResourcesFiller::addClipProjectionData_SubmitIfNeeded(const ClipPro
 	uint64_t outClipProjectionAddress = addClipProjectionData_Internal(clipProjectionData);
 	if (outClipProjectionAddress == InvalidClipProjectionAddress)
 	{
-		finalizeAllCopiesToGPU(intendedNextSubmit);
-		submitDraws(intendedNextSubmit);
+		autoSubmit(intendedNextSubmit, AutoSubmitReason::GEOMETRY_BUFFER);
 
 		resetGeometryCounters();
 		resetMainObjectCounters();
@@ -732,16 +1475,13 @@ void DrawResourcesFiller::addPolylineObjects_Internal(const CPolylineBase& polyl
 		assert(false); // we don't handle other object types
 }
 
-void DrawResourcesFiller::addPolylineConnectors_Internal(const CPolylineBase& polyline, uint32_t& currentPolylineConnectorObj, uint32_t mainObjIdx)
+void DrawResourcesFiller::addPolylineConnectors_Internal(const CPolylineBase& polyline, uint32_t& currentPolylineConnectorObj, uint32_t connectorsEnd, uint32_t mainObjIdx)
 {
 	const auto maxGeometryBufferConnectors = (maxGeometryBufferSize - currentGeometryBufferSize) / sizeof(PolylineConnector);
 
-	uint32_t uploadableObjects = (maxIndexCount / 6u) - currentDrawObjectCount;
-	uploadableObjects = std::min(static_cast<uint64_t>(uploadableObjects), maxGeometryBufferConnectors);
-	uploadableObjects = std::min(uploadableObjects, maxDrawObjects - currentDrawObjectCount);
+	uint32_t uploadableObjects = getUploadableDrawObjectCount(maxGeometryBufferConnectors);
 
-	const auto connectorCount = polyline.getConnectors().size();
-	const auto remainingObjects = connectorCount - currentPolylineConnectorObj;
+	const auto remainingObjects = connectorsEnd - currentPolylineConnectorObj;
 
 	const uint32_t objectsToUpload = min(uploadableObjects, remainingObjects);
 
@@ -779,9 +1519,7 @@ void DrawResourcesFiller::addLines_Internal(const CPolylineBase& polyline, const
 	const auto maxGeometryBufferPoints = (maxGeometryBufferSize - currentGeometryBufferSize) / sizeof(LinePointInfo);
 	const auto maxGeometryBufferLines = (maxGeometryBufferPoints <= 1u) ? 0u : maxGeometryBufferPoints - 1u;
 
-	uint32_t uploadableObjects = (maxIndexCount / 6u) - currentDrawObjectCount;
-	uploadableObjects = std::min(static_cast<uint64_t>(uploadableObjects), maxGeometryBufferLines);
-	uploadableObjects = std::min(uploadableObjects, maxDrawObjects - currentDrawObjectCount);
+	uint32_t uploadableObjects = getUploadableDrawObjectCount(maxGeometryBufferLines);
 
 	const auto lineCount = section.count;
 	const auto remainingObjects = lineCount - currentObjectInSection;
@@ -820,9 +1558,8 @@ void DrawResourcesFiller::addQuadBeziers_Internal(const CPolylineBase& polyline,
 
 	const auto maxGeometryBufferBeziers = (maxGeometryBufferSize - currentGeometryBufferSize) / sizeof(QuadraticBezierInfo);
 	
-	uint32_t uploadableObjects = (maxIndexCount / 6u) - currentDrawObjectCount;
-	uploadableObjects = std::min(static_cast<uint64_t>(uploadableObjects), maxGeometryBufferBeziers);
-	uploadableObjects = std::min(uploadableObjects, maxDrawObjects - currentDrawObjectCount);
+	// every cage is a draw object but they share the bezier's geometry, so count in draw objects and convert back
+	uint32_t uploadableObjects = getUploadableDrawObjectCount(maxGeometryBufferBeziers * CagesPerQuadBezier);
 	uploadableObjects /= CagesPerQuadBezier;
 
 	const auto beziersCount = section.count;
@@ -858,15 +1595,13 @@ void DrawResourcesFiller::addQuadBeziers_Internal(const CPolylineBase& polyline,
 	currentObjectInSection += objectsToUpload;
 }
 
-void DrawResourcesFiller::addHatch_Internal(const Hatch& hatch, uint32_t& currentObjectInSection, uint32_t mainObjIndex)
+void DrawResourcesFiller::addHatch_Internal(const Hatch& hatch, uint32_t& currentObjectInSection, uint32_t hatchBoxesEnd, uint32_t mainObjIndex)
 {
 	const auto maxGeometryBufferHatchBoxes = (maxGeometryBufferSize - currentGeometryBufferSize) / sizeof(Hatch::CurveHatchBox);
 	
-	uint32_t uploadableObjects = (maxIndexCount / 6u) - currentDrawObjectCount;
-	uploadableObjects = std::min(uploadableObjects, maxDrawObjects - currentDrawObjectCount);
-	uploadableObjects = std::min(static_cast<uint64_t>(uploadableObjects), maxGeometryBufferHatchBoxes);
+	uint32_t uploadableObjects = getUploadableDrawObjectCount(maxGeometryBufferHatchBoxes);
 
-	uint32_t remainingObjects = hatch.getHatchBoxCount() - currentObjectInSection;
+	uint32_t remainingObjects = hatchBoxesEnd - currentObjectInSection;
 	uploadableObjects = std::min(uploadableObjects, remainingObjects);
 
 	for (uint32_t i = 0; i < uploadableObjects; i++)
@@ -895,13 +1630,56 @@ void DrawResourcesFiller::addHatch_Internal(const Hatch& hatch, uint32_t& curren
 	currentObjectInSection += uploadableObjects;
 }
 
+uint32_t DrawResourcesFiller::addStaticBatchDrawObjects_Internal(const DrawObject* drawObjects, uint32_t count, uint32_t mainObjIdx)
+{
+	uint32_t uploadableObjects = getUploadableDrawObjectCount();
+	uploadableObjects = std::min(uploadableObjects, count);
+
+	DrawObject* drawObjsDst = reinterpret_cast<DrawObject*>(cpuDrawBuffers.drawObjectsBuffer->getPointer()) + currentDrawObjectCount;
+	memcpy(drawObjsDst, drawObjects, sizeof(DrawObject) * uploadableObjects);
+	for (uint32_t i = 0u; i < uploadableObjects; ++i)
+		drawObjsDst[i].mainObjIndex = mainObjIdx;
+	currentDrawObjectCount += uploadableObjects;
+
+	return uploadableObjects;
+}
+
+bool DrawResourcesFiller::addRecordedSegment_Internal(const RecordingContext& context, const RecordingContext::RecordedSegment& segment, uint32_t mainObjIdx)
+{
+	const uint32_t uploadableObjects = getUploadableDrawObjectCount();
+	if (segment.geometrySize > maxGeometryBufferSize - currentGeometryBufferSize)
+	{
+		drawBuffersLimit = AutoSubmitReason::GEOMETRY_BUFFER;
+		return false;
+	}
+	if (segment.drawObjectsCount > uploadableObjects)
+		return false;
+
+	// Add Geometry
+	const uint64_t segmentGeometryAddress = geometryBufferAddress + currentGeometryBufferSize;
+	void* geomDst = reinterpret_cast<char*>(cpuDrawBuffers.geometryBuffer->getPointer()) + currentGeometryBufferSize;
+	memcpy(geomDst, context.geometry.data() + segment.geometryOffset, segment.geometrySize);
+	currentGeometryBufferSize += segment.geometrySize;
+
+	// Add DrawObjs
+	DrawObject* drawObjsDst = reinterpret_cast<DrawObject*>(cpuDrawBuffers.drawObjectsBuffer->getPointer()) + currentDrawObjectCount;
+	for (uint32_t i = 0u; i < segment.drawObjectsCount; ++i)
+	{
+		DrawObject drawObj = context.drawObjects[segment.drawObjectsOffset + i];
+		drawObj.mainObjIndex = mainObjIdx;
+		drawObj.geometryAddress += segmentGeometryAddress;
+		memcpy(drawObjsDst + i, &drawObj, sizeof(DrawObject));
+	}
+	currentDrawObjectCount += segment.drawObjectsCount;
+
+	return true;
+}
+
 bool DrawResourcesFiller::addFontGlyph_Internal(const GlyphInfo& glyphInfo, uint32_t mainObjIdx)
 {
 	const auto maxGeometryBufferFontGlyphs = (maxGeometryBufferSize - currentGeometryBufferSize) / sizeof(GlyphInfo);
 	
-	uint32_t uploadableObjects = (maxIndexCount / 6u) - currentDrawObjectCount;
-	uploadableObjects = std::min(uploadableObjects, maxDrawObjects - currentDrawObjectCount);
-	uploadableObjects = std::min(static_cast<uint64_t>(uploadableObjects), maxGeometryBufferFontGlyphs);
+	const uint32_t uploadableObjects = getUploadableDrawObjectCount(maxGeometryBufferFontGlyphs);
 
 	if (uploadableObjects >= 1u)
 	{
@@ -946,6 +1724,46 @@ uint32_t DrawResourcesFiller::addMSDFTexture(const MSDFInputInfo& msdfInput, cor
 	if (!sizeMatch)
 		return InvalidTextureIdx; // TODO: Log
 
+	bool newlyInserted = false;
+	MSDFReference* inserted = insertMSDFReference(msdfInput, mainObjIdx, intendedNextSubmit, newlyInserted);
+	
+	// if it wasn't newly inserted then it means we had a cache hit and updated the value of our sema, in which case we don't queue anything for upload, and return the idx
+	if (newlyInserted && inserted->alloc_idx != InvalidTextureIdx)
+	{
+		// We queue copy and finalize all on `finalizeTextureCopies` function called before draw calls to make sure it's in mem
+		msdfTextureCopies.push_back({ .image = std::move(cpuImage), .index = inserted->alloc_idx });
+	}
+	
+	assert(inserted->alloc_idx != InvalidTextureIdx); // shouldn't happen, because we're using LRU cache, so worst case eviction will happen + multi-deallocate and next next multi_allocate should definitely succeed
+	if (inserted->alloc_idx != InvalidTextureIdx)
+		msdfTextureArrayIndicesUsed[inserted->alloc_idx] = true;
+
+	return inserted->alloc_idx;
+}
+
+uint32_t DrawResourcesFiller::addMSDFTextureAsync(const MSDFInputInfo& msdfInput, SharedMSDFCache::GenerateFunc&& generate, uint32_t mainObjIdx, SIntendedSubmitInfo& intendedNextSubmit)
+{
+	bool newlyInserted = false;
+	MSDFReference* inserted = insertMSDFReference(msdfInput, mainObjIdx, intendedNextSubmit, newlyInserted);
+	assert(inserted->alloc_idx != InvalidTextureIdx);
+	if (inserted->alloc_idx == InvalidTextureIdx)
+		return InvalidTextureIdx;
+
+	if (newlyInserted)
+	{
+		inserted->pending = true;
+		m_msdfGenerationPool->submit(msdfInput, inserted->alloc_idx, std::move(generate));
+	}
+
+	// the placeholder is never evicted, so only track the real index once it's in use
+	if (inserted->pending)
+		return m_placeholderMSDFIdx;
+	msdfTextureArrayIndicesUsed[inserted->alloc_idx] = true;
+	return inserted->alloc_idx;
+}
+
+DrawResourcesFiller::MSDFReference* DrawResourcesFiller::insertMSDFReference(const MSDFInputInfo& msdfInput, uint32_t mainObjIdx, SIntendedSubmitInfo& intendedNextSubmit, bool& newlyInserted)
+{
 	// TextureReferences hold the semaValue related to the "scratch semaphore" in IntendedSubmitInfo
 	// Every single submit increases this value by 1
 	// The reason for hiolding on to the lastUsedSema is deferred dealloc, which we call in the case of eviction, making sure we get rid of the entry inside the allocator only when the texture is done being used
@@ -953,19 +1771,23 @@ uint32_t DrawResourcesFiller::addMSDFTexture(const MSDFInputInfo& msdfInput, cor
 
 	auto evictionCallback = [&](const MSDFReference& evicted)
 	{
-		if (msdfTextureArrayIndicesUsed.contains(evicted.alloc_idx)) 
+		m_msdfEvictionCount++;
+		if (msdfTextureArrayIndicesUsed[evicted.alloc_idx])
 		{
 			// Dealloc once submission is finished
-			msdfTextureArrayIndexAllocator->multi_deallocate(1u, &evicted.alloc_idx, nextSemaSignal);
+			if (m_headless)
+				msdfTextureArrayIndexAllocator->multi_deallocate(1u, &evicted.alloc_idx); // headless submits finish immediately, there's nothing in flight
+			else
+				msdfTextureArrayIndexAllocator->multi_deallocate(1u, &evicted.alloc_idx, nextSemaSignal);
 
 			// If we reset main objects will cause an auto submission bug, where adding an msdf texture while constructing glyphs will have wrong main object references (See how SingleLineTexts add Glyphs with a single mainObject)
 			// for the same reason we don't reset line styles
 			// `submitCurrentObjectsAndReset` function handles the above + updating clipProjectionData and making sure the mainObjectIdx references to the correct clipProj data after reseting geometry buffer
-			submitCurrentDrawObjectsAndReset(intendedNextSubmit, mainObjIdx);
+			submitCurrentDrawObjectsAndReset(intendedNextSubmit, mainObjIdx, AutoSubmitReason::MSDF_EVICTION);
 		} 
 		else
 		{
-			// We didn't use it this frame, so it's safe to dealloc now, withou needing to "overflow" submit
+			// We didn't use it this frame (or it's still pending, in which case `patchGeneratedMSDFs` will drop its result), so it's safe to dealloc now, withou needing to "overflow" submit
 			msdfTextureArrayIndexAllocator->multi_deallocate(1u, &evicted.alloc_idx);
 		}
 	};
@@ -973,28 +1795,187 @@ uint32_t DrawResourcesFiller::addMSDFTexture(const MSDFInputInfo& msdfInput, cor
 	// We pass nextSemaValue instead of constructing a new MSDFReference and passing it into `insert` that's because we might get a cache hit and only update the value of the nextSema
 	MSDFReference* inserted = msdfLRUCache->insert(msdfInput, nextSemaSignal.value, evictionCallback);
 	
-	// if inserted->alloc_idx was not InvalidTextureIdx then it means we had a cache hit and updated the value of our sema, in which case we don't queue anything for upload, and return the idx
-	if (inserted->alloc_idx == InvalidTextureIdx)
+	// if inserted->alloc_idx was not InvalidTextureIdx then it means we had a cache hit and updated the value of our sema
+	newlyInserted = (inserted->alloc_idx == InvalidTextureIdx);
+	if (newlyInserted)
 	{
 		// New insertion == cache miss happened and insertion was successfull
 		inserted->alloc_idx = IndexAllocator::AddressAllocator::invalid_address;
 		msdfTextureArrayIndexAllocator->multi_allocate(std::chrono::time_point<std::chrono::steady_clock>::max(), 1u, &inserted->alloc_idx); // if the prev submit causes DEVICE_LOST then we'll get a deadlock here since we're using max timepoint
 
-		if (inserted->alloc_idx != IndexAllocator::AddressAllocator::invalid_address)
+		if (inserted->alloc_idx == IndexAllocator::AddressAllocator::invalid_address)
+		{
+			// TODO: log here, assert will be called by the caller
+			inserted->alloc_idx = InvalidTextureIdx;
+		}
+	}
+	return inserted;
+}
+
+void DrawResourcesFiller::enableAsyncMSDFGeneration(smart_refctd_ptr<ICPUImage>&& placeholder, uint32_t threadCount)
+{
+	assert(msdfTextureArrayIndexAllocator); // allocate the MSDF textures first
+
+	if (m_placeholderMSDFIdx == InvalidTextureIdx)
+	{
+		uint32_t placeholderIdx = IndexAllocator::AddressAllocator::invalid_address;
+		msdfTextureArrayIndexAllocator->multi_allocate(std::chrono::time_point<std::chrono::steady_clock>::max(), 1u, &placeholderIdx);
+		assert(placeholderIdx != IndexAllocator::AddressAllocator::invalid_address);
+		m_placeholderMSDFIdx = placeholderIdx;
+	}
+	msdfTextureCopies.push_back({ .image = std::move(placeholder), .index = m_placeholderMSDFIdx });
+
+	m_msdfGenerationPool = std::unique_ptr<MSDFGenerationPool>(new MSDFGenerationPool(threadCount));
+}
+
+void DrawResourcesFiller::patchGeneratedMSDFs()
+{
+	if (!m_msdfGenerationPool)
+		return;
+
+	m_generatedMSDFs.clear();
+	m_msdfGenerationPool->collect(m_generatedMSDFs);
+	for (auto& generated : m_generatedMSDFs)
+	{
+		// the entry could've been evicted (and its index reused) while it was generating
+		MSDFReference* ref = msdfLRUCache->peek(generated.input);
+		if (!ref || !ref->pending || ref->alloc_idx != generated.textureIdx)
+			continue;
+
+		bool valid = bool(generated.image);
+		if (valid)
+		{
+			const auto imageSize = generated.image->getMipSize(0);
+			valid = imageSize.x == getMSDFResolution().x && imageSize.y == getMSDFResolution().y && imageSize.z == 1u;
+		}
+
+		if (valid)
 		{
-			// We queue copy and finalize all on `finalizeTextureCopies` function called before draw calls to make sure it's in mem
-			msdfTextureCopies.push_back({ .image = std::move(cpuImage), .index = inserted->alloc_idx });
+			msdfTextureCopies.push_back({ .image = std::move(generated.image), .index = generated.textureIdx });
+			ref->pending = false;
 		}
 		else
 		{
-			// TODO: log here, assert will be called in a few lines
-			inserted->alloc_idx = InvalidTextureIdx;
+			// TODO: Log, generation failed, nothing referenced the index so it can go right away
+			msdfLRUCache->erase(generated.input);
+			msdfTextureArrayIndexAllocator->multi_deallocate(1u, &generated.textureIdx);
 		}
 	}
-	
-	assert(inserted->alloc_idx != InvalidTextureIdx); // shouldn't happen, because we're using LRU cache, so worst case eviction will happen + multi-deallocate and next next multi_allocate should definitely succeed
-	if (inserted->alloc_idx != InvalidTextureIdx)
-		msdfTextureArrayIndicesUsed.emplace(inserted->alloc_idx);
+}
 
-	return inserted->alloc_idx;
-}
\ No newline at end of file
+uint32_t DrawResourcesFiller::getHatchFillPatternMSDFIndex(HatchFillPattern fillPattern, SIntendedSubmitInfo& intendedNextSubmit)
+{
+	if (fillPattern == HatchFillPattern::SOLID_FILL)
+		return InvalidTextureIdx;
+
+	MSDFInputInfo msdfInfo = MSDFInputInfo(fillPattern);
+	uint32_t textureIdx = getMSDFIndexFromInputInfo(msdfInfo, intendedNextSubmit);
+	if (textureIdx == InvalidTextureIdx)
+	{
+		if (m_msdfGenerationPool)
+		{
+			textureIdx = addMSDFTextureAsync(msdfInfo,
+				[fillPattern, msdfInfo, getHatchFillPatternMSDF = getHatchFillPatternMSDF, sharedCache = m_sharedMSDFCache]()
+				{
+					auto generate = [&]() { return getHatchFillPatternMSDF(fillPattern); };
+					return sharedCache ? sharedCache->getOrGenerate(msdfInfo, generate) : generate();
+				},
+				InvalidMainObjectIdx, intendedNextSubmit);
+		}
+		else
+			textureIdx = addMSDFTexture(msdfInfo, getMSDFImage(msdfInfo, [&]() { return getHatchFillPatternMSDF(fillPattern); }), InvalidMainObjectIdx, intendedNextSubmit);
+	}
+	_NBL_DEBUG_BREAK_IF(textureIdx == InvalidTextureIdx); // probably getHatchFillPatternMSDF returned nullptr
+	return textureIdx;
+}
+
+const char* DrawResourcesFiller::FrameStats::getName(AutoSubmitReason reason)
+{
+	switch (reason)
+	{
+	case AutoSubmitReason::INDEX_BUFFER: return "index_buffer";
+	case AutoSubmitReason::DRAW_OBJECTS_BUFFER: return "draw_objects_buffer";
+	case AutoSubmitReason::GEOMETRY_BUFFER: return "geometry_buffer";
+	case AutoSubmitReason::MAIN_OBJECTS_BUFFER: return "main_objects_buffer";
+	case AutoSubmitReason::LINE_STYLES_BUFFER: return "line_styles_buffer";
+	case AutoSubmitReason::MSDF_EVICTION: return "msdf_eviction";
+	default: return "unknown";
+	}
+}
+
+const char* DrawResourcesFiller::FrameStats::getName(DrawCallType type)
+{
+	switch (type)
+	{
+	case DrawCallType::POLYLINE: return "polyline";
+	case DrawCallType::HATCH: return "hatch";
+	case DrawCallType::FONT_GLYPH: return "font_glyph";
+	case DrawCallType::FONT_GLYPH_RUN: return "font_glyph_run";
+	case DrawCallType::RECORDING_CONTEXT_MERGE: return "recording_context_merge";
+	case DrawCallType::STATIC_BATCH: return "static_batch";
+	default: return "unknown";
+	}
+}
+
+void DrawResourcesFiller::FrameStats::writeJSON(std::ostream& out, std::span<const FrameStats> frames)
+{
+	out << "[\n";
+	for (size_t f = 0u; f < frames.size(); ++f)
+	{
+		const FrameStats& stats = frames[f];
+		out << "\t{\n";
+		out << "\t\t\"frame\": " << f << ",\n";
+		out << "\t\t\"autoSubmits\": {";
+		for (uint32_t r = 0u; r < static_cast<uint32_t>(AutoSubmitReason::COUNT); ++r)
+			out << (r ? ", " : " ") << "\"" << getName(static_cast<AutoSubmitReason>(r)) << "\": " << stats.autoSubmits[r];
+		out << " },\n";
+		out << "\t\t\"autoSubmitMs\": " << stats.autoSubmitMs << ",\n";
+		out << "\t\t\"uploadedBytes\": { \"mainObjects\": " << stats.uploadedMainObjectBytes
+			<< ", \"drawObjects\": " << stats.uploadedDrawObjectBytes
+			<< ", \"geometry\": " << stats.uploadedGeometryBytes
+			<< ", \"lineStyles\": " << stats.uploadedLineStyleBytes
+			<< ", \"msdfs\": " << stats.uploadedMSDFBytes << " },\n";
+		out << "\t\t\"peakUsage\": { \"mainObjects\": " << stats.peakMainObjectCount
+			<< ", \"drawObjects\": " << stats.peakDrawObjectCount
+			<< ", \"indices\": " << uint64_t(stats.peakDrawObjectCount) * 6u
+			<< ", \"geometryBytes\": " << stats.peakGeometryBytes
+			<< ", \"lineStyles\": " << stats.peakLineStyleCount << " },\n";
+		out << "\t\t\"msdfHits\": " << stats.msdfHits << ",\n";
+		out << "\t\t\"msdfMisses\": " << stats.msdfMisses << ",\n";
+		out << "\t\t\"drawCalls\": {";
+		for (uint32_t t = 0u; t < static_cast<uint32_t>(DrawCallType::COUNT); ++t)
+			out << (t ? ", " : " ") << "\"" << getName(static_cast<DrawCallType>(t)) << "\": { \"count\": " << stats.drawCalls[t] << ", \"recordingMs\": " << stats.recordingMs[t] << " }";
+		out << " }\n";
+		out << "\t}" << ((f + 1u < frames.size()) ? "," : "") << "\n";
+	}
+	out << "]\n";
+}
+
+void DrawResourcesFiller::FrameStats::writeCSV(std::ostream& out, std::span<const FrameStats> frames)
+{
+	out << "frame";
+	for (uint32_t r = 0u; r < static_cast<uint32_t>(AutoSubmitReason::COUNT); ++r)
+		out << ",auto_submits_" << getName(static_cast<AutoSubmitReason>(r));
+	out << ",auto_submit_ms";
+	out << ",uploaded_main_object_bytes,uploaded_draw_object_bytes,uploaded_geometry_bytes,uploaded_line_style_bytes,uploaded_msdf_bytes";
+	out << ",peak_main_objects,peak_draw_objects,peak_indices,peak_geometry_bytes,peak_line_styles";
+	out << ",msdf_hits,msdf_misses";
+	for (uint32_t t = 0u; t < static_cast<uint32_t>(DrawCallType::COUNT); ++t)
+		out << "," << getName(static_cast<DrawCallType>(t)) << "_calls," << getName(static_cast<DrawCallType>(t)) << "_ms";
+	out << "\n";
+
+	for (size_t f = 0u; f < frames.size(); ++f)
+	{
+		const FrameStats& stats = frames[f];
+		out << f;
+		for (const uint32_t count : stats.autoSubmits)
+			out << "," << count;
+		out << "," << stats.autoSubmitMs;
+		out << "," << stats.uploadedMainObjectBytes << "," << stats.uploadedDrawObjectBytes << "," << stats.uploadedGeometryBytes << "," << stats.uploadedLineStyleBytes << "," << stats.uploadedMSDFBytes;
+		out << "," << stats.peakMainObjectCount << "," << stats.peakDrawObjectCount << "," << uint64_t(stats.peakDrawObjectCount) * 6u << "," << stats.peakGeometryBytes << "," << stats.peakLineStyleCount;
+		out << "," << stats.msdfHits << "," << stats.msdfMisses;
+		for (uint32_t t = 0u; t < static_cast<uint32_t>(DrawCallType::COUNT); ++t)
+			out << "," << stats.drawCalls[t] << "," << stats.recordingMs[t];
+		out << "\n";
+	}
+}
@@ -2,9 +2,15 @@
 #include "Polyline.h"
 #include "Hatch.h"
 #include "IndexAllocator.h"
+#include "SharedMSDFCache.h"
+#include "MSDFGenerationPool.h"
+#include "SpatialGrid.h"
+#include "PolylineLOD.h"
 #include <nbl/video/utilities/SIntendedSubmitInfo.h>
 #include <nbl/core/containers/LRUCache.h>  
 #include <nbl/ext/TextRendering/TextRendering.h>
+#include <chrono>
+#include <ostream>
 
 using namespace nbl;
 using namespace nbl::video;
@@ -18,6 +24,27 @@ static_assert(sizeof(Globals) == 128u);
 static_assert(sizeof(LineStyle) == 96u);
 static_assert(sizeof(ClipProjectionData) == 88u);
 
+// Consistent with `operator==(LineStyle, LineStyle)`: screenSpaceLineWidth is hashed by bits (it may hold a texture index) and only the used part of the stipple pattern is hashed
+struct LineStyleHash
+{
+	std::size_t operator()(const LineStyle& style) const
+	{
+		std::size_t ret = 0ull;
+		auto combine = [&ret](std::size_t h) { ret ^= h + 0x9e3779b97f4a7c15ull + (ret << 6) + (ret >> 2); };
+		for (uint32_t i = 0u; i < 4u; ++i)
+			combine(std::hash<float>{}(style.color[i]));
+		combine(std::hash<uint32_t>{}(nbl::hlsl::bit_cast<uint32_t, float>(style.screenSpaceLineWidth)));
+		combine(std::hash<float>{}(style.worldSpaceLineWidth));
+		combine(std::hash<int32_t>{}(style.stipplePatternSize));
+		combine(std::hash<float>{}(style.reciprocalStipplePatternLen));
+		for (int32_t i = 0; i < style.stipplePatternSize; ++i)
+			combine(std::hash<uint32_t>{}(style.stipplePattern[i]));
+		combine(std::hash<uint32_t>{}(style.isRoadStyleFlag));
+		combine(std::hash<uint32_t>{}(style.rigidSegmentIdx));
+		return ret;
+	}
+};
+
 template <typename BufferType>
 struct DrawBuffers
 {
@@ -59,6 +86,16 @@ public:
 	
 	void allocateMSDFTextures(ILogicalDevice* logicalDevice, uint32_t maxMSDFs, uint32_t2 msdfsExtent);
 
+	// ! Headless (CPU-only) backend, allocates only host memory for all buffers and the MSDF cache, no device, utilities or queue needed
+	// ! `finalizeAllCopiesToGPU` only counts the bytes it would've uploaded and submits just hand the recorded buffers to the submit function before they get reset (like a buffer swap)
+	// ! Used for measuring recording cost on machines without a GPU, use it instead of the other allocate* functions and don't touch `gpuDrawBuffers` or the MSDF texture array
+	void allocateHeadless(uint32_t maxIndices, uint32_t mainObjects, uint32_t drawObjects, size_t geometryBufferSize, uint32_t lineStylesCount, uint32_t maxMSDFs, uint32_t2 msdfsExtent);
+
+	inline bool isHeadless() const { return m_headless; }
+
+	// Bytes `finalizeAllCopiesToGPU` would've uploaded so far, headless only
+	inline uint64_t getHeadlessUploadedBytes() const { return m_headlessUploadedBytes; }
+
 	// functions that user should set to get MSDF texture if it's not available in cache.
 	// it's up to user to return cached or generate on the fly.
 	typedef std::function<core::smart_refctd_ptr<ICPUImage>(nbl::ext::TextRendering::FontFace* /*face*/, uint32_t /*glyphIdx*/)> GetGlyphMSDFTextureFunc;
@@ -66,10 +103,46 @@ public:
 	void setGlyphMSDFTextureFunction(const GetGlyphMSDFTextureFunc& func);
 	void setHatchFillMSDFTextureFunction(const GetHatchFillPatternMSDFTextureFunc& func);
 
+	// Optional, MSDFs missing from this filler's texture array are looked up in `cache` before calling the functions above, so fillers sharing it generate each MSDF once
+	void setSharedMSDFCache(smart_refctd_ptr<SharedMSDFCache>&& cache) { m_sharedMSDFCache = std::move(cache); }
+
+	// ! Generates missing MSDFs on `threadCount` background workers (0 will use std::thread::hardware_concurrency()) instead of during recording, call after allocating the MSDF textures
+	// ! Until its MSDF is uploaded a glyph or fill pattern uses `placeholder` (same size as the MSDFs), finished MSDFs are patched in by `finalizeAllCopiesToGPU`
+	// ! The MSDF functions above get called from the workers, so they have to be thread-safe
+	void enableAsyncMSDFGeneration(smart_refctd_ptr<ICPUImage>&& placeholder, uint32_t threadCount = 0u);
+
+	// Queue depth and submit to completion latency of the async MSDF generation, zeroes if it's not enabled
+	MSDFGenerationPool::Stats getAsyncMSDFGenerationStats() const { return m_msdfGenerationPool ? m_msdfGenerationPool->getStats() : MSDFGenerationPool::Stats{}; }
+
+	// ! Same as `Globals::defaultClipProjection`, the clip projection used while nothing is pushed. Only needed for culling and polyline LOD selection, set it again whenever the view changes
+	void setDefaultClipProjection(const ClipProjectionData& clipProjection) { m_defaultClipProjection = clipProjection; }
+
+	// ! Culling: lines, quadratic beziers, polyline connectors, hatch boxes and glyphs completely outside the current clip projection (top of the clip projection stack, or the default one if it's empty) are skipped before they get written to the buffers
+	// ! It's conservative, objects are tested with world space AABBs grown by their style's world space line width (times `miterLimit` for connectors) and `ndcMargin` has to cover whatever is sized in screen space (screen space line widths and their miters, AA, glyph bold and tilt)
+	// ! Only draw objects get skipped, main objects and draw order stay the same. Recording contexts and static batches aren't culled
+	// ! Use `SpatialGrid` on top of it to skip whole main objects without touching their geometry
+	void enableCulling(float32_t2 ndcMargin = float32_t2(0.0f, 0.0f), float32_t miterLimit = 10.0f);
+
+	void disableCulling() { m_cullingEnabled = false; }
+
+	inline bool isCullingEnabled() const { return m_cullingEnabled; }
+
+	// Number of draw objects culling skipped so far (lines, beziers, connectors, hatch boxes and glyphs, not their cages)
+	inline uint64_t getCulledObjectCount() const { return m_culledObjectCount; }
+
 	//! this function fills buffers required for drawing a polyline and submits a draw through provided callback when there is not enough memory.
 	void drawPolyline(const CPolylineBase& polyline, const LineStyleInfo& lineStyleInfo, SIntendedSubmitInfo& intendedNextSubmit);
 
 	void drawPolyline(const CPolylineBase& polyline, uint32_t polylineMainObjIdx, SIntendedSubmitInfo& intendedNextSubmit);
+
+	// ! Draws the coarsest level of `polylineLOD` that stays within the max error set by `setPolylineLODMaxNDCError` at the current clip projection (see `setDefaultClipProjection`)
+	void drawPolyline(const CPolylineLOD& polylineLOD, const LineStyleInfo& lineStyleInfo, SIntendedSubmitInfo& intendedNextSubmit);
+
+	// ! Max error of the polyline LOD levels in NDC, e.g. 1.0f / screenWidth for half a pixel, 0 always draws level 0
+	void setPolylineLODMaxNDCError(float32_t maxNDCError) { m_polylineLODMaxNDCError = maxNDCError; }
+
+	// Number of polylines drawn at each LOD level so far
+	inline std::span<const uint64_t> getPolylineLODLevelHistogram() const { return m_polylineLODLevelHistogram; }
 	
 	// ! Convinience function for Hatch with MSDF Pattern and a solid background
 	void drawHatch(
@@ -102,6 +175,23 @@ public:
 		float32_t2 minUV,
 		uint32_t mainObjIdx,
 		SIntendedSubmitInfo& intendedNextSubmit);
+
+	struct GlyphRunInstance
+	{
+		float64_t2 topLeft;
+		float32_t2 dirU;
+		float32_t2 minUV;
+		float32_t  aspectRatio;
+		uint32_t   glyphIdx;
+	};
+
+	// ! Draw a run of Font Glyphs of the same face under `mainObjIdx`, same result as `drawFontGlyph` on each of them, will auto submit if there is no space
+	// ! MSDFs are resolved in one pass over the distinct glyphs of the run before anything is written, then the glyphs get written contiguously in as few chunks as the buffers allow
+	void drawFontGlyphRun(
+		nbl::ext::TextRendering::FontFace* fontFace,
+		std::span<const GlyphRunInstance> glyphs,
+		uint32_t mainObjIdx,
+		SIntendedSubmitInfo& intendedNextSubmit);
 	
 	void _test_addImageObject(
 		float64_t2 topLeftPos,
@@ -112,9 +202,7 @@ public:
 		auto addImageObject_Internal = [&](const ImageObjectInfo& imageObjectInfo, uint32_t mainObjIdx) -> bool
 			{
 				const auto maxGeometryBufferImageObjects = (maxGeometryBufferSize - currentGeometryBufferSize) / sizeof(ImageObjectInfo);
-				uint32_t uploadableObjects = (maxIndexCount / 6u) - currentDrawObjectCount;
-				uploadableObjects = std::min(uploadableObjects, maxDrawObjects - currentDrawObjectCount);
-				uploadableObjects = std::min(static_cast<uint64_t>(uploadableObjects), maxGeometryBufferImageObjects);
+				const uint32_t uploadableObjects = getUploadableDrawObjectCount(maxGeometryBufferImageObjects);
 
 				if (uploadableObjects >= 1u)
 				{
@@ -153,6 +241,138 @@ public:
 		}
 	}
 
+	// ! RecordingContext
+	// ! CPU-only recording of draws which doesn't touch the DrawResourcesFiller at all, so multiple threads can each record into their own context at the same time.
+	// ! Geometry is recorded in "segments" small enough to always fit into empty buffers, draw objects inside reference their main object and geometry locally.
+	// ! Styles, clip projections and MSDF textures are recorded by value and only resolved on merge, because those need the filler's (single threaded) caches and allocators.
+	// ! Use `DrawResourcesFiller::createRecordingContext` to create one and `mergeRecordingContexts` to bring them into the filler in submission order.
+	// ! Glyphs hold on to the FontFace pointer they were recorded with, make sure it outlives the merge.
+	class RecordingContext
+	{
+	public:
+		static constexpr uint32_t MaxSegmentDrawObjects = 1024u;
+		static constexpr uint64_t MaxSegmentGeometrySize = 64ull * 1024ull;
+
+		// clears everything recorded but keeps the memory around
+		void reset();
+
+		void pushClipProjectionData(const ClipProjectionData& clipProjectionData);
+		void popClipProjectionData();
+
+		void drawPolyline(const CPolylineBase& polyline, const LineStyleInfo& lineStyleInfo);
+
+		void drawHatch(const Hatch& hatch, const float32_t4& foregroundColor, const float32_t4& backgroundColor, const HatchFillPattern fillPattern);
+		void drawHatch(const Hatch& hatch, const float32_t4& color, const HatchFillPattern fillPattern);
+		void drawHatch(const Hatch& hatch, const float32_t4& color);
+
+		// Same rule as `DrawResourcesFiller::addMainObject_SubmitIfNeeded`, only draw into the last main object you added
+		uint32_t addMainObject(const LineStyleInfo& lineStyleInfo);
+
+		// `mainObjIdx` is the local index returned by `addMainObject`
+		void drawFontGlyph(
+			nbl::ext::TextRendering::FontFace* fontFace,
+			uint32_t glyphIdx,
+			float64_t2 topLeft,
+			float32_t2 dirU,
+			float32_t  aspectRatio,
+			float32_t2 minUV,
+			uint32_t mainObjIdx);
+
+		inline uint32_t getMainObjectCount() const { return mainObjects.size(); }
+		inline uint32_t getDrawObjectCount() const { return drawObjects.size(); }
+		inline size_t getGeometrySize() const { return geometry.size(); }
+
+	protected:
+		friend struct DrawResourcesFiller;
+
+		RecordingContext(uint32_t maxSegmentDrawObjects, uint64_t maxSegmentGeometrySize) 
+			: maxSegmentDrawObjects(maxSegmentDrawObjects)
+			, maxSegmentGeometrySize(maxSegmentGeometrySize)
+		{}
+
+		static constexpr uint32_t InvalidIdx = ~0u;
+
+		struct RecordedMainObject
+		{
+			LineStyleInfo lineStyle = {};
+			HatchFillPattern fillPattern = HatchFillPattern::SOLID_FILL; // the MSDF texture index of the pattern goes in the style, resolved on merge
+			uint32_t clipProjectionIdx = InvalidIdx; // into `clipProjections`, InvalidIdx uses whatever is on top of the filler's stack on merge
+			uint32_t segmentsOffset = 0u;
+			uint32_t segmentsCount = 0u;
+		};
+
+		struct RecordedGlyph
+		{
+			nbl::ext::TextRendering::FontFace* fontFace;
+			uint32_t glyphIdx;
+			float64_t2 topLeft;
+			float32_t2 dirU;
+			float32_t aspectRatio;
+			float32_t2 minUV;
+		};
+
+		// Smallest unit that gets merged, always copied as a whole so draw objects and the geometry they reference never get split by an auto-submit
+		struct RecordedSegment
+		{
+			uint32_t drawObjectsOffset = 0u;
+			uint32_t drawObjectsCount = 0u;
+			uint64_t geometryOffset = 0u;
+			uint64_t geometrySize = 0u;
+			uint32_t glyphIdx = InvalidIdx; // glyphs are a segment of their own, their MSDF texture index needs to be resolved on merge
+		};
+
+		uint32_t addMainObject_Internal(const LineStyleInfo& lineStyleInfo, HatchFillPattern fillPattern);
+
+		// Returns the last segment of the main object if it has room for `drawObjectCount` draw objects and `geometrySize` bytes of geometry, otherwise starts a new one
+		RecordedSegment& acquireSegment(uint32_t mainObjIdx, uint32_t drawObjectCount, uint64_t geometrySize);
+		// returns the address of the geometry relative to the start of the segment
+		uint64_t addSegmentGeometry(RecordedSegment& segment, const void* data, uint64_t size);
+		void addSegmentDrawObject(RecordedSegment& segment, ObjectType type, uint16_t subsectionIdx, uint64_t segmentGeometryAddress);
+
+		void addLines(const CPolylineBase& polyline, const CPolylineBase::SectionInfo& section, uint32_t mainObjIdx);
+		void addQuadBeziers(const CPolylineBase& polyline, const CPolylineBase::SectionInfo& section, uint32_t mainObjIdx);
+		void addPolylineConnectors(const CPolylineBase& polyline, uint32_t mainObjIdx);
+		void addHatchBoxes(const Hatch& hatch, uint32_t mainObjIdx);
+
+		uint32_t maxSegmentDrawObjects;
+		uint64_t maxSegmentGeometrySize;
+
+		std::vector<RecordedMainObject> mainObjects;
+		std::vector<RecordedSegment> segments;
+		std::vector<DrawObject> drawObjects; // `mainObjIndex` is fixed up and `geometryAddress` is relative to the segment's geometry until merged
+		std::vector<uint8_t> geometry;
+		std::vector<RecordedGlyph> glyphs;
+		std::vector<ClipProjectionData> clipProjections;
+		std::vector<uint32_t> clipProjectionStack; // indices into `clipProjections`
+	};
+
+	// Contexts are sized after the buffers allocated so far, so create them after the `allocate*` calls
+	RecordingContext createRecordingContext() const;
+
+	// Copies recorded contexts into the buffers in the order given, fixing up main object indices, geometry addresses, styles, clip projections and MSDF texture indices
+	// behaves just as if everything was drawn directly through this filler from a single thread, including auto-submits
+	// call it on the thread that owns the filler, before `finalizeAllCopiesToGPU`
+	void mergeRecordingContexts(std::span<const RecordingContext> contexts, SIntendedSubmitInfo& intendedNextSubmit);
+
+	void mergeRecordingContext(const RecordingContext& context, SIntendedSubmitInfo& intendedNextSubmit);
+
+	// ! Static Batches (Retained Mode)
+	// ! Geometry of a recorded context is copied once into a resident region at the front of the geometry buffer, which survives resets and auto-submits and is uploaded only once.
+	// ! Drawing the batch in later frames only re-emits it's main objects, styles and clip projections, plus it's prebuilt draw objects which already point to the resident geometry.
+	// ! Register (and release) batches right after `reset()`, before anything else is drawn in the frame, because the resident region needs to stay at the front of the buffer.
+	// ! Glyphs aren't retained since their MSDF textures can get evicted, draw them every frame as usual.
+	using StaticBatchHandle = uint32_t;
+	static constexpr StaticBatchHandle InvalidStaticBatchHandle = ~0u;
+
+	// returns InvalidStaticBatchHandle if the resident region can't grow enough to hold the batch's geometry
+	StaticBatchHandle registerStaticBatch(const RecordingContext& context);
+
+	void drawStaticBatch(StaticBatchHandle handle, SIntendedSubmitInfo& intendedNextSubmit);
+
+	void releaseAllStaticBatches();
+
+	inline uint64_t getResidentGeometryBufferSize() const { return residentGeometryBufferSize; }
+
 	bool finalizeAllCopiesToGPU(SIntendedSubmitInfo& intendedNextSubmit);
 
 	inline uint32_t getLineStyleCount() const { return currentLineStylesCount; }
@@ -192,6 +412,91 @@ public:
 	DrawBuffers<IGPUBuffer> gpuDrawBuffers;
 
 	uint32_t addLineStyle_SubmitIfNeeded(const LineStyleInfo& lineStyle, SIntendedSubmitInfo& intendedNextSubmit);
+
+	struct LineStyleLookupStats
+	{
+		uint64_t lookups = 0ull;
+		uint64_t hits = 0ull; // style already existed in the buffer and it's index was reused
+		uint64_t comparisons = 0ull; // LineStyle equality checks done by the lookups (size of the hash buckets searched)
+
+		inline double getHitRate() const { return (lookups > 0ull) ? static_cast<double>(hits) / static_cast<double>(lookups) : 0.0; }
+		inline double getAverageComparisonsPerLookup() const { return (lookups > 0ull) ? static_cast<double>(comparisons) / static_cast<double>(lookups) : 0.0; }
+	};
+
+	inline const LineStyleLookupStats& getLineStyleLookupStats() const { return lineStyleLookupStats; }
+	inline void resetLineStyleLookupStats() { lineStyleLookupStats = {}; }
+
+	// ! What ran out and made the filler auto-submit
+	enum class AutoSubmitReason : uint8_t
+	{
+		INDEX_BUFFER,
+		DRAW_OBJECTS_BUFFER,
+		GEOMETRY_BUFFER, // includes clip projections
+		MAIN_OBJECTS_BUFFER,
+		LINE_STYLES_BUFFER,
+		MSDF_EVICTION, // an MSDF used since the last submit had to be evicted from the texture array
+		COUNT
+	};
+
+	enum class DrawCallType : uint8_t
+	{
+		POLYLINE,
+		HATCH,
+		FONT_GLYPH,
+		FONT_GLYPH_RUN,
+		RECORDING_CONTEXT_MERGE,
+		STATIC_BATCH,
+		COUNT
+	};
+
+	// ! Instrumentation of everything since the last `resetFrameStats` (call it once a frame), to size the allocate* functions from real scenes
+	// ! Counters are always on, draw call timing only after `enableFrameStatsTiming(true)` because it reads the clock twice per draw call
+	struct FrameStats
+	{
+		std::array<uint32_t, static_cast<size_t>(AutoSubmitReason::COUNT)> autoSubmits = {};
+		double autoSubmitMs = 0.0; // finalizing the copies and calling the submit function, in auto-submits only
+
+		// bytes the finalize functions uploaded (would've uploaded when headless)
+		uint64_t uploadedMainObjectBytes = 0ull;
+		uint64_t uploadedDrawObjectBytes = 0ull;
+		uint64_t uploadedGeometryBytes = 0ull;
+		uint64_t uploadedLineStyleBytes = 0ull;
+		uint64_t uploadedMSDFBytes = 0ull;
+
+		// highest usage seen by `finalizeAllCopiesToGPU`, buffers at least this big wouldn't have auto-submitted (6 indices per draw object)
+		uint32_t peakMainObjectCount = 0u;
+		uint32_t peakDrawObjectCount = 0u;
+		uint64_t peakGeometryBytes = 0ull;
+		uint32_t peakLineStyleCount = 0u;
+
+		// per glyph (or hatch fill pattern) drawn, whether its MSDF was already in the texture array
+		uint64_t msdfHits = 0ull;
+		uint64_t msdfMisses = 0ull;
+
+		// draw calls made by the user, not the ones they make internally (e.g. `drawFontGlyphRun` falling back to `drawFontGlyph`)
+		std::array<uint32_t, static_cast<size_t>(DrawCallType::COUNT)> drawCalls = {};
+		std::array<double, static_cast<size_t>(DrawCallType::COUNT)> recordingMs = {}; // without the auto-submits they did
+
+		inline uint32_t getAutoSubmitCount() const
+		{
+			uint32_t ret = 0u;
+			for (const uint32_t count : autoSubmits)
+				ret += count;
+			return ret;
+		}
+
+		static const char* getName(AutoSubmitReason reason);
+		static const char* getName(DrawCallType type);
+
+		// ! A JSON array with an object per frame
+		static void writeJSON(std::ostream& out, std::span<const FrameStats> frames);
+		// ! A header row and a row per frame
+		static void writeCSV(std::ostream& out, std::span<const FrameStats> frames);
+	};
+
+	inline const FrameStats& getFrameStats() const { return m_frameStats; }
+	inline void resetFrameStats() { m_frameStats = {}; }
+	inline void enableFrameStatsTiming(bool enable) { m_frameStatsTiming = enable; }
 	
 	// [ADVANCED] Do not use this function unless you know what you're doing (It may cause auto submit)
 	// Never call this function multiple times in a row before indexing it in a drawable, because future auto-submits may invalidate mainObjects, so do them one by one, for example:
@@ -206,10 +511,14 @@ public:
 	smart_refctd_ptr<IGPUImageView> getMSDFsTextureArray() { return msdfTextureArray; }
 
 	uint32_t2 getMSDFResolution() {
+		if (m_headless)
+			return m_headlessMSDFExtent;
 		auto extents = msdfTextureArray->getCreationParameters().image->getCreationParameters().extent;
 		return uint32_t2(extents.width, extents.height);
 	}
 	uint32_t getMSDFMips() {
+		if (m_headless)
+			return MSDFMips;
 		return msdfTextureArray->getCreationParameters().image->getCreationParameters().mipLevels;
 	}
 
@@ -233,12 +542,77 @@ protected:
 	
 	bool finalizeTextureCopies(SIntendedSubmitInfo& intendedNextSubmit);
 
+	// headless version of all the finalize functions above, only counts the bytes and marks everything as in memory
+	bool finalizeAllCopiesHeadless();
+
 	// Internal Function to call whenever we overflow while filling our buffers with geometry (potential limiters: indexBuffer, drawObjectsBuffer or geometryBuffer)
 	// ! mainObjIdx: is the mainObject the "overflowed" drawObjects belong to.
 	//		mainObjIdx is required to ensure that valid data, especially the `clipProjectionData`, remains linked to the main object.
 	//		This is important because, while other data may change during overflow handling, the main object must persist to maintain consistency throughout rendering all parts of it. (for example all lines and beziers of a single polyline)
 	//		[ADVANCED] If you have not created your mainObject yet, pass `InvalidMainObjectIdx` (See drawHatch)
-	void submitCurrentDrawObjectsAndReset(SIntendedSubmitInfo& intendedNextSubmit, uint32_t mainObjectIndex);
+	// ! The overflowed buffer is the one the last `getUploadableDrawObjectCount()` ran out of, pass `reason` when it's something else
+	void submitCurrentDrawObjectsAndReset(SIntendedSubmitInfo& intendedNextSubmit, uint32_t mainObjectIndex) { submitCurrentDrawObjectsAndReset(intendedNextSubmit, mainObjectIndex, drawBuffersLimit); }
+	void submitCurrentDrawObjectsAndReset(SIntendedSubmitInfo& intendedNextSubmit, uint32_t mainObjectIndex, AutoSubmitReason reason);
+
+	// Finalizes the copies and calls the submit function, callers reset whatever the submit invalidated
+	void autoSubmit(SIntendedSubmitInfo& intendedNextSubmit, AutoSubmitReason reason);
+
+	// Draw objects that fit in what's left of the index and draw objects buffers, and in `geometryBufferObjects` (the objects' geometry fitting in what's left of the geometry buffer)
+	// the buffer which limited the count is kept in `drawBuffersLimit`, as the reason of the auto-submit if the objects don't fit
+	uint32_t getUploadableDrawObjectCount(uint64_t geometryBufferObjects = ~0ull)
+	{
+		uint32_t uploadableObjects = (maxIndexCount / 6u) - currentDrawObjectCount;
+		drawBuffersLimit = AutoSubmitReason::INDEX_BUFFER;
+		if (maxDrawObjects - currentDrawObjectCount < uploadableObjects)
+		{
+			uploadableObjects = maxDrawObjects - currentDrawObjectCount;
+			drawBuffersLimit = AutoSubmitReason::DRAW_OBJECTS_BUFFER;
+		}
+		if (geometryBufferObjects < uploadableObjects)
+		{
+			uploadableObjects = static_cast<uint32_t>(geometryBufferObjects);
+			drawBuffersLimit = AutoSubmitReason::GEOMETRY_BUFFER;
+		}
+		return uploadableObjects;
+	}
+
+	// Counts the draw call and times it if enabled, only the outermost one since draw calls call each other, auto-submits inside it aren't counted as it's recording time
+	class DrawCallScope
+	{
+	public:
+		DrawCallScope(DrawResourcesFiller& filler, DrawCallType type)
+			: m_filler(filler)
+			, m_type(type)
+			, m_outermost(filler.m_drawCallDepth++ == 0u)
+		{
+			if (m_outermost && m_filler.m_frameStatsTiming)
+			{
+				m_autoSubmitMsBegin = m_filler.m_frameStats.autoSubmitMs;
+				m_begin = std::chrono::steady_clock::now();
+			}
+		}
+
+		~DrawCallScope()
+		{
+			m_filler.m_drawCallDepth--;
+			if (!m_outermost)
+				return;
+			FrameStats& stats = m_filler.m_frameStats;
+			stats.drawCalls[static_cast<size_t>(m_type)]++;
+			if (m_filler.m_frameStatsTiming)
+			{
+				const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_begin).count();
+				stats.recordingMs[static_cast<size_t>(m_type)] += ms - (stats.autoSubmitMs - m_autoSubmitMsBegin);
+			}
+		}
+
+	private:
+		DrawResourcesFiller& m_filler;
+		DrawCallType m_type;
+		bool m_outermost;
+		double m_autoSubmitMsBegin = 0.0;
+		std::chrono::steady_clock::time_point m_begin;
+	};
 
 	uint32_t addMainObject_Internal(const MainObject& mainObject);
 
@@ -263,15 +637,68 @@ protected:
 
 	void addPolylineObjects_Internal(const CPolylineBase& polyline, const CPolylineBase::SectionInfo& section, uint32_t& currentObjectInSection, uint32_t mainObjIdx);
 
-	void addPolylineConnectors_Internal(const CPolylineBase& polyline, uint32_t& currentPolylineConnectorObj, uint32_t mainObjIdx);
+	void addPolylineConnectors_Internal(const CPolylineBase& polyline, uint32_t& currentPolylineConnectorObj, uint32_t connectorsEnd, uint32_t mainObjIdx);
 
 	void addLines_Internal(const CPolylineBase& polyline, const CPolylineBase::SectionInfo& section, uint32_t& currentObjectInSection, uint32_t mainObjIdx);
 
 	void addQuadBeziers_Internal(const CPolylineBase& polyline, const CPolylineBase::SectionInfo& section, uint32_t& currentObjectInSection, uint32_t mainObjIdx);
 
-	void addHatch_Internal(const Hatch& hatch, uint32_t& currentObjectInSection, uint32_t mainObjIndex);
+	void addHatch_Internal(const Hatch& hatch, uint32_t& currentObjectInSection, uint32_t hatchBoxesEnd, uint32_t mainObjIndex);
+
+	// Top of the clip projection stack, or the default clip projection if it's empty
+	const ClipProjectionData& getCurrentClipProjection() const { return clipProjections.empty() ? m_defaultClipProjection : clipProjections.back(); }
+
+	// World space region visible through the current clip projection, see `enableCulling`
+	SpatialGrid::AABB getCullingWorldAABB() const;
+
+	// Conservative, whatever it's direction the glyph fits in a circle of radius width + height around it's top left
+	static bool isGlyphVisible(float64_t2 topLeft, float32_t2 dirU, float32_t aspectRatio, const SpatialGrid::AABB& cullingAABB)
+	{
+		const float64_t width = glm::length(dirU);
+		const float64_t radius = width + width * aspectRatio;
+		const SpatialGrid::AABB glyphAABB = { topLeft - float64_t2(radius, radius), topLeft + float64_t2(radius, radius) };
+		return glyphAABB.overlaps(cullingAABB);
+	}
+
+	// Calls `addRun(begin, end)` for every run of consecutive objects in [0, objectCount) for which `isVisible(objIdx)` is true, or once for all of them if culling is disabled
+	template<typename VisibleFunc, typename RunFunc>
+	void forEachVisibleRun(uint32_t objectCount, VisibleFunc&& isVisible, RunFunc&& addRun)
+	{
+		if (!m_cullingEnabled)
+		{
+			if (objectCount > 0u)
+				addRun(0u, objectCount);
+			return;
+		}
+
+		uint32_t runBegin = 0u;
+		for (uint32_t i = 0u; i < objectCount; ++i)
+		{
+			if (isVisible(i))
+				continue;
+			if (i > runBegin)
+				addRun(runBegin, i);
+			runBegin = i + 1u;
+			m_culledObjectCount++;
+		}
+		if (objectCount > runBegin)
+			addRun(runBegin, objectCount);
+	}
+
+	// Adds the style (resolving it's fill pattern MSDF) and the mainObject of a recorded main object
+	// `pushedClipProjectionIdx` is the index in `clipProjections` currently pushed on top of our stack on behalf of the caller, pushes and pops so it matches the main object's
+	uint32_t addRecordedMainObject_SubmitIfNeeded(const RecordingContext::RecordedMainObject& recordedMainObject, std::span<const ClipProjectionData> clipProjections, uint32_t& pushedClipProjectionIdx, SIntendedSubmitInfo& intendedNextSubmit);
+
+	// Copies as many of the draw objects as fit into the buffers, pointing them to `mainObjIdx`. returns the number of draw objects copied.
+	uint32_t addStaticBatchDrawObjects_Internal(const DrawObject* drawObjects, uint32_t count, uint32_t mainObjIdx);
+
+	// Copies a whole recorded segment into the buffers, fixing up it's draw objects' main object index and geometry addresses. returns false if it doesn't fit.
+	bool addRecordedSegment_Internal(const RecordingContext& context, const RecordingContext::RecordedSegment& segment, uint32_t mainObjIdx);
 	
 	bool addFontGlyph_Internal(const GlyphInfo& glyphInfo, uint32_t mainObjIdx);
+
+	// Gets the MSDF texture index of the glyph, adding the texture if it's not in cache yet (may auto-submit)
+	uint32_t getGlyphMSDFIndex(nbl::ext::TextRendering::FontFace* fontFace, uint32_t glyphIdx, uint32_t mainObjIdx, SIntendedSubmitInfo& intendedNextSubmit);
 	
 	void resetMainObjectCounters()
 	{
@@ -287,8 +714,9 @@ protected:
 		inMemDrawObjectCount = 0u;
 		currentDrawObjectCount = 0u;
 
-		inMemGeometryBufferSize = 0u;
-		currentGeometryBufferSize = 0u;
+		// resident geometry of static batches stays, it only needs uploading if it hasn't been already
+		inMemGeometryBufferSize = std::min(inMemGeometryBufferSize, residentGeometryBufferSize);
+		currentGeometryBufferSize = residentGeometryBufferSize;
 
 		// Invalidate all the clip projection addresses because geometry buffer got reset
 		for (auto& clipProjAddr : clipProjectionAddresses)
@@ -299,6 +727,7 @@ protected:
 	{
 		currentLineStylesCount = 0u;
 		inMemLineStylesCount = 0u;
+		lineStyleIndices.clear(); // indices are only valid while the styles are in the buffer, we don't clear it on `submitCurrentDrawObjectsAndReset` because styles are kept
 	}
 
 	MainObject* getMainObject(uint32_t idx)
@@ -307,71 +736,12 @@ protected:
 		return &mainObjsArray[idx];
 	}
 
-	// MSDF Hashing and Caching Internal Functions 
-	enum class MSDFType : uint8_t
-	{
-		HATCH_FILL_PATTERN,
-		FONT_GLYPH,
-	};
-
-	struct MSDFInputInfo
-	{
-		// It's a font glyph
-		MSDFInputInfo(core::blake3_hash_t fontFaceHash, uint32_t glyphIdx)
-			: type(MSDFType::FONT_GLYPH)
-			, faceHash(fontFaceHash)
-			, glyphIndex(glyphIdx)
-		{
-			computeBlake3Hash();
-		}
-
-		// It's a hatch fill pattern
-		MSDFInputInfo(HatchFillPattern fillPattern)
-			: type(MSDFType::HATCH_FILL_PATTERN)
-			, faceHash({})
-			, fillPattern(fillPattern)
-		{
-			computeBlake3Hash();
-		}
-		
-		bool operator==(const MSDFInputInfo& rhs) const
-		{ return hash == rhs.hash && glyphIndex == rhs.glyphIndex && type == rhs.type;
-		}
-
-		MSDFType type;
-		uint8_t pad[3u]; // 3 bytes pad
-		union
-		{
-			uint32_t glyphIndex;
-			HatchFillPattern fillPattern;
-		};
-		static_assert(sizeof(uint32_t) == sizeof(HatchFillPattern));
-		
-		core::blake3_hash_t faceHash = {};
-		core::blake3_hash_t hash = {}; // actual hash, we will check in == operator
-		size_t lookupHash = 0ull; // for containers expecting size_t hash
-
-
-	private:
-		
-		void computeBlake3Hash()
-		{
-			core::blake3_hasher hasher;
-			hasher.update(&type, sizeof(MSDFType));
-			hasher.update(&glyphIndex, sizeof(uint32_t));
-			hasher.update(&faceHash, sizeof(core::blake3_hash_t));
-			hash = static_cast<core::blake3_hash_t>(hasher);
-			lookupHash = std::hash<core::blake3_hash_t>{}(hash); // hashing the hash :D
-		}
-
-	};
-
-	struct MSDFInputInfoHash { std::size_t operator()(const MSDFInputInfo& info) const { return info.lookupHash; } };
-
+	// MSDF Caching Internal Functions, see SharedMSDFCache.h for `MSDFInputInfo`
 	struct MSDFReference
 	{
 		uint32_t alloc_idx;
 		uint64_t lastUsedSemaphoreValue;
+		bool pending = false; // alloc_idx is reserved but its MSDF is still being generated in the background
 
 		MSDFReference(uint32_t alloc_idx, uint64_t semaphoreVal) : alloc_idx(alloc_idx), lastUsedSemaphoreValue(semaphoreVal) {}
 		MSDFReference(uint64_t semaphoreVal) : MSDFReference(InvalidTextureIdx, semaphoreVal) {}
@@ -381,21 +751,46 @@ protected:
 		inline MSDFReference& operator=(uint64_t semamphoreVal) { lastUsedSemaphoreValue = semamphoreVal; return *this;  }
 	};
 	
+	// Gets the MSDF texture index of the fill pattern, adding the texture if it's not in cache yet (may auto-submit, so call it before creating the hatch's mainObject)
+	uint32_t getHatchFillPatternMSDFIndex(HatchFillPattern fillPattern, SIntendedSubmitInfo& intendedNextSubmit);
+
 	uint32_t getMSDFIndexFromInputInfo(const MSDFInputInfo& msdfInfo, SIntendedSubmitInfo& intendedNextSubmit)
 	{
 		uint32_t textureIdx = InvalidTextureIdx;
 		MSDFReference* tRef = msdfLRUCache->get(msdfInfo);
 		if (tRef)
 		{
-			textureIdx = tRef->alloc_idx;
+			m_frameStats.msdfHits++;
+			textureIdx = tRef->pending ? m_placeholderMSDFIdx : tRef->alloc_idx;
 			tRef->lastUsedSemaphoreValue = intendedNextSubmit.getFutureScratchSemaphore().value; // update this because the texture will get used on the next submit
+			if (!tRef->pending)
+				msdfTextureArrayIndicesUsed[tRef->alloc_idx] = true; // so evicting it later in the frame submits first
 		}
+		else
+			m_frameStats.msdfMisses++;
 		return textureIdx;
 	}
 	
 	// ! mainObjIdx: make sure to pass your mainObjIdx to it if you want it to stay synced/updated if some overflow submit occured which would potentially erase what your mainObject points at.
 	// If you haven't created a mainObject yet, then pass InvalidMainObjectIdx
 	uint32_t addMSDFTexture(const MSDFInputInfo& msdfInput, core::smart_refctd_ptr<ICPUImage>&& cpuImage, uint32_t mainObjIdx, SIntendedSubmitInfo& intendedNextSubmit);
+
+	// Same as `addMSDFTexture` but reserves the texture index and hands `generate` to the async workers, returns the placeholder index until it's patched in
+	uint32_t addMSDFTextureAsync(const MSDFInputInfo& msdfInput, SharedMSDFCache::GenerateFunc&& generate, uint32_t mainObjIdx, SIntendedSubmitInfo& intendedNextSubmit);
+
+	// Inserts `msdfInput` into the LRU cache (evicting if needed) and allocates a texture index for it, `newlyInserted` is false on cache hits
+	MSDFReference* insertMSDFReference(const MSDFInputInfo& msdfInput, uint32_t mainObjIdx, SIntendedSubmitInfo& intendedNextSubmit, bool& newlyInserted);
+
+	// Queues uploads of the MSDFs the async workers finished since the last call
+	void patchGeneratedMSDFs();
+
+	// `generate()` or the shared cache's image if one is set
+	core::smart_refctd_ptr<ICPUImage> getMSDFImage(const MSDFInputInfo& msdfInput, const SharedMSDFCache::GenerateFunc& generate)
+	{
+		if (m_sharedMSDFCache)
+			return m_sharedMSDFCache->getOrGenerate(msdfInput, generate);
+		return generate();
+	}
 	
 	// Members
 	smart_refctd_ptr<IUtilities> m_utilities;
@@ -415,27 +810,82 @@ protected:
 	uint64_t currentGeometryBufferSize = 0u;
 	uint64_t maxGeometryBufferSize = 0u;
 
+	AutoSubmitReason drawBuffersLimit = AutoSubmitReason::INDEX_BUFFER; // set by `getUploadableDrawObjectCount`
+
 	uint32_t inMemLineStylesCount = 0u;
 	uint32_t currentLineStylesCount = 0u;
 	uint32_t maxLineStyles = 0u;
+	std::unordered_map<LineStyle, uint32_t, LineStyleHash> lineStyleIndices; // style -> index in the styles buffer, so we don't search all styles for duplicates
+	LineStyleLookupStats lineStyleLookupStats = {};
 
 	uint64_t geometryBufferAddress = 0u; // Actual BDA offset 0 of the gpu buffer
 
+	// Static batches take at most half of the geometry buffer, the rest is left for what's drawn every frame
+	inline uint64_t getMaxResidentGeometryBufferSize() const { return maxGeometryBufferSize / 2u; }
+
+	struct StaticBatch
+	{
+		struct MainObjectInfo
+		{
+			RecordingContext::RecordedMainObject recorded; // segments are baked into the draw objects, only style, fill pattern and clip projection are used
+			uint32_t drawObjectsOffset = 0u;
+			uint32_t drawObjectsCount = 0u;
+		};
+
+		std::vector<MainObjectInfo> mainObjects;
+		std::vector<DrawObject> drawObjects; // `geometryAddress` points into the resident region, `mainObjIndex` is set when drawn
+		std::vector<ClipProjectionData> clipProjections;
+	};
+
+	uint64_t residentGeometryBufferSize = 0u; // size of the region at the front of the geometry buffer holding static batches, never reset
+	std::vector<StaticBatch> staticBatches;
+
 	std::deque<ClipProjectionData> clipProjections; // stack of clip projectios stored so we can resubmit them if geometry buffer got reset.
 	std::deque<uint64_t> clipProjectionAddresses; // stack of clip projection gpu addresses in geometry buffer. to keep track of them in push/pops
 
 	// MSDF
 	GetGlyphMSDFTextureFunc getGlyphMSDF;
 	GetHatchFillPatternMSDFTextureFunc getHatchFillPatternMSDF;
+	smart_refctd_ptr<SharedMSDFCache> m_sharedMSDFCache;
+	std::unique_ptr<MSDFGenerationPool> m_msdfGenerationPool;
+	uint32_t m_placeholderMSDFIdx = InvalidTextureIdx; // never in the LRU cache, so never evicted
+	std::vector<MSDFGenerationPool::GeneratedMSDF> m_generatedMSDFs; // reused by `patchGeneratedMSDFs`
+	uint64_t m_msdfEvictionCount = 0ull;
+	// reused by `drawFontGlyphRun`
+	std::vector<uint32_t> m_glyphRunTextureIndices;
+	std::unordered_map<uint32_t, uint32_t> m_glyphRunDistinctGlyphs;
+	std::vector<GlyphRunInstance> m_glyphRunVisibleGlyphs;
 
 	using MSDFsLRUCache = core::LRUCache<MSDFInputInfo, MSDFReference, MSDFInputInfoHash>;
 	smart_refctd_ptr<IGPUImageView>		msdfTextureArray; // view to the resource holding all the msdfs in it's layers
 	smart_refctd_ptr<IndexAllocator>	msdfTextureArrayIndexAllocator;
-	std::set<uint32_t>					msdfTextureArrayIndicesUsed = {}; // indices in the msdf texture array allocator that have been used in the current frame // TODO: make this a dynamic bitset
+	std::vector<bool>					msdfTextureArrayIndicesUsed = {}; // bit per index in the msdf texture array allocator, set if it's been used in the current frame
 	std::vector<MSDFTextureCopy>		msdfTextureCopies = {}; // queued up texture copies
 	std::unique_ptr<MSDFsLRUCache>		msdfLRUCache; // LRU Cache to evict Least Recently Used in case of overflow
 	static constexpr asset::E_FORMAT	MSDFTextureFormat = asset::E_FORMAT::EF_R8G8B8_SNORM;
 
 	bool m_hasInitializedMSDFTextureArrays = false;
+
+	ClipProjectionData m_defaultClipProjection = {};
+
+	// Culling
+	bool m_cullingEnabled = false;
+	float32_t2 m_cullingNDCMargin = float32_t2(0.0f, 0.0f);
+	float32_t m_cullingMiterLimit = 10.0f;
+	uint64_t m_culledObjectCount = 0ull;
+
+	// Polyline LOD
+	float32_t m_polylineLODMaxNDCError = 0.0f;
+	std::array<uint64_t, CPolylineLOD::MaxLevels> m_polylineLODLevelHistogram = {};
+
+	// Instrumentation
+	FrameStats m_frameStats = {};
+	bool m_frameStatsTiming = false;
+	uint32_t m_drawCallDepth = 0u;
+
+	// Headless
+	bool m_headless = false;
+	uint32_t2 m_headlessMSDFExtent = {};
+	uint64_t m_headlessUploadedBytes = 0ull;
 };
 
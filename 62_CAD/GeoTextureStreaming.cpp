@@ -0,0 +1,415 @@
+#include "GeoTextureStreaming.h"
+
+static core::smart_refctd_ptr<system::IFile> createGeoTextureFile(system::ISystem* system, const system::path& path, const core::bitflag<system::IFile::E_CREATE_FLAGS> flags)
+{
+	core::smart_refctd_ptr<system::IFile> file;
+	system::ISystem::future_t<core::smart_refctd_ptr<system::IFile>> future;
+	system->createFile(future, path, flags);
+	if (future.wait())
+		future.acquire().move_into(file);
+	return file;
+}
+
+bool TiledGeoTexture::convert(nbl::system::ISystem* system, const nbl::system::path& outputPath, uint32_t2 extent, const GeoTextureOBB& obb, const ReadRowsFunc& readRows, uint32_t tileSize)
+{
+	if (!system || extent.x == 0u || extent.y == 0u || tileSize == 0u || !readRows)
+		return false;
+
+	Header header = {};
+	header.extent = extent;
+	header.tileSize = tileSize;
+	header.mipCount = getMipCount(extent, tileSize);
+	header.obb = obb;
+
+	std::vector<uint32_t> mipFirstTile(header.mipCount + 1u, 0u);
+	for (uint32_t mip = 0u; mip < header.mipCount; ++mip)
+	{
+		const uint32_t2 tileCount = getMipTileCount(header, mip);
+		mipFirstTile[mip + 1u] = mipFirstTile[mip] + tileCount.x * tileCount.y;
+	}
+	std::vector<uint64_t> tileOffsets(mipFirstTile.back(), 0ull);
+
+	// the tile table gets filled in as tiles are written and rewritten at the end
+	system->deleteFile(outputPath);
+	core::smart_refctd_ptr<system::IFile> file = createGeoTextureFile(system, outputPath, system::IFile::ECF_WRITE);
+	if (!file)
+		return false;
+	auto write = [&file](const void* data, size_t offset, size_t size) -> bool
+		{
+			system::IFile::success_t succ;
+			file->write(succ, data, offset, size);
+			return bool(succ);
+		};
+	if (!write(&header, 0ull, sizeof(Header)) || !write(tileOffsets.data(), sizeof(Header), tileOffsets.size() * sizeof(uint64_t)))
+		return false;
+	uint64_t nextTileOffset = sizeof(Header) + tileOffsets.size() * sizeof(uint64_t);
+
+	// a row of tiles being filled per mip, written out as soon as it's full (or the mip's last row arrives)
+	struct MipBand
+	{
+		uint32_t2 extent;
+		std::vector<uint8_t> texels; // `tileSize` rows
+		std::vector<uint8_t> pendingRow; // even row waiting for the next one to be downsampled together
+		std::vector<uint8_t> downsampledRow; // goes to the next mip
+		uint32_t rowCount = 0u; // filled rows of `texels`
+		uint32_t nextRow = 0u; // index of the next row within the mip
+	};
+	std::vector<MipBand> bands(header.mipCount);
+	for (uint32_t mip = 0u; mip < header.mipCount; ++mip)
+	{
+		MipBand& band = bands[mip];
+		band.extent = getMipExtent(header, mip);
+		const size_t rowBytes = size_t(band.extent.x) * BytesPerTexel;
+		band.texels.resize(rowBytes * tileSize);
+		if (mip + 1u < header.mipCount)
+		{
+			band.pendingRow.resize(rowBytes);
+			band.downsampledRow.resize(size_t(core::max(band.extent.x >> 1u, 1u)) * BytesPerTexel);
+		}
+	}
+
+	const uint64_t tileBytes = getTileByteSize(header);
+	std::vector<uint8_t> tile(tileBytes);
+	auto writeBand = [&](uint32_t mip) -> bool
+		{
+			MipBand& band = bands[mip];
+			const uint32_t2 tileCount = getMipTileCount(header, mip);
+			const uint32_t tileY = (band.nextRow - 1u) / tileSize;
+			for (uint32_t tileX = 0u; tileX < tileCount.x; ++tileX)
+			{
+				const uint32_t firstX = tileX * tileSize;
+				const uint32_t copiedX = core::min(tileSize, band.extent.x - firstX);
+				for (uint32_t y = 0u; y < tileSize; ++y)
+				{
+					// padding repeats the last row/column of the mip
+					const uint8_t* srcRow = band.texels.data() + size_t(core::min(y, band.rowCount - 1u)) * band.extent.x * BytesPerTexel;
+					uint8_t* dstRow = tile.data() + size_t(y) * tileSize * BytesPerTexel;
+					memcpy(dstRow, srcRow + size_t(firstX) * BytesPerTexel, size_t(copiedX) * BytesPerTexel);
+					for (uint32_t x = copiedX; x < tileSize; ++x)
+						memcpy(dstRow + size_t(x) * BytesPerTexel, srcRow + size_t(band.extent.x - 1u) * BytesPerTexel, BytesPerTexel);
+				}
+				tileOffsets[mipFirstTile[mip] + tileY * tileCount.x + tileX] = nextTileOffset;
+				if (!write(tile.data(), nextTileOffset, tileBytes))
+					return false;
+				nextTileOffset += tileBytes;
+			}
+			band.rowCount = 0u;
+			return true;
+		};
+
+	auto downsample = [](const uint8_t* rowA, const uint8_t* rowB, uint32_t srcWidth, uint8_t* dst)
+		{
+			const uint32_t dstWidth = core::max(srcWidth >> 1u, 1u);
+			for (uint32_t x = 0u; x < dstWidth; ++x)
+			{
+				const size_t x0 = size_t(core::min(x * 2u, srcWidth - 1u)) * BytesPerTexel;
+				const size_t x1 = size_t(core::min(x * 2u + 1u, srcWidth - 1u)) * BytesPerTexel;
+				for (uint32_t c = 0u; c < BytesPerTexel; ++c)
+					dst[x * BytesPerTexel + c] = static_cast<uint8_t>((uint32_t(rowA[x0 + c]) + rowA[x1 + c] + rowB[x0 + c] + rowB[x1 + c] + 2u) >> 2u);
+			}
+		};
+
+	// a row of mip 0 trickles down the pyramid, every second row of a mip makes a row of the next one
+	auto pushRow = [&](const uint8_t* row) -> bool
+		{
+			for (uint32_t mip = 0u; mip < header.mipCount && row; ++mip)
+			{
+				MipBand& band = bands[mip];
+				const size_t rowBytes = size_t(band.extent.x) * BytesPerTexel;
+				uint8_t* bandRow = band.texels.data() + band.rowCount * rowBytes;
+				memcpy(bandRow, row, rowBytes);
+				band.rowCount++;
+				const uint32_t rowIdx = band.nextRow++;
+				// `writeBand` leaves the rows in place, so `bandRow` is still valid below
+				if ((band.rowCount == tileSize || band.nextRow == band.extent.y) && !writeBand(mip))
+					return false;
+
+				row = nullptr;
+				if (mip + 1u == header.mipCount)
+					break;
+				if (band.extent.y == 1u)
+				{
+					downsample(bandRow, bandRow, band.extent.x, band.downsampledRow.data());
+					row = band.downsampledRow.data();
+				}
+				else if (rowIdx & 0x1u)
+				{
+					downsample(band.pendingRow.data(), bandRow, band.extent.x, band.downsampledRow.data());
+					row = band.downsampledRow.data();
+				}
+				else
+					memcpy(band.pendingRow.data(), bandRow, rowBytes);
+			}
+			return true;
+		};
+
+	std::vector<uint8_t> sourceRows(size_t(extent.x) * BytesPerTexel * tileSize);
+	for (uint32_t firstRow = 0u; firstRow < extent.y; firstRow += tileSize)
+	{
+		const uint32_t rowCount = core::min(tileSize, extent.y - firstRow);
+		if (!readRows(firstRow, rowCount, sourceRows.data()))
+			return false;
+		for (uint32_t r = 0u; r < rowCount; ++r)
+			if (!pushRow(sourceRows.data() + size_t(r) * extent.x * BytesPerTexel))
+				return false;
+	}
+
+	return write(tileOffsets.data(), sizeof(Header), tileOffsets.size() * sizeof(uint64_t));
+}
+
+bool TiledGeoTexture::convert(nbl::system::ISystem* system, const nbl::system::path& outputPath, const asset::ICPUImage* image, const GeoTextureOBB& obb, uint32_t tileSize)
+{
+	if (!image || !image->getBuffer())
+		return false;
+	const auto& params = image->getCreationParameters();
+	if (params.format != asset::EF_R8G8B8A8_UNORM && params.format != asset::EF_R8G8B8A8_SRGB)
+		return false;
+
+	const asset::IImage::SBufferCopy* mip0Region = nullptr;
+	for (const auto& region : image->getRegions())
+	{
+		if (region.imageSubresource.mipLevel == 0u && region.imageSubresource.baseArrayLayer == 0u)
+		{
+			mip0Region = &region;
+			break;
+		}
+	}
+	// only whole images in a single region
+	if (!mip0Region || mip0Region->imageOffset.x != 0u || mip0Region->imageOffset.y != 0u || mip0Region->imageExtent.width != params.extent.width || mip0Region->imageExtent.height != params.extent.height)
+		return false;
+
+	const uint32_t width = params.extent.width;
+	const size_t rowStride = size_t(mip0Region->bufferRowLength ? mip0Region->bufferRowLength : width) * BytesPerTexel;
+	const uint8_t* texels = reinterpret_cast<const uint8_t*>(image->getBuffer()->getPointer()) + mip0Region->bufferOffset;
+	auto readRows = [&](uint32_t firstRow, uint32_t rowCount, uint8_t* dst)
+		{
+			for (uint32_t r = 0u; r < rowCount; ++r)
+				memcpy(dst + size_t(r) * width * BytesPerTexel, texels + (firstRow + r) * rowStride, size_t(width) * BytesPerTexel);
+			return true;
+		};
+	return convert(system, outputPath, uint32_t2(width, params.extent.height), obb, readRows, tileSize);
+}
+
+bool GeoTextureStreamer::open(const nbl::system::path& path)
+{
+	m_residentTiles = nullptr;
+	m_tileMemory.clear();
+	m_freeSlots.clear();
+	m_slotCount = 0u;
+	m_stats = {};
+
+	m_file = createGeoTextureFile(m_system.get(), path, system::IFile::ECF_READ);
+	if (!m_file)
+		return false;
+
+	system::IFile::success_t succ;
+	m_file->read(succ, &m_header, 0ull, sizeof(TiledGeoTexture::Header));
+	if (!succ || m_header.magic != TiledGeoTexture::Magic || m_header.version != TiledGeoTexture::Version)
+		return false;
+	if (m_header.extent.x == 0u || m_header.extent.y == 0u || m_header.tileSize == 0u || m_header.mipCount != TiledGeoTexture::getMipCount(m_header.extent, m_header.tileSize))
+		return false;
+
+	m_mipFirstTile.assign(m_header.mipCount + 1u, 0u);
+	for (uint32_t mip = 0u; mip < m_header.mipCount; ++mip)
+	{
+		const uint32_t2 tileCount = TiledGeoTexture::getMipTileCount(m_header, mip);
+		m_mipFirstTile[mip + 1u] = m_mipFirstTile[mip] + tileCount.x * tileCount.y;
+	}
+	m_tileOffsets.resize(m_mipFirstTile.back());
+	system::IFile::success_t tableSucc;
+	m_file->read(tableSucc, m_tileOffsets.data(), sizeof(TiledGeoTexture::Header), m_tileOffsets.size() * sizeof(uint64_t));
+	if (!tableSucc)
+		return false;
+
+	const uint64_t tileBytes = TiledGeoTexture::getTileByteSize(m_header);
+	m_slotCount = static_cast<uint32_t>(core::max(m_memoryBudget / tileBytes, uint64_t(2u)));
+	m_tileMemory.resize(m_slotCount * tileBytes);
+	m_freeSlots.resize(m_slotCount);
+	for (uint32_t slot = 0u; slot < m_slotCount; ++slot)
+		m_freeSlots[slot] = m_slotCount - 1u - slot;
+	m_residentTiles = std::unique_ptr<core::LRUCache<uint64_t, uint32_t>>(new core::LRUCache<uint64_t, uint32_t>(m_slotCount));
+	return true;
+}
+
+uint32_t GeoTextureStreamer::selectMip(const ClipProjectionData& clipProjection, uint32_t2 viewportResolution) const
+{
+	const float64_t3x3& m = clipProjection.projectionToNDC;
+	// NDC is 2 units across the viewport, the rows of the 2x2 part scale world space into NDC x and y
+	const float64_t ndcPerWorldX = std::sqrt(m[0][0] * m[0][0] + m[0][1] * m[0][1]);
+	const float64_t ndcPerWorldY = std::sqrt(m[1][0] * m[1][0] + m[1][1] * m[1][1]);
+	if (ndcPerWorldX == 0.0 || ndcPerWorldY == 0.0 || viewportResolution.x == 0u || viewportResolution.y == 0u)
+		return m_header.mipCount - 1u;
+	const float64_t pixelWorldSize = core::min(2.0 / (viewportResolution.x * ndcPerWorldX), 2.0 / (viewportResolution.y * ndcPerWorldY));
+
+	const float64_t2 dirU = float64_t2(m_header.obb.dirU);
+	const float64_t texelWorldSize = std::sqrt(dirU.x * dirU.x + dirU.y * dirU.y) / m_header.extent.x;
+	const float64_t texelsPerPixel = pixelWorldSize / texelWorldSize;
+	if (!(texelsPerPixel > 1.0))
+		return 0u;
+	return core::min(static_cast<uint32_t>(std::floor(std::log2(texelsPerPixel))), m_header.mipCount - 1u);
+}
+
+std::span<const GeoTextureStreamer::ResidentTile> GeoTextureStreamer::update(const ClipProjectionData& clipProjection, uint32_t2 viewportResolution, FrameStats* frameStats)
+{
+	m_frameTiles.clear();
+	m_frameFallbacks.clear();
+	FrameStats frame = {};
+	if (!m_residentTiles)
+		return {};
+	m_stats.frameCount++;
+
+	const SpatialGrid::AABB worldAABB = SpatialGrid::getClipProjectionWorldAABB(clipProjection, float32_t2(0.0f, 0.0f));
+	uint32_t mip = selectMip(clipProjection, viewportResolution);
+	uint32_t2 minTile, maxTile;
+	bool visible = getVisibleTiles(worldAABB, mip, minTile, maxTile);
+	// every tile touched this frame (visible ones + at most as many stand-ins) has to fit in the cache at once, the last mip is a single tile so this always ends
+	while (visible && mip + 1u < m_header.mipCount && (maxTile.x - minTile.x + 1u) * (maxTile.y - minTile.y + 1u) > m_slotCount / 2u)
+		visible = getVisibleTiles(worldAABB, ++mip, minTile, maxTile);
+	frame.mip = mip;
+
+	if (visible)
+	{
+		frame.visibleTileCount = (maxTile.x - minTile.x + 1u) * (maxTile.y - minTile.y + 1u);
+		constexpr uint32_t InvalidSlot = ~0u;
+		auto evictionCallback = [&](const uint32_t& evictedSlot)
+			{
+				m_freeSlots.push_back(evictedSlot);
+				m_stats.evictionCount++;
+			};
+
+		uint32_t loadsLeft = m_maxTileLoadsPerFrame;
+		for (uint32_t y = minTile.y; y <= maxTile.y; ++y)
+		{
+			for (uint32_t x = minTile.x; x <= maxTile.x; ++x)
+			{
+				const TileKey key = { mip, uint32_t2(x, y) };
+				if (const uint32_t* slot = m_residentTiles->get(key.pack()))
+				{
+					frame.hitCount++;
+					m_frameTiles.push_back(makeResidentTile(key, *slot, false));
+					continue;
+				}
+
+				if (loadsLeft > 0u)
+				{
+					loadsLeft--;
+					// inserting first so a full cache evicts into `m_freeSlots`
+					uint32_t* inserted = m_residentTiles->insert(key.pack(), InvalidSlot, evictionCallback);
+					const uint32_t slot = m_freeSlots.back();
+					m_freeSlots.pop_back();
+					*inserted = slot;
+					if (loadTile(key, slot))
+					{
+						frame.loadCount++;
+						m_frameTiles.push_back(makeResidentTile(key, slot, true));
+						continue;
+					}
+					m_residentTiles->erase(key.pack());
+					m_freeSlots.push_back(slot);
+				}
+
+				// closest coarser resident tile, shared by all the visible tiles it covers
+				bool foundStandIn = false;
+				TileKey parent = key;
+				while (!foundStandIn && parent.mip + 1u < m_header.mipCount)
+				{
+					parent.mip++;
+					parent.coord = uint32_t2(parent.coord.x >> 1u, parent.coord.y >> 1u);
+					if (const uint32_t* slot = m_residentTiles->get(parent.pack()))
+					{
+						if (std::find(m_frameFallbacks.begin(), m_frameFallbacks.end(), parent.pack()) == m_frameFallbacks.end())
+						{
+							m_frameFallbacks.push_back(parent.pack());
+							m_frameTiles.push_back(makeResidentTile(parent, *slot, false));
+						}
+						foundStandIn = true;
+					}
+				}
+				if (foundStandIn)
+					frame.fallbackCount++;
+				else
+					frame.missingCount++;
+			}
+		}
+	}
+
+	m_stats.requestedTileCount += frame.visibleTileCount;
+	m_stats.hitCount += frame.hitCount;
+	m_stats.loadCount += frame.loadCount;
+	m_stats.fallbackCount += frame.fallbackCount;
+	m_stats.missingCount += frame.missingCount;
+	if (frameStats)
+		*frameStats = frame;
+	return m_frameTiles;
+}
+
+bool GeoTextureStreamer::getVisibleTiles(const SpatialGrid::AABB& worldAABB, uint32_t mip, uint32_t2& minTile, uint32_t2& maxTile) const
+{
+	// same OBB as the geotexture vertex shader: topLeft + u * dirU + v * dirV with dirV perpendicular to dirU
+	const float64_t2 dirU = float64_t2(m_header.obb.dirU);
+	const float64_t2 dirV = float64_t2(dirU.y, -dirU.x) * float64_t(m_header.obb.aspectRatio);
+	const float64_t lenSqU = dirU.x * dirU.x + dirU.y * dirU.y;
+	const float64_t lenSqV = dirV.x * dirV.x + dirV.y * dirV.y;
+	if (lenSqU == 0.0 || lenSqV == 0.0)
+		return false;
+
+	float64_t2 minUV = float64_t2(0.0, 0.0);
+	float64_t2 maxUV = float64_t2(1.0, 1.0);
+	// an infinite AABB (degenerate projection) sees the whole texture
+	if (std::isfinite(worldAABB.min.x) && std::isfinite(worldAABB.min.y) && std::isfinite(worldAABB.max.x) && std::isfinite(worldAABB.max.y))
+	{
+		const float64_t2 corners[4u] = {
+			worldAABB.min,
+			float64_t2(worldAABB.max.x, worldAABB.min.y),
+			float64_t2(worldAABB.min.x, worldAABB.max.y),
+			worldAABB.max,
+		};
+		for (uint32_t i = 0u; i < 4u; ++i)
+		{
+			const float64_t2 d = corners[i] - m_header.obb.topLeft;
+			const float64_t2 uv = float64_t2((d.x * dirU.x + d.y * dirU.y) / lenSqU, (d.x * dirV.x + d.y * dirV.y) / lenSqV);
+			minUV = (i == 0u) ? uv : float64_t2(core::min(minUV.x, uv.x), core::min(minUV.y, uv.y));
+			maxUV = (i == 0u) ? uv : float64_t2(core::max(maxUV.x, uv.x), core::max(maxUV.y, uv.y));
+		}
+		if (maxUV.x < 0.0 || maxUV.y < 0.0 || minUV.x > 1.0 || minUV.y > 1.0)
+			return false;
+	}
+
+	const uint32_t2 mipExtent = TiledGeoTexture::getMipExtent(m_header, mip);
+	const uint32_t2 tileCount = TiledGeoTexture::getMipTileCount(m_header, mip);
+	for (uint32_t axis = 0u; axis < 2u; ++axis)
+	{
+		auto getTile = [&](float64_t uv)
+			{
+				return static_cast<uint32_t>(std::clamp(std::floor(uv * mipExtent[axis] / m_header.tileSize), 0.0, float64_t(tileCount[axis] - 1u)));
+			};
+		minTile[axis] = getTile(minUV[axis]);
+		maxTile[axis] = getTile(maxUV[axis]);
+	}
+	return true;
+}
+
+bool GeoTextureStreamer::loadTile(const TileKey& key, uint32_t slot)
+{
+	const uint32_t2 tileCount = TiledGeoTexture::getMipTileCount(m_header, key.mip);
+	const uint64_t tileBytes = TiledGeoTexture::getTileByteSize(m_header);
+	system::IFile::success_t succ;
+	m_file->read(succ, m_tileMemory.data() + slot * tileBytes, m_tileOffsets[m_mipFirstTile[key.mip] + key.coord.y * tileCount.x + key.coord.x], tileBytes);
+	if (!succ)
+		return false;
+	m_stats.bytesRead += tileBytes;
+	return true;
+}
+
+GeoTextureStreamer::ResidentTile GeoTextureStreamer::makeResidentTile(const TileKey& key, uint32_t slot, bool loadedThisFrame) const
+{
+	const float64_t2 mipExtent = float64_t2(TiledGeoTexture::getMipExtent(m_header, key.mip));
+	const float64_t tileSize = m_header.tileSize;
+	ResidentTile ret = {};
+	ret.key = key;
+	ret.slot = slot;
+	ret.loadedThisFrame = loadedThisFrame;
+	ret.minUV = float32_t2(float64_t2(key.coord) * tileSize / mipExtent);
+	ret.maxUV = float32_t2((float64_t2(key.coord) + float64_t2(1.0, 1.0)) * tileSize / mipExtent);
+	return ret;
+}
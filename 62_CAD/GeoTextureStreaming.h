@@ -0,0 +1,154 @@
+#pragma once
+
+#include "SpatialGrid.h"
+#include "shaders/geotexture/common.hlsl"
+
+#include <functional>
+#include <nbl/core/containers/LRUCache.h>
+
+// On-disk layout of a geo texture too large to upload whole: a mip pyramid of RGBA8 texels cut into fixed size square tiles
+// [Header][one uint64_t file offset per tile, mip 0 first, tiles row major within a mip][tile payloads in any order]
+// Every tile is `tileSize * tileSize` texels, the ones on the right and bottom edges are padded by repeating the last texel so clamped sampling doesn't bleed
+// The last mip is the first one fitting in a single tile
+class TiledGeoTexture
+{
+public:
+	static constexpr uint32_t Magic = 0x31585447u; // "GTX1"
+	static constexpr uint32_t Version = 1u;
+	static constexpr uint32_t BytesPerTexel = 4u;
+	static constexpr uint32_t MaxMipCount = 24u;
+
+	struct Header
+	{
+		uint32_t magic = Magic;
+		uint32_t version = Version;
+		uint32_t2 extent = uint32_t2(0u, 0u); // mip 0 in texels
+		uint32_t tileSize = 0u;
+		uint32_t mipCount = 0u;
+		GeoTextureOBB obb = {}; // where mip 0 goes in world space
+	};
+
+	// fills `dst` with `rowCount` tightly packed RGBA8 rows of the source image starting at `firstRow`, returning false aborts the conversion
+	using ReadRowsFunc = std::function<bool(uint32_t firstRow, uint32_t rowCount, uint8_t* dst)>;
+
+	// Reads the source a band of `tileSize` rows at a time, so images that don't fit in memory (or come from a decoder/another file) can be converted, memory use is around two bands of mip 0 (`2 * 4 * extent.x * tileSize` bytes)
+	// Mips are 2x2 box filtered on the stored values (no sRGB decoding), odd extents round down like GPU mips do
+	static bool convert(nbl::system::ISystem* system, const nbl::system::path& outputPath, uint32_t2 extent, const GeoTextureOBB& obb, const ReadRowsFunc& readRows, uint32_t tileSize = 256u);
+	// Mip 0 of an already loaded R8G8B8A8 image (UNORM or SRGB, the texels are copied as is), other formats need converting with the asset filters first
+	static bool convert(nbl::system::ISystem* system, const nbl::system::path& outputPath, const asset::ICPUImage* image, const GeoTextureOBB& obb, uint32_t tileSize = 256u);
+
+	static inline uint32_t2 getMipExtent(const Header& header, uint32_t mip)
+	{
+		return uint32_t2(core::max(header.extent.x >> mip, 1u), core::max(header.extent.y >> mip, 1u));
+	}
+
+	static inline uint32_t2 getMipTileCount(const Header& header, uint32_t mip)
+	{
+		const uint32_t2 mipExtent = getMipExtent(header, mip);
+		return uint32_t2((mipExtent.x + header.tileSize - 1u) / header.tileSize, (mipExtent.y + header.tileSize - 1u) / header.tileSize);
+	}
+
+	static inline uint32_t getMipCount(uint32_t2 extent, uint32_t tileSize)
+	{
+		uint32_t ret = 1u;
+		while (ret < MaxMipCount && core::max(core::max(extent.x >> (ret - 1u), 1u), core::max(extent.y >> (ret - 1u), 1u)) > tileSize)
+			ret++;
+		return ret;
+	}
+
+	static inline uint64_t getTileByteSize(const Header& header) { return uint64_t(header.tileSize) * header.tileSize * BytesPerTexel; }
+};
+
+// Keeps the tiles of a `TiledGeoTexture` file needed by the current view resident in a fixed memory budget
+// Every frame `update` picks the mip matching the view's texel density, loads the visible tiles of that mip that aren't resident yet (at most `maxTileLoadsPerFrame` of them) and
+// evicts the least recently used tiles to make room, tiles that couldn't be loaded this frame are stood in for by their closest resident coarser tile
+// Resident tiles live in `getSlotCount()` fixed slots of one allocation, so a renderer can mirror the slots 1:1 in a texture array and upload only the tiles loaded this frame
+// Loads are synchronous reads on the calling thread, `maxTileLoadsPerFrame` bounds how long `update` can take
+class GeoTextureStreamer
+{
+public:
+	struct TileKey
+	{
+		uint32_t mip;
+		uint32_t2 coord;
+
+		inline uint64_t pack() const { return (uint64_t(mip) << 56u) | (uint64_t(coord.y) << 28u) | uint64_t(coord.x); }
+	};
+
+	struct ResidentTile
+	{
+		TileKey key;
+		uint32_t slot;
+		bool loadedThisFrame; // has to be (re)uploaded
+		// part of the whole texture covered by this tile, including padding texels past the edges (they map past 1.0)
+		float32_t2 minUV;
+		float32_t2 maxUV;
+	};
+
+	struct FrameStats
+	{
+		uint32_t mip = 0u; // `selectMip`, or coarser if the view needed too many tiles
+		uint32_t visibleTileCount = 0u; // at `mip`
+		uint32_t hitCount = 0u; // visible tiles already resident
+		uint32_t loadCount = 0u;
+		uint32_t fallbackCount = 0u; // visible tiles drawn with a coarser resident tile instead
+		uint32_t missingCount = 0u; // visible tiles with nothing resident to stand in
+	};
+
+	struct Stats
+	{
+		uint64_t frameCount = 0ull;
+		uint64_t requestedTileCount = 0ull;
+		uint64_t hitCount = 0ull;
+		uint64_t loadCount = 0ull;
+		uint64_t evictionCount = 0ull;
+		uint64_t fallbackCount = 0ull;
+		uint64_t missingCount = 0ull;
+		uint64_t bytesRead = 0ull;
+	};
+
+	// `memoryBudget` in bytes, rounded down to a whole number of tiles (at least 2) once the file is opened
+	GeoTextureStreamer(core::smart_refctd_ptr<system::ISystem>&& system, uint64_t memoryBudget, uint32_t maxTileLoadsPerFrame = 32u)
+		: m_system(std::move(system))
+		, m_memoryBudget(memoryBudget)
+		, m_maxTileLoadsPerFrame(maxTileLoadsPerFrame)
+	{}
+
+	// Reads the header and tile table, drops whatever was resident from a previous file
+	bool open(const nbl::system::path& path);
+
+	inline const TiledGeoTexture::Header& getHeader() const { return m_header; }
+	inline uint32_t getSlotCount() const { return m_slotCount; }
+	inline const uint8_t* getSlotTexels(uint32_t slot) const { return m_tileMemory.data() + slot * TiledGeoTexture::getTileByteSize(m_header); }
+	inline const Stats& getStats() const { return m_stats; }
+
+	// Mip whose texels are closest to (but not bigger than) a pixel of `viewportResolution` under `clipProjection`, clamped to the file's mips
+	uint32_t selectMip(const ClipProjectionData& clipProjection, uint32_t2 viewportResolution) const;
+
+	// Makes the visible tiles resident and returns what to draw this frame: visible tiles of the selected mip, or a coarser resident tile in place of several of them
+	// If the view needs more tiles than half the slots, a coarser mip is used so the tiles returned can never evict each other
+	std::span<const ResidentTile> update(const ClipProjectionData& clipProjection, uint32_t2 viewportResolution, FrameStats* frameStats = nullptr);
+
+protected:
+	// range of tiles of `mip` covering the part of the texture inside `worldAABB`, false if it doesn't overlap the texture
+	bool getVisibleTiles(const SpatialGrid::AABB& worldAABB, uint32_t mip, uint32_t2& minTile, uint32_t2& maxTile) const;
+	bool loadTile(const TileKey& key, uint32_t slot);
+	ResidentTile makeResidentTile(const TileKey& key, uint32_t slot, bool loadedThisFrame) const;
+
+	TiledGeoTexture::Header m_header = {};
+	std::vector<uint64_t> m_tileOffsets;
+	std::vector<uint32_t> m_mipFirstTile; // index of each mip's first tile in `m_tileOffsets`
+	core::smart_refctd_ptr<system::ISystem> m_system;
+	core::smart_refctd_ptr<system::IFile> m_file;
+
+	uint64_t m_memoryBudget;
+	uint32_t m_maxTileLoadsPerFrame;
+	uint32_t m_slotCount = 0u;
+	std::vector<uint8_t> m_tileMemory;
+	std::vector<uint32_t> m_freeSlots;
+	std::unique_ptr<core::LRUCache<uint64_t, uint32_t>> m_residentTiles; // packed `TileKey` -> slot
+
+	std::vector<ResidentTile> m_frameTiles;
+	std::vector<uint64_t> m_frameFallbacks; // coarser tiles already in `m_frameTiles`
+	Stats m_stats = {};
+};
@@ -5,6 +5,12 @@
 #include <tgmath.h>
 #include <nbl/builtin/hlsl/shapes/util.hlsl>
 
+#include <thread>
+#include <atomic>
+
+#include "IntervalTree.h"
+#include "ImplicitTreap.h"
+
 // #define DEBUG_HATCH_VISUALLY
 
 using namespace nbl;
@@ -133,7 +139,7 @@ std::array<double, 2> Hatch::Segment::intersect(const Segment& other) const
 	return result;
 }
 
-Hatch::Hatch(std::span<CPolyline> lines, const MajorAxis majorAxis, nbl::system::logger_opt_smart_ptr logger, int32_t* debugStepPtr, const std::function<void(CPolyline, LineStyleInfo)>& debugOutput)
+Hatch::Hatch(std::span<CPolyline> lines, const MajorAxis majorAxis, nbl::system::logger_opt_smart_ptr logger, int32_t* debugStepPtr, const std::function<void(CPolyline, LineStyleInfo)>& debugOutput, std::pmr::memory_resource* scratchMemory)
 {
 	// this threshsold is used to decide when to consider minor position to be 
 	// the same and check tangents because intersection algorithms has rounding 
@@ -141,10 +147,19 @@ Hatch::Hatch(std::span<CPolyline> lines, const MajorAxis majorAxis, nbl::system:
 	constexpr float64_t MinorPositionComparisonThreshhold = 1e-3;
 	constexpr float64_t TangentComparisonThreshhold = 1e-7;
 
-	std::vector<QuadraticBezier> beziers; // Referenced into by the segments
-	std::stack<Segment> starts; // Next segments sorted by start points
-	std::stack<double> ends; // Next end points
-	std::priority_queue<double, std::vector<double>, std::greater<double> > intersections; // Next intersection points as major coordinate
+	std::pmr::vector<QuadraticBezier> beziers(scratchMemory); // Referenced into by the segments
+	std::stack<Segment, std::pmr::deque<Segment>> starts(std::pmr::deque<Segment>{ scratchMemory }); // Next segments sorted by start points
+	std::stack<const QuadraticBezier*, std::pmr::deque<const QuadraticBezier*>> ends(std::pmr::deque<const QuadraticBezier*>{ scratchMemory }); // Next segments sorted by end points
+	// the curves which cross, their order swaps there
+	struct IntersectionEvent
+	{
+		double major;
+		const QuadraticBezier* lhs;
+		const QuadraticBezier* rhs;
+
+		bool operator>(const IntersectionEvent& other) const { return major > other.major; }
+	};
+	std::priority_queue<IntersectionEvent, std::pmr::vector<IntersectionEvent>, std::greater<IntersectionEvent> > intersections(std::greater<IntersectionEvent>{}, std::pmr::vector<IntersectionEvent>(scratchMemory)); // Next intersection points as major coordinate
 	double maxMajor;
 
 	int major = (int)majorAxis;
@@ -191,7 +206,7 @@ Hatch::Hatch(std::span<CPolyline> lines, const MajorAxis majorAxis, nbl::system:
 #endif
 
 	{
-		std::vector<Segment> segments;
+		std::pmr::vector<Segment> segments(scratchMemory);
 		for (CPolyline& polyline : lines)
 		{
 			for (uint32_t secIdx = 0; secIdx < polyline.getSectionsCount(); secIdx ++)
@@ -275,6 +290,7 @@ Hatch::Hatch(std::span<CPolyline> lines, const MajorAxis majorAxis, nbl::system:
 			}
 		}
 
+		segments.reserve(beziers.size());
 		for (uint32_t bezierIdx = 0; bezierIdx < beziers.size(); bezierIdx++)
 		{
 			auto hatchBezier = &beziers[bezierIdx];
@@ -297,7 +313,7 @@ Hatch::Hatch(std::span<CPolyline> lines, const MajorAxis majorAxis, nbl::system:
 
 		std::sort(segments.begin(), segments.end(), [&](const Segment& a, const Segment& b) { return a.originalBezier->P2[major] > b.originalBezier->P2[major]; });
 		for (Segment& segment : segments)
-			ends.push(segment.originalBezier->P2[major]);
+			ends.push(segment.originalBezier);
 		maxMajor = segments.front().originalBezier->P2[major];
 	}
 
@@ -306,7 +322,29 @@ Hatch::Hatch(std::span<CPolyline> lines, const MajorAxis majorAxis, nbl::system:
 #endif
 
 	// Sweep line algorithm
-	std::vector<Segment> activeCandidates; // Set of active candidates for neighbor search in sweep line
+	// Active candidates in minor order at the sweep position, that order only changes at start, end and intersection events (in between no two curves cross)
+	// so instead of keys (which move with the sweep) they're kept in a treap which is searched with `candidateComparator` evaluated at the sweep position
+	struct ActiveCandidate
+	{
+		const QuadraticBezier* bezier = nullptr; // nullptr once the candidate ended
+		uint32_t minorExtentsHandle = ~0u;
+		bool touched = false; // it's pair might have changed since the sweep last advanced
+		// hatch box between this candidate and the next one, open since `boxStartMajor`, only candidates at even positions have one
+		const QuadraticBezier* boxPartner = nullptr;
+		double boxStartMajor = 0.0;
+		double boxStartT = 0.0;
+		double boxPartnerStartT = 0.0;
+	};
+	using candidate_handle_t = ImplicitTreap<ActiveCandidate>::handle_t;
+	constexpr candidate_handle_t InvalidCandidateHandle = ImplicitTreap<ActiveCandidate>::InvalidHandle;
+	ImplicitTreap<ActiveCandidate> activeCandidates(scratchMemory);
+	activeCandidates.reserve(static_cast<uint32_t>(beziers.size()));
+	std::pmr::vector<candidate_handle_t> bezierCandidateHandles(beziers.size(), InvalidCandidateHandle, scratchMemory); // indexed like `beziers`
+	std::pmr::vector<candidate_handle_t> touchedCandidates(scratchMemory);
+	std::pmr::vector<uint32_t> touchedRanks(scratchMemory);
+	// Same candidates indexed by their minor axis extents, so a new candidate is only tested for intersections against the ones it can overlap
+	IntervalTree<double, const QuadraticBezier*> activeCandidatesMinorExtents(scratchMemory);
+	activeCandidatesMinorExtents.reserve(static_cast<uint32_t>(beziers.size()));
 
 	// if we weren't spawning quads, we could just have unsorted `vector<Bezier*>`
 	auto candidateComparator = [&](const Segment& lhs, const Segment& rhs)
@@ -426,14 +464,170 @@ Hatch::Hatch(std::span<CPolyline> lines, const MajorAxis majorAxis, nbl::system:
 #endif
 		return _lhs < _rhs;
 	};
-	auto addToCandidateSet = [&](const Segment& entry)
+	// Bezier is contained in the convex hull of it's control points, so their minor extents bound the whole curve
+	auto getMinorExtents = [&](const QuadraticBezier& bezier) -> std::pair<double, double>
+	{
+		const double p0 = bezier.P0[minor], p1 = bezier.P1[minor], p2 = bezier.P2[minor];
+		return { std::min(std::min(p0, p1), p2), std::max(std::max(p0, p1), p2) };
+	};
+	// The curves are monotonic in major, so every major coordinate within a curve's extents has one t
+	auto getTAtMajor = [&](const QuadraticBezier& bezier, double majorCoord) -> double
+	{
+		if (majorCoord <= bezier.P0[major])
+			return 0.0;
+		if (majorCoord >= bezier.P2[major])
+			return 1.0;
+		const double t = intersectOrtho(bezier, majorCoord, major);
+		// Due to precision, if the curve is right at one of it's ends, intersectOrtho may return nan
+		if (core::isnan(t))
+			return (majorCoord - bezier.P0[major] < bezier.P2[major] - majorCoord) ? 0.0 : 1.0;
+		return t;
+	};
+	auto getSegmentAtMajor = [&](const QuadraticBezier* bezier, double majorCoord) -> Segment
+	{
+		Segment segment;
+		segment.originalBezier = bezier;
+		segment.t_start = getTAtMajor(*bezier, majorCoord);
+		segment.t_end = 1.0;
+		return segment;
+	};
+	auto getCandidateComparatorAt = [&](double sweepMajor)
+	{
+		return [&, sweepMajor](const ActiveCandidate& lhs, const ActiveCandidate& rhs)
+		{
+			return candidateComparator(getSegmentAtMajor(lhs.bezier, sweepMajor), getSegmentAtMajor(rhs.bezier, sweepMajor));
+		};
+	};
+	// Any change to the order is remembered until the sweep advances, only the pairs around it need new hatch boxes
+	auto touchCandidate = [&](candidate_handle_t handle)
+	{
+		ActiveCandidate& candidate = activeCandidates.getValue(handle);
+		if (candidate.touched)
+			return;
+		candidate.touched = true;
+		touchedCandidates.push_back(handle);
+	};
+
+	// Transform curves into AABB UV space and turn them into quadratic coefficients
+	// so we wont need to convert here
+	auto transformCurves = [](Hatch::QuadraticBezier bezier, float64_t2 aabbMin, float64_t2 aabbMax, float32_t2* output) {
+		auto rcpAabbExtents = float64_t2(1.0, 1.0) / (aabbMax - aabbMin);
+		auto transformedBezier = QuadraticBezier::construct(
+			(bezier.P0 - aabbMin) * rcpAabbExtents,
+			(bezier.P1 - aabbMin) * rcpAabbExtents,
+			(bezier.P2 - aabbMin) * rcpAabbExtents
+		);
+		auto quadratic = QuadraticCurve::constructFromBezier(transformedBezier);
+
+		if (isLineSegment(transformedBezier))
+			quadratic.A = float64_t2(0.0);
+
+		output[0] = (quadratic.A);
+		output[1] = (quadratic.B);
+		output[2] = (quadratic.C);
+		};
+	// Ends the box of `candidate` and it's partner at `endMajor`, a box spans every advance of the sweep while the pair stays the same
+	auto closeHatchBox = [&](ActiveCandidate& candidate, double endMajor)
+	{
+		if (!candidate.boxPartner)
+			return;
+		if (endMajor > candidate.boxStartMajor)
+		{
+			CurveHatchBox curveBox;
+
+			auto splitCurveMin = *candidate.bezier;
+			splitCurveMin.splitFromMinToMax(candidate.boxStartT, getTAtMajor(*candidate.bezier, endMajor));
+			auto splitCurveMax = *candidate.boxPartner;
+			splitCurveMax.splitFromMinToMax(candidate.boxPartnerStartT, getTAtMajor(*candidate.boxPartner, endMajor));
+
+			assert(splitCurveMin.evaluate(0.0)[major] <= splitCurveMin.evaluate(1.0)[major]);
+			assert(splitCurveMax.evaluate(0.0)[major] <= splitCurveMax.evaluate(1.0)[major]);
+
+			auto curveMinAabb = getBezierBoundingBoxMinor(splitCurveMin);
+			auto curveMaxAabb = getBezierBoundingBoxMinor(splitCurveMax);
+			curveBox.aabbMin = float64_t2(std::min(curveMinAabb.first.x, curveMaxAabb.first.x), candidate.boxStartMajor);
+			curveBox.aabbMax = float64_t2(std::max(curveMinAabb.second.x, curveMaxAabb.second.x), endMajor);
+
+#ifdef DEBUG_HATCH_VISUALLY
+			if (debugOutput && step == debugStep)
+			{
+				drawDebugBezier(splitCurveMin, float64_t4(1.0, 0.0, 0.0, 1.0));
+				drawDebugBezier(splitCurveMax, float64_t4(0.0, 1.0, 0.0, 1.0));
+			}
+#endif
+
+			transformCurves(splitCurveMin, curveBox.aabbMin, curveBox.aabbMax, &curveBox.curveMin[0]);
+			transformCurves(splitCurveMax, curveBox.aabbMin, curveBox.aabbMax, &curveBox.curveMax[0]);
+
+			hatchBoxes.push_back(curveBox);
+		}
+		candidate.boxPartner = nullptr;
+	};
+	// Candidates are paired up in order (0 with 1, 2 with 3 and so on), ends the boxes of the pairs which changed since the sweep last advanced and opens the new ones at `sweepMajor`
+	// Pairs are visited from every touched candidate until one that didn't change, an odd number of candidates starting or ending together shifts all pairs after them
+	// (which only happens for broken input, because starts and ends of a closed loop come in pairs)
+	auto updateHatchBoxes = [&](double sweepMajor)
+	{
+		touchedRanks.clear();
+		for (const candidate_handle_t handle : touchedCandidates)
+		{
+			ActiveCandidate& candidate = activeCandidates.getValue(handle);
+			// ended, or a handle reused and touched twice
+			if (!candidate.bezier || !candidate.touched)
+				continue;
+			candidate.touched = false;
+			touchedRanks.push_back(activeCandidates.getRank(handle));
+		}
+		touchedCandidates.clear();
+		std::sort(touchedRanks.begin(), touchedRanks.end());
+
+		const uint32_t candidatesSize = activeCandidates.size();
+		// returns whether the pair starting at `leftRank` already had it's box open
+		auto updatePair = [&](uint32_t leftRank) -> bool
+		{
+			ActiveCandidate& left = activeCandidates.getValue(activeCandidates.at(leftRank));
+			ActiveCandidate* right = (leftRank + 1u < candidatesSize) ? &activeCandidates.getValue(activeCandidates.at(leftRank + 1u)) : nullptr;
+			// the right one could have been the left one of a pair before
+			if (right)
+				closeHatchBox(*right, sweepMajor);
+			if (left.boxPartner == (right ? right->bezier : nullptr))
+				return true;
+			closeHatchBox(left, sweepMajor);
+			if (right)
+			{
+				left.boxPartner = right->bezier;
+				left.boxStartMajor = sweepMajor;
+				left.boxStartT = getTAtMajor(*left.bezier, sweepMajor);
+				left.boxPartnerStartT = getTAtMajor(*right->bezier, sweepMajor);
+			}
+			return false;
+		};
+
+		size_t touchedIdx = 0u;
+		while (touchedIdx < touchedRanks.size())
+		{
+			for (uint32_t leftRank = touchedRanks[touchedIdx] & ~1u; leftRank < candidatesSize; leftRank += 2u)
+			{
+				bool pairTouched = false;
+				for (; touchedIdx < touchedRanks.size() && touchedRanks[touchedIdx] <= leftRank + 1u; touchedIdx++)
+					pairTouched = true;
+				// every pair after an unchanged one is unchanged as well, until the next touched candidate
+				if (updatePair(leftRank) && !pairTouched)
+					break;
+			}
+		}
+	};
+	auto addToCandidateSet = [&](const Segment& entry, double sweepMajor)
 	{
 		if (entry.isStraightLineConstantMajor())
 			return;
-		// Look for intersections among active candidates
-		// this is a little O(n^2) but only in the `n=candidates.size()`
-		for (const auto& segment : activeCandidates)
+		// Look for intersections among active candidates whose minor extents overlap the entry's,
+		// curves with disjoint extents can't intersect
+		const auto entryExtents = getMinorExtents(*entry.originalBezier);
+		activeCandidatesMinorExtents.query(entryExtents.first, entryExtents.second, [&](const QuadraticBezier* candidateBezier)
 		{
+			// `Segment::intersect` only reports intersections past `t_start`, the ones before the sweep position don't change the order anymore
+			const Segment segment = getSegmentAtMajor(candidateBezier, sweepMajor);
 			// find intersections entry vs segment
 			auto intersectionPoints = entry.intersect(segment);
 #ifdef DEBUG_HATCH_VISUALLY
@@ -458,10 +652,54 @@ Hatch::Hatch(std::span<CPolyline> lines, const MajorAxis majorAxis, nbl::system:
 			{
 				if (nbl::core::isnan(intersectionPoints[i]))
 					continue;
-				intersections.push(segment.originalBezier->evaluate(intersectionPoints[i])[major]);
+				const double intersectionMajor = segment.originalBezier->evaluate(intersectionPoints[i])[major];
+				if (intersectionMajor >= sweepMajor)
+					intersections.push({ intersectionMajor, entry.originalBezier, segment.originalBezier });
 			}
-		}
-		activeCandidates.push_back(entry);
+		});
+
+		ActiveCandidate candidate;
+		candidate.bezier = entry.originalBezier;
+		candidate.minorExtentsHandle = activeCandidatesMinorExtents.insert(entryExtents.first, entryExtents.second, entry.originalBezier);
+		const candidate_handle_t handle = activeCandidates.insert(candidate, getCandidateComparatorAt(sweepMajor));
+		bezierCandidateHandles[entry.originalBezier - beziers.data()] = handle;
+		touchCandidate(handle);
+	};
+	auto removeFromCandidateSet = [&](const QuadraticBezier* bezier, double sweepMajor)
+	{
+		candidate_handle_t& handle = bezierCandidateHandles[bezier - beziers.data()];
+		// lines constant in major never become candidates
+		if (handle == InvalidCandidateHandle)
+			return;
+		ActiveCandidate& candidate = activeCandidates.getValue(handle);
+		closeHatchBox(candidate, sweepMajor);
+		activeCandidatesMinorExtents.erase(candidate.minorExtentsHandle);
+		candidate.bezier = nullptr;
+
+		const uint32_t rank = activeCandidates.getRank(handle);
+		activeCandidates.erase(handle);
+		handle = InvalidCandidateHandle;
+		// pairs shift from here on, the neighbours are where the change starts
+		if (rank > 0u)
+			touchCandidate(activeCandidates.at(rank - 1u));
+		if (rank < activeCandidates.size())
+			touchCandidate(activeCandidates.at(rank));
+	};
+	// At an intersection the curves swap, re-sort the candidates between the two (usually just them, unless more curves cross at the same point)
+	auto reorderCandidates = [&](const IntersectionEvent& intersection, double sweepMajor)
+	{
+		const candidate_handle_t lhsHandle = bezierCandidateHandles[intersection.lhs - beziers.data()];
+		const candidate_handle_t rhsHandle = bezierCandidateHandles[intersection.rhs - beziers.data()];
+		// one of them ended right at the intersection
+		if (lhsHandle == InvalidCandidateHandle || rhsHandle == InvalidCandidateHandle)
+			return;
+		uint32_t first = activeCandidates.getRank(lhsHandle);
+		uint32_t last = activeCandidates.getRank(rhsHandle);
+		if (first > last)
+			std::swap(first, last);
+		activeCandidates.sortRange(first, last, getCandidateComparatorAt(sweepMajor));
+		for (uint32_t rank = first; rank <= last; rank++)
+			touchCandidate(activeCandidates.at(rank));
 	};
 
 	double lastMajor = starts.top().originalBezier->evaluate(starts.top().t_start)[major];
@@ -473,226 +711,149 @@ Hatch::Hatch(std::span<CPolyline> lines, const MajorAxis majorAxis, nbl::system:
 		bool isCurrentDebugStep = step == debugStep;
 #endif
 
-		double newMajor;
-		bool addStartSegmentToCandidates = false;
-
 		if (ends.empty())
 		{
 			logger.log("Hatch Creation Failure: `ends` stack is empty in the main loop", nbl::system::ILogger::ELL_ERROR);
 			_NBL_DEBUG_BREAK_IF(true); // This shouldn't happen, TODO: LOG
 			break;
 		}
-		const double maxMajorEnds = ends.top();
+		const double maxMajorEnds = ends.top()->P2[major];
 
 		const Segment nextStartEvent = starts.empty() ? Segment() : starts.top();
 		const double minMajorStart = nextStartEvent.originalBezier ? nextStartEvent.originalBezier->evaluate(nextStartEvent.t_start)[major] : 0.0;
 
 		// We check which event, within start, end and intersection events have the smallest
 		// major coordinate at this point
-		auto intersectionVisit = [&]()
-		{
-			const double newMajor = intersections.top();
-#ifdef DEBUG_HATCH_VISUALLY
-			if (debugOutput && isCurrentDebugStep)
-				drawDebugLine(float64_t2(-1000.0, newMajor), float64_t2(1000.0, newMajor), float32_t4(0.0, 0.0, 0.8, 1.0));
-#endif
-			intersections.pop(); // O(n)
-			return newMajor;
-		};
-
-		// next start event is before next end event
-		if (nextStartEvent.originalBezier && minMajorStart < maxMajorEnds)
+		enum class EventType : uint8_t { START, END, INTERSECTION };
+		EventType eventType;
+		double newMajor;
+		// next start event is before next end event and next intersection event
+		if (nextStartEvent.originalBezier && minMajorStart < maxMajorEnds && (intersections.empty() || minMajorStart < intersections.top().major)) // priority queue top() is O(1)
 		{
-			// next start event is before next intersection event
-			// (start event)
-			if (intersections.empty() || minMajorStart < intersections.top()) // priority queue top() is O(1)
-			{
-				starts.pop();
-				newMajor = minMajorStart;
-				addStartSegmentToCandidates = true;
-#ifdef DEBUG_HATCH_VISUALLY
-				if (debugOutput && isCurrentDebugStep)
-					drawDebugLine(float64_t2(-1000.0, newMajor), float64_t2(1000.0, newMajor), float32_t4(0.0, 0.8, 0.0, 1.0));
-#endif
-			}
-			// (intersection event)
-			else newMajor = intersectionVisit();
+			eventType = EventType::START;
+			newMajor = minMajorStart;
 		}
 		// next intersection event is before next end event
-		// (intersection event)
-		else if (!intersections.empty() && intersections.top() < maxMajorEnds)
-			newMajor = intersectionVisit();
+		else if (!intersections.empty() && intersections.top().major < maxMajorEnds)
+		{
+			eventType = EventType::INTERSECTION;
+			newMajor = intersections.top().major;
+		}
 		else
 		{
-			// (end event)
+			eventType = EventType::END;
 			newMajor = maxMajorEnds;
-			ends.pop();
-#ifdef DEBUG_HATCH_VISUALLY
-			if (debugOutput && isCurrentDebugStep)
-				drawDebugLine(float64_t2(-1000.0, newMajor), float64_t2(1000.0, newMajor), float32_t4(0.0, 0.0, 0.8, 1.0));
-#endif
-			//std::cout << "End event at " << newMajor << "\n";
 		}
-		// spawn quads for the previous iterations if we advanced
-
-		if (newMajor > lastMajor) 
-		{
-			const auto candidatesSize = std::distance(activeCandidates.begin(),activeCandidates.end());
-			// Because n4ce works on loops, this must be `true` in almost every case, but can fail at times, because we skip adding beziers (lines) almost constant in major direction
-			if (candidatesSize % 2u == 0u)
-			{
 #ifdef DEBUG_HATCH_VISUALLY
-				if (debugOutput && isCurrentDebugStep)
-					drawDebugLine(float64_t2(-1000.0, lastMajor), float64_t2(1000.0, lastMajor), float32_t4(0.1, 0.1, 0.0, 0.5));
-#endif
-				// trim
-				if ((candidatesSize % 2u) != 0u)
-				{
-					logger.log("Hatch Creation Failure: candidatesSize is odd", nbl::system::ILogger::ELL_ERROR);
-					_NBL_DEBUG_BREAK_IF(true); // input polyline/polygon 
-				}
-#ifdef DEBUG_HATCH_VISUALLY
-				if (candidatesSize % 2u == 1u)
-				{
-					for (uint32_t i = 0u; i < candidatesSize; i++)
-					{
-						const Segment& item = activeCandidates[i];
-						auto curveMinEnd = intersectOrtho(*item.originalBezier, newMajor, major);
-						auto splitCurveMin = *item.originalBezier;
-						splitCurveMin.splitCurveFromMinToMax(item.t_start, core::isnan(curveMinEnd) ? 1.0 : curveMinEnd);
-
-						drawDebugBezier(splitCurveMin, (i == candidatesSize - 1) ? float32_t4(0.0, 0.0, 1.0, 1.0) : float32_t4(1.0, 0.0, 0.0, 1.0));
-						if (i == candidatesSize - 1)
-						{
-							printf(std::format("problematic guy: ({}, {}), ({}, {}), ({}, {})",
-								splitCurveMin.P0.x, splitCurveMin.P0.y,
-								splitCurveMin.P1.x, splitCurveMin.P1.y,
-								splitCurveMin.P2.x, splitCurveMin.P2.y
-							).c_str());
-						}
-					}
-				}
-#endif
-				for (auto i = 0u; i < (candidatesSize / 2) * 2;)
-				{
-					const Segment& left = activeCandidates[i++];
-					const Segment& right = activeCandidates[i++];
-
-					CurveHatchBox curveBox;
-
-					// Due to precision, if the curve is right at the end, intersectOrtho may return nan
-					auto curveMinEnd = intersectOrtho(*left.originalBezier, newMajor, major);
-					auto curveMaxEnd = intersectOrtho(*right.originalBezier, newMajor, major);
-
-					auto splitCurveMin = *left.originalBezier;
-					splitCurveMin.splitFromMinToMax(left.t_start, core::isnan(curveMinEnd) ? 1.0 : curveMinEnd);
-					auto splitCurveMax = *right.originalBezier;
-					splitCurveMax.splitFromMinToMax(right.t_start, core::isnan(curveMaxEnd) ? 1.0 : curveMaxEnd);
-
-					assert(splitCurveMin.evaluate(0.0)[major] <= splitCurveMin.evaluate(1.0)[major]);
-					assert(splitCurveMax.evaluate(0.0)[major] <= splitCurveMax.evaluate(1.0)[major]);
-
-					auto curveMinAabb = getBezierBoundingBoxMinor(splitCurveMin);
-					auto curveMaxAabb = getBezierBoundingBoxMinor(splitCurveMax);
-					curveBox.aabbMin = float64_t2(std::min(curveMinAabb.first.x, curveMaxAabb.first.x), lastMajor);
-					curveBox.aabbMax = float64_t2(std::max(curveMinAabb.second.x, curveMaxAabb.second.x), newMajor);
-
-#ifdef DEBUG_HATCH_VISUALLY
-					if (isCurrentDebugStep)
-					{
-						drawDebugBezier(splitCurveMin, float64_t4(1.0, 0.0, 0.0, 1.0));
-						drawDebugBezier(splitCurveMax, float64_t4(0.0, 1.0, 0.0, 1.0));
-
-						printf(std::format("AABB min: {}, {} max: {}, {} curve min: ({}, {}), ({}, {}), ({}, {}) curve max ({}, {}), ({}, {}), ({}, {})\n",
-							curveBox.aabbMin.x, curveBox.aabbMin.y, curveBox.aabbMax.x, curveBox.aabbMax.y,
-
-							splitCurveMin.P0.x, splitCurveMin.P0.y,
-							splitCurveMin.P1.x, splitCurveMin.P1.y,
-							splitCurveMin.P2.x, splitCurveMin.P2.y,
-							splitCurveMax.P0.x, splitCurveMax.P0.y,
-							splitCurveMax.P1.x, splitCurveMax.P1.y,
-							splitCurveMax.P2.x, splitCurveMax.P2.y
-						).c_str());
-					}
+		if (debugOutput && isCurrentDebugStep)
+		{
+			const float32_t4 eventColor = (eventType == EventType::START) ? float32_t4(0.0, 0.8, 0.0, 1.0) : float32_t4(0.0, 0.0, 0.8, 1.0);
+			drawDebugLine(float64_t2(-1000.0, newMajor), float64_t2(1000.0, newMajor), eventColor);
+		}
 #endif
 
-					// Transform curves into AABB UV space and turn them into quadratic coefficients
-					// so we wont need to convert here
-					auto transformCurves = [](Hatch::QuadraticBezier bezier, float64_t2 aabbMin, float64_t2 aabbMax, float32_t2* output) {
-						auto rcpAabbExtents = float64_t2(1.0, 1.0) / (aabbMax - aabbMin);
-						auto transformedBezier = QuadraticBezier::construct(
-							(bezier.P0 - aabbMin) * rcpAabbExtents,
-							(bezier.P1 - aabbMin) * rcpAabbExtents,
-							(bezier.P2 - aabbMin) * rcpAabbExtents
-						);
-						auto quadratic = QuadraticCurve::constructFromBezier(transformedBezier);
-
-						if (isLineSegment(transformedBezier))
-							quadratic.A = float64_t2(0.0);
-
-						output[0] = (quadratic.A);
-						output[1] = (quadratic.B);
-						output[2] = (quadratic.C);
-						};
-					transformCurves(splitCurveMin, curveBox.aabbMin, curveBox.aabbMax, &curveBox.curveMin[0]);
-					transformCurves(splitCurveMax, curveBox.aabbMin, curveBox.aabbMax, &curveBox.curveMax[0]);
-
-					hatchBoxes.push_back(curveBox);
-				}
-			}
-
-			// advance and trim all of the beziers in the candidate set
-			auto oit = activeCandidates.begin();
-			for (auto iit = activeCandidates.begin(); iit != activeCandidates.end(); iit++)
-			{
-				const double evalAtMajor = iit->originalBezier->evaluate(iit->t_end)[major];
-
-				auto origBez = iit->originalBezier;
-				// if we scrolled past the end of the segment, remove it
-				// (basically, we memcpy everything after something is different
-				// and we skip on the memcpy for any items that are also different)
-				// (this is supposedly a pattern with input/output operators)
-				if (newMajor < evalAtMajor)
-				{
-					const double new_t_start = intersectOrtho(*iit->originalBezier, newMajor, major);
-
-					// little optimization (don't memcpy anything before something was removed)
-					if (oit != iit)
-						*oit = *iit;
-					oit->t_start = new_t_start;
-					oit++;
-				}
-			}
-			// trim
-			const auto newSize = std::distance(activeCandidates.begin(), oit);
-			activeCandidates.resize(newSize);
-		}
+		// Everything at `lastMajor` was processed, so the pairs are final there
+		if (newMajor > lastMajor)
+			updateHatchBoxes(lastMajor);
 
-		// If we had a start event, we need to add the candidate
-		if (addStartSegmentToCandidates)
+		switch (eventType)
 		{
-			addToCandidateSet(nextStartEvent);
+		case EventType::START:
+			starts.pop();
+			addToCandidateSet(nextStartEvent, newMajor);
+			break;
+		case EventType::INTERSECTION:
+		{
+			const IntersectionEvent intersection = intersections.top();
+			intersections.pop(); // O(log n)
+			reorderCandidates(intersection, newMajor);
+			break;
 		}
-		
-		// We'll need to sort if we had a start event and added to the candidate set
-		// or if we have advanced our candidate set
-		if (addStartSegmentToCandidates || newMajor > lastMajor)
+		case EventType::END:
 		{
-			std::sort(activeCandidates.begin(), activeCandidates.end(), candidateComparator);
+			const QuadraticBezier* endingBezier = ends.top();
+			ends.pop();
+			removeFromCandidateSet(endingBezier, newMajor);
+			break;
+		}
 		}
 
 		if (newMajor > lastMajor)
 			lastMajor = newMajor;
+		sweepEventCount++;
 
 #ifdef DEBUG_HATCH_VISUALLY
 		step++;
 #endif
 	}
+	// candidates ending at `maxMajor` along with the last end event
+	activeCandidates.forEach([&](candidate_handle_t handle) { closeHatchBox(activeCandidates.getValue(handle), lastMajor); });
 #ifdef DEBUG_HATCH_VISUALLY
 	debugStep = debugStep - step;
 #endif
 }
 
+uint32_t Hatch::getParallelThreadCount(uint32_t hatchCount, uint32_t threadCount)
+{
+	if (threadCount == 0u)
+		threadCount = std::thread::hardware_concurrency();
+	return core::max(core::min(threadCount, hatchCount), 1u);
+}
+
+std::vector<Hatch> Hatch::constructInParallel(std::span<const std::span<CPolyline>> hatchesPolylines, const MajorAxis majorAxis, nbl::system::logger_opt_smart_ptr logger, uint32_t threadCount)
+{
+	const uint32_t hatchCount = static_cast<uint32_t>(hatchesPolylines.size());
+	
+	// The sweep of a single hatch carries it's active candidate set along the whole major axis, so we parallelize over independent hatches instead of bands
+	// Each worker writes into it's own slot, this is what keeps the merged output deterministic
+	std::vector<std::vector<CurveHatchBox>> hatchBoxesPerHatch(hatchCount);
+
+	threadCount = getParallelThreadCount(hatchCount, threadCount);
+
+	std::atomic_uint32_t nextHatchIdx = 0u;
+	auto worker = [&]()
+		{
+			// hatches are picked dynamically because their sweep costs vary wildly with segment count
+			for (uint32_t hatchIdx = nextHatchIdx++; hatchIdx < hatchCount; hatchIdx = nextHatchIdx++)
+			{
+				Hatch hatch(hatchesPolylines[hatchIdx], majorAxis, logger);
+				hatchBoxesPerHatch[hatchIdx] = std::move(hatch.hatchBoxes);
+			}
+		};
+
+	if (threadCount > 1u)
+	{
+		std::vector<std::thread> workers;
+		workers.reserve(threadCount - 1u);
+		for (uint32_t i = 1u; i < threadCount; ++i)
+			workers.emplace_back(worker);
+		worker(); // calling thread does work as well
+		for (auto& thread : workers)
+			thread.join();
+	}
+	else
+		worker();
+
+	std::vector<Hatch> ret;
+	ret.reserve(hatchCount);
+	for (auto& hatchBoxes : hatchBoxesPerHatch)
+		ret.emplace_back(std::move(hatchBoxes));
+	return ret;
+}
+
+Hatch Hatch::merge(std::span<const Hatch> hatches)
+{
+	size_t totalHatchBoxes = 0ull;
+	for (const auto& hatch : hatches)
+		totalHatchBoxes += hatch.hatchBoxes.size();
+
+	std::vector<CurveHatchBox> mergedHatchBoxes;
+	mergedHatchBoxes.reserve(totalHatchBoxes);
+	for (const auto& hatch : hatches)
+		mergedHatchBoxes.insert(mergedHatchBoxes.end(), hatch.hatchBoxes.begin(), hatch.hatchBoxes.end());
+	return Hatch(std::move(mergedHatchBoxes));
+}
+
 // returns two possible values of t in the lhs curve where the curves intersect
 std::array<double, 4> Hatch::bezierBezierIntersections(const QuadraticBezier& lhs, const QuadraticBezier& rhs)
 {
@@ -10,6 +10,8 @@
 #include "Curves.h"
 #include "Polyline.h"
 
+#include <memory_resource>
+
 #include <nbl/builtin/hlsl/math/equations/cubic.hlsl>
 #include <nbl/builtin/hlsl/math/equations/quartic.hlsl>
 #include <nbl/builtin/hlsl/shapes/beziers.hlsl>
@@ -76,7 +78,8 @@ public:
 		bool isStraightLineConstantMajor() const;
 	};
 
-	Hatch(std::span<CPolyline> lines, const MajorAxis majorAxis, nbl::system::logger_opt_smart_ptr logger = nullptr, int32_t* debugStep = nullptr, const std::function<void(CPolyline, LineStyleInfo)>& debugOutput = {});
+	// `scratchMemory` backs the temporaries of the construction only (e.g. a per-frame `MemoryArena`), the hatch boxes are always on the heap
+	Hatch(std::span<CPolyline> lines, const MajorAxis majorAxis, nbl::system::logger_opt_smart_ptr logger = nullptr, int32_t* debugStep = nullptr, const std::function<void(CPolyline, LineStyleInfo)>& debugOutput = {}, std::pmr::memory_resource* scratchMemory = std::pmr::get_default_resource());
 	
 	// (temporary)
 	Hatch(std::vector<CurveHatchBox>&& in_hatchBoxes) :
@@ -84,13 +87,27 @@ public:
 	{
 	};
 
+	// Number of workers `constructInParallel` runs for `hatchCount` hatches, there's never more workers than hatches
+	static uint32_t getParallelThreadCount(uint32_t hatchCount, uint32_t threadCount = 0u);
+
+	// Constructs multiple independent hatches concurrently, the sweep of each hatch runs on a single worker
+	// `hatchesPolylines[i]` produces the i-th returned hatch, so the output is deterministic regardless of scheduling
+	// threadCount of 0 will use std::thread::hardware_concurrency()
+	static std::vector<Hatch> constructInParallel(std::span<const std::span<CPolyline>> hatchesPolylines, const MajorAxis majorAxis, nbl::system::logger_opt_smart_ptr logger = nullptr, uint32_t threadCount = 0u);
+
+	// Concatenates the hatch boxes of `hatches` in input order into a single hatch (to draw them under a single main object)
+	static Hatch merge(std::span<const Hatch> hatches);
+
 	const CurveHatchBox& getHatchBox(uint32_t idx) const { return hatchBoxes[idx]; }
 	uint32_t getHatchBoxCount() const { return hatchBoxes.size(); }
+	// number of start, end and intersection events the sweep went through, 0 for hatches not constructed from polylines
+	uint32_t getSweepEventCount() const { return sweepEventCount; }
 
 	// Generate Fill Pattern
 	static core::smart_refctd_ptr<asset::ICPUImage> generateHatchFillPatternMSDF(nbl::ext::TextRendering::TextRenderer* textRenderer, HatchFillPattern fillPattern, uint32_t2 msdfExtents);
 
 private:
 	std::vector<CurveHatchBox> hatchBoxes;
+	uint32_t sweepEventCount = 0u;
 };
 
@@ -0,0 +1,195 @@
+#include "HatchCache.h"
+
+HatchCache::HatchCache(core::smart_refctd_ptr<system::ISystem>&& system, const system::path& cacheDirectory, system::logger_opt_smart_ptr logger, uint32_t memoryCacheCapacity)
+	: m_system(std::move(system))
+	, m_cacheDirectory(cacheDirectory)
+	, m_logger(std::move(logger))
+	, m_memoryCacheCapacity(memoryCacheCapacity)
+	, m_memoryCache(std::make_unique<MemoryCache>(memoryCacheCapacity))
+{
+	std::error_code ec;
+	std::filesystem::create_directories(m_cacheDirectory, ec);
+	if (ec)
+		m_logger.log("Failed Creating Hatch Cache Directory %s.", system::ILogger::ELL_ERROR, m_cacheDirectory.string().c_str());
+}
+
+core::blake3_hash_t HatchCache::computeHash(std::span<const CPolyline> polylines, const MajorAxis majorAxis)
+{
+	core::blake3_hasher hasher;
+	hasher.update(&majorAxis, sizeof(MajorAxis));
+	for (const CPolyline& polyline : polylines)
+	{
+		const uint32_t sectionsCount = polyline.getSectionsCount();
+		hasher.update(&sectionsCount, sizeof(uint32_t));
+		for (uint32_t secIdx = 0u; secIdx < sectionsCount; secIdx++)
+		{
+			const auto& section = polyline.getSectionInfoAt(secIdx);
+			hasher.update(&section.type, sizeof(ObjectType));
+			hasher.update(&section.count, sizeof(uint32_t));
+			// only the geometry matters to the sweep, styling info such as phaseShift/stretchValue/arcLen doesn't change the hatch boxes
+			if (section.type == ObjectType::LINE)
+			{
+				if (section.count == 0u)
+					continue;
+				for (uint32_t itemIdx = section.index; itemIdx <= section.index + section.count; itemIdx++)
+					hasher.update(&polyline.getLinePointAt(itemIdx).p, sizeof(float64_t2));
+			}
+			else if (section.type == ObjectType::QUAD_BEZIER)
+			{
+				for (uint32_t itemIdx = section.index; itemIdx < section.index + section.count; itemIdx++)
+					hasher.update(&polyline.getQuadBezierInfoAt(itemIdx).shape, sizeof(shapes::QuadraticBezier<double>));
+			}
+		}
+	}
+	return static_cast<core::blake3_hash_t>(hasher);
+}
+
+std::shared_ptr<const Hatch> HatchCache::getOrConstruct(std::span<CPolyline> polylines, const MajorAxis majorAxis)
+{
+	const core::blake3_hash_t hash = computeHash(polylines, majorAxis);
+
+	if (std::shared_ptr<const Hatch>* cached = m_memoryCache->get(hash))
+		return *cached;
+
+	std::shared_ptr<const Hatch> hatch;
+	std::vector<Hatch::CurveHatchBox> hatchBoxes;
+	if (load(hash, hatchBoxes))
+		hatch = std::make_shared<const Hatch>(std::move(hatchBoxes));
+	else
+	{
+		hatch = std::make_shared<const Hatch>(polylines, majorAxis, m_logger);
+		store(hash, *hatch);
+	}
+	m_memoryCache->insert(hash, hatch);
+	return hatch;
+}
+
+bool HatchCache::load(const core::blake3_hash_t& hash, std::vector<Hatch::CurveHatchBox>& outHatchBoxes) const
+{
+	const auto filePath = getCacheFilePath(hash);
+	if (!std::filesystem::exists(filePath))
+		return false;
+
+	core::smart_refctd_ptr<system::IFile> file;
+	{
+		system::ISystem::future_t<core::smart_refctd_ptr<system::IFile>> future;
+		m_system->createFile(future, filePath, core::bitflag(system::IFile::ECF_READ) | system::IFile::ECF_MAPPABLE);
+		if (!future.wait())
+			return false;
+		future.acquire().move_into(file);
+	}
+	if (!file)
+		return false;
+
+	const size_t fileSize = file->getSize();
+	if (fileSize < sizeof(FileHeader))
+		return false;
+
+	// we need the const overload, the non-const `getMappedPointer` returns nullptr for files without write access
+	const system::IFile* constFile = file.get();
+	const uint8_t* mapped = reinterpret_cast<const uint8_t*>(constFile->getMappedPointer());
+
+	FileHeader header;
+	std::vector<uint8_t> contents;
+	if (!mapped)
+	{
+		// fallback for when the system couldn't map the file
+		contents.resize(fileSize);
+		system::IFile::success_t succ;
+		file->read(succ, contents.data(), 0, fileSize);
+		if (!succ)
+			return false;
+		mapped = contents.data();
+	}
+	memcpy(&header, mapped, sizeof(FileHeader));
+
+	if (header.magic != FileMagic || header.version != FileVersion || header.hatchBoxSize != sizeof(Hatch::CurveHatchBox) || header.hash != hash)
+	{
+		m_logger.log("Hatch Cache File %s is outdated or corrupted, ignoring it.", system::ILogger::ELL_WARNING, filePath.string().c_str());
+		return false;
+	}
+	if (fileSize != sizeof(FileHeader) + size_t(header.hatchBoxCount) * sizeof(Hatch::CurveHatchBox))
+	{
+		m_logger.log("Hatch Cache File %s has the wrong size, ignoring it.", system::ILogger::ELL_WARNING, filePath.string().c_str());
+		return false;
+	}
+
+	outHatchBoxes.resize(header.hatchBoxCount);
+	memcpy(outHatchBoxes.data(), mapped + sizeof(FileHeader), size_t(header.hatchBoxCount) * sizeof(Hatch::CurveHatchBox));
+	return true;
+}
+
+bool HatchCache::store(const core::blake3_hash_t& hash, const Hatch& hatch) const
+{
+	FileHeader header = {};
+	header.magic = FileMagic;
+	header.version = FileVersion;
+	header.hatchBoxSize = sizeof(Hatch::CurveHatchBox);
+	header.hatchBoxCount = hatch.getHatchBoxCount();
+	header.hash = hash;
+
+	// written to a temporary file which is then renamed over the entry, so a crash (or a second instance loading the entry) never sees a partially written file
+	std::vector<uint8_t> contents(sizeof(FileHeader) + size_t(header.hatchBoxCount) * sizeof(Hatch::CurveHatchBox));
+	memcpy(contents.data(), &header, sizeof(FileHeader));
+	if (header.hatchBoxCount > 0u)
+		memcpy(contents.data() + sizeof(FileHeader), &hatch.getHatchBox(0u), size_t(header.hatchBoxCount) * sizeof(Hatch::CurveHatchBox));
+
+	const auto filePath = getCacheFilePath(hash);
+	auto tempFilePath = filePath;
+	tempFilePath += ".tmp";
+	m_system->deleteFile(tempFilePath);
+
+	{
+		core::smart_refctd_ptr<system::IFile> file;
+		{
+			system::ISystem::future_t<core::smart_refctd_ptr<system::IFile>> future;
+			m_system->createFile(future, tempFilePath, system::IFile::ECF_WRITE);
+			if (!future.wait())
+			{
+				m_logger.log("Failed Creating Hatch Cache File %s.", system::ILogger::ELL_ERROR, tempFilePath.string().c_str());
+				return false;
+			}
+			future.acquire().move_into(file);
+		}
+		if (!file)
+		{
+			m_logger.log("Failed Creating Hatch Cache File %s.", system::ILogger::ELL_ERROR, tempFilePath.string().c_str());
+			return false;
+		}
+
+		system::IFile::success_t succ;
+		file->write(succ, contents.data(), 0, contents.size());
+		if (!succ)
+		{
+			m_logger.log("Failed Writing To Hatch Cache File %s.", system::ILogger::ELL_ERROR, tempFilePath.string().c_str());
+			file = nullptr;
+			m_system->deleteFile(tempFilePath);
+			return false;
+		}
+		// the file has to be closed before it can be renamed
+	}
+
+	// an existing entry has the same contents (the name is the hash of the input), replacing it is harmless
+	m_system->deleteFile(filePath);
+	if (!m_system->moveFileOrDirectory(tempFilePath, filePath))
+	{
+		m_logger.log("Failed Moving Hatch Cache File %s into place.", system::ILogger::ELL_ERROR, filePath.string().c_str());
+		m_system->deleteFile(tempFilePath);
+		return false;
+	}
+	return true;
+}
+
+system::path HatchCache::getCacheFilePath(const core::blake3_hash_t& hash) const
+{
+	constexpr char HexDigits[] = "0123456789abcdef";
+	std::string fileName;
+	fileName.reserve(sizeof(hash.data) * 2u + 4u);
+	for (const uint8_t byte : hash.data)
+	{
+		fileName.push_back(HexDigits[byte >> 4u]);
+		fileName.push_back(HexDigits[byte & 0xFu]);
+	}
+	fileName += ".bin";
+	return m_cacheDirectory / fileName;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Hatch.h"
+
+#include <nbl/core/containers/LRUCache.h>
+
+// Content addressed cache of `Hatch::CurveHatchBox`es, so identical drawings don't redo the sweep on every load
+// The key is a blake3 hash of everything the sweep reads from the input: section types/ranges, line points, bezier shapes and the major axis
+// Every entry is a compact binary file named after the hex of its hash which gets memory mapped back on load
+// The most recently used entries are also kept in memory (up to `memoryCacheCapacity` hatches), repeated lookups of the same geometry won't touch the disk again
+class HatchCache
+{
+public:
+	HatchCache(core::smart_refctd_ptr<system::ISystem>&& system, const system::path& cacheDirectory, system::logger_opt_smart_ptr logger = nullptr, uint32_t memoryCacheCapacity = 64u);
+
+	static core::blake3_hash_t computeHash(std::span<const CPolyline> polylines, const MajorAxis majorAxis);
+
+	// Returns the cached hatch if found (memory then disk), otherwise constructs it and writes it to the cache
+	// the hatch is shared with the memory cache, hits don't copy the hatch boxes
+	std::shared_ptr<const Hatch> getOrConstruct(std::span<CPolyline> polylines, const MajorAxis majorAxis);
+
+	// returns false if there's no valid cache file for `hash`
+	bool load(const core::blake3_hash_t& hash, std::vector<Hatch::CurveHatchBox>& outHatchBoxes) const;
+	bool store(const core::blake3_hash_t& hash, const Hatch& hatch) const;
+
+	void clearMemoryCache() { m_memoryCache = std::make_unique<MemoryCache>(m_memoryCacheCapacity); }
+
+	system::path getCacheFilePath(const core::blake3_hash_t& hash) const;
+
+protected:
+	static constexpr uint32_t FileMagic = 0x58424348u; // "HCBX"
+	// bump whenever the sweep or `CurveHatchBox` changes in a way that makes old files invalid
+	static constexpr uint32_t FileVersion = 1u;
+
+	struct FileHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t hatchBoxSize;
+		uint32_t hatchBoxCount;
+		core::blake3_hash_t hash;
+	};
+
+	core::smart_refctd_ptr<system::ISystem> m_system;
+	system::path m_cacheDirectory;
+	system::logger_opt_smart_ptr m_logger;
+	using MemoryCache = core::LRUCache<core::blake3_hash_t, std::shared_ptr<const Hatch>>;
+	uint32_t m_memoryCacheCapacity;
+	std::unique_ptr<MemoryCache> m_memoryCache;
+};
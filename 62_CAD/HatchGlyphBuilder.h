@@ -1,8 +1,19 @@
+#pragma once
+
 // Debug tool to Visualize Freetype Glyphs by turning them into Polyline objects
 
 class FreetypeHatchBuilder
 {
 public:
+	FreetypeHatchBuilder() : FreetypeHatchBuilder(std::pmr::get_default_resource()) {}
+
+	// output polylines and scratch storage come from `memoryResource`, e.g. a per-frame `MemoryArena`
+	explicit FreetypeHatchBuilder(std::pmr::memory_resource* memoryResource) :
+		polylines(memoryResource),
+		currentPolyline(memoryResource),
+		quadBeziers(memoryResource)
+	{}
+
 	// Start a new line from here
 	void moveTo(const float64_t2 to)
 	{
@@ -14,9 +25,7 @@ public:
 	void lineTo(const float64_t2 to)
 	{
 		if (to != lastPosition) {
-			std::vector<float64_t2> linePoints;
-			linePoints.push_back(lastPosition);
-			linePoints.push_back(to);
+			float64_t2 linePoints[2u] = { lastPosition, to };
 			currentPolyline.addLinePoints(linePoints);
 
 			lastPosition = to;
@@ -40,7 +49,7 @@ public:
 	// [last position, control1, control2, end]
 	void cubic(const float64_t2 control1, const float64_t2 control2, const float64_t2 to)
 	{
-		std::vector<shapes::QuadraticBezier<double>> quadBeziers;
+		quadBeziers.clear();
 		curves::CubicCurve myCurve(
 			float64_t4(lastPosition.x, lastPosition.y, control1.x, control1.y),
 			float64_t4(control2.x, control2.y, to.x, to.y)
@@ -60,13 +69,19 @@ public:
 	void finish()
 	{
 		if (currentPolyline.getSectionsCount() > 0)
-			polylines.push_back(currentPolyline);
+		{
+			// moving keeps the polyline in our memory resource
+			polylines.push_back(std::move(currentPolyline));
+			currentPolyline = CPolyline(polylines.get_allocator().resource());
+		}
 	}
 
-	std::vector<CPolyline> polylines;
-	CPolyline currentPolyline = {};
+	std::pmr::vector<CPolyline> polylines;
+	CPolyline currentPolyline;
 	// Set with move to and line to
 	float64_t2 lastPosition = float64_t2(0.0);
+	// reused by `cubic`
+	std::pmr::vector<shapes::QuadraticBezier<double>> quadBeziers;
 };
 
 // TODO: Figure out what this is supposed to do
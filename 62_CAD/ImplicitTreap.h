@@ -0,0 +1,266 @@
+#pragma once
+
+#include <vector>
+#include <memory_resource>
+#include <cstdint>
+#include <cassert>
+
+// Ordered sequence of values which doesn't store the keys it's ordered by, for orders which change as a whole but stay consistent, like curves along a sweep line
+// Implemented as an implicit treap (ordered by position, augmented with subtree sizes), callers search it with a comparator evaluated at the time of the search
+// insert/erase/getRank/at are O(log n) expected, sortRange is O(log n + k^2) where k is the number of values in the range
+// Nodes live in a pool and are referred to by handles which stay valid until erased, so callers can keep a handle next to their own data
+template<typename value_t>
+class ImplicitTreap
+{
+public:
+	using handle_t = uint32_t;
+	static constexpr handle_t InvalidHandle = ~0u;
+
+	explicit ImplicitTreap(std::pmr::memory_resource* memoryResource = std::pmr::get_default_resource())
+		: m_nodes(memoryResource)
+		, m_freeNodes(memoryResource)
+		, m_rangeScratch(memoryResource)
+	{}
+
+	void reserve(uint32_t capacity)
+	{
+		m_nodes.reserve(capacity);
+	}
+
+	inline uint32_t size() const { return getSize(m_root); }
+	inline bool empty() const { return m_root == InvalidHandle; }
+
+	// inserts `value` after every value it isn't `less(value, other)` than, `less` has to agree with the current order
+	template<typename Less>
+	handle_t insert(const value_t& value, Less&& less)
+	{
+		uint32_t rank = 0u;
+		for (handle_t node = m_root; node != InvalidHandle;)
+		{
+			if (less(value, m_nodes[node].value))
+				node = m_nodes[node].left;
+			else
+			{
+				rank += getSize(m_nodes[node].left) + 1u;
+				node = m_nodes[node].right;
+			}
+		}
+
+		handle_t handle;
+		if (!m_freeNodes.empty())
+		{
+			handle = m_freeNodes.back();
+			m_freeNodes.pop_back();
+		}
+		else
+		{
+			handle = static_cast<handle_t>(m_nodes.size());
+			m_nodes.emplace_back();
+		}
+
+		Node& node = m_nodes[handle];
+		node.value = value;
+		node.priority = nextPriority();
+		resetLinks(handle);
+
+		handle_t lhs, rhs;
+		split(m_root, rank, lhs, rhs);
+		setRoot(merge(merge(lhs, handle), rhs));
+		return handle;
+	}
+
+	void erase(handle_t handle)
+	{
+		assert(handle < m_nodes.size());
+		handle_t lhs, mid, rhs;
+		split(m_root, getRank(handle), lhs, mid);
+		split(mid, 1u, mid, rhs);
+		assert(mid == handle);
+		setRoot(merge(lhs, rhs));
+		m_freeNodes.push_back(handle);
+	}
+
+	// position of `handle` in the sequence
+	uint32_t getRank(handle_t handle) const
+	{
+		uint32_t rank = getSize(m_nodes[handle].left);
+		for (handle_t node = handle; m_nodes[node].parent != InvalidHandle; node = m_nodes[node].parent)
+		{
+			const handle_t parent = m_nodes[node].parent;
+			if (m_nodes[parent].right == node)
+				rank += getSize(m_nodes[parent].left) + 1u;
+		}
+		return rank;
+	}
+
+	// handle at position `rank`, `InvalidHandle` past the end
+	handle_t at(uint32_t rank) const
+	{
+		handle_t node = m_root;
+		while (node != InvalidHandle)
+		{
+			const uint32_t leftSize = getSize(m_nodes[node].left);
+			if (rank == leftSize)
+				break;
+			if (rank < leftSize)
+				node = m_nodes[node].left;
+			else
+			{
+				rank -= leftSize + 1u;
+				node = m_nodes[node].right;
+			}
+		}
+		return node;
+	}
+
+	inline value_t& getValue(handle_t handle) { return m_nodes[handle].value; }
+	inline const value_t& getValue(handle_t handle) const { return m_nodes[handle].value; }
+
+	// Stable sorts the values at positions [first, last] with `less`, every handle stays with it's value
+	// meant for the few values around a point where the order changes, it's an insertion sort
+	template<typename Less>
+	void sortRange(uint32_t first, uint32_t last, Less&& less)
+	{
+		assert(first <= last && last < size());
+		handle_t lhs, mid, rhs;
+		split(m_root, first, lhs, mid);
+		split(mid, last - first + 1u, mid, rhs);
+
+		m_rangeScratch.clear();
+		auto gather = [&](handle_t handle) { m_rangeScratch.push_back(handle); };
+		forEach_impl(mid, gather);
+		for (size_t i = 1u; i < m_rangeScratch.size(); i++)
+		{
+			const handle_t item = m_rangeScratch[i];
+			size_t j = i;
+			for (; j > 0u && less(m_nodes[item].value, m_nodes[m_rangeScratch[j - 1u]].value); j--)
+				m_rangeScratch[j] = m_rangeScratch[j - 1u];
+			m_rangeScratch[j] = item;
+		}
+
+		mid = InvalidHandle;
+		for (const handle_t handle : m_rangeScratch)
+		{
+			resetLinks(handle);
+			mid = merge(mid, handle);
+		}
+		setRoot(merge(merge(lhs, mid), rhs));
+	}
+
+	// calls `func(handle_t)` for every value in order
+	template<typename Func>
+	void forEach(Func&& func) const
+	{
+		forEach_impl(m_root, func);
+	}
+
+private:
+	struct Node
+	{
+		value_t value;
+		uint32_t priority;
+		uint32_t size;
+		handle_t left;
+		handle_t right;
+		handle_t parent;
+	};
+
+	inline uint32_t getSize(handle_t handle) const { return handle != InvalidHandle ? m_nodes[handle].size : 0u; }
+
+	// deterministic xorshift, we don't want different tree shapes (and timings) between runs
+	inline uint32_t nextPriority()
+	{
+		m_prioritySeed ^= m_prioritySeed << 13u;
+		m_prioritySeed ^= m_prioritySeed >> 17u;
+		m_prioritySeed ^= m_prioritySeed << 5u;
+		return m_prioritySeed;
+	}
+
+	inline void resetLinks(handle_t handle)
+	{
+		Node& node = m_nodes[handle];
+		node.size = 1u;
+		node.left = InvalidHandle;
+		node.right = InvalidHandle;
+		node.parent = InvalidHandle;
+	}
+
+	inline void setRoot(handle_t handle)
+	{
+		m_root = handle;
+		if (m_root != InvalidHandle)
+			m_nodes[m_root].parent = InvalidHandle;
+	}
+
+	inline void update(handle_t handle)
+	{
+		Node& node = m_nodes[handle];
+		node.size = getSize(node.left) + getSize(node.right) + 1u;
+		if (node.left != InvalidHandle)
+			m_nodes[node.left].parent = handle;
+		if (node.right != InvalidHandle)
+			m_nodes[node.right].parent = handle;
+	}
+
+	// splits `root` into the first `count` values and the rest
+	void split(handle_t root, uint32_t count, handle_t& outLhs, handle_t& outRhs)
+	{
+		if (root == InvalidHandle)
+		{
+			outLhs = outRhs = InvalidHandle;
+			return;
+		}
+
+		const uint32_t leftSize = getSize(m_nodes[root].left);
+		if (leftSize < count)
+		{
+			split(m_nodes[root].right, count - leftSize - 1u, m_nodes[root].right, outRhs);
+			outLhs = root;
+		}
+		else
+		{
+			split(m_nodes[root].left, count, outLhs, m_nodes[root].left);
+			outRhs = root;
+		}
+		update(root);
+		m_nodes[root].parent = InvalidHandle;
+	}
+
+	// all values of `lhs` go before the values of `rhs`
+	handle_t merge(handle_t lhs, handle_t rhs)
+	{
+		if (lhs == InvalidHandle)
+			return rhs;
+		if (rhs == InvalidHandle)
+			return lhs;
+
+		if (m_nodes[lhs].priority > m_nodes[rhs].priority)
+		{
+			m_nodes[lhs].right = merge(m_nodes[lhs].right, rhs);
+			update(lhs);
+			return lhs;
+		}
+		else
+		{
+			m_nodes[rhs].left = merge(lhs, m_nodes[rhs].left);
+			update(rhs);
+			return rhs;
+		}
+	}
+
+	template<typename Func>
+	void forEach_impl(handle_t root, Func& func) const
+	{
+		if (root == InvalidHandle)
+			return;
+		forEach_impl(m_nodes[root].left, func);
+		func(root);
+		forEach_impl(m_nodes[root].right, func);
+	}
+
+	std::pmr::vector<Node> m_nodes;
+	std::pmr::vector<handle_t> m_freeNodes;
+	std::pmr::vector<handle_t> m_rangeScratch;
+	handle_t m_root = InvalidHandle;
+	uint32_t m_prioritySeed = 0x9E3779B9u;
+};
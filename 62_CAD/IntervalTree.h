@@ -0,0 +1,212 @@
+#pragma once
+
+#include <vector>
+#include <memory_resource>
+#include <cstdint>
+#include <cassert>
+
+// Dynamic set of closed intervals [min, max] answering "which intervals overlap [queryMin, queryMax]"
+// Implemented as a treap keyed on interval min, every node is augmented with the max of it's subtree so overlap queries prune whole subtrees
+// insert/erase are O(log n) expected, query is O(log n + k) expected, where k is the number of reported intervals
+// Nodes live in a pool and are referred to by handles which stay valid until erased, so callers can keep a handle next to their own data
+template<typename T, typename value_t>
+class IntervalTree
+{
+public:
+	using handle_t = uint32_t;
+	static constexpr handle_t InvalidHandle = ~0u;
+
+	explicit IntervalTree(std::pmr::memory_resource* memoryResource = std::pmr::get_default_resource())
+		: m_nodes(memoryResource)
+		, m_freeNodes(memoryResource)
+	{}
+
+	void reserve(uint32_t capacity)
+	{
+		m_nodes.reserve(capacity);
+	}
+
+	void clear()
+	{
+		m_nodes.clear();
+		m_freeNodes.clear();
+		m_root = InvalidHandle;
+		m_count = 0u;
+	}
+
+	inline uint32_t size() const { return m_count; }
+	inline bool empty() const { return m_count == 0u; }
+
+	handle_t insert(T min, T max, const value_t& value)
+	{
+		assert(min <= max);
+		handle_t handle;
+		if (!m_freeNodes.empty())
+		{
+			handle = m_freeNodes.back();
+			m_freeNodes.pop_back();
+		}
+		else
+		{
+			handle = static_cast<handle_t>(m_nodes.size());
+			m_nodes.emplace_back();
+		}
+
+		Node& node = m_nodes[handle];
+		node.min = min;
+		node.max = max;
+		node.subtreeMax = max;
+		node.value = value;
+		node.priority = nextPriority();
+		node.left = InvalidHandle;
+		node.right = InvalidHandle;
+
+		handle_t lhs, rhs;
+		split(m_root, node.min, handle, lhs, rhs);
+		m_root = merge(merge(lhs, handle), rhs);
+		m_count++;
+		return handle;
+	}
+
+	void erase(handle_t handle)
+	{
+		assert(handle < m_nodes.size());
+		m_root = erase_impl(m_root, handle);
+		m_freeNodes.push_back(handle);
+		m_count--;
+	}
+
+	inline value_t& getValue(handle_t handle) { return m_nodes[handle].value; }
+	inline const value_t& getValue(handle_t handle) const { return m_nodes[handle].value; }
+
+	// calls `func(const value_t&)` for every interval overlapping [queryMin, queryMax]
+	template<typename Func>
+	void query(T queryMin, T queryMax, Func&& func) const
+	{
+		query_impl(m_root, queryMin, queryMax, func);
+	}
+
+private:
+	struct Node
+	{
+		T min;
+		T max;
+		T subtreeMax;
+		value_t value;
+		uint32_t priority;
+		handle_t left;
+		handle_t right;
+	};
+
+	// keys are (min, handle) so they are unique even for equal mins
+	inline bool keyLess(T lhsMin, handle_t lhsHandle, T rhsMin, handle_t rhsHandle) const
+	{
+		return lhsMin < rhsMin || (lhsMin == rhsMin && lhsHandle < rhsHandle);
+	}
+
+	// deterministic xorshift, we don't want different tree shapes (and timings) between runs
+	inline uint32_t nextPriority()
+	{
+		m_prioritySeed ^= m_prioritySeed << 13u;
+		m_prioritySeed ^= m_prioritySeed >> 17u;
+		m_prioritySeed ^= m_prioritySeed << 5u;
+		return m_prioritySeed;
+	}
+
+	inline void update(handle_t handle)
+	{
+		Node& node = m_nodes[handle];
+		node.subtreeMax = node.max;
+		if (node.left != InvalidHandle && m_nodes[node.left].subtreeMax > node.subtreeMax)
+			node.subtreeMax = m_nodes[node.left].subtreeMax;
+		if (node.right != InvalidHandle && m_nodes[node.right].subtreeMax > node.subtreeMax)
+			node.subtreeMax = m_nodes[node.right].subtreeMax;
+	}
+
+	// splits `root` into keys less than (min, handle) and the rest
+	void split(handle_t root, T min, handle_t handle, handle_t& outLhs, handle_t& outRhs)
+	{
+		if (root == InvalidHandle)
+		{
+			outLhs = outRhs = InvalidHandle;
+			return;
+		}
+
+		Node& node = m_nodes[root];
+		if (keyLess(node.min, root, min, handle))
+		{
+			split(node.right, min, handle, m_nodes[root].right, outRhs);
+			outLhs = root;
+		}
+		else
+		{
+			split(node.left, min, handle, outLhs, m_nodes[root].left);
+			outRhs = root;
+		}
+		update(root);
+	}
+
+	// all keys in `lhs` must be less than keys in `rhs`
+	handle_t merge(handle_t lhs, handle_t rhs)
+	{
+		if (lhs == InvalidHandle)
+			return rhs;
+		if (rhs == InvalidHandle)
+			return lhs;
+
+		if (m_nodes[lhs].priority > m_nodes[rhs].priority)
+		{
+			m_nodes[lhs].right = merge(m_nodes[lhs].right, rhs);
+			update(lhs);
+			return lhs;
+		}
+		else
+		{
+			m_nodes[rhs].left = merge(lhs, m_nodes[rhs].left);
+			update(rhs);
+			return rhs;
+		}
+	}
+
+	handle_t erase_impl(handle_t root, handle_t handle)
+	{
+		assert(root != InvalidHandle); // erasing a handle that isn't in the tree
+		if (root == handle)
+			return merge(m_nodes[root].left, m_nodes[root].right);
+
+		const Node& target = m_nodes[handle];
+		if (keyLess(target.min, handle, m_nodes[root].min, root))
+			m_nodes[root].left = erase_impl(m_nodes[root].left, handle);
+		else
+			m_nodes[root].right = erase_impl(m_nodes[root].right, handle);
+		update(root);
+		return root;
+	}
+
+	template<typename Func>
+	void query_impl(handle_t root, T queryMin, T queryMax, Func& func) const
+	{
+		if (root == InvalidHandle)
+			return;
+		const Node& node = m_nodes[root];
+		// nothing in this subtree reaches the query interval
+		if (node.subtreeMax < queryMin)
+			return;
+
+		query_impl(node.left, queryMin, queryMax, func);
+
+		// every interval in the right subtree starts after this one, so they're all past the query interval as well
+		if (node.min > queryMax)
+			return;
+		if (node.max >= queryMin)
+			func(node.value);
+
+		query_impl(node.right, queryMin, queryMax, func);
+	}
+
+	std::pmr::vector<Node> m_nodes;
+	std::pmr::vector<handle_t> m_freeNodes;
+	handle_t m_root = InvalidHandle;
+	uint32_t m_count = 0u;
+	uint32_t m_prioritySeed = 0x9E3779B9u;
+};
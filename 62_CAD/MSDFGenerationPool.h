@@ -0,0 +1,133 @@
+#pragma once
+
+#include "SharedMSDFCache.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <thread>
+
+// Background workers generating MSDF images for `DrawResourcesFiller`, so new glyphs/fill patterns don't stall recording while msdfgen runs
+// The filler submits a job per missing MSDF together with the texture array index reserved for it and collects finished jobs once per frame
+// Generate functions run on the worker threads, so whatever they touch has to be thread-safe
+class MSDFGenerationPool
+{
+public:
+	using clock_t = std::chrono::steady_clock;
+
+	struct GeneratedMSDF
+	{
+		MSDFInputInfo input;
+		uint32_t textureIdx;
+		core::smart_refctd_ptr<asset::ICPUImage> image; // nullptr if generation failed
+		clock_t::duration latency; // from `submit` to the end of generation
+	};
+
+	struct Stats
+	{
+		uint32_t queueDepth = 0u; // submitted and not collected yet, including the ones being generated
+		uint64_t completedCount = 0ull; // collected so far
+		double averageLatencyMs = 0.0;
+		double maxLatencyMs = 0.0;
+	};
+
+	// threadCount of 0 will use std::thread::hardware_concurrency()
+	explicit MSDFGenerationPool(uint32_t threadCount = 0u)
+	{
+		if (threadCount == 0u)
+			threadCount = core::max(std::thread::hardware_concurrency(), 1u);
+		m_workers.reserve(threadCount);
+		for (uint32_t i = 0u; i < threadCount; ++i)
+			m_workers.emplace_back([this]() { workerLoop(); });
+	}
+
+	~MSDFGenerationPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_exiting = true;
+		}
+		m_jobAvailable.notify_all();
+		for (auto& worker : m_workers)
+			worker.join();
+	}
+
+	void submit(const MSDFInputInfo& input, uint32_t textureIdx, SharedMSDFCache::GenerateFunc&& generate)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_jobs.push_back({ input, textureIdx, std::move(generate), clock_t::now() });
+			m_queueDepth++;
+		}
+		m_jobAvailable.notify_one();
+	}
+
+	// Appends the jobs finished since the last call to `out`
+	void collect(std::vector<GeneratedMSDF>& out)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for (auto& generated : m_finished)
+		{
+			const double latencyMs = std::chrono::duration<double, std::milli>(generated.latency).count();
+			m_totalLatencyMs += latencyMs;
+			m_maxLatencyMs = core::max(m_maxLatencyMs, latencyMs);
+			m_completedCount++;
+			m_queueDepth--;
+			out.push_back(std::move(generated));
+		}
+		m_finished.clear();
+	}
+
+	Stats getStats() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		Stats ret = {};
+		ret.queueDepth = m_queueDepth;
+		ret.completedCount = m_completedCount;
+		ret.averageLatencyMs = (m_completedCount > 0ull) ? m_totalLatencyMs / m_completedCount : 0.0;
+		ret.maxLatencyMs = m_maxLatencyMs;
+		return ret;
+	}
+
+protected:
+	struct Job
+	{
+		MSDFInputInfo input;
+		uint32_t textureIdx;
+		SharedMSDFCache::GenerateFunc generate;
+		clock_t::time_point submitTime;
+	};
+
+	void workerLoop()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		while (true)
+		{
+			m_jobAvailable.wait(lock, [this]() { return m_exiting || !m_jobs.empty(); });
+			if (m_exiting)
+				return;
+
+			Job job = std::move(m_jobs.front());
+			m_jobs.pop_front();
+			lock.unlock();
+
+			core::smart_refctd_ptr<asset::ICPUImage> image = job.generate ? job.generate() : nullptr;
+			const auto latency = clock_t::now() - job.submitTime;
+
+			lock.lock();
+			m_finished.push_back({ job.input, job.textureIdx, std::move(image), latency });
+		}
+	}
+
+	mutable std::mutex m_mutex;
+	std::condition_variable m_jobAvailable;
+	std::deque<Job> m_jobs;
+	std::vector<GeneratedMSDF> m_finished;
+	std::vector<std::thread> m_workers;
+	bool m_exiting = false;
+
+	uint32_t m_queueDepth = 0u;
+	uint64_t m_completedCount = 0ull;
+	double m_totalLatencyMs = 0.0;
+	double m_maxLatencyMs = 0.0;
+};
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <memory_resource>
+#include <optional>
+#include <cstddef>
+#include <cstdint>
+
+// Monotonic arena for short lived cpu side storage (polylines, hatch construction temporaries, ...), meant to be reset once per frame or per document
+// Deallocations are no-ops and `reset` frees everything at once, pass it to the classes taking a `std::pmr::memory_resource*`
+// On reset the owned block grows to the high water mark of the previous cycle, so steady-state frames don't touch the upstream resource at all
+// Not thread-safe, use one arena per thread
+class MemoryArena : public std::pmr::memory_resource
+{
+public:
+	explicit MemoryArena(size_t initialSize = 64u * 1024u, std::pmr::memory_resource* upstream = std::pmr::get_default_resource()) :
+		m_upstream(upstream)
+	{
+		allocateBlock(initialSize);
+	}
+
+	MemoryArena(const MemoryArena&) = delete;
+	MemoryArena& operator=(const MemoryArena&) = delete;
+
+	~MemoryArena()
+	{
+		freeBlock();
+	}
+
+	// Everything allocated from the arena since the last reset is invalidated
+	void reset()
+	{
+		m_monotonic->release();
+		if (m_bytesSinceReset > m_blockSize)
+		{
+			freeBlock();
+			allocateBlock(m_bytesSinceReset);
+		}
+		m_bytesSinceReset = 0u;
+		m_allocationsSinceReset = 0u;
+	}
+
+	// allocations served since the last reset and their size in bytes (including alignment padding upper bounds)
+	inline uint64_t getAllocationCount() const { return m_allocationsSinceReset; }
+	inline size_t getAllocatedBytes() const { return m_bytesSinceReset; }
+	// size of the owned block, the most a cycle can allocate without falling back to the upstream resource
+	inline size_t getBlockSize() const { return m_blockSize; }
+
+	std::pmr::memory_resource* getUpstream() const { return m_upstream; }
+
+protected:
+	void* do_allocate(size_t bytes, size_t alignment) override
+	{
+		m_allocationsSinceReset++;
+		m_bytesSinceReset += bytes + alignment - 1u;
+		return m_monotonic->allocate(bytes, alignment);
+	}
+
+	void do_deallocate(void* p, size_t bytes, size_t alignment) override {}
+
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+	{
+		return this == &other;
+	}
+
+	void allocateBlock(size_t size)
+	{
+		m_blockSize = size;
+		m_block = m_upstream->allocate(m_blockSize, alignof(std::max_align_t));
+		m_monotonic.emplace(m_block, m_blockSize, m_upstream);
+	}
+
+	void freeBlock()
+	{
+		m_monotonic.reset();
+		m_upstream->deallocate(m_block, m_blockSize, alignof(std::max_align_t));
+		m_block = nullptr;
+		m_blockSize = 0u;
+	}
+
+	std::pmr::memory_resource* m_upstream;
+	void* m_block = nullptr;
+	size_t m_blockSize = 0u;
+	std::optional<std::pmr::monotonic_buffer_resource> m_monotonic;
+	uint64_t m_allocationsSinceReset = 0u;
+	size_t m_bytesSinceReset = 0u;
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "Polyline.h"
+
+#include <nbl/core/containers/LRUCache.h>
+
+// Memoizes `CPolyline::generateParallelPolyline`, so restyling a layer (e.g. switching road widths back and forth) doesn't offset the same polylines again
+// Keyed by (polylineId, offset, maxError), `polylineId` is the caller's identity for the polyline's geometry (e.g. entity id combined with an edit counter)
+// and has to change whenever the geometry does, stale entries are never looked up again and get evicted by the LRU policy
+// Entries always live on the default memory resource, whatever resource the input polylines use
+class ParallelPolylineCache
+{
+public:
+	explicit ParallelPolylineCache(uint32_t capacity = 4096u) : m_cache(capacity) {}
+
+	// returned reference is only valid until the next miss
+	const CPolyline& getOrGenerate(uint64_t polylineId, const CPolyline& polyline, float64_t offset, const float64_t maxError = 1e-5, uint32_t threadCount = 1u)
+	{
+		const Key key = { polylineId, offset, maxError };
+		if (CPolyline* cached = m_cache.get(key))
+		{
+			m_hitCount++;
+			return *cached;
+		}
+		m_missCount++;
+		// the offset polyline comes from `polyline`'s memory resource, which could be a `MemoryArena` that gets reset long before the entry is evicted
+		// copy assignment keeps the destination's resource (moves keep the source's), so the cached copy lives on the default resource
+		CPolyline parallelPolyline = polyline.generateParallelPolyline(offset, maxError, threadCount);
+		if (parallelPolyline.getMemoryResource() != std::pmr::get_default_resource())
+		{
+			CPolyline defaultResourceCopy(std::pmr::get_default_resource());
+			defaultResourceCopy = parallelPolyline;
+			return *m_cache.insert(key, std::move(defaultResourceCopy));
+		}
+		return *m_cache.insert(key, std::move(parallelPolyline));
+	}
+
+	// `CPolyline::makeWideWhole` with both offsets going through the cache
+	void makeWideWhole(uint64_t polylineId, const CPolyline& polyline, CPolyline& outOffset1, CPolyline& outOffset2, float64_t offset, const float64_t maxError = 1e-5, uint32_t threadCount = 1u)
+	{
+		outOffset1 = getOrGenerate(polylineId, polyline, offset, maxError, threadCount);
+		outOffset2 = getOrGenerate(polylineId, polyline, -1.0 * offset, maxError, threadCount);
+		polyline.connectWideEnds(outOffset1, outOffset2);
+	}
+
+	uint64_t getHitCount() const { return m_hitCount; }
+	uint64_t getMissCount() const { return m_missCount; }
+
+protected:
+	struct Key
+	{
+		uint64_t polylineId;
+		float64_t offset;
+		float64_t maxError;
+
+		inline bool operator==(const Key& other) const
+		{
+			return polylineId == other.polylineId && offset == other.offset && maxError == other.maxError;
+		}
+	};
+
+	struct KeyHash
+	{
+		inline std::size_t operator()(const Key& key) const
+		{
+			std::size_t ret = 0ull;
+			auto combine = [&ret](std::size_t h) { ret ^= h + 0x9e3779b97f4a7c15ull + (ret << 6) + (ret >> 2); };
+			combine(std::hash<uint64_t>{}(key.polylineId));
+			combine(std::hash<float64_t>{}(key.offset));
+			combine(std::hash<float64_t>{}(key.maxError));
+			return ret;
+		}
+	};
+
+	core::LRUCache<Key, CPolyline, KeyHash> m_cache;
+	uint64_t m_hitCount = 0ull;
+	uint64_t m_missCount = 0ull;
+};
@@ -6,6 +6,11 @@
 #include <nbl/builtin/hlsl/math/geometry.hlsl>
 #include <nbl/builtin/hlsl/shapes/util.hlsl>
 #include "Curves.h"
+#include "AABBTree.h"
+
+#include <memory_resource>
+#include <thread>
+#include <atomic>
 
 // holds values for `LineStyle` struct and caculates stipple pattern re values, cant think of better name
 // Also used for TextStyles aliased with some members here. (temporarily?)
@@ -357,12 +362,22 @@ public:
 class CPolyline : public CPolylineBase
 {
 public:
-	CPolyline() :
+	CPolyline() : CPolyline(std::pmr::get_default_resource()) {}
+
+	// all of the polyline's storage comes from `memoryResource`, e.g. a `MemoryArena` for polylines that only live for a frame
+	// copies go back to the default resource (as with any pmr container), moves keep the source's resource
+	explicit CPolyline(std::pmr::memory_resource* memoryResource) :
+		m_polylineConnector(memoryResource),
+		m_sections(memoryResource),
+		m_linePoints(memoryResource),
+		m_quadBeziers(memoryResource),
+		m_closedPolygon(false),
 		m_Min(float64_t2(nbl::hlsl::numeric_limits<float64_t>::max, nbl::hlsl::numeric_limits<float64_t>::max)),
-		m_Max(float64_t2(nbl::hlsl::numeric_limits<float64_t>::min, nbl::hlsl::numeric_limits<float64_t>::min)),
-		m_closedPolygon(false)
+		m_Max(float64_t2(nbl::hlsl::numeric_limits<float64_t>::min, nbl::hlsl::numeric_limits<float64_t>::min))
 	{}
 
+	std::pmr::memory_resource* getMemoryResource() const { return m_sections.get_allocator().resource(); }
+
 	size_t getSectionsCount() const override { return m_sections.size(); }
 
 	const SectionInfo& getSectionInfoAt(const uint32_t idx) const override
@@ -519,6 +534,10 @@ public:
 		const bool patternStartAgain = lineStyle.stretchToFit;
 		float currentPhaseShift = lineStyle.phaseShift;
 
+		// bezier arc lengths come from the batch and shape positions on curves are collected for a whole section and their inverse arc lengths solved together
+		// the batch is reused by every call on this thread so it doesn't allocate per polyline, `addShape` must not preprocess another polyline itself
+		thread_local curves::QuadraticArcLenInverseBatch bezierArcLens;
+
 		for (uint32_t sectionIdx = 0u; sectionIdx < m_sections.size(); sectionIdx++)
 		{
 			const auto& section = m_sections[sectionIdx];
@@ -579,20 +598,16 @@ public:
 			{
 				const uint32_t quadBezierCount = section.count;
 				
-				// when stretchToFit is true, we need to calculate the whole section arc length to figure out the stretch value needed for stippling phaseshift
+				// batch bezier `i` is the section's i-th bezier
+				bezierArcLens.clear();
+				float64_t sectionArcLen = 0.0;
+				for (uint32_t i = 0u; i < quadBezierCount; i++)
+					sectionArcLen += bezierArcLens.getBezierArcLen(bezierArcLens.addBezier(m_quadBeziers[section.index + i].shape));
+
+				// when stretchToFit is true, we need the whole section arc length to figure out the stretch value needed for stippling phaseshift
 				float stretchValue = 1.0;
 				if (lineStyle.stretchToFit)
-				{
-					float64_t sectionArcLen = 0.0;
-					for (uint32_t i = 0u; i < quadBezierCount; i++)
-					{
-						const QuadraticBezierInfo& quadBezierInfo = m_quadBeziers[section.index + i];
-						nbl::hlsl::shapes::Quadratic<double> quadratic = nbl::hlsl::shapes::Quadratic<double>::constructFromBezier(quadBezierInfo.shape);
-						nbl::hlsl::shapes::Quadratic<double>::ArcLengthCalculator arcLenCalc = nbl::hlsl::shapes::Quadratic<double>::ArcLengthCalculator::construct(quadratic);
-						sectionArcLen += arcLenCalc.calcArcLen(1.0);
-					}
 					stretchValue = lineStyle.calculateStretchValue(sectionArcLen);
-				}
 				
 				if (patternStartAgain)
 					currentPhaseShift = lineStyle.getStretchedPhaseShift(stretchValue);
@@ -612,9 +627,7 @@ public:
 						connectorBuilder.addBezierNormals(m_quadBeziers[currIdx], currentPhaseShift);
 					
 					// setting next phase shift based on current arc length
-					nbl::hlsl::shapes::Quadratic<double> quadratic = nbl::hlsl::shapes::Quadratic<double>::constructFromBezier(quadBezierInfo.shape);
-					nbl::hlsl::shapes::Quadratic<double>::ArcLengthCalculator arcLenCalc = nbl::hlsl::shapes::Quadratic<double>::ArcLengthCalculator::construct(quadratic);
-					const double bezierLen = arcLenCalc.calcArcLen(1.0);
+					const double bezierLen = bezierArcLens.getBezierArcLen(i);
 					
 					if (shouldAddShapes)
 					{
@@ -631,8 +644,7 @@ public:
 						float64_t currentWorldSpaceOffset = nextShapeOffset * stretchedPatternLen;
 						for (int32_t s = 0; s < numberOfShapes; ++s)
 						{
-							float64_t t = arcLenCalc.calcArcLenInverse(quadratic, 0.0, 1.0, currentWorldSpaceOffset, 1e-5, 0.5);
-							addShape(quadratic.evaluate(t), quadratic.derivative(t), stretchValue);
+							bezierArcLens.add(i, currentWorldSpaceOffset);
 							currentWorldSpaceOffset += stretchedPatternLen;
 						}
 					}
@@ -640,13 +652,25 @@ public:
 					const double changeInPhaseShift = glm::fract(bezierLen * rcpStretchedPatternLen);
 					currentPhaseShift = static_cast<float32_t>(glm::fract(currentPhaseShift + changeInPhaseShift));
 				}
+
+				if (shouldAddShapes)
+				{
+					bezierArcLens.solve(1e-5);
+					for (uint32_t s = 0u; s < bezierArcLens.getProblemCount(); ++s)
+					{
+						const float64_t t = bezierArcLens.getResult(s);
+						nbl::hlsl::shapes::Quadratic<double> quadratic = nbl::hlsl::shapes::Quadratic<double>::constructFromBezier(m_quadBeziers[section.index + bezierArcLens.getProblemBezier(s)].shape);
+						addShape(quadratic.evaluate(t), quadratic.derivative(t), stretchValue);
+					}
+				}
 			}
 		}
 
 		if (lineStyle.isRoadStyleFlag)
 		{
 			connectorBuilder.setPhaseShiftAtEndOfPolyline(currentPhaseShift);
-			m_polylineConnector = connectorBuilder.buildConnectors(lineStyle, m_closedPolygon);
+			const std::vector<PolylineConnector> connectors = connectorBuilder.buildConnectors(lineStyle, m_closedPolygon);
+			m_polylineConnector.assign(connectors.begin(), connectors.end());
 		}
 	}
 
@@ -727,7 +751,10 @@ public:
 		}
 	}
 
-	CPolyline generateParallelPolyline(float64_t offset, const float64_t maxError = 1e-5) const
+	// Sections are offset in parallel on `threadCount` threads (0 will use std::thread::hardware_concurrency()) then connected serially in order, the result doesn't depend on the thread count
+	// Only polylines with at least `ParallelOffsetMinObjectsPerThread` objects per thread go wide, threads cost more than offsetting small ones
+	// The result uses this polyline's memory resource, copy it to another resource (see `ParallelPolylineCache`) if it has to outlive e.g. a `MemoryArena` reset
+	CPolyline generateParallelPolyline(float64_t offset, const float64_t maxError = 1e-5, uint32_t threadCount = 1u) const
 	{
 		// DISCONNECTION DETECTED, will break styling and offsetting the polyline, if you don't care about those then ignore discontinuity.
 		_NBL_DEBUG_BREAK_IF(!checkSectionsContinuity());
@@ -741,7 +768,7 @@ public:
 				return vec / dirLen;
 			};
 
-		CPolyline parallelPolyline = {};
+		CPolyline parallelPolyline(getMemoryResource());
 		parallelPolyline.setClosed(m_closedPolygon);
 
 		// The next two lamda functions connect offsetted beziers and lines
@@ -913,60 +940,109 @@ public:
 				previousLineSectionIdx = newSections.size() - 1u;
 			};
 
-		// This loop Generates Mitered Line Sections and Offseted Beziers -> will still have breaks and disconnections 
-		// then we call addBezierSection and it connects it to the previous section
-		for (uint32_t i = 0; i < m_sections.size(); ++i)
+		// This Generates Mitered Line Sections and Offseted Beziers -> will still have breaks and disconnections 
+		// Sections don't depend on each other here, so this part (where bezier subdivision takes most of the time) can go wide
+		struct OffsettedSection
 		{
-			const auto& section = m_sections[i];
-			if (section.type == ObjectType::LINE)
+			std::vector<float64_t2> linePoints;
+			std::vector<nbl::hlsl::shapes::QuadraticBezier<double>> beziers;
+		};
+		std::vector<OffsettedSection> offsettedSections(m_sections.size());
+
+		auto offsetSection = [&](uint32_t i)
 			{
-				// TODO: try merging lines if they have same tangent (resultin in less points)
-				std::vector<float64_t2> newLinePoints;
-				newLinePoints.reserve(m_linePoints.size());
-				for (uint32_t j = 0; j < section.count + 1; ++j)
+				const auto& section = m_sections[i];
+				if (section.type == ObjectType::LINE)
 				{
-					const uint32_t linePointIdx = section.index + j;
-					float64_t2 offsetVector;
-					if (j == 0)
+					// TODO: try merging lines if they have same tangent (resultin in less points)
+					std::vector<float64_t2>& newLinePoints = offsettedSections[i].linePoints;
+					newLinePoints.reserve(section.count + 1u);
+					for (uint32_t j = 0; j < section.count + 1; ++j)
 					{
-						const float64_t2 tangent = safe_normalize(m_linePoints[linePointIdx + 1].p - m_linePoints[linePointIdx].p);
-						offsetVector = float64_t2(tangent.y, -tangent.x);
-					}
-					else if (j == section.count)
-					{
-						const float64_t2 tangent = safe_normalize(m_linePoints[linePointIdx].p - m_linePoints[linePointIdx - 1].p);
-						offsetVector = float64_t2(tangent.y, -tangent.x);
+						const uint32_t linePointIdx = section.index + j;
+						float64_t2 offsetVector;
+						if (j == 0)
+						{
+							const float64_t2 tangent = safe_normalize(m_linePoints[linePointIdx + 1].p - m_linePoints[linePointIdx].p);
+							offsetVector = float64_t2(tangent.y, -tangent.x);
+						}
+						else if (j == section.count)
+						{
+							const float64_t2 tangent = safe_normalize(m_linePoints[linePointIdx].p - m_linePoints[linePointIdx - 1].p);
+							offsetVector = float64_t2(tangent.y, -tangent.x);
+						}
+						else
+						{
+							const float64_t2 tangentPrevLine = safe_normalize(m_linePoints[linePointIdx].p - m_linePoints[linePointIdx - 1].p);
+							const float64_t2 normalPrevLine = float64_t2(tangentPrevLine.y, -tangentPrevLine.x);
+							const float64_t2 tangentNextLine = safe_normalize(m_linePoints[linePointIdx + 1].p - m_linePoints[linePointIdx].p);
+							const float64_t2 normalNextLine = float64_t2(tangentNextLine.y, -tangentNextLine.x);
+
+							const float64_t2 intersectionDirection = safe_normalize(normalPrevLine + normalNextLine);
+							const float64_t cosAngleBetweenNormals = glm::dot(normalPrevLine, normalNextLine);
+							offsetVector = intersectionDirection * sqrt(2.0 / (1.0 + cosAngleBetweenNormals));
+						}
+						newLinePoints.push_back(m_linePoints[linePointIdx].p + offsetVector * offset);
 					}
-					else
+				}
+				else if (section.type == ObjectType::QUAD_BEZIER)
+				{
+					std::vector<nbl::hlsl::shapes::QuadraticBezier<double>>& newBeziers = offsettedSections[i].beziers;
+					curves::Subdivision::AddBezierFunc addToBezier = [&](nbl::hlsl::shapes::QuadraticBezier<double>&& info) -> void
+						{
+							newBeziers.push_back(info);
+						};
+					for (uint32_t j = 0; j < section.count; ++j)
 					{
-						const float64_t2 tangentPrevLine = safe_normalize(m_linePoints[linePointIdx].p - m_linePoints[linePointIdx - 1].p);
-						const float64_t2 normalPrevLine = float64_t2(tangentPrevLine.y, -tangentPrevLine.x);
-						const float64_t2 tangentNextLine = safe_normalize(m_linePoints[linePointIdx + 1].p - m_linePoints[linePointIdx].p);
-						const float64_t2 normalNextLine = float64_t2(tangentNextLine.y, -tangentNextLine.x);
-
-						const float64_t2 intersectionDirection = safe_normalize(normalPrevLine + normalNextLine);
-						const float64_t cosAngleBetweenNormals = glm::dot(normalPrevLine, normalNextLine);
-						offsetVector = intersectionDirection * sqrt(2.0 / (1.0 + cosAngleBetweenNormals));
+						const uint32_t bezierIdx = section.index + j;
+						curves::OffsettedBezier offsettedBezier(m_quadBeziers[bezierIdx].shape, offset);
+						curves::Subdivision::adaptive(offsettedBezier, maxError, addToBezier, 10u);
 					}
-					newLinePoints.push_back(m_linePoints[linePointIdx].p + offsetVector * offset);
 				}
-				connectLinesSection(std::move(newLinePoints));
-			}
-			else if (section.type == ObjectType::QUAD_BEZIER)
-			{
-				std::vector<nbl::hlsl::shapes::QuadraticBezier<double>> newBeziers;
-				curves::Subdivision::AddBezierFunc addToBezier = [&](nbl::hlsl::shapes::QuadraticBezier<double>&& info) -> void
-					{
-						newBeziers.push_back(info);
-					};
-				for (uint32_t j = 0; j < section.count; ++j)
+			};
+
+		const uint32_t sectionCount = static_cast<uint32_t>(m_sections.size());
+		const uint32_t objectCount = static_cast<uint32_t>(m_linePoints.size() + m_quadBeziers.size());
+		if (threadCount == 0u)
+			threadCount = std::thread::hardware_concurrency();
+		threadCount = nbl::core::max(nbl::core::min(threadCount, objectCount / ParallelOffsetMinObjectsPerThread), 1u);
+
+		if (threadCount > 1u)
+		{
+			// sections are handed out in small chunks, their cost varies a lot with the type and object count
+			constexpr uint32_t SectionsPerChunk = 16u;
+			std::atomic_uint32_t nextSectionIdx = 0u;
+			auto worker = [&]()
 				{
-					const uint32_t bezierIdx = section.index + j;
-					curves::OffsettedBezier offsettedBezier(m_quadBeziers[bezierIdx].shape, offset);
-					curves::Subdivision::adaptive(offsettedBezier, maxError, addToBezier, 10u);
-				}
-				connectBezierSection(std::move(newBeziers));
-			}
+					for (uint32_t first = nextSectionIdx.fetch_add(SectionsPerChunk); first < sectionCount; first = nextSectionIdx.fetch_add(SectionsPerChunk))
+					{
+						const uint32_t last = nbl::core::min(first + SectionsPerChunk, sectionCount);
+						for (uint32_t i = first; i < last; ++i)
+							offsetSection(i);
+					}
+				};
+
+			std::vector<std::thread> workers;
+			workers.reserve(threadCount - 1u);
+			for (uint32_t i = 1u; i < threadCount; ++i)
+				workers.emplace_back(worker);
+			worker(); // calling thread does work as well
+			for (auto& thread : workers)
+				thread.join();
+		}
+		else
+		{
+			for (uint32_t i = 0u; i < sectionCount; ++i)
+				offsetSection(i);
+		}
+
+		// then we connect each offsetted section to the previous one in order, miters and trims at the section boundaries change the previous sections so this stays serial
+		for (uint32_t i = 0u; i < sectionCount; ++i)
+		{
+			if (m_sections[i].type == ObjectType::LINE)
+				connectLinesSection(std::move(offsettedSections[i].linePoints));
+			else if (m_sections[i].type == ObjectType::QUAD_BEZIER)
+				connectBezierSection(std::move(offsettedSections[i].beziers));
 		}
 
 		if (parallelPolyline.m_closedPolygon)
@@ -980,11 +1056,16 @@ public:
 	}
 	
 	// outputs two offsets to the polyline and connects the ends if not closed
-	void makeWideWhole(CPolyline& outOffset1, CPolyline& outOffset2, float64_t offset, const float64_t maxError = 1e-5) const
+	void makeWideWhole(CPolyline& outOffset1, CPolyline& outOffset2, float64_t offset, const float64_t maxError = 1e-5, uint32_t threadCount = 1u) const
 	{
-		outOffset1 = generateParallelPolyline(offset, maxError);
-		outOffset2 = generateParallelPolyline(-1.0 * offset, maxError);
+		outOffset1 = generateParallelPolyline(offset, maxError, threadCount);
+		outOffset2 = generateParallelPolyline(-1.0 * offset, maxError, threadCount);
+		connectWideEnds(outOffset1, outOffset2);
+	}
 
+	// connects the ends of two opposite offsets of this polyline (if not closed) by adding the connectors to `outOffset2`
+	void connectWideEnds(const CPolyline& outOffset1, CPolyline& outOffset2) const
+	{
 		if (!m_closedPolygon)
 		{
 			nbl::hlsl::float64_t2 beginToBeginConnector[2u];
@@ -997,6 +1078,89 @@ public:
 			outOffset2.addLinePoints({ endToEndConnector, endToEndConnector + 2 });
 		}
 	}
+
+	// Level of detail simplification: the result stays within `maxError` of this polyline (checked at sample points along both)
+	// Line sections are reduced with Douglas-Peucker and runs of consecutive beziers in a section are merged into one bezier, or into a line when a straight one is close enough
+	// Only the geometry is kept, call `preprocessPolylineWithStyle` on the result to style it
+	CPolyline generateSimplifiedPolyline(float64_t maxError) const
+	{
+		CPolyline ret(getMemoryResource());
+		ret.setClosed(m_closedPolygon);
+
+		// only one of these is non-empty at a time, so sections are added in order
+		std::vector<float64_t2> linePoints;
+		std::vector<nbl::hlsl::shapes::QuadraticBezier<float64_t>> beziers;
+		auto flushLinePoints = [&]()
+			{
+				if (linePoints.size() > 1u)
+					ret.addLinePoints(linePoints);
+				linePoints.clear();
+			};
+		auto flushBeziers = [&]()
+			{
+				if (!beziers.empty())
+					ret.addQuadBeziers(beziers);
+				beziers.clear();
+			};
+		auto addLinePoint = [&](const float64_t2& point)
+			{
+				if (linePoints.empty() || linePoints.back().x != point.x || linePoints.back().y != point.y)
+					linePoints.push_back(point);
+			};
+
+		for (const SectionInfo& section : m_sections)
+		{
+			if (section.type == ObjectType::LINE)
+			{
+				flushBeziers();
+				const std::span<const LinePointInfo> points = { m_linePoints.data() + section.index, section.count + 1u };
+				std::vector<bool> keep(points.size(), false);
+				simplifyLinePoints(points, maxError, keep);
+				for (uint32_t i = 0u; i < points.size(); ++i)
+					if (keep[i])
+						addLinePoint(points[i].p);
+			}
+			else if (section.type == ObjectType::QUAD_BEZIER)
+			{
+				const std::span<const QuadraticBezierInfo> sectionBeziers = { m_quadBeziers.data() + section.index, section.count };
+				uint32_t first = 0u;
+				while (first < sectionBeziers.size())
+				{
+					// greedily grow the run for as long as it can be merged
+					nbl::hlsl::shapes::QuadraticBezier<float64_t> merged = sectionBeziers[first].shape;
+					bool mergedIsStraight = false;
+					uint32_t end = first + 1u;
+					for (uint32_t candidateEnd = first + 1u; candidateEnd <= sectionBeziers.size() && candidateEnd - first <= SimplifyMaxMergedBeziers; ++candidateEnd)
+					{
+						nbl::hlsl::shapes::QuadraticBezier<float64_t> candidate;
+						bool candidateIsStraight;
+						if (!mergeBeziers(sectionBeziers.subspan(first, candidateEnd - first), maxError, candidate, candidateIsStraight))
+							break;
+						merged = candidate;
+						mergedIsStraight = candidateIsStraight;
+						end = candidateEnd;
+					}
+
+					if (mergedIsStraight)
+					{
+						flushBeziers();
+						addLinePoint(merged.P0);
+						addLinePoint(merged.P2);
+					}
+					else
+					{
+						flushLinePoints();
+						beziers.push_back(merged);
+					}
+					first = end;
+				}
+			}
+		}
+		flushLinePoints();
+		flushBeziers();
+
+		return ret;
+	}
 			
 	// Manual CPU Styling: breaks the current polyline into more polylines based the stipple pattern
 	// we could output a list/vector of polylines instead of using lambda but most of the time we need to work with the output and throw it away immediately.
@@ -1014,7 +1178,7 @@ public:
 		const float32_t gapSectionNormalizedLen = 1.0 - lineStyle.stipplePattern[0];
 		const float32_t drawSectionLen = drawSectionNormalizedLen / lineStyle.reciprocalStipplePatternLen;
 		
-		CPolyline currentPolyline;
+		CPolyline currentPolyline(getMemoryResource());
 		std::vector<float64_t2> linePoints;
 		std::vector<nbl::hlsl::shapes::QuadraticBezier<float64_t>> beziers;
 		auto flushCurrentPolyline = [&]()
@@ -1205,14 +1369,17 @@ public:
 		m_closedPolygon = closed;
 	}
 
+	// see `generateParallelPolyline`
+	static constexpr uint32_t ParallelOffsetMinObjectsPerThread = 4096u;
+
 	float64_t2 getMin() const { return m_Min; }
 	float64_t2 getMax() const { return m_Max; }
 
 protected:
-	std::vector<PolylineConnector> m_polylineConnector;
-	std::vector<SectionInfo> m_sections;
-	std::vector<LinePointInfo> m_linePoints;
-	std::vector<QuadraticBezierInfo> m_quadBeziers;
+	std::pmr::vector<PolylineConnector> m_polylineConnector;
+	std::pmr::vector<SectionInfo> m_sections;
+	std::pmr::vector<LinePointInfo> m_linePoints;
+	std::pmr::vector<QuadraticBezierInfo> m_quadBeziers;
 	uint32_t lastSectionsSize = std::numeric_limits<uint32_t>::max();
 	// important for miter and parallel generation
 	bool m_closedPolygon = false;
@@ -1228,6 +1395,133 @@ protected:
 	float64_t2 m_Min; // min coordinate of the whole polyline
 	float64_t2 m_Max; // max coordinate of the whole polyline
 
+	// `generateSimplifiedPolyline` helpers
+	static constexpr uint32_t SimplifyMaxMergedBeziers = 32u;
+	static constexpr uint32_t SimplifySegmentsPerBezier = 16u; // beziers are flattened to lines to measure distances
+
+	static float64_t distanceToSegment(const float64_t2& point, const float64_t2& a, const float64_t2& b)
+	{
+		const float64_t2 ab = b - a;
+		const float64_t lenSq = glm::dot(ab, ab);
+		const float64_t t = (lenSq > 0.0) ? std::clamp(glm::dot(point - a, ab) / lenSq, 0.0, 1.0) : 0.0;
+		return glm::distance(point, a + ab * t);
+	}
+
+	// Douglas-Peucker, sets `keep` for the points to keep (always the first and last)
+	static void simplifyLinePoints(std::span<const LinePointInfo> points, float64_t maxError, std::vector<bool>& keep)
+	{
+		keep.front() = keep.back() = true;
+		std::vector<std::pair<uint32_t, uint32_t>> stack = { { 0u, static_cast<uint32_t>(points.size() - 1u) } };
+		while (!stack.empty())
+		{
+			const auto [first, last] = stack.back();
+			stack.pop_back();
+
+			float64_t maxDistance = 0.0;
+			uint32_t farthest = first;
+			for (uint32_t i = first + 1u; i < last; ++i)
+			{
+				const float64_t distance = distanceToSegment(points[i].p, points[first].p, points[last].p);
+				if (distance > maxDistance)
+				{
+					maxDistance = distance;
+					farthest = i;
+				}
+			}
+
+			if (maxDistance > maxError)
+			{
+				keep[farthest] = true;
+				stack.push_back({ first, farthest });
+				stack.push_back({ farthest, last });
+			}
+		}
+	}
+
+	// Appends `SimplifySegmentsPerBezier + 1` points along `bezier` to `out` and returns how far the lines between them can get from the curve
+	static float64_t flattenBezier(const nbl::hlsl::shapes::QuadraticBezier<float64_t>& bezier, std::vector<float64_t2>& out)
+	{
+		for (uint32_t i = 0u; i <= SimplifySegmentsPerBezier; ++i)
+		{
+			const float64_t t = float64_t(i) / float64_t(SimplifySegmentsPerBezier);
+			const float64_t s = 1.0 - t;
+			out.push_back(bezier.P0 * (s * s) + bezier.P1 * (2.0 * s * t) + bezier.P2 * (t * t));
+		}
+		// chord error of a quadratic is |second derivative| * h^2 / 8, with h = 1 / segments
+		const float64_t2 secondDerivative = (bezier.P0 - bezier.P1 * 2.0 + bezier.P2) * 2.0;
+		return glm::length(secondDerivative) / (8.0 * SimplifySegmentsPerBezier * SimplifySegmentsPerBezier);
+	}
+
+	// Tries replacing `run` with a single straight line or (failing that) a bezier tangent to the run's ends, returns false if neither stays within `maxError`
+	static bool mergeBeziers(std::span<const QuadraticBezierInfo> run, float64_t maxError, nbl::hlsl::shapes::QuadraticBezier<float64_t>& outMerged, bool& outIsStraight)
+	{
+		const float64_t2 P0 = run.front().shape.P0;
+		const float64_t2 P2 = run.back().shape.P2;
+
+		std::vector<float64_t2> runPoints;
+		runPoints.reserve(run.size() * (SimplifySegmentsPerBezier + 1u));
+		float64_t runFlatteningError = 0.0;
+		for (const auto& bezier : run)
+			runFlatteningError = nbl::core::max(runFlatteningError, flattenBezier(bezier.shape, runPoints));
+
+		auto distanceToPoints = [](const float64_t2& point, const std::vector<float64_t2>& points)
+			{
+				float64_t ret = std::numeric_limits<float64_t>::max();
+				for (uint32_t i = 1u; i < points.size(); ++i)
+					ret = nbl::core::min(ret, distanceToSegment(point, points[i - 1u], points[i]));
+				return ret;
+			};
+		// both ways, so the candidate neither misses parts of the run nor wanders off where the run has no samples
+		auto fits = [&](const std::vector<float64_t2>& candidatePoints, float64_t candidateFlatteningError)
+			{
+				for (const float64_t2& point : runPoints)
+					if (distanceToPoints(point, candidatePoints) + candidateFlatteningError > maxError)
+						return false;
+				for (const float64_t2& point : candidatePoints)
+					if (distanceToPoints(point, runPoints) + runFlatteningError > maxError)
+						return false;
+				return true;
+			};
+
+		// a straight line is cheaper to draw (one cage instead of three), try it first
+		std::vector<float64_t2> candidatePoints;
+		for (uint32_t i = 0u; i <= SimplifySegmentsPerBezier; ++i)
+			candidatePoints.push_back(P0 + (P2 - P0) * (float64_t(i) / float64_t(SimplifySegmentsPerBezier)));
+		if (fits(candidatePoints, 0.0))
+		{
+			outMerged = nbl::hlsl::shapes::QuadraticBezier<float64_t>::construct(P0, (P0 + P2) * 0.5, P2);
+			outIsStraight = true;
+			return true;
+		}
+
+		// P1 where the tangents at the ends meet
+		auto getTangent = [](const nbl::hlsl::shapes::QuadraticBezier<float64_t>& bezier, bool atStart)
+			{
+				const float64_t2 tangent = atStart ? bezier.P1 - bezier.P0 : bezier.P2 - bezier.P1;
+				return (glm::dot(tangent, tangent) > 0.0) ? tangent : bezier.P2 - bezier.P0;
+			};
+		const float64_t2 startTangent = getTangent(run.front().shape, true);
+		const float64_t2 endTangent = getTangent(run.back().shape, false);
+		const float64_t crossTangents = startTangent.x * endTangent.y - startTangent.y * endTangent.x;
+		if (std::abs(crossTangents) <= 1e-12 * glm::length(startTangent) * glm::length(endTangent))
+			return false;
+		const float64_t2 chord = P2 - P0;
+		const float64_t startParam = (chord.x * endTangent.y - chord.y * endTangent.x) / crossTangents;
+		const float64_t endParam = (startTangent.x * chord.y - startTangent.y * chord.x) / crossTangents;
+		if (startParam <= 0.0 || endParam <= 0.0)
+			return false;
+
+		const auto candidate = nbl::hlsl::shapes::QuadraticBezier<float64_t>::construct(P0, P0 + startTangent * startParam, P2);
+		candidatePoints.clear();
+		const float64_t candidateFlatteningError = flattenBezier(candidate, candidatePoints);
+		if (!fits(candidatePoints, candidateFlatteningError))
+			return false;
+
+		outMerged = candidate;
+		outIsStraight = false;
+		return true;
+	}
+
 	// Next 3 are protected member functions to modify current lines and bezier sections used in polyline offsetting:
 
 	void insertLinePointsToSection(uint32_t sectionIdx, uint32_t insertionPoint, const std::span<float64_t2> linePoints)
@@ -1446,7 +1740,130 @@ protected:
 		return res;
 	}
 
+	// Intersects an object of each section and selects the intersection if it removes more objects from both sections than the currently selected one
+	void intersectSectionObjectsAndSelect(const SectionInfo& prevSection, uint32_t prevObjIdx, const SectionInfo& nextSection, uint32_t nextObjIdx, SectionIntersectResult& selected, int32_t& selectedObjectRemoveCount) const
+	{
+		int32_t objectsToRemove = (prevSection.count - prevObjIdx - 1u) + (nextObjIdx); // number of objects that will be pruned/removed if this intersection is selected
+		assert(objectsToRemove >= 0);
+
+		constexpr uint32_t MaxIntersectionResults = 4u;
+		SectionIntersectResult intersectionResults[MaxIntersectionResults];
+		uint32_t intersectionResultCount = 0u;
+
+		if (prevSection.type == ObjectType::LINE && nextSection.type == ObjectType::LINE)
+		{
+			SectionIntersectResult localIntersectionResult = intersectLineSectionObjects(prevSection, prevObjIdx, nextSection, nextObjIdx);
+			intersectionResults[0u] = localIntersectionResult;
+			intersectionResultCount = 1u;
+		}
+		else if ((prevSection.type == ObjectType::QUAD_BEZIER && nextSection.type == ObjectType::LINE) || (prevSection.type == ObjectType::LINE && nextSection.type == ObjectType::QUAD_BEZIER))
+		{
+			std::array<SectionIntersectResult, 2> localIntersectionResults = intersectLineBezierSectionObjects(prevSection, prevObjIdx, nextSection, nextObjIdx);
+			intersectionResults[0] = localIntersectionResults[0];
+			intersectionResults[1] = localIntersectionResults[1];
+			intersectionResultCount = 2u;
+		}
+		else if (prevSection.type == ObjectType::QUAD_BEZIER && nextSection.type == ObjectType::QUAD_BEZIER)
+		{
+			std::array<SectionIntersectResult, 4> localIntersectionResults = intersectBezierBezierSectionObjects(prevSection, prevObjIdx, nextSection, nextObjIdx);
+			intersectionResults[0] = localIntersectionResults[0];
+			intersectionResults[1] = localIntersectionResults[1];
+			intersectionResults[2] = localIntersectionResults[2];
+			intersectionResults[3] = localIntersectionResults[3];
+			intersectionResultCount = 4u;
+		}
+
+		for (uint32_t i = 0u; i < intersectionResultCount; ++i)
+		{
+			if (intersectionResults[i].valid())
+			{
+				// TODO: Better Criterial to select between multiple intersections of the same objects
+				if (objectsToRemove > selectedObjectRemoveCount)
+				{
+					selected = intersectionResults[i];
+					selectedObjectRemoveCount = objectsToRemove;
+				}
+			}
+		}
+	}
+
+	using SectionObjectAABB = AABBTree<float64_t2>::AABB;
+
+	SectionObjectAABB getSectionObjectAABB(const SectionInfo& section, uint32_t objIdx) const
+	{
+		SectionObjectAABB ret = {};
+		auto extend = [&](const float64_t2 point)
+			{
+				ret.min.x = nbl::core::min(ret.min.x, point.x);
+				ret.min.y = nbl::core::min(ret.min.y, point.y);
+				ret.max.x = nbl::core::max(ret.max.x, point.x);
+				ret.max.y = nbl::core::max(ret.max.y, point.y);
+			};
+
+		if (section.type == ObjectType::LINE)
+		{
+			ret.min = ret.max = m_linePoints[section.index + objIdx].p;
+			extend(m_linePoints[section.index + objIdx + 1u].p);
+		}
+		else if (section.type == ObjectType::QUAD_BEZIER)
+		{
+			const auto& bezier = m_quadBeziers[section.index + objIdx].shape;
+			ret.min = ret.max = bezier.P0;
+			extend(bezier.P2);
+
+			const auto quadratic = nbl::hlsl::shapes::Quadratic<float64_t>::constructFromBezier(bezier.P0, bezier.P1, bezier.P2);
+			const float64_t tExtremumX = -quadratic.B.x / (2.0 * quadratic.A.x);
+			const float64_t tExtremumY = -quadratic.B.y / (2.0 * quadratic.A.y);
+			// NaN/inf for a degenerate axis fails these checks as well
+			if (tExtremumX >= 0.0 && tExtremumX <= 1.0)
+				extend(quadratic.evaluate(tExtremumX));
+			if (tExtremumY >= 0.0 && tExtremumY <= 1.0)
+				extend(quadratic.evaluate(tExtremumY));
+		}
+		return ret;
+	}
+
+	// Sweep and prune is cheaper for small sections but only prunes along one axis, so it degrades to testing all pairs when many objects overlap along the sweep axis
+	static constexpr uint32_t SectionIntersectSweepAndPruneMaxObjects = 64u;
+
 	SectionIntersectResult intersectTwoSections(const SectionInfo& prevSection, const SectionInfo& nextSection) const
+	{
+		if (prevSection.count + nextSection.count <= SectionIntersectSweepAndPruneMaxObjects)
+			return intersectTwoSections_SweepAndPrune(prevSection, nextSection);
+		else
+			return intersectTwoSections_BVH(prevSection, nextSection);
+	}
+
+	// Builds a BVH over the next section's objects and queries it with each of the previous section's objects
+	SectionIntersectResult intersectTwoSections_BVH(const SectionInfo& prevSection, const SectionInfo& nextSection) const
+	{
+		SectionIntersectResult ret = {};
+		ret.invalidate();
+
+		if (prevSection.count == 0 || nextSection.count == 0)
+			return ret;
+
+		std::vector<SectionObjectAABB> nextObjectsAABBs(nextSection.count);
+		for (uint32_t i = 0u; i < nextSection.count; ++i)
+			nextObjectsAABBs[i] = getSectionObjectAABB(nextSection, i);
+
+		AABBTree<float64_t2> nextObjectsBVH;
+		nextObjectsBVH.build(nextObjectsAABBs);
+
+		int32_t currentIntersectionObjectRemoveCount = -1; // we use this value to select only one from many intersections that removes the most objects from both sections.
+		for (uint32_t prevObjIdx = 0u; prevObjIdx < prevSection.count; ++prevObjIdx)
+		{
+			nextObjectsBVH.query(getSectionObjectAABB(prevSection, prevObjIdx),
+				[&](uint32_t nextObjIdx)
+				{
+					intersectSectionObjectsAndSelect(prevSection, prevObjIdx, nextSection, nextObjIdx, ret, currentIntersectionObjectRemoveCount);
+				});
+		}
+
+		return ret;
+	}
+
+	SectionIntersectResult intersectTwoSections_SweepAndPrune(const SectionInfo& prevSection, const SectionInfo& nextSection) const
 	{
 		SectionIntersectResult ret = {};
 		ret.invalidate();
@@ -1532,49 +1949,7 @@ protected:
 					{
 						uint32_t prevObjIdx = (obj.isInPrevSection) ? obj.idxInSection : entry.idxInSection;
 						uint32_t nextObjIdx = (obj.isInPrevSection) ? entry.idxInSection : obj.idxInSection;
-
-						int32_t objectsToRemove = (prevSection.count - prevObjIdx - 1u) + (nextObjIdx); // number of objects that will be pruned/removed if this intersection is selected
-						assert(objectsToRemove >= 0);
-
-						constexpr uint32_t MaxIntersectionResults = 4u;
-						SectionIntersectResult intersectionResults[MaxIntersectionResults];
-						uint32_t intersectionResultCount = 0u;
-
-						if (prevSection.type == ObjectType::LINE && nextSection.type == ObjectType::LINE)
-						{
-							SectionIntersectResult localIntersectionResult = intersectLineSectionObjects(prevSection, prevObjIdx, nextSection, nextObjIdx);
-							intersectionResults[0u] = localIntersectionResult;
-							intersectionResultCount = 1u;
-						}
-						else if ((prevSection.type == ObjectType::QUAD_BEZIER && nextSection.type == ObjectType::LINE) || (prevSection.type == ObjectType::LINE && nextSection.type == ObjectType::QUAD_BEZIER))
-						{
-							std::array<SectionIntersectResult, 2> localIntersectionResults = intersectLineBezierSectionObjects(prevSection, prevObjIdx, nextSection, nextObjIdx);
-							intersectionResults[0] = localIntersectionResults[0];
-							intersectionResults[1] = localIntersectionResults[1];
-							intersectionResultCount = 2u;
-						}
-						else if (prevSection.type == ObjectType::QUAD_BEZIER && nextSection.type == ObjectType::QUAD_BEZIER)
-						{
-							std::array<SectionIntersectResult, 4> localIntersectionResults = intersectBezierBezierSectionObjects(prevSection, prevObjIdx, nextSection, nextObjIdx);
-							intersectionResults[0] = localIntersectionResults[0];
-							intersectionResults[1] = localIntersectionResults[1];
-							intersectionResults[2] = localIntersectionResults[2];
-							intersectionResults[3] = localIntersectionResults[3];
-							intersectionResultCount = 4u;
-						}
-						
-						for (uint32_t i = 0u; i < intersectionResultCount; ++i)
-						{
-							if (intersectionResults[i].valid())
-							{
-								// TODO: Better Criterial to select between multiple intersections of the same objects
-								if (objectsToRemove > currentIntersectionObjectRemoveCount)
-								{
-									ret = intersectionResults[i];
-									currentIntersectionObjectRemoveCount = objectsToRemove;
-								}
-							}
-						}
+						intersectSectionObjectsAndSelect(prevSection, prevObjIdx, nextSection, nextObjIdx, ret, currentIntersectionObjectRemoveCount);
 					}
 				}
 				activeCandidates.push_back(entry);
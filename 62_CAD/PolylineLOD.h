@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Polyline.h"
+
+// Precomputed levels of detail of a polyline for coarse zoom, made by `CPolyline::generateSimplifiedPolyline`
+// Level 0 is a copy of the polyline, level i > 0 stays within `getLevelError(i)` (world space) of it, the error growing by at least `errorGrowth` per level
+// Levels are simplified from the original polyline rather than from the previous level, so errors don't add up
+// `DrawResourcesFiller::drawPolyline(const CPolylineLOD&, ...)` picks the level from the current clip projection
+class CPolylineLOD
+{
+public:
+	static constexpr uint32_t MaxLevels = 8u;
+
+	// `finestError` is the error of the first simplified level, errors that don't remove anything compared to the previous level don't get a level
+	// `maxLevels` is clamped to `MaxLevels`
+	CPolylineLOD(const CPolyline& polyline, float64_t finestError, float64_t errorGrowth = 4.0, uint32_t maxLevels = MaxLevels)
+	{
+		m_levels.push_back(polyline);
+		m_levelErrors.push_back(0.0);
+
+		uint32_t prevObjectCount = getObjectCount(polyline);
+		float64_t error = finestError;
+		maxLevels = std::min(maxLevels, MaxLevels);
+		for (uint32_t level = 1u; level < maxLevels && prevObjectCount > 1u; ++level)
+		{
+			CPolyline simplified = polyline.generateSimplifiedPolyline(error);
+			const uint32_t objectCount = getObjectCount(simplified);
+			if (objectCount < prevObjectCount)
+			{
+				m_levels.push_back(std::move(simplified));
+				m_levelErrors.push_back(error);
+				prevObjectCount = objectCount;
+			}
+			error *= errorGrowth;
+		}
+	}
+
+	inline uint32_t getLevelCount() const { return static_cast<uint32_t>(m_levels.size()); }
+	inline const CPolyline& getLevel(uint32_t level) const { return m_levels[level]; }
+	inline float64_t getLevelError(uint32_t level) const { return m_levelErrors[level]; }
+
+	// Coarsest level with error under `maxError`
+	uint32_t selectLevel(float64_t maxError) const
+	{
+		uint32_t ret = 0u;
+		while (ret + 1u < m_levels.size() && m_levelErrors[ret + 1u] <= maxError)
+			ret++;
+		return ret;
+	}
+
+	// `CPolyline::preprocessPolylineWithStyle` on every level, simplified levels are slightly shorter so their stipple patterns drift a bit from level 0's
+	void preprocessPolylineWithStyle(const LineStyleInfo& lineStyle)
+	{
+		for (CPolyline& level : m_levels)
+			level.preprocessPolylineWithStyle(lineStyle);
+	}
+
+	// Line + bezier count of a polyline, what draw cost roughly scales with
+	static uint32_t getObjectCount(const CPolylineBase& polyline)
+	{
+		uint32_t ret = 0u;
+		for (uint32_t i = 0u; i < polyline.getSectionsCount(); ++i)
+			ret += polyline.getSectionInfoAt(i).count;
+		return ret;
+	}
+
+protected:
+	std::vector<CPolyline> m_levels;
+	std::vector<float64_t> m_levelErrors;
+};
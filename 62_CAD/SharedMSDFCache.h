@@ -0,0 +1,186 @@
+#pragma once
+
+#include "Hatch.h"
+#include <nbl/core/containers/LRUCache.h>
+#include <nbl/ext/TextRendering/TextRendering.h>
+
+#include <array>
+#include <future>
+#include <mutex>
+
+// MSDF Hashing
+enum class MSDFType : uint8_t
+{
+	HATCH_FILL_PATTERN,
+	FONT_GLYPH,
+};
+
+struct MSDFInputInfo
+{
+	// It's a font glyph
+	MSDFInputInfo(nbl::core::blake3_hash_t fontFaceHash, uint32_t glyphIdx)
+		: type(MSDFType::FONT_GLYPH)
+		, faceHash(fontFaceHash)
+		, glyphIndex(glyphIdx)
+	{
+		computeBlake3Hash();
+	}
+
+	// It's a hatch fill pattern
+	MSDFInputInfo(HatchFillPattern fillPattern)
+		: type(MSDFType::HATCH_FILL_PATTERN)
+		, faceHash({})
+		, fillPattern(fillPattern)
+	{
+		computeBlake3Hash();
+	}
+
+	bool operator==(const MSDFInputInfo& rhs) const
+	{ return hash == rhs.hash && glyphIndex == rhs.glyphIndex && type == rhs.type;
+	}
+
+	MSDFType type;
+	uint8_t pad[3u]; // 3 bytes pad
+	union
+	{
+		uint32_t glyphIndex;
+		HatchFillPattern fillPattern;
+	};
+	static_assert(sizeof(uint32_t) == sizeof(HatchFillPattern));
+
+	nbl::core::blake3_hash_t faceHash = {};
+	nbl::core::blake3_hash_t hash = {}; // actual hash, we will check in == operator
+	size_t lookupHash = 0ull; // for containers expecting size_t hash
+
+
+private:
+
+	void computeBlake3Hash()
+	{
+		nbl::core::blake3_hasher hasher;
+		hasher.update(&type, sizeof(MSDFType));
+		hasher.update(&glyphIndex, sizeof(uint32_t));
+		hasher.update(&faceHash, sizeof(nbl::core::blake3_hash_t));
+		hash = static_cast<nbl::core::blake3_hash_t>(hasher);
+		lookupHash = std::hash<nbl::core::blake3_hash_t>{}(hash); // hashing the hash :D
+	}
+
+};
+
+struct MSDFInputInfoHash { std::size_t operator()(const MSDFInputInfo& info) const { return info.lookupHash; } };
+
+// Thread-safe cache of generated MSDF images, shared between `DrawResourcesFiller`s (e.g. one per viewport of the same drawing) so each glyph/fill pattern is generated by msdfgen once
+// Only the cpu images are shared, every filler still uploads to and evicts from its own texture array
+// All fillers sharing a cache must use the same MSDF resolution and mip count, since those aren't part of `MSDFInputInfo`
+// Entries are split into shards by `MSDFInputInfo::lookupHash`, each with its own lock and LRU, so concurrent lookups of different glyphs rarely contend
+// Concurrent misses of the same input are deduped: the first caller generates, the others wait for its result
+class SharedMSDFCache : public nbl::core::IReferenceCounted
+{
+public:
+	static constexpr uint32_t ShardCount = 16u;
+
+	using GenerateFunc = std::function<nbl::core::smart_refctd_ptr<nbl::asset::ICPUImage>()>;
+
+	// `capacity` is the max number of images kept across all shards
+	explicit SharedMSDFCache(uint32_t capacity = 4096u)
+	{
+		m_shardCapacity = nbl::core::max((capacity + ShardCount - 1u) / ShardCount, 1u);
+		for (auto& shard : m_shards)
+			shard.cache = std::unique_ptr<ImageLRUCache>(new ImageLRUCache(m_shardCapacity));
+	}
+
+	// Returns the cached image of `input` or calls `generate` (outside of any lock) and caches its result, nullptr results aren't cached
+	// if `generate` throws, the entry is dropped and the exception is rethrown here and in every caller waiting on the same input
+	nbl::core::smart_refctd_ptr<nbl::asset::ICPUImage> getOrGenerate(const MSDFInputInfo& input, const GenerateFunc& generate)
+	{
+		Shard& shard = getShard(input);
+		std::unique_lock<std::mutex> lock(shard.mutex);
+		if (CacheEntry* cached = shard.cache->get(input))
+		{
+			// copy out before unlocking, the entry may get evicted meanwhile
+			const ImageFuture future = cached->image;
+			lock.unlock();
+			return future.get(); // blocks only if another thread is still generating it
+		}
+		std::promise<nbl::core::smart_refctd_ptr<nbl::asset::ICPUImage>> promise;
+		// the miss count never goes back, so it tells this generation apart from any later one of the same input
+		const uint64_t generationId = shard.missCount++;
+		shard.cache->insert(input, CacheEntry{ promise.get_future().share(), generationId });
+		lock.unlock();
+
+		// only erases our own entry, it could've been evicted and replaced by another caller's generation meanwhile
+		auto eraseOwnEntry = [&]()
+			{
+				std::lock_guard<std::mutex> eraseLock(shard.mutex);
+				const CacheEntry* entry = shard.cache->peek(input);
+				if (entry && entry->generationId == generationId)
+					shard.cache->erase(input);
+			};
+
+		nbl::core::smart_refctd_ptr<nbl::asset::ICPUImage> image;
+		try
+		{
+			image = generate ? generate() : nullptr;
+		}
+		catch (...)
+		{
+			eraseOwnEntry();
+			promise.set_exception(std::current_exception());
+			throw;
+		}
+
+		if (!image)
+			eraseOwnEntry();
+		promise.set_value(image);
+		return image;
+	}
+
+	// Drops every cached image, fillers keep the layers they already uploaded
+	void clear()
+	{
+		for (auto& shard : m_shards)
+		{
+			std::lock_guard<std::mutex> lock(shard.mutex);
+			shard.cache = std::unique_ptr<ImageLRUCache>(new ImageLRUCache(m_shardCapacity));
+		}
+	}
+
+	// number of `generate` calls, i.e. inputs not found in the cache
+	uint64_t getMissCount() const
+	{
+		uint64_t ret = 0ull;
+		for (auto& shard : m_shards)
+		{
+			std::lock_guard<std::mutex> lock(shard.mutex);
+			ret += shard.missCount;
+		}
+		return ret;
+	}
+
+protected:
+	~SharedMSDFCache() override = default;
+
+	using ImageFuture = std::shared_future<nbl::core::smart_refctd_ptr<nbl::asset::ICPUImage>>;
+	struct CacheEntry
+	{
+		ImageFuture image;
+		uint64_t generationId;
+	};
+	using ImageLRUCache = nbl::core::LRUCache<MSDFInputInfo, CacheEntry, MSDFInputInfoHash>;
+
+	struct alignas(64) Shard
+	{
+		mutable std::mutex mutex;
+		std::unique_ptr<ImageLRUCache> cache;
+		uint64_t missCount = 0ull;
+	};
+
+	Shard& getShard(const MSDFInputInfo& input)
+	{
+		// high bits, the LRU's hash map buckets already use the low ones
+		return m_shards[(input.lookupHash >> 32u) % ShardCount];
+	}
+
+	uint32_t m_shardCapacity;
+	std::array<Shard, ShardCount> m_shards;
+};
@@ -50,20 +50,32 @@ void SingleLineText::Draw(
 	const float32_t tiltTiltAngle,
 	const float32_t boldInPixels) const
 {
+	// columns of `translation * rotation * scale`, applied directly instead of a 3x3 multiply per glyph
 	float32_t2 vec(cos(rotateAngle), sin(rotateAngle));
-	float64_t3x3 rotationMulScaleMat =
+	const float64_t2 axisX = float64_t2(vec.x * scale.x, -vec.y * scale.x);
+	const float64_t2 axisY = float64_t2(vec.y * scale.y, vec.x * scale.y);
+	const float64_t axisXLen = glm::length(axisX);
+	const float64_t axisYLen = glm::length(axisY);
+
+	const uint32_t2 msdfResolution = drawResourcesFiller.getMSDFResolution();
+	if (m_glyphRun.size() != m_glyphBoxes.size() || m_glyphRunMSDFResolution.x != msdfResolution.x || m_glyphRunMSDFResolution.y != msdfResolution.y)
 	{
-		vec.x  * scale.x,	vec.y * scale.y,	0.0,
-		-vec.y * scale.x,	vec.x * scale.y,	0.0,
-		0.0,				0.0,				1.0,
-	};
-	float64_t3x3 translationMat =
+		m_glyphRun.resize(m_glyphBoxes.size());
+		for (uint32_t i = 0u; i < m_glyphBoxes.size(); ++i)
+		{
+			m_glyphRun[i].glyphIdx = m_glyphBoxes[i].glyphIdx;
+			m_glyphRun[i].minUV = m_face->getUV(float32_t2(0.0f,0.0f), m_glyphBoxes[i].size, msdfResolution, MSDFPixelRange);
+		}
+		m_glyphRunMSDFResolution = msdfResolution;
+	}
+
+	for (uint32_t i = 0u; i < m_glyphBoxes.size(); ++i)
 	{
-		1.0,	0.0,	baselineStart.x,
-		0.0,	1.0,	baselineStart.y,
-		0.0,	0.0,	1.0,
-	};
-	float64_t3x3 transformation = mul(translationMat, rotationMulScaleMat);
+		const GlyphBox& glyphBox = m_glyphBoxes[i];
+		m_glyphRun[i].topLeft = baselineStart + axisX * glyphBox.topLeft.x + axisY * glyphBox.topLeft.y;
+		m_glyphRun[i].dirU = float32_t2(axisX * float64_t(glyphBox.size.x));
+		m_glyphRun[i].aspectRatio = static_cast<float32_t>((glyphBox.size.y * axisYLen) / (glyphBox.size.x * axisXLen));
+	}
 
 	// TODO: Use Separate TextStyleInfo or something, and somehow alias with line style for improved readability
 	LineStyleInfo lineStyle = {};
@@ -73,16 +85,5 @@ void SingleLineText::Draw(
 	const uint32_t styleIdx = drawResourcesFiller.addLineStyle_SubmitIfNeeded(lineStyle, intendedNextSubmit);
 	auto glyphObjectIdx = drawResourcesFiller.addMainObject_SubmitIfNeeded(styleIdx, intendedNextSubmit);
 
-	for (const auto& glyphBox : m_glyphBoxes)
-	{
-		const float64_t2 topLeft = mul(transformation, float64_t3(glyphBox.topLeft, 1.0)).xy;
-		const float64_t2 dirU = mul(transformation, float64_t3(glyphBox.size.x, 0.0, 0.0)).xy;
-		const float64_t2 dirV = mul(transformation, float64_t3(0.0, -glyphBox.size.y, 0.0)).xy;
-
-		// float32_t3 xx = float64_t3(0.0, -glyphBox.size.y, 0.0);
-		const float32_t aspectRatio = static_cast<float32_t>(glm::length(dirV) / glm::length(dirU)); // check if you can just do: (glyphBox.size.y * scale.y) / glyphBox.size.x * scale.x)
-		const float32_t2 minUV = m_face->getUV(float32_t2(0.0f,0.0f), glyphBox.size, drawResourcesFiller.getMSDFResolution(), MSDFPixelRange);
-		drawResourcesFiller.drawFontGlyph(m_face.get(), glyphBox.glyphIdx, topLeft, dirU, aspectRatio, minUV, glyphObjectIdx, intendedNextSubmit);
-	}
-
+	drawResourcesFiller.drawFontGlyphRun(m_face.get(), m_glyphRun, glyphObjectIdx, intendedNextSubmit);
 }
\ No newline at end of file
@@ -50,4 +50,9 @@ protected:
 	BoundingBox m_boundingBox = {};
 	std::vector<GlyphBox> m_glyphBoxes;
 	core::smart_refctd_ptr<nbl::ext::TextRendering::FontFace> m_face;
+
+	// glyph run handed to `DrawResourcesFiller::drawFontGlyphRun`, glyph indices and minUVs only depend on the MSDF resolution so they're filled once, `Draw` rewrites the transformed part
+	// makes `Draw` not thread-safe on the same `SingleLineText`
+	mutable std::vector<DrawResourcesFiller::GlyphRunInstance> m_glyphRun;
+	mutable uint32_t2 m_glyphRunMSDFResolution = uint32_t2(0u, 0u);
 };
\ No newline at end of file
@@ -0,0 +1,201 @@
+#pragma once
+
+#include "Polyline.h"
+
+// Uniform grid of tiles over the AABBs of a drawing's main objects (polylines, hatches, text blocks...) answering "which objects are visible in this clip projection"
+// Tiles are sized so each holds around `targetObjectsPerTile` objects, objects covering more than `MaxTilesPerObject` tiles (e.g. a sheet border) go to a separate list checked on every query
+// build is O(n), rebuilding after edits is cheap compared to a tree, query is O(tiles + k) where k is the number of objects in the visited tiles
+// Objects are referred to by their index in the span passed to `build` and are reported in that order, so drawing them as reported keeps the draw order
+class SpatialGrid
+{
+public:
+	using AABB = AABBTree<float64_t2>::AABB;
+
+	static constexpr uint32_t MaxTilesPerObject = 64u;
+	static constexpr uint32_t MaxTilesPerAxis = 4096u;
+
+	SpatialGrid() = default;
+
+	void build(std::span<const AABB> boxes, uint32_t targetObjectsPerTile = 16u)
+	{
+		clear();
+		if (boxes.empty())
+			return;
+
+		m_boxes.assign(boxes.begin(), boxes.end());
+		m_bounds = boxes[0];
+		for (const AABB& box : boxes)
+			m_bounds.extend(box);
+
+		// tiles as square as the bounds allow
+		const float64_t2 extents = m_bounds.max - m_bounds.min;
+		const float64_t tileCount = core::max(float64_t(boxes.size()) / float64_t(core::max(targetObjectsPerTile, 1u)), 1.0);
+		const float64_t tileSize = (extents.x > 0.0 && extents.y > 0.0) ? std::sqrt(extents.x * extents.y / tileCount) : core::max(extents.x, extents.y) / tileCount;
+		for (uint32_t axis = 0u; axis < 2u; ++axis)
+		{
+			const float64_t axisTiles = (tileSize > 0.0) ? std::ceil(extents[axis] / tileSize) : 1.0;
+			m_tileCount[axis] = static_cast<uint32_t>(std::clamp(axisTiles, 1.0, float64_t(MaxTilesPerAxis)));
+			m_invTileSize[axis] = (extents[axis] > 0.0) ? float64_t(m_tileCount[axis]) / extents[axis] : 0.0;
+		}
+
+		// two passes over the boxes, counting then filling, so the tiles are stored contiguously in `m_tileObjects` and each tile's objects stay in ascending order
+		m_tileOffsets.assign(m_tileCount.x * m_tileCount.y + 1u, 0u);
+		for (uint32_t i = 0u; i < m_boxes.size(); ++i)
+		{
+			const TileRange range = getTileRange(m_boxes[i]);
+			if (range.getTileCount() > MaxTilesPerObject)
+				continue;
+			for (uint32_t y = range.min.y; y <= range.max.y; ++y)
+				for (uint32_t x = range.min.x; x <= range.max.x; ++x)
+					m_tileOffsets[y * m_tileCount.x + x + 1u]++;
+		}
+		for (uint32_t t = 1u; t < m_tileOffsets.size(); ++t)
+			m_tileOffsets[t] += m_tileOffsets[t - 1u];
+
+		m_tileObjects.resize(m_tileOffsets.back());
+		std::vector<uint32_t> tileFill(m_tileOffsets.begin(), m_tileOffsets.end() - 1u);
+		for (uint32_t i = 0u; i < m_boxes.size(); ++i)
+		{
+			const TileRange range = getTileRange(m_boxes[i]);
+			if (range.getTileCount() > MaxTilesPerObject)
+			{
+				m_largeObjects.push_back(i);
+				continue;
+			}
+			for (uint32_t y = range.min.y; y <= range.max.y; ++y)
+				for (uint32_t x = range.min.x; x <= range.max.x; ++x)
+					m_tileObjects[tileFill[y * m_tileCount.x + x]++] = i;
+		}
+	}
+
+	void clear()
+	{
+		m_boxes.clear();
+		m_tileOffsets.clear();
+		m_tileObjects.clear();
+		m_largeObjects.clear();
+		m_tileCount = uint32_t2(0u, 0u);
+	}
+
+	inline uint32_t size() const { return static_cast<uint32_t>(m_boxes.size()); }
+	inline bool empty() const { return m_boxes.empty(); }
+	inline uint32_t2 getTileCount() const { return m_tileCount; }
+
+	// Appends the (ascending) indices of the boxes overlapping `queryBox` to `out`
+	void query(const AABB& queryBox, std::vector<uint32_t>& out) const
+	{
+		if (m_boxes.empty())
+			return;
+
+		const size_t outBegin = out.size();
+		for (const uint32_t objIdx : m_largeObjects)
+			if (m_boxes[objIdx].overlaps(queryBox))
+				out.push_back(objIdx);
+
+		if (m_bounds.overlaps(queryBox))
+		{
+			const TileRange range = getTileRange(queryBox);
+			for (uint32_t y = range.min.y; y <= range.max.y; ++y)
+			{
+				for (uint32_t x = range.min.x; x <= range.max.x; ++x)
+				{
+					const uint32_t tileIdx = y * m_tileCount.x + x;
+					// objects overlap the tiles they're in, so the ones in tiles completely inside the query box don't need testing
+					const bool tileInside = x > range.min.x && x < range.max.x && y > range.min.y && y < range.max.y;
+					for (uint32_t i = m_tileOffsets[tileIdx]; i < m_tileOffsets[tileIdx + 1u]; ++i)
+					{
+						const uint32_t objIdx = m_tileObjects[i];
+						if (tileInside || m_boxes[objIdx].overlaps(queryBox))
+							out.push_back(objIdx);
+					}
+				}
+			}
+		}
+
+		// objects spanning multiple tiles got reported once per tile
+		std::sort(out.begin() + outBegin, out.end());
+		out.erase(std::unique(out.begin() + outBegin, out.end()), out.end());
+	}
+
+	// `query` with the visible region of `clipProjection`, see `getClipProjectionWorldAABB`
+	void queryVisible(const ClipProjectionData& clipProjection, float32_t2 ndcMargin, std::vector<uint32_t>& out) const
+	{
+		query(getClipProjectionWorldAABB(clipProjection, ndcMargin), out);
+	}
+
+	// World space AABB of what `clipProjection` shows: it's clip rectangle (within the screen) grown by `ndcMargin`, brought back to world space by inverting `projectionToNDC`
+	// `projectionToNDC` is expected to be a 2D affine transform like the ones `Camera2D` makes, rotations make the AABB conservative
+	static AABB getClipProjectionWorldAABB(const ClipProjectionData& clipProjection, float32_t2 ndcMargin)
+	{
+		const float64_t3x3& m = clipProjection.projectionToNDC;
+		const float64_t det = m[0][0] * m[1][1] - m[0][1] * m[1][0];
+
+		AABB ret = {};
+		if (det == 0.0)
+		{
+			// everything collapses to a point in NDC, nothing to cull against
+			ret.min = float64_t2(-std::numeric_limits<float64_t>::infinity(), -std::numeric_limits<float64_t>::infinity());
+			ret.max = float64_t2(std::numeric_limits<float64_t>::infinity(), std::numeric_limits<float64_t>::infinity());
+			return ret;
+		}
+
+		const float64_t2 ndcMin = float64_t2(core::max(clipProjection.minClipNDC.x, -1.0f) - ndcMargin.x, core::max(clipProjection.minClipNDC.y, -1.0f) - ndcMargin.y);
+		const float64_t2 ndcMax = float64_t2(core::min(clipProjection.maxClipNDC.x, 1.0f) + ndcMargin.x, core::min(clipProjection.maxClipNDC.y, 1.0f) + ndcMargin.y);
+
+		const float64_t invDet = 1.0 / det;
+		auto ndcToWorld = [&](const float64_t2 ndc)
+			{
+				const float64_t2 p = ndc - float64_t2(m[0][2], m[1][2]);
+				return float64_t2((m[1][1] * p.x - m[0][1] * p.y) * invDet, (m[0][0] * p.y - m[1][0] * p.x) * invDet);
+			};
+
+		const float64_t2 corners[4u] = {
+			ndcToWorld(ndcMin),
+			ndcToWorld(float64_t2(ndcMax.x, ndcMin.y)),
+			ndcToWorld(float64_t2(ndcMin.x, ndcMax.y)),
+			ndcToWorld(ndcMax),
+		};
+		ret.min = ret.max = corners[0u];
+		for (uint32_t i = 1u; i < 4u; ++i)
+			ret.extend({ corners[i], corners[i] });
+		return ret;
+	}
+
+protected:
+	struct TileRange
+	{
+		uint32_t2 min;
+		uint32_t2 max;
+
+		inline uint32_t getTileCount() const { return (max.x - min.x + 1u) * (max.y - min.y + 1u); }
+	};
+
+	// tiles touched by `box`, clamped to the grid
+	TileRange getTileRange(const AABB& box) const
+	{
+		TileRange ret = {};
+		for (uint32_t axis = 0u; axis < 2u; ++axis)
+		{
+			const float64_t maxTile = float64_t(m_tileCount[axis] - 1u);
+			auto getTile = [&](float64_t coord) -> uint32_t
+				{
+					// flat bounds along this axis have a single tile
+					if (m_invTileSize[axis] == 0.0)
+						return 0u;
+					return static_cast<uint32_t>(std::clamp(std::floor((coord - m_bounds.min[axis]) * m_invTileSize[axis]), 0.0, maxTile));
+				};
+			ret.min[axis] = getTile(box.min[axis]);
+			ret.max[axis] = getTile(box.max[axis]);
+		}
+		return ret;
+	}
+
+	std::vector<AABB> m_boxes;
+	AABB m_bounds = {};
+	uint32_t2 m_tileCount = uint32_t2(0u, 0u);
+	float64_t2 m_invTileSize = float64_t2(0.0, 0.0);
+
+	std::vector<uint32_t> m_tileOffsets; // tile (row major) -> range in `m_tileObjects`, one extra at the end
+	std::vector<uint32_t> m_tileObjects;
+	std::vector<uint32_t> m_largeObjects;
+};
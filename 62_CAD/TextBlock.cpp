@@ -0,0 +1,205 @@
+#include "TextBlock.h"
+
+TextLayout TextLayout::create(nbl::ext::TextRendering::FontFace* face, const std::string& text, const TextLayoutParams& params)
+{
+	TextLayout ret = {};
+	ret.fontSize = params.fontSize;
+	ret.glyphs.reserve(text.length());
+
+	FT_Face ftFace = face->getFreetypeFace();
+	const bool hasKerning = FT_HAS_KERNING(ftFace);
+	// everything below is in the face's units until the end, where `fontSize` gets applied
+	const float64_t lineHeight = (ftFace->size->metrics.height / 64.0) * params.lineSpacing;
+	const float64_t maxLineWidth = params.maxLineWidth / params.fontSize;
+
+	struct Line
+	{
+		uint32_t glyphBegin;
+		uint32_t glyphEnd;
+	};
+	std::vector<Line> lines;
+
+	constexpr uint32_t InvalidGlyph = ~0u;
+	uint32_t lineStart = 0u;
+	float64_t penX = 0.0;
+	uint32_t prevGlyphIndex = 0u;
+	// the word after the last space of the line, where it can be broken
+	uint32_t breakGlyph = InvalidGlyph;
+	float64_t breakPenX = 0.0;
+
+	auto breakLine = [&](uint32_t glyphEnd)
+		{
+			lines.push_back({ lineStart, glyphEnd });
+			lineStart = glyphEnd;
+			breakGlyph = InvalidGlyph;
+		};
+
+	for (uint32_t i = 0; i < text.length(); i++)
+	{
+		const char c = text.at(i);
+		if (c == '\n')
+		{
+			breakLine(ret.glyphs.size());
+			penX = 0.0;
+			prevGlyphIndex = 0u;
+			continue;
+		}
+
+		const auto glyphIndex = face->getGlyphIndex(wchar_t(c));
+		const auto glyphMetrics = face->getGlyphMetrics(glyphIndex);
+
+		if (hasKerning && prevGlyphIndex != 0u && glyphIndex != 0u)
+		{
+			FT_Vector kerning = {};
+			if (FT_Get_Kerning(ftFace, prevGlyphIndex, glyphIndex, FT_KERNING_DEFAULT, &kerning) == 0)
+				penX += kerning.x / 64.0;
+		}
+		prevGlyphIndex = glyphIndex;
+
+		if (c == ' ' || c == '\t')
+		{
+			penX += glyphMetrics.advance.x;
+			breakGlyph = ret.glyphs.size();
+			breakPenX = penX;
+			continue;
+		}
+
+		const bool skipGenerateGlyph = (glyphIndex == 0 || (glyphMetrics.size.x == 0.0 && glyphMetrics.size.y == 0.0));
+		if (!skipGenerateGlyph)
+		{
+			const float64_t right = penX + glyphMetrics.horizontalBearing.x + glyphMetrics.size.x;
+			if (right > maxLineWidth && ret.glyphs.size() > lineStart)
+			{
+				if (breakGlyph != InvalidGlyph && breakGlyph > lineStart)
+				{
+					// move the current word to the next line
+					const uint32_t wordStart = breakGlyph;
+					breakLine(wordStart);
+					for (uint32_t g = wordStart; g < ret.glyphs.size(); ++g)
+						ret.glyphs[g].topLeft.x -= breakPenX;
+					penX -= breakPenX;
+				}
+				else
+				{
+					// word longer than a line, break it right here
+					breakLine(ret.glyphs.size());
+					penX = 0.0;
+				}
+			}
+
+			ret.glyphs.push_back({
+				.topLeft = float64_t2(penX, 0.0) + float64_t2(glyphMetrics.horizontalBearing),
+				.size = glyphMetrics.size,
+				.glyphIdx = glyphIndex,
+			});
+		}
+		penX += glyphMetrics.advance.x;
+	}
+	breakLine(ret.glyphs.size());
+	ret.lineCount = lines.size();
+
+	// Alignment
+	std::vector<float64_t> lineWidths(lines.size(), 0.0);
+	float64_t maxWidth = 0.0;
+	for (uint32_t l = 0u; l < lines.size(); ++l)
+	{
+		for (uint32_t g = lines[l].glyphBegin; g < lines[l].glyphEnd; ++g)
+			lineWidths[l] = nbl::core::max(lineWidths[l], ret.glyphs[g].topLeft.x + ret.glyphs[g].size.x);
+		maxWidth = nbl::core::max(maxWidth, lineWidths[l]);
+	}
+	const float64_t alignWidth = std::isinf(maxLineWidth) ? maxWidth : maxLineWidth;
+	const float64_t alignFactor = (params.alignment == TextAlignment::CENTER) ? 0.5 : ((params.alignment == TextAlignment::RIGHT) ? 1.0 : 0.0);
+
+	ret.boundingBox.min = float64_t2(0.0, 0.0);
+	ret.boundingBox.max = float64_t2(0.0, 0.0);
+	for (uint32_t l = 0u; l < lines.size(); ++l)
+	{
+		const float64_t2 lineOffset = float64_t2((alignWidth - lineWidths[l]) * alignFactor, -lineHeight * l);
+		for (uint32_t g = lines[l].glyphBegin; g < lines[l].glyphEnd; ++g)
+		{
+			Glyph& glyph = ret.glyphs[g];
+			glyph.topLeft = (glyph.topLeft + lineOffset) * params.fontSize;
+
+			const float64_t2 scaledSize = float64_t2(glyph.size) * params.fontSize;
+			ret.boundingBox.min.x = nbl::core::min(ret.boundingBox.min.x, glyph.topLeft.x);
+			ret.boundingBox.min.y = nbl::core::min(ret.boundingBox.min.y, glyph.topLeft.y - scaledSize.y);
+			ret.boundingBox.max.x = nbl::core::max(ret.boundingBox.max.x, glyph.topLeft.x + scaledSize.x);
+			ret.boundingBox.max.y = nbl::core::max(ret.boundingBox.max.y, glyph.topLeft.y);
+		}
+	}
+
+	return ret;
+}
+
+std::shared_ptr<const TextLayout> TextLayoutCache::getOrCreate(nbl::ext::TextRendering::FontFace* face, const std::string& text, const TextLayoutParams& params)
+{
+	Key key = { face->getHash(), text, params };
+	if (std::shared_ptr<const TextLayout>* cached = m_cache.get(key))
+	{
+		m_hitCount++;
+		return *cached;
+	}
+	m_missCount++;
+	std::shared_ptr<const TextLayout> layout = std::make_shared<const TextLayout>(TextLayout::create(face, text, params));
+	m_cache.insert(std::move(key), layout);
+	return layout;
+}
+
+TextBlock::TextBlock(core::smart_refctd_ptr<nbl::ext::TextRendering::FontFace>&& face, const std::string& text, const TextLayoutParams& params, TextLayoutCache* layoutCache)
+{
+	m_face = std::move(face);
+	if (layoutCache)
+		m_layout = layoutCache->getOrCreate(m_face.get(), text, params);
+	else
+		m_layout = std::make_shared<const TextLayout>(TextLayout::create(m_face.get(), text, params));
+}
+
+void TextBlock::Draw(
+	DrawResourcesFiller& drawResourcesFiller,
+	SIntendedSubmitInfo& intendedNextSubmit,
+	const float64_t2& baselineStart,
+	const float32_t2& scale,
+	const float32_t& rotateAngle,
+	const float32_t4& color,
+	const float32_t tiltTiltAngle,
+	const float32_t boldInPixels) const
+{
+	const auto& glyphs = m_layout->glyphs;
+
+	// columns of `translation * rotation * scale`, same as `SingleLineText::Draw`
+	float32_t2 vec(cos(rotateAngle), sin(rotateAngle));
+	const float64_t2 axisX = float64_t2(vec.x * scale.x, -vec.y * scale.x);
+	const float64_t2 axisY = float64_t2(vec.y * scale.y, vec.x * scale.y);
+	const float64_t axisXLen = glm::length(axisX);
+	const float64_t axisYLen = glm::length(axisY);
+
+	const uint32_t2 msdfResolution = drawResourcesFiller.getMSDFResolution();
+	if (m_glyphRun.size() != glyphs.size() || m_glyphRunMSDFResolution.x != msdfResolution.x || m_glyphRunMSDFResolution.y != msdfResolution.y)
+	{
+		m_glyphRun.resize(glyphs.size());
+		for (uint32_t i = 0u; i < glyphs.size(); ++i)
+		{
+			m_glyphRun[i].glyphIdx = glyphs[i].glyphIdx;
+			m_glyphRun[i].minUV = m_face->getUV(float32_t2(0.0f,0.0f), glyphs[i].size, msdfResolution, MSDFPixelRange);
+		}
+		m_glyphRunMSDFResolution = msdfResolution;
+	}
+
+	for (uint32_t i = 0u; i < glyphs.size(); ++i)
+	{
+		const TextLayout::Glyph& glyph = glyphs[i];
+		m_glyphRun[i].topLeft = baselineStart + axisX * glyph.topLeft.x + axisY * glyph.topLeft.y;
+		m_glyphRun[i].dirU = float32_t2(axisX * (float64_t(glyph.size.x) * m_layout->fontSize));
+		m_glyphRun[i].aspectRatio = static_cast<float32_t>((glyph.size.y * axisYLen) / (glyph.size.x * axisXLen));
+	}
+
+	// TODO: Use Separate TextStyleInfo or something, and somehow alias with line style for improved readability
+	LineStyleInfo lineStyle = {};
+	lineStyle.color = color;
+	lineStyle.screenSpaceLineWidth = tan(tiltTiltAngle);
+	lineStyle.worldSpaceLineWidth = boldInPixels;
+	const uint32_t styleIdx = drawResourcesFiller.addLineStyle_SubmitIfNeeded(lineStyle, intendedNextSubmit);
+	auto glyphObjectIdx = drawResourcesFiller.addMainObject_SubmitIfNeeded(styleIdx, intendedNextSubmit);
+
+	drawResourcesFiller.drawFontGlyphRun(m_face.get(), m_glyphRun, glyphObjectIdx, intendedNextSubmit);
+}
@@ -0,0 +1,132 @@
+#pragma once
+#include "DrawResourcesFiller.h"
+
+#include <limits>
+
+using namespace nbl;
+using namespace nbl::video;
+using namespace nbl::core;
+using namespace nbl::asset;
+using namespace nbl::ext::TextRendering;
+
+enum class TextAlignment : uint8_t
+{
+	LEFT,
+	CENTER,
+	RIGHT,
+};
+
+struct TextLayoutParams
+{
+	float64_t fontSize = 1.0; // multiplies the face's metrics
+	float64_t maxLineWidth = std::numeric_limits<float64_t>::infinity(); // after `fontSize`, lines get broken at spaces (or anywhere if a word doesn't fit) to stay within it
+	float64_t lineSpacing = 1.0; // multiplies the face's line height
+	TextAlignment alignment = TextAlignment::LEFT; // within `maxLineWidth`, or within the widest line if it's infinite
+
+	inline bool operator==(const TextLayoutParams& other) const
+	{
+		return fontSize == other.fontSize && maxLineWidth == other.maxLineWidth && lineSpacing == other.lineSpacing && alignment == other.alignment;
+	}
+};
+
+// Result of laying out a paragraph, positions are relative to the first line's baseline start (y up, lines go down)
+struct TextLayout
+{
+	struct Glyph
+	{
+		float64_t2 topLeft; // after `fontSize`
+		float32_t2 size; // in the face's units (before `fontSize`), what the MSDF UVs need
+		uint32_t glyphIdx;
+	};
+
+	struct BoundingBox
+	{
+		float64_t2 min;
+		float64_t2 max;
+	};
+
+	std::vector<Glyph> glyphs;
+	float64_t fontSize = 1.0;
+	uint32_t lineCount = 0u;
+	BoundingBox boundingBox = {};
+
+	// Line breaking, kerning and alignment of `text` ('\n' starts a new line)
+	static TextLayout create(nbl::ext::TextRendering::FontFace* face, const std::string& text, const TextLayoutParams& params);
+};
+
+// LRU cache of `TextLayout`s keyed by (font face hash, string, layout params), so re-creating the same labels (e.g. dimension annotations on every zoom step) is a hash lookup instead of a re-layout
+// Not thread-safe
+class TextLayoutCache
+{
+public:
+	explicit TextLayoutCache(uint32_t capacity = 16384u) : m_cache(capacity) {}
+
+	// layouts are shared with the `TextBlock`s using them, so eviction never invalidates one in use
+	std::shared_ptr<const TextLayout> getOrCreate(nbl::ext::TextRendering::FontFace* face, const std::string& text, const TextLayoutParams& params);
+
+	uint64_t getHitCount() const { return m_hitCount; }
+	uint64_t getMissCount() const { return m_missCount; }
+
+protected:
+	struct Key
+	{
+		core::blake3_hash_t faceHash;
+		std::string text;
+		TextLayoutParams params;
+
+		inline bool operator==(const Key& other) const
+		{
+			return faceHash == other.faceHash && params == other.params && text == other.text;
+		}
+	};
+
+	struct KeyHash
+	{
+		inline std::size_t operator()(const Key& key) const
+		{
+			std::size_t ret = 0ull;
+			auto combine = [&ret](std::size_t h) { ret ^= h + 0x9e3779b97f4a7c15ull + (ret << 6) + (ret >> 2); };
+			combine(std::hash<core::blake3_hash_t>{}(key.faceHash));
+			combine(std::hash<std::string>{}(key.text));
+			combine(std::hash<float64_t>{}(key.params.fontSize));
+			combine(std::hash<float64_t>{}(key.params.maxLineWidth));
+			combine(std::hash<float64_t>{}(key.params.lineSpacing));
+			combine(std::hash<uint8_t>{}(static_cast<uint8_t>(key.params.alignment)));
+			return ret;
+		}
+	};
+
+	core::LRUCache<Key, std::shared_ptr<const TextLayout>, KeyHash> m_cache;
+	uint64_t m_hitCount = 0ull;
+	uint64_t m_missCount = 0ull;
+};
+
+// Multi-line counterpart of `SingleLineText`
+class TextBlock
+{
+public:
+	// lays `text` out, or takes the layout from `layoutCache` if it's not null
+	TextBlock(core::smart_refctd_ptr<nbl::ext::TextRendering::FontFace>&& face, const std::string& text, const TextLayoutParams& params = {}, TextLayoutCache* layoutCache = nullptr);
+
+	TextLayout::BoundingBox GetAABB() const { return m_layout->boundingBox; }
+	uint32_t getLineCount() const { return m_layout->lineCount; }
+
+	// Same as `SingleLineText::Draw`, `baselineStart` is the start of the first line's baseline
+	void Draw(
+		DrawResourcesFiller& drawResourcesFiller,
+		SIntendedSubmitInfo& intendedNextSubmit,
+		const float64_t2& baselineStart = float64_t2(0.0,0.0),
+		const float32_t2& scale = float64_t2(1.0f, 1.0f),
+		const float32_t& rotateAngle = 0.0f,
+		const float32_t4& color = float32_t4(1.0f,1.0f,1.0f,1.0f),
+		const float32_t italicTilt = 0.0f,
+		const float32_t boldInPixels = 0.0f) const;
+
+protected:
+	std::shared_ptr<const TextLayout> m_layout;
+	core::smart_refctd_ptr<nbl::ext::TextRendering::FontFace> m_face;
+
+	// same as `SingleLineText::m_glyphRun`
+	mutable std::vector<DrawResourcesFiller::GlyphRunInstance> m_glyphRun;
+	mutable uint32_t2 m_glyphRunMSDFResolution = uint32_t2(0u, 0u);
+};
@@ -498,26 +498,12 @@ void Subdivision::adaptive(const OffsettedBezier& curve, float64_t targetMaxErro
     }
 }
 
-void Subdivision::adaptive_impl(const ParametricCurve& curve, float64_t min, float64_t max, float64_t targetMaxError, AddBezierFunc& addBezierFunc, uint32_t depth)
+// Approximates the curve between two points by a bezier and decides whether that's good enough or the range needs to be subdivided further
+// shared by `adaptive_impl` and the batched subdivisions, the position at split is only computed when needed
+template<typename PositionAtSplitFunc>
+static bool shouldSubdivideInterval(const float64_t2 P0, const float64_t2 V0, const float64_t2 P2, const float64_t2 V2, PositionAtSplitFunc&& computePositionAtSplit, float64_t targetMaxError, uint32_t depth, shapes::QuadraticBezier<double>& bezier)
 {
-    if (min == max)
-        return;
-    assert(min < max);
-
-    float64_t split = curve.inverseArcLen_BisectionSearch(0.5, min, max);
-
-    // Shouldn't happen but may happen if we use NewtonRaphson for non convergent inverse CDF
-    if (split <= min || split >= max)
-    {
-        _NBL_DEBUG_BREAK_IF(split < min || split > max);
-        split = (min + max) / 2.0;
-    }
-
-    const float64_t2 P0 = curve.computePosition(min);
-    const float64_t2 V0 = curve.computeTangent(min);
-    const float64_t2 P2 = curve.computePosition(max);
-    const float64_t2 V2 = curve.computeTangent(max);
-    shapes::QuadraticBezier<double> bezier = shapes::QuadraticBezier<double>::constructBezierWithTwoPointsAndTangents(P0, V0, P2, V2);
+    bezier = shapes::QuadraticBezier<double>::constructBezierWithTwoPointsAndTangents(P0, V0, P2, V2);
 
     bool shouldSubdivide = false;
 
@@ -533,7 +519,7 @@ void Subdivision::adaptive_impl(const ParametricCurve& curve, float64_t min, flo
         {
             if (glm::distance(P0, P2) < targetMaxError)
             {
-                const float64_t2 posAtSplit = curve.computePosition(split);
+                const float64_t2 posAtSplit = computePositionAtSplit();
                 // If it came down to a bezier small that causes P0 P2 and the position at split smaller than targetMaxError then we stop
                 if (glm::distance(posAtSplit, P0) < targetMaxError)
                     shouldSubdivide = false;
@@ -543,7 +529,7 @@ void Subdivision::adaptive_impl(const ParametricCurve& curve, float64_t min, flo
             }
             else
             {
-                const float64_t2 curvePositionAtSplit = curve.computePosition(split);
+                const float64_t2 curvePositionAtSplit = computePositionAtSplit();
                 float64_t bezierYAtSplit = bezier.calcYatX(curvePositionAtSplit.x);
                 //_NBL_DEBUG_BREAK_IF(core::isnan(bezierYAtSplit)); 
                 // TODO: maybe a better error comaprison is find the normal at split and intersect with the bezier
@@ -553,6 +539,31 @@ void Subdivision::adaptive_impl(const ParametricCurve& curve, float64_t min, flo
         }
     }
 
+    return shouldSubdivide;
+}
+
+void Subdivision::adaptive_impl(const ParametricCurve& curve, float64_t min, float64_t max, float64_t targetMaxError, AddBezierFunc& addBezierFunc, uint32_t depth)
+{
+    if (min == max)
+        return;
+    assert(min < max);
+
+    float64_t split = curve.inverseArcLen_BisectionSearch(0.5, min, max);
+
+    // Shouldn't happen but may happen if we use NewtonRaphson for non convergent inverse CDF
+    if (split <= min || split >= max)
+    {
+        _NBL_DEBUG_BREAK_IF(split < min || split > max);
+        split = (min + max) / 2.0;
+    }
+
+    const float64_t2 P0 = curve.computePosition(min);
+    const float64_t2 V0 = curve.computeTangent(min);
+    const float64_t2 P2 = curve.computePosition(max);
+    const float64_t2 V2 = curve.computeTangent(max);
+    shapes::QuadraticBezier<double> bezier;
+    const bool shouldSubdivide = shouldSubdivideInterval(P0, V0, P2, V2, [&]() { return curve.computePosition(split); }, targetMaxError, depth, bezier);
+
     if (shouldSubdivide)
     {
         adaptive_impl(curve, min, split, targetMaxError, addBezierFunc, depth - 1u);
@@ -566,4 +577,337 @@ void Subdivision::adaptive_impl(const ParametricCurve& curve, float64_t min, flo
     }
 }
 
+// Batched Subdivision
+// Same algorithm as `adaptive_impl`, but the curve is evaluated through a concrete evaluator instead of the virtual `ParametricCurve` interface
+// so the arc length integration (where almost all the time goes) inlines, and the recursion is an explicit interval stack reused across curves
+namespace
+{
+
+struct CubicCurveEvaluator
+{
+    float64_t4 X;
+    float64_t4 Y;
+
+    static bool isValid(const CubicCurve& curve) { return true; }
+    static float64_t computeInflectionPoint(const CubicCurve& curve, float64_t errorThreshold) { return curve.computeInflectionPoint(errorThreshold); }
+
+    explicit CubicCurveEvaluator(const CubicCurve& curve) : X(curve.X), Y(curve.Y) {}
+
+    inline float64_t2 computePosition(float64_t t) const
+    {
+        return float64_t2(
+            ((X[0] * t + X[1]) * t + X[2]) * t + X[3],
+            ((Y[0] * t + Y[1]) * t + Y[2]) * t + Y[3]
+        );
+    }
+
+    inline float64_t2 computeTangent(float64_t t) const
+    {
+        return float64_t2(
+            (3.0 * X[0] * t + 2.0 * X[1]) * t + X[2],
+            (3.0 * Y[0] * t + 2.0 * Y[1]) * t + Y[2]
+        );
+    }
+
+    inline void transformOutput(shapes::QuadraticBezier<double>& bezier) const {}
+};
+
+// Same as `AxisAlignedEllipse` + the transform `Subdivision::adaptive(const EllipticalArcInfo&...)` applies to it's output
+struct EllipticalArcEvaluator
+{
+    float64_t a;
+    float64_t b;
+    float64_t start;
+    float64_t end;
+    float64_t2x2 rotate;
+    float64_t2 center;
+
+    static bool isValid(const EllipticalArcInfo& ellipse)
+    {
+        _NBL_DEBUG_BREAK_IF(!ellipse.isValid());
+        return ellipse.isValid();
+    }
+    static float64_t computeInflectionPoint(const EllipticalArcInfo& ellipse, float64_t errorThreshold) { return std::numeric_limits<double>::quiet_NaN(); }
+
+    explicit EllipticalArcEvaluator(const EllipticalArcInfo& ellipse)
+    {
+        const float64_t lenghtMajor = length(ellipse.majorAxis);
+        const float64_t2 normalizedMajor = ellipse.majorAxis / lenghtMajor;
+        a = lenghtMajor;
+        b = lenghtMajor * ellipse.eccentricity;
+        start = ellipse.angleBounds.x;
+        end = ellipse.angleBounds.y;
+        rotate = float64_t2x2({
+            float64_t2(normalizedMajor.x, -normalizedMajor.y),
+            float64_t2(normalizedMajor.y, normalizedMajor.x)
+            });
+        center = ellipse.center;
+    }
+
+    inline float64_t2 computePosition(float64_t t) const
+    {
+        const float64_t theta = start + (end - start) * t;
+        return float64_t2(a * cos(theta), b * sin(theta));
+    }
+
+    inline float64_t2 computeTangent(float64_t t) const
+    {
+        const float64_t theta = start + (end - start) * t;
+        const float64_t dThetaDt = end - start;
+        return float64_t2(-a * dThetaDt * sin(theta), b * dThetaDt * cos(theta));
+    }
+
+    inline void transformOutput(shapes::QuadraticBezier<double>& bezier) const
+    {
+        bezier.P0 = mul(rotate, bezier.P0) + center;
+        bezier.P1 = mul(rotate, bezier.P1) + center;
+        bezier.P2 = mul(rotate, bezier.P2) + center;
+    }
+};
+
+// non virtual `ParametricCurve::ArcLenIntegrand`
+template<typename CurveEvaluator>
+struct EvaluatorArcLenIntegrand
+{
+    const CurveEvaluator* m_curve;
+
+    inline float64_t operator()(const float64_t t) const
+    {
+        return length(m_curve->computeTangent(t));
+    }
+};
+
+template<typename CurveEvaluator>
+float64_t evaluatorArcLen(const CurveEvaluator& curve, float64_t t0, float64_t t1)
+{
+    constexpr uint16_t IntegrationOrder = 10u;
+    return nbl::hlsl::math::quadrature::GaussLegendreIntegration<IntegrationOrder, double, EvaluatorArcLenIntegrand<CurveEvaluator>>::calculateIntegral(EvaluatorArcLenIntegrand<CurveEvaluator>{ &curve }, t0, t1);
+}
+
+// same as `ParametricCurve::inverseArcLen_BisectionSearch`
+template<typename CurveEvaluator>
+float64_t evaluatorInverseArcLen_BisectionSearch(const CurveEvaluator& curve, float64_t targetLen, float64_t min, float64_t max, const float64_t cdfAccuracyThreshold = 1e-4, const uint16_t iterationThreshold = 16u)
+{
+    float64_t xi = 0.0;
+    float64_t low = min;
+    float64_t high = max;
+    for (uint16_t i = 0; i < iterationThreshold; ++i)
+    {
+        xi = (low + high) / 2.0;
+        const float64_t sum = evaluatorArcLen(curve, min, xi);
+        const float64_t integral = sum + evaluatorArcLen(curve, xi, max);
+        const float64_t valueAtParamGuess = sum - targetLen * integral;
+
+        if (abs(valueAtParamGuess) < cdfAccuracyThreshold * integral)
+            return xi;
+        if (valueAtParamGuess > 0.0)
+            high = xi;
+        else
+            low = xi;
+    }
+    return xi;
+}
+}
+
+template<typename CurveEvaluator, typename InputCurve, typename SubdivideSingleFunc>
+uint32_t Subdivision::adaptiveBatched_impl(std::span<const InputCurve> curves, float64_t targetMaxError, std::span<shapes::QuadraticBezier<double>> outBeziers, std::span<BatchedOutputRange> outRanges, AddBezierFunc& overflowAddBezierFunc, uint32_t maxDepth, SubdivideSingleFunc&& subdivideOverflowed)
+{
+    assert(outRanges.size() >= curves.size());
+
+    struct Interval
+    {
+        float64_t min;
+        float64_t max;
+        uint32_t depth;
+    };
+    // depth first, same order as the recursion in `adaptive_impl`, so the beziers of a curve come out in order
+    std::vector<Interval> intervals;
+    intervals.reserve(maxDepth * 2u + 2u);
+
+    uint32_t bezierCount = 0u;
+    for (uint32_t curveIdx = 0u; curveIdx < curves.size(); curveIdx++)
+    {
+        const InputCurve& inputCurve = curves[curveIdx];
+        BatchedOutputRange& range = outRanges[curveIdx];
+        range = { .offset = bezierCount, .count = 0u };
+        if (!CurveEvaluator::isValid(inputCurve))
+            continue;
+
+        const CurveEvaluator curve(inputCurve);
+        // same as `adaptive`, split at the inflection point first, pushed in reverse so the first half gets popped first
+        const float64_t inflectX = CurveEvaluator::computeInflectionPoint(inputCurve, targetMaxError);
+        intervals.clear();
+        if (inflectX > 0.0 && inflectX < 1.0)
+        {
+            intervals.push_back({ inflectX, 1.0, maxDepth });
+            intervals.push_back({ 0.0, inflectX, maxDepth });
+        }
+        else
+            intervals.push_back({ 0.0, 1.0, maxDepth });
+
+        bool overflowed = false;
+        while (!intervals.empty())
+        {
+            const Interval current = intervals.back();
+            intervals.pop_back();
+            if (current.min == current.max)
+                continue;
+            assert(current.min < current.max);
+
+            float64_t split = evaluatorInverseArcLen_BisectionSearch(curve, 0.5, current.min, current.max);
+            if (split <= current.min || split >= current.max)
+            {
+                _NBL_DEBUG_BREAK_IF(split < current.min || split > current.max);
+                split = (current.min + current.max) / 2.0;
+            }
+
+            const float64_t2 P0 = curve.computePosition(current.min);
+            const float64_t2 V0 = curve.computeTangent(current.min);
+            const float64_t2 P2 = curve.computePosition(current.max);
+            const float64_t2 V2 = curve.computeTangent(current.max);
+            shapes::QuadraticBezier<double> bezier;
+            const bool shouldSubdivide = shouldSubdivideInterval(P0, V0, P2, V2, [&]() { return curve.computePosition(split); }, targetMaxError, current.depth, bezier);
+
+            if (shouldSubdivide)
+            {
+                intervals.push_back({ split, current.max, current.depth - 1u });
+                intervals.push_back({ current.min, split, current.depth - 1u });
+            }
+            else
+            {
+                const bool degenerate = (bezier.P0 == bezier.P2);
+                if (degenerate)
+                    continue;
+                if (bezierCount >= outBeziers.size())
+                {
+                    overflowed = true;
+                    break;
+                }
+                curve.transformOutput(bezier);
+                outBeziers[bezierCount++] = bezier;
+            }
+        }
+
+        if (overflowed)
+        {
+            // drop what this curve already wrote and hand the whole curve to `adaptive`, later curves may still fit in the output
+            bezierCount = range.offset;
+            range = {};
+            AddBezierFunc countingAddBezierFunc = [&](shapes::QuadraticBezier<double>&& bezier)
+                {
+                    range.count++;
+                    overflowAddBezierFunc(std::move(bezier));
+                };
+            subdivideOverflowed(inputCurve, countingAddBezierFunc);
+        }
+        else
+            range.count = bezierCount - range.offset;
+    }
+
+    return bezierCount;
 }
+
+uint32_t Subdivision::adaptiveBatched(std::span<const EllipticalArcInfo> ellipses, float64_t targetMaxError, std::span<shapes::QuadraticBezier<double>> outBeziers, std::span<BatchedOutputRange> outRanges, AddBezierFunc& overflowAddBezierFunc, uint32_t maxDepth)
+{
+    return adaptiveBatched_impl<EllipticalArcEvaluator>(ellipses, targetMaxError, outBeziers, outRanges, overflowAddBezierFunc, maxDepth,
+        [&](const EllipticalArcInfo& ellipse, AddBezierFunc& addBezierFunc) { adaptive(ellipse, targetMaxError, addBezierFunc, maxDepth); });
+}
+
+uint32_t Subdivision::adaptiveBatched(std::span<const CubicCurve> curves, float64_t targetMaxError, std::span<shapes::QuadraticBezier<double>> outBeziers, std::span<BatchedOutputRange> outRanges, AddBezierFunc& overflowAddBezierFunc, uint32_t maxDepth)
+{
+    return adaptiveBatched_impl<CubicCurveEvaluator>(curves, targetMaxError, outBeziers, outRanges, overflowAddBezierFunc, maxDepth,
+        [&](const CubicCurve& curve, AddBezierFunc& addBezierFunc) { adaptive(curve, 0.0, 1.0, targetMaxError, addBezierFunc, maxDepth); });
+}
+
+// Batched Quadratic Arc Length Inverse
+// |derivative(t)|^2 = a*t^2 + b*t + c = a*((t + k)^2 + m) with k = b/2a and m = c/a - k^2, which integrates to sqrt(a)/2 * [x*sqrt(x^2 + m) + m*asinh(x/sqrt(m))] with x = t + k
+// beziers where A is (almost) zero are lines, with constant speed sqrt(c)
+static inline float64_t quadraticArcLen(float64_t a, float64_t b, float64_t c, float64_t t)
+{
+    if (a <= 1e-12 * c)
+        return sqrt(c) * t;
+
+    const float64_t k = b / (2.0 * a);
+    const float64_t m = nbl::core::max(c / a - k * k, 0.0);
+    const float64_t rcpSqrtM = (m > 0.0) ? 1.0 / sqrt(m) : 0.0;
+
+    // asinh is odd, evaluating it on the absolute value keeps it accurate for negative arguments
+    auto antiderivative = [&](float64_t x) -> float64_t
+        {
+            const float64_t asinhY = std::asinh(abs(x) * rcpSqrtM);
+            return x * sqrt(x * x + m) + m * ((x < 0.0) ? -asinhY : asinhY);
+        };
+
+    return sqrt(a) * 0.5 * (antiderivative(t + k) - antiderivative(k));
+}
+
+float64_t QuadraticArcLenInverseBatch::arcLen(float64_t a, float64_t b, float64_t c, float64_t t)
+{
+    return quadraticArcLen(a, b, c, t);
+}
+
+void QuadraticArcLenInverseBatch::clear()
+{
+    m_beziers.clear();
+    m_problems.clear();
+    m_results.clear();
+}
+
+void QuadraticArcLenInverseBatch::reserve(uint32_t bezierCount, uint32_t problemCount)
+{
+    m_beziers.reserve(bezierCount);
+    m_problems.reserve(problemCount);
+    m_results.reserve(problemCount);
+}
+
+uint32_t QuadraticArcLenInverseBatch::addBezier(const shapes::QuadraticBezier<double>& bezier)
+{
+    // derivative(t) = 2At + B
+    const float64_t2 A = bezier.P0 - 2.0 * bezier.P1 + bezier.P2;
+    const float64_t2 B = 2.0 * (bezier.P1 - bezier.P0);
+    Bezier& added = m_beziers.emplace_back();
+    added.a = 4.0 * glm::dot(A, A);
+    added.b = 4.0 * glm::dot(A, B);
+    added.c = glm::dot(B, B);
+    added.arcLen = quadraticArcLen(added.a, added.b, added.c, 1.0);
+    return static_cast<uint32_t>(m_beziers.size() - 1u);
+}
+
+uint32_t QuadraticArcLenInverseBatch::add(uint32_t bezierIdx, float64_t arcLen)
+{
+    assert(bezierIdx < m_beziers.size());
+    m_problems.push_back({ bezierIdx, arcLen });
+    m_results.push_back(0.0);
+    return static_cast<uint32_t>(m_problems.size() - 1u);
+}
+
+void QuadraticArcLenInverseBatch::solve(float64_t accuracyThreshold, uint32_t maxIterations)
+{
+    for (uint32_t p = 0u; p < m_problems.size(); p++)
+    {
+        const Bezier& bezier = m_beziers[m_problems[p].bezierIdx];
+        const float64_t target = nbl::core::min(nbl::core::max(m_problems[p].targetArcLen, 0.0), bezier.arcLen);
+
+        // arc length is monotonic in t, so the linear guess is already in the bracket
+        float64_t low = 0.0;
+        float64_t high = 1.0;
+        float64_t t = (bezier.arcLen > 0.0) ? target / bezier.arcLen : 0.0;
+        for (uint32_t i = 0u; i < maxIterations; i++)
+        {
+            const float64_t error = quadraticArcLen(bezier.a, bezier.b, bezier.c, t) - target;
+            if (abs(error) <= accuracyThreshold)
+                break;
+
+            if (error < 0.0)
+                low = t;
+            else
+                high = t;
+            const float64_t speed = sqrt((bezier.a * t + bezier.b) * t + bezier.c);
+            const float64_t newtonT = t - error / speed;
+            t = (speed > 0.0 && newtonT > low && newtonT < high) ? newtonT : (low + high) * 0.5;
+        }
+        m_results[p] = t;
+    }
+}
+
+}
\ No newline at end of file
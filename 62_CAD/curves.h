@@ -313,9 +313,80 @@ public:
         
     static void adaptive(const OffsettedBezier& curve, float64_t targetMaxError, AddBezierFunc& addBezierFunc, uint32_t maxDepth = 12);
 
+    //! where the beziers of a single input curve ended up in the output of the batched versions of `adaptive`
+    struct BatchedOutputRange
+    {
+        static constexpr uint32_t InvalidOffset = ~0u;
+        uint32_t offset = InvalidOffset; // InvalidOffset if the curve's beziers didn't fit in the output anymore and went through the overflow AddBezierFunc instead
+        uint32_t count = 0u;
+    };
+
+    //! upper bound of beziers a single curve can be subdivided into (a split at the inflection point, then a full binary tree of `maxDepth` levels), use it to size the output of the batched versions
+    static constexpr uint32_t getMaxBeziersPerCurve(uint32_t maxDepth) { return 2u << maxDepth; }
+
+    //! Batched versions of `adaptive` for converting lots of curves at once (e.g. DXF import), same algorithm and error metric as the single curve versions
+    //! the curves are evaluated without any virtual calls and beziers are written straight into `outBeziers` without any AddBezierFunc, in input order, `outRanges[i]` tells you where the i-th curve's beziers are.
+    //! a curve whose beziers don't fit in what's left of `outBeziers` is subdivided by `adaptive` into `overflowAddBezierFunc` instead, so nothing is ever dropped.
+    //! `outRanges` must be at least the size of the input, returns the total number of beziers written to `outBeziers`.
+    static uint32_t adaptiveBatched(std::span<const EllipticalArcInfo> ellipses, float64_t targetMaxError, std::span<shapes::QuadraticBezier<double>> outBeziers, std::span<BatchedOutputRange> outRanges, AddBezierFunc& overflowAddBezierFunc, uint32_t maxDepth = 12);
+
+    //! cubic curves are subdivided over their whole [0, 1] range
+    static uint32_t adaptiveBatched(std::span<const CubicCurve> curves, float64_t targetMaxError, std::span<shapes::QuadraticBezier<double>> outBeziers, std::span<BatchedOutputRange> outRanges, AddBezierFunc& overflowAddBezierFunc, uint32_t maxDepth = 12);
+
 private:
     static void adaptive_impl(const ParametricCurve& curve, float64_t min, float64_t max, float64_t targetMaxError, AddBezierFunc& addBezierFunc, uint32_t depth);
 
+    template<typename CurveEvaluator, typename InputCurve, typename SubdivideSingleFunc>
+    static uint32_t adaptiveBatched_impl(std::span<const InputCurve> curves, float64_t targetMaxError, std::span<shapes::QuadraticBezier<double>> outBeziers, std::span<BatchedOutputRange> outRanges, AddBezierFunc& overflowAddBezierFunc, uint32_t maxDepth, SubdivideSingleFunc&& subdivideOverflowed);
+
+};
+
+//! Arc lengths and inverse arc lengths of many quadratic beziers at once, e.g. placing all the stipple shapes of a polyline section
+//! Newton iterations on the closed form arc length of the quadratic, falling back to bisection whenever a step would leave the bracket of the root.
+//! Beziers are added once and any number of problems can refer to them, `clear` keeps the storage so a batch can be reused without allocating.
+class QuadraticArcLenInverseBatch final
+{
+public:
+    void clear();
+    void reserve(uint32_t bezierCount, uint32_t problemCount);
+
+    //! adds a bezier problems can be queued on, returns it's index, beziers are indexed in the order they were added
+    uint32_t addBezier(const shapes::QuadraticBezier<double>& bezier);
+    //! arc length of the whole bezier
+    float64_t getBezierArcLen(uint32_t bezierIdx) const { return m_beziers[bezierIdx].arcLen; }
+    uint32_t getBezierCount() const { return static_cast<uint32_t>(m_beziers.size()); }
+
+    //! queues solving for the t in [0, 1] at which the arc length of bezier `bezierIdx` from P0 is `arcLen` (clamped to the length of the bezier), returns the index of it's result
+    uint32_t add(uint32_t bezierIdx, float64_t arcLen);
+
+    //! solves every queued problem, `accuracyThreshold` is the max error in arc length
+    void solve(float64_t accuracyThreshold = 1e-5, uint32_t maxIterations = 16u);
+
+    uint32_t getProblemCount() const { return static_cast<uint32_t>(m_problems.size()); }
+    uint32_t getProblemBezier(uint32_t idx) const { return m_problems[idx].bezierIdx; }
+    float64_t getResult(uint32_t idx) const { return m_results[idx]; }
+
+    //! closed form arc length over [0, t] of a curve with |derivative(t)|^2 = a*t^2 + b*t + c
+    static float64_t arcLen(float64_t a, float64_t b, float64_t c, float64_t t);
+
+private:
+    struct Bezier
+    {
+        // coefficients of |derivative(t)|^2 = a*t^2 + b*t + c
+        float64_t a;
+        float64_t b;
+        float64_t c;
+        float64_t arcLen;
+    };
+    struct Problem
+    {
+        uint32_t bezierIdx;
+        float64_t targetArcLen;
+    };
+
+    std::vector<Bezier> m_beziers;
+    std::vector<Problem> m_problems;
+    std::vector<float64_t> m_results;
 };
 } // namespace curves
 #endif
\ No newline at end of file
@@ -21,6 +21,7 @@ using namespace video;
 #include <nbl/builtin/hlsl/cpp_compat/matrix.hlsl>
 #include "Curves.h"
 #include "Hatch.h"
+#include "HatchCache.h"
 #include "Polyline.h"
 #include "DrawResourcesFiller.h"
 #include "SingleLineText.h"
@@ -29,15 +30,30 @@ using namespace video;
 #include "nbl/ext/FullScreenTriangle/FullScreenTriangle.h"
 
 #include "HatchGlyphBuilder.h"
+#include "MemoryArena.h"
 #include "GeoTexture.h"
+#include "Benchmarks.h"
 
 #include <chrono>
 #define BENCHMARK_TILL_FIRST_FRAME
+// CPU-only benchmarks, run once on app init (see Benchmarks.h)
+//#define BENCHMARK_HATCH_CONSTRUCTION
+//#define BENCHMARK_HATCH_SWEEP_SCALING
+//#define BENCHMARK_CURVE_SUBDIVISION
+//#define BENCHMARK_POLYLINE_SECTION_INTERSECTION
+//#define BENCHMARK_POLYLINE_OFFSETTING
+//#define BENCHMARK_STIPPLE_PREPROCESSING
+//#define BENCHMARK_GEOTEXTURE_STREAMING
+//#define BENCHMARK_GLYPH_TO_HATCH
+//#define BENCHMARK_TEXT_LAYOUT
+// Replaces the whole app with a windowless and deviceless one that replays test scenes into a headless DrawResourcesFiller, for machines without a GPU
+//#define BENCHMARK_HEADLESS_RECORDING
 
 static constexpr bool DebugModeWireframe = false;
 static constexpr bool DebugRotatingViewProj = false;
 static constexpr bool FragmentShaderPixelInterlock = true;
-static constexpr bool LargeGeoTextureStreaming = true;
+static constexpr bool LargeGeoTextureStreaming = true; // CASE_7 also converts its image to a tiled geo texture file and streams its tiles with `GeoTextureStreamer` (cpu side only for now)
+static constexpr bool AsyncMSDFGeneration = false; // generate missing glyph/fill pattern MSDFs on background threads, drawing a placeholder until they're ready
 
 enum class ExampleMode
 {
@@ -1031,6 +1047,32 @@ public:
 		m_Camera.setSize(cameraExtents[uint32_t(mode)]);
 
 		m_timeElapsed = 0.0;
+
+		m_hatchCache = std::make_unique<HatchCache>(smart_refctd_ptr(m_system), localOutputCWD / "hatch_cache", logger_opt_smart_ptr(smart_refctd_ptr(m_logger)));
+		if constexpr (LargeGeoTextureStreaming)
+			m_geoTextureStreamer = std::make_unique<GeoTextureStreamer>(smart_refctd_ptr(m_system), 256ull << 20u);
+
+#ifdef BENCHMARK_HATCH_CONSTRUCTION
+		cad_benchmarks::benchmarkHatchConstruction(m_logger.get());
+#endif
+#ifdef BENCHMARK_HATCH_SWEEP_SCALING
+		cad_benchmarks::benchmarkHatchSweepScaling(m_logger.get());
+#endif
+#ifdef BENCHMARK_CURVE_SUBDIVISION
+		cad_benchmarks::benchmarkCurveSubdivision(m_logger.get());
+#endif
+#ifdef BENCHMARK_POLYLINE_SECTION_INTERSECTION
+		cad_benchmarks::benchmarkPolylineSectionIntersection(m_logger.get());
+#endif
+#ifdef BENCHMARK_POLYLINE_OFFSETTING
+		cad_benchmarks::benchmarkPolylineOffsetting(m_logger.get());
+#endif
+#ifdef BENCHMARK_STIPPLE_PREPROCESSING
+		cad_benchmarks::benchmarkStipplePreprocessing(m_logger.get());
+#endif
+#ifdef BENCHMARK_GEOTEXTURE_STREAMING
+		cad_benchmarks::benchmarkGeoTextureStreaming(m_logger.get(), m_system.get(), std::filesystem::temp_directory_path() / "cad_geotexture_benchmark.gtx");
+#endif
 		
 		// Loading font stuff
 		m_textRenderer = nbl::core::make_smart_refctd_ptr<TextRenderer>();
@@ -1039,25 +1081,77 @@ public:
 	
 		if (m_font->getFreetypeFace()->num_charmaps > 0)
 			FT_Set_Charmap(m_font->getFreetypeFace(), m_font->getFreetypeFace()->charmaps[0]);
+
+#ifdef BENCHMARK_GLYPH_TO_HATCH
+		cad_benchmarks::benchmarkGlyphToHatch(m_logger.get(), m_font.get());
+#endif
+#ifdef BENCHMARK_TEXT_LAYOUT
+		cad_benchmarks::benchmarkTextLayout(m_logger.get(), m_font.get());
+#endif
 		
 		const auto str = "MSDF: ABCDEFGHIJKLMNOPQRSTUVWXYZ abcdefghijklmnoprstuvwxyz '1234567890-=\"!@#$%&*()_+";
 		singleLineText = std::unique_ptr<SingleLineText>(new SingleLineText(
 			core::smart_refctd_ptr<FontFace>(m_font), 
 			std::string(str)));
 
-		drawResourcesFiller.setGlyphMSDFTextureFunction(
-			[&](nbl::ext::TextRendering::FontFace* face, uint32_t glyphIdx) -> core::smart_refctd_ptr<asset::ICPUImage>
-			{
-				return face->generateGlyphMSDF(MSDFPixelRange, glyphIdx, drawResourcesFiller.getMSDFResolution(), MSDFMips);
-			}
-		);
+		if (AsyncMSDFGeneration)
+		{
+			// freetype faces aren't thread-safe and the app keeps using its faces, so the workers get a copy of every face the app draws text with and take turns on each copy
+			// the map is filled before the workers start and only read after
+			m_msdfWorkerFaces = std::make_shared<msdf_worker_faces_t>();
+			auto addMSDFWorkerFace = [&](FontFace* sourceFace, const std::string& path)
+				{
+					auto workerFace = std::make_unique<MSDFWorkerFace>();
+					workerFace->face = FontFace::create(core::smart_refctd_ptr(m_textRenderer), std::string(path));
+					if (!workerFace->face)
+						return;
+					if (workerFace->face->getFreetypeFace()->num_charmaps > 0)
+						FT_Set_Charmap(workerFace->face->getFreetypeFace(), workerFace->face->getFreetypeFace()->charmaps[0]);
+					(*m_msdfWorkerFaces)[sourceFace->getHash()] = std::move(workerFace);
+				};
+			addMSDFWorkerFace(m_font.get(), "C:\\Windows\\Fonts\\arial.ttf");
 
-		drawResourcesFiller.setHatchFillMSDFTextureFunction(
-			[&](HatchFillPattern pattern) -> core::smart_refctd_ptr<asset::ICPUImage>
-			{
-				return Hatch::generateHatchFillPatternMSDF(m_textRenderer.get(), pattern, drawResourcesFiller.getMSDFResolution());
-			}
-		);
+			// the workers may outlive members declared after `drawResourcesFiller`, so the functions hold their own references
+			const uint32_t2 msdfResolution = drawResourcesFiller.getMSDFResolution();
+			drawResourcesFiller.setGlyphMSDFTextureFunction(
+				[workerFaces = m_msdfWorkerFaces, msdfResolution](nbl::ext::TextRendering::FontFace* face, uint32_t glyphIdx) -> core::smart_refctd_ptr<asset::ICPUImage>
+				{
+					// the result gets cached under `face`'s hash, so it has to come from a copy of that very face
+					const auto found = workerFaces->find(face->getHash());
+					assert(found != workerFaces->end());
+					if (found == workerFaces->end())
+						return nullptr;
+					MSDFWorkerFace& workerFace = *found->second;
+					std::lock_guard<std::mutex> lock(workerFace.lock);
+					return workerFace.face->generateGlyphMSDF(MSDFPixelRange, glyphIdx, msdfResolution, MSDFMips);
+				}
+			);
+
+			drawResourcesFiller.setHatchFillMSDFTextureFunction(
+				[textRenderer = m_textRenderer, msdfResolution](HatchFillPattern pattern) -> core::smart_refctd_ptr<asset::ICPUImage>
+				{
+					return Hatch::generateHatchFillPatternMSDF(textRenderer.get(), pattern, msdfResolution);
+				}
+			);
+
+			drawResourcesFiller.enableAsyncMSDFGeneration(Hatch::generateHatchFillPatternMSDF(m_textRenderer.get(), HatchFillPattern::LIGHT_SHADED, msdfResolution));
+		}
+		else
+		{
+			drawResourcesFiller.setGlyphMSDFTextureFunction(
+				[&](nbl::ext::TextRendering::FontFace* face, uint32_t glyphIdx) -> core::smart_refctd_ptr<asset::ICPUImage>
+				{
+					return face->generateGlyphMSDF(MSDFPixelRange, glyphIdx, drawResourcesFiller.getMSDFResolution(), MSDFMips);
+				}
+			);
+
+			drawResourcesFiller.setHatchFillMSDFTextureFunction(
+				[&](HatchFillPattern pattern) -> core::smart_refctd_ptr<asset::ICPUImage>
+				{
+					return Hatch::generateHatchFillPatternMSDF(m_textRenderer.get(), pattern, drawResourcesFiller.getMSDFResolution());
+				}
+			);
+		}
 		
 		m_geoTextureRenderer = std::unique_ptr<GeoTextureRenderer>(new GeoTextureRenderer(smart_refctd_ptr(m_device), smart_refctd_ptr(m_logger)));
 		m_geoTextureRenderer->initialize(geoTexturePipelineShaders[0].get(), geoTexturePipelineShaders[1].get(), compatibleRenderPass.get(), m_globalsBuffer);
@@ -1500,6 +1594,7 @@ protected:
 			}
 		);
 		drawResourcesFiller.reset();
+		m_frameArena.reset();
 
 		if constexpr (mode == ExampleMode::CASE_0)
 		{
@@ -1610,7 +1705,10 @@ protected:
 				}
 				//printf("hatchDebugStep = %d\n", hatchDebugStep);
 				std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
-				Hatch hatch(polylines, SelectedMajorAxis, logger_opt_smart_ptr(smart_refctd_ptr(m_logger)), &hatchDebugStep, debug);
+				// while stepping through the construction it has to actually run with the debug step and output, the cache would just hand back the finished boxes
+				std::shared_ptr<const Hatch> hatch = (hatchDebugStep != 0) ?
+					std::make_shared<const Hatch>(polylines, SelectedMajorAxis, logger_opt_smart_ptr(smart_refctd_ptr(m_logger)), &hatchDebugStep, debug) :
+					m_hatchCache->getOrConstruct(polylines, SelectedMajorAxis);
 				std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
 				//// std::cout << "Hatch::Hatch time = " << std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count() << "[us]" << std::endl;
 				//std::sort(hatch.intersectionAmounts.begin(), hatch.intersectionAmounts.end());
@@ -1623,7 +1721,7 @@ protected:
 				//	"Intersection amounts: 10%%: {}, 25%%: {}, 50%%: {}, 75%%: {}, 90%%: {}, 100%% (max): {}\n",
 				//	percentile(0.1), percentile(0.25), percentile(0.5), percentile(0.75), percentile(0.9), hatch.intersectionAmounts[hatch.intersectionAmounts.size() - 1]
 				//).c_str());
-				drawResourcesFiller.drawHatch(hatch, float32_t4(0.6, 0.6, 0.1, 1.0f), intendedNextSubmit);
+				drawResourcesFiller.drawHatch(*hatch, float32_t4(0.6, 0.6, 0.1, 1.0f), intendedNextSubmit);
 			}
 			if (hatchDebugStep > 0)
 			{
@@ -2982,6 +3080,31 @@ protected:
 					}
 				};
 				cmdbuf->pipelineBarrier(E_DEPENDENCY_FLAGS::EDF_NONE,  { .imgBarriers = afterCopyImageBarriers  });
+
+				if constexpr (LargeGeoTextureStreaming)
+				{
+					// the image is small, but it goes through the same tiled file and streamer a huge one would, placed where the first image object is drawn
+					GeoTextureOBB obb = {};
+					obb.topLeft = float64_t2(0.0, 0.0);
+					obb.dirU = float32_t2(100.0f, 0.0f);
+					obb.aspectRatio = float32_t(origImage->getCreationParameters().extent.height) / float32_t(origImage->getCreationParameters().extent.width);
+					const system::path geoTexturePath = localOutputCWD / "R8G8B8A8_1.gtx";
+					if (!TiledGeoTexture::convert(m_system.get(), geoTexturePath, origImage.get(), obb) || !m_geoTextureStreamer->open(geoTexturePath))
+						m_logger->log("Failed converting %s to a tiled geo texture, it won't be streamed!", ILogger::ELL_ERROR, imagePath.c_str());
+				}
+			}
+			if constexpr (LargeGeoTextureStreaming)
+			{
+				// TODO: upload the tiles loaded this frame into the matching layers of a texture array and draw the returned tiles with `GeoTextureRenderer`
+				ClipProjectionData clipProjection = {};
+				clipProjection.projectionToNDC = m_Camera.constructViewProjection();
+				clipProjection.minClipNDC = float32_t2(-1.0, -1.0);
+				clipProjection.maxClipNDC = float32_t2(+1.0, +1.0);
+				GeoTextureStreamer::FrameStats frameStats = {};
+				m_geoTextureStreamer->update(clipProjection, uint32_t2(m_window->getWidth(), m_window->getHeight()), &frameStats);
+				if (frameStats.loadCount > 0u)
+					m_logger->log("GeoTexture streaming loaded %u tiles of mip %u (%u visible, %u stand-ins, %u missing)", ILogger::ELL_DEBUG,
+						frameStats.loadCount, frameStats.mip, frameStats.visibleTileCount, frameStats.fallbackCount, frameStats.missingCount);
 			}
 			drawResourcesFiller._test_addImageObject({ 0.0, 0.0 }, { 100.0, 100.0 }, 0.0, intendedNextSubmit);
 			drawResourcesFiller._test_addImageObject({ 40.0, +40.0 }, { 100.0, 100.0 }, 0.0, intendedNextSubmit);
@@ -3123,7 +3246,7 @@ protected:
 						{
 							const auto msdfTextureIdx = uint32_t(k) - uint32_t(FirstGeneratedCharacter);
 
-							FreetypeHatchBuilder hatchBuilder;
+							FreetypeHatchBuilder hatchBuilder(&m_frameArena);
 							{
 								FT_Outline_Funcs ftFunctions;
 								ftFunctions.move_to = &ftMoveTo;
@@ -3141,7 +3264,7 @@ protected:
 							assert(loadedGlyph);
 
 							auto& shapePolylines = hatchBuilder.polylines;
-							std::vector<CPolyline> transformedPolylines;
+							std::pmr::vector<CPolyline> transformedPolylines(&m_frameArena);
 
 							auto transformPoint = [&](float64_t2 point)
 							{
@@ -3163,7 +3286,7 @@ protected:
 							{
 								auto& polyline = shapePolylines[polylineIdx];
 								if (polyline.getSectionsCount() == 0) continue;
-								CPolyline transformedPolyline;
+								CPolyline transformedPolyline(&m_frameArena);
 								for (uint32_t sectorIdx = 0; sectorIdx < polyline.getSectionsCount(); sectorIdx++)
 								{
 									auto& section = polyline.getSectionInfoAt(sectorIdx);
@@ -3171,7 +3294,7 @@ protected:
 									{
 										if (section.count == 0u) continue;
 
-										std::vector<float64_t2> points;
+										std::pmr::vector<float64_t2> points(&m_frameArena);
 										for (uint32_t i = section.index; i < section.index + section.count + 1; i++)
 										{
 											auto point = polyline.getLinePointAt(i).p;
@@ -3183,7 +3306,7 @@ protected:
 									{
 										if (section.count == 0u) continue;
 
-										std::vector<nbl::hlsl::shapes::QuadraticBezier<double>> beziers;
+										std::pmr::vector<nbl::hlsl::shapes::QuadraticBezier<double>> beziers(&m_frameArena);
 										for (uint32_t i = section.index; i < section.index + section.count; i++)
 										{
 											QuadraticBezierInfo bezier = polyline.getQuadBezierInfoAt(i);
@@ -3196,11 +3319,11 @@ protected:
 										transformedPolyline.addQuadBeziers(beziers);
 									}
 								}
-								transformedPolylines.push_back(transformedPolyline);
+								transformedPolylines.push_back(std::move(transformedPolyline));
 							}
 
 							if (transformedPolylines.size() == 0) continue;
-							Hatch hatch(transformedPolylines, SelectedMajorAxis);
+							Hatch hatch(transformedPolylines, SelectedMajorAxis, nullptr, nullptr, {}, &m_frameArena);
 							drawResourcesFiller.drawHatch(hatch, float32_t4(1.0, 0.8, 1.0, 1.0f), intendedNextSubmit);
 						}
 
@@ -3274,6 +3397,14 @@ protected:
 	smart_refctd_ptr<IGPUImageView> colorStorageImageView;
 	smart_refctd_ptr<TextRenderer> m_textRenderer;
 	smart_refctd_ptr<FontFace> m_font;
+	// copies of the app's faces only used by the async MSDF generation workers, keyed by the hash of the face they copy
+	struct MSDFWorkerFace
+	{
+		smart_refctd_ptr<FontFace> face;
+		std::mutex lock;
+	};
+	using msdf_worker_faces_t = std::unordered_map<core::blake3_hash_t, std::unique_ptr<MSDFWorkerFace>>;
+	std::shared_ptr<msdf_worker_faces_t> m_msdfWorkerFaces;
 	std::unique_ptr<SingleLineText> singleLineText = nullptr;
 	
 	std::vector<std::unique_ptr<msdfgen::Shape>> m_shapeMSDFImages = {};
@@ -3289,6 +3420,113 @@ protected:
 	#endif
 	
 	std::unique_ptr<GeoTextureRenderer> m_geoTextureRenderer;
+	std::unique_ptr<HatchCache> m_hatchCache;
+	std::unique_ptr<GeoTextureStreamer> m_geoTextureStreamer;
+
+	// backs cpu side temporaries built while recording a frame (glyph hatches for now), reset at the start of `addObjects`
+	MemoryArena m_frameArena{ 1024u * 1024u };
 };
 
+#ifdef BENCHMARK_HEADLESS_RECORDING
+class HeadlessRecordingBenchmark final : public application_templates::MonoSystemMonoLoggerApplication
+{
+	using base_t = application_templates::MonoSystemMonoLoggerApplication;
+public:
+	using base_t::base_t;
+
+	// same sizes as `ComputerAidedDesign::allocateResources(1024 * 1024u)`, so auto-submits happen at the same points
+	static constexpr uint32_t MaxObjects = 1024u * 1024u;
+
+	bool onAppInitialized(smart_refctd_ptr<ISystem>&& system) override
+	{
+		if (!base_t::onAppInitialized(std::move(system)))
+			return false;
+
+		m_textRenderer = nbl::core::make_smart_refctd_ptr<TextRenderer>();
+
+		std::vector<cad_benchmarks::HeadlessRecordingScene> scenes;
+
+		// Polylines
+		std::vector<CPolyline> syntheticPolylines = cad_benchmarks::generateSyntheticPolylines(20000u, 16u, 8u);
+		scenes.push_back({ "polylines", [&](DrawResourcesFiller& filler, SIntendedSubmitInfo& intendedNextSubmit)
+			{
+				for (uint32_t i = 0u; i < syntheticPolylines.size(); ++i)
+				{
+					LineStyleInfo lineStyle = {};
+					lineStyle.screenSpaceLineWidth = 2.0f;
+					lineStyle.worldSpaceLineWidth = 0.0f;
+					lineStyle.color = float32_t4(float(i % 64u) / 64.0f, 0.5f, 0.2f, 1.0f); // reuse a handful of styles, like real drawings
+					filler.drawPolyline(syntheticPolylines[i], lineStyle, intendedNextSubmit);
+				}
+			} });
+
+		// Bike Hatch
+#include "bike_hatch.h"
+		Hatch bikeHatch(polylines, SelectedMajorAxis);
+		scenes.push_back({ "bike_hatch", [&](DrawResourcesFiller& filler, SIntendedSubmitInfo& intendedNextSubmit)
+			{
+				filler.drawHatch(bikeHatch, float32_t4(0.6, 0.6, 0.1, 1.0f), intendedNextSubmit);
+				LineStyleInfo lineStyle = {};
+				lineStyle.screenSpaceLineWidth = 1.0f;
+				lineStyle.color = float32_t4(0.0f, 0.0f, 0.0f, 1.0f);
+				for (const CPolyline& polyline : polylines)
+					filler.drawPolyline(polyline, lineStyle, intendedNextSubmit);
+			} });
+
+		// Text
+		smart_refctd_ptr<FontFace> font = FontFace::create(core::smart_refctd_ptr(m_textRenderer), std::string("C:\\Windows\\Fonts\\arial.ttf"));
+		std::unique_ptr<SingleLineText> text = nullptr;
+		if (font)
+		{
+			if (font->getFreetypeFace()->num_charmaps > 0)
+				FT_Set_Charmap(font->getFreetypeFace(), font->getFreetypeFace()->charmaps[0]);
+			text = std::unique_ptr<SingleLineText>(new SingleLineText(core::smart_refctd_ptr(font), std::string("MSDF: ABCDEFGHIJKLMNOPQRSTUVWXYZ abcdefghijklmnoprstuvwxyz '1234567890-=\"!@#$%&*()_+")));
+			scenes.push_back({ "text", [&](DrawResourcesFiller& filler, SIntendedSubmitInfo& intendedNextSubmit)
+				{
+					for (uint32_t i = 0u; i < 256u; ++i)
+						text->Draw(filler, intendedNextSubmit, float64_t2(0.0, -double(i) * 20.0), float32_t2(1.0f, 1.0f), 0.0f, float32_t4(1.0f, 1.0f, 1.0f, 1.0f));
+				} });
+		}
+		else
+			m_logger->log("Couldn't load the font, skipping the text scene.", ILogger::ELL_WARNING);
+
+		// every scene gets a new filler, they share the generated MSDFs like viewports of the same drawing would
+		smart_refctd_ptr<SharedMSDFCache> sharedMSDFCache = core::make_smart_refctd_ptr<SharedMSDFCache>();
+		const auto allocateFiller = [&](DrawResourcesFiller& filler)
+			{
+				const size_t geometryBufferSize = MaxObjects * sizeof(QuadraticBezierInfo) * 3 + 128 * sizeof(ClipProjectionData);
+				filler.allocateHeadless(MaxObjects * 6u * 2u, MaxObjects, MaxObjects * 5u, geometryBufferSize, 512u, 256u, uint32_t2(MSDFSize, MSDFSize));
+				filler.setSharedMSDFCache(smart_refctd_ptr(sharedMSDFCache));
+				filler.setGlyphMSDFTextureFunction(
+					[&filler](nbl::ext::TextRendering::FontFace* face, uint32_t glyphIdx) -> core::smart_refctd_ptr<asset::ICPUImage>
+					{
+						return face->generateGlyphMSDF(MSDFPixelRange, glyphIdx, filler.getMSDFResolution(), MSDFMips);
+					});
+				filler.setHatchFillMSDFTextureFunction(
+					[&](HatchFillPattern pattern) -> core::smart_refctd_ptr<asset::ICPUImage>
+					{
+						return Hatch::generateHatchFillPatternMSDF(m_textRenderer.get(), pattern, filler.getMSDFResolution());
+					});
+			};
+		cad_benchmarks::benchmarkHeadlessRecording(m_logger.get(), scenes, allocateFiller, 64u, std::filesystem::temp_directory_path());
+		if (font)
+			cad_benchmarks::benchmarkTextThroughput(m_logger.get(), font.get(), allocateFiller, std::string("MSDF: ABCDEFGHIJKLMNOPQRSTUVWXYZ abcdefghijklmnoprstuvwxyz '1234567890-=\"!@#$%&*()_+"));
+		cad_benchmarks::benchmarkSpatialCulling(m_logger.get(), allocateFiller);
+		cad_benchmarks::benchmarkPolylineLOD(m_logger.get(), allocateFiller);
+		m_logger->log("MSDFs generated across all fillers: %llu", ILogger::ELL_PERFORMANCE, sharedMSDFCache->getMissCount());
+
+		return true;
+	}
+
+	void workLoopBody() override {}
+
+	bool keepRunning() override { return false; }
+
+private:
+	smart_refctd_ptr<TextRenderer> m_textRenderer;
+};
+
+NBL_MAIN_FUNC(HeadlessRecordingBenchmark)
+#else
 NBL_MAIN_FUNC(ComputerAidedDesign)
+#endif